@@ -0,0 +1,98 @@
+#ifndef ARENA_C
+#define ARENA_C
+
+#include "arena.h"
+
+local ArenaBlock* arena_allocBlock(const uint_fast64_t);
+
+ERROR_CODE arena_init(Arena* arena, const uint_fast64_t blockSize){
+	memset(arena, 0, sizeof(*arena));
+
+	arena->blockSize = ARENA_ALIGN(blockSize);
+
+	if((arena->blocks = arena_allocBlock(arena->blockSize)) == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	arena->currentBlock = arena->blocks;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+void arena_free(Arena* arena){
+	ArenaBlock* block = arena->blocks;
+
+	while(block != NULL){
+		ArenaBlock* next = block->next;
+
+		free(block);
+
+		block = next;
+	}
+
+	memset(arena, 0, sizeof(*arena));
+}
+
+local ArenaBlock* arena_allocBlock(const uint_fast64_t size){
+	ArenaBlock* block = malloc(sizeof(*block) + size);
+	if(block == NULL){
+		return NULL;
+	}
+
+	block->next = NULL;
+	block->size = size;
+
+	return block;
+}
+
+// Note: Returns NULL if the arena runs out of blocks and no new one could be allocated.
+inline void* arena_alloc(Arena* arena, const uint_fast64_t size){
+	const uint_fast64_t alignedSize = ARENA_ALIGN(size);
+
+	if(arena->offset + alignedSize > arena->currentBlock->size){
+		// Note: Blocks kept from before the last reset get used in order, the ones too small for this allocation are skipped until the next reset.
+		ArenaBlock* block = arena->currentBlock->next;
+		while(block != NULL && block->size < alignedSize){
+			block = block->next;
+		}
+
+		if(block == NULL){
+			// Note: Allocations larger than a block get a block of their own.
+			if((block = arena_allocBlock(alignedSize > arena->blockSize ? alignedSize : arena->blockSize)) == NULL){
+				return NULL;
+			}
+
+			block->next = arena->currentBlock->next;
+			arena->currentBlock->next = block;
+		}
+
+		arena->currentBlock = block;
+		arena->offset = 0;
+	}
+
+	void* ret = (int8_t*) (arena->currentBlock + 1) + arena->offset;
+
+	arena->offset += alignedSize;
+
+	return ret;
+}
+
+// Note: The copy is '\0' terminated.
+inline char* arena_copyString(Arena* arena, const char* s, const uint_fast64_t length){
+	char* ret = arena_alloc(arena, length + 1);
+	if(ret == NULL){
+		return NULL;
+	}
+
+	memcpy(ret, s, length);
+	ret[length] = '\0';
+
+	return ret;
+}
+
+inline void arena_reset(Arena* arena){
+	arena->currentBlock = arena->blocks;
+	arena->offset = 0;
+}
+
+#endif
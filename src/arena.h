@@ -0,0 +1,34 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "util.h"
+
+// Note: Bump pointer allocator for memory that lives only as long as the request it belongs to. Allocations can't be freed one by one, 'arena_reset' hands all of them back at once and keeps the blocks for the next request.
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(size) (((size) + (ARENA_ALIGNMENT - 1)) & ~((uint_fast64_t) ARENA_ALIGNMENT - 1))
+
+// Note: The data of a block follows right after the struct, which is a multiple of 'ARENA_ALIGNMENT' in size.
+typedef struct arenaBlock{
+	struct arenaBlock* next;
+	uint_fast64_t size;
+}ArenaBlock;
+
+typedef struct{
+	ArenaBlock* blocks;
+	ArenaBlock* currentBlock;
+	uint_fast64_t offset;
+	uint_fast64_t blockSize;
+}Arena;
+
+ERROR_CODE arena_init(Arena*, const uint_fast64_t);
+
+void arena_free(Arena*);
+
+void* arena_alloc(Arena*, const uint_fast64_t);
+
+char* arena_copyString(Arena*, const char*, const uint_fast64_t);
+
+void arena_reset(Arena*);
+
+#endif
@@ -0,0 +1,526 @@
+#include "util.c"
+#include "arena.c"
+#include "linkedList.c"
+#include "arrayList.c"
+#include "doublyLinkedList.c"
+#include "properties.c"
+#include "http.c"
+#include "cache.c"
+#include "util.h"
+
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+
+// Note: Load generator used to compare server configurations against each other, e.g. the 'epoll' and 'io_uring' network backends. Also measures the throughput of the request parser for every scan implementation the CPU supports and of the static file cache index.
+
+#define BENCHMARK_READ_BUFFER_SIZE 16384
+
+// Note: Typical browser request, the header fields are what the parser spends its time on.
+#define BENCHMARK_PARSE_REQUEST "GET /index.html HTTP/1.1\r\nHost: localhost:1869\r\nUser-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:99.0) Gecko/20100101 Firefox/99.0\r\nAccept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\nAccept-Language: en-US,en;q=0.5\r\nAccept-Encoding: gzip, deflate, br\r\nDNT: 1\r\nConnection: keep-alive\r\nCookie: session=6f1c2d3e4b5a69788796a5b4c3d2e1f0; theme=dark; consent=1\r\nUpgrade-Insecure-Requests: 1\r\nSec-Fetch-Dest: document\r\nSec-Fetch-Mode: navigate\r\nSec-Fetch-Site: none\r\nSec-Fetch-User: ?1\r\nIf-None-Match: \"5f3a-1c2b3d4e\"\r\nCache-Control: max-age=0\r\n\r\n"
+
+typedef struct{
+	SSL_CTX* sslContext;
+	const char* port;
+	const char* path;
+	uint_fast64_t numRequests;
+	uint_fast64_t numCompletedRequests;
+	uint_fast64_t totalLatencyNanos;
+	bool failed;
+}BenchmarkConnection;
+
+local uint_fast64_t benchmark_getMonotonicTimeNanos(void){
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (uint_fast64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+local int benchmark_connect(const char* port){
+	struct addrinfo addressHints = {0};
+	addressHints.ai_family = AF_INET6;
+	addressHints.ai_socktype = SOCK_STREAM;
+
+	struct addrinfo* serverInfo;
+	int error;
+	if((error = getaddrinfo("::1", port, &addressHints, &serverInfo)) != 0){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "GetaddrInfo: '%s'.", gai_strerror(error));
+
+		return -1;
+	}
+
+	int socketFileDescriptor = -1;
+
+	struct addrinfo* sockInfo;
+	for(sockInfo = serverInfo; sockInfo != NULL; sockInfo = sockInfo->ai_next){
+		if((socketFileDescriptor = socket(sockInfo->ai_family, sockInfo->ai_socktype, sockInfo->ai_protocol)) == -1){
+			continue;
+		}
+
+		if(connect(socketFileDescriptor, sockInfo->ai_addr, sockInfo->ai_addrlen) == -1){
+			close(socketFileDescriptor);
+
+			socketFileDescriptor = -1;
+
+			continue;
+		}
+
+		break;
+	}
+
+	freeaddrinfo(serverInfo);
+
+	if(socketFileDescriptor != -1){
+		const int enable = 1;
+		setsockopt(socketFileDescriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+	}
+
+	return socketFileDescriptor;
+}
+
+// Reads a single response, returns false if the connection broke or the server closed it.
+local bool benchmark_readResponse(SSL* sslInstance, char* buffer, bool* keepAlive){
+	uint_fast64_t bufferLength = 0;
+
+	char* endOfHeader = NULL;
+	while(endOfHeader == NULL){
+		if(bufferLength == BENCHMARK_READ_BUFFER_SIZE - 1){
+			return false;
+		}
+
+		const int numBytesRead = SSL_read(sslInstance, buffer + bufferLength, BENCHMARK_READ_BUFFER_SIZE - 1 - bufferLength);
+		if(numBytesRead <= 0){
+			return false;
+		}
+
+		bufferLength += numBytesRead;
+		buffer[bufferLength] = '\0';
+
+		endOfHeader = strstr(buffer, "\r\n\r\n");
+	}
+
+	const uint_fast64_t headerLength = (endOfHeader - buffer) + 4;
+
+	uint_fast64_t contentLength = 0;
+
+	const char* contentLengthField = strstr(buffer, "Content-Length: ");
+	if(contentLengthField != NULL && contentLengthField < endOfHeader){
+		contentLength = strtoull(contentLengthField + 16, NULL, 10);
+	}
+
+	*keepAlive = strstr(buffer, "Connection: close") == NULL;
+
+	// Discard the body.
+	uint_fast64_t remaining = headerLength + contentLength - MIN(bufferLength, headerLength + contentLength);
+	while(remaining > 0){
+		const int numBytesRead = SSL_read(sslInstance, buffer, MIN(remaining, BENCHMARK_READ_BUFFER_SIZE));
+		if(numBytesRead <= 0){
+			return false;
+		}
+
+		remaining -= numBytesRead;
+	}
+
+	return true;
+}
+
+local void* benchmark_runConnection(void* data){
+	BenchmarkConnection* connection = data;
+
+	char request[512];
+	const int requestLength = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n", connection->path);
+
+	char* buffer = malloc(BENCHMARK_READ_BUFFER_SIZE);
+
+	SSL* sslInstance = NULL;
+	int socketFileDescriptor = -1;
+
+	while(buffer != NULL && connection->numCompletedRequests < connection->numRequests){
+		// (Re)connect, the server closes connections once they reached 'keep_alive_max_requests'.
+		if(sslInstance == NULL){
+			if((socketFileDescriptor = benchmark_connect(connection->port)) == -1){
+				break;
+			}
+
+			sslInstance = SSL_new(connection->sslContext);
+			SSL_set_fd(sslInstance, socketFileDescriptor);
+
+			if(SSL_connect(sslInstance) != 1){
+				ERR_print_errors_fp(stderr);
+
+				break;
+			}
+		}
+
+		const uint_fast64_t start = benchmark_getMonotonicTimeNanos();
+
+		bool keepAlive = false;
+		if(SSL_write(sslInstance, request, requestLength) != requestLength || !benchmark_readResponse(sslInstance, buffer, &keepAlive)){
+			break;
+		}
+
+		connection->totalLatencyNanos += benchmark_getMonotonicTimeNanos() - start;
+		connection->numCompletedRequests++;
+
+		if(!keepAlive){
+			SSL_free(sslInstance);
+			close(socketFileDescriptor);
+
+			sslInstance = NULL;
+			socketFileDescriptor = -1;
+		}
+	}
+
+	connection->failed = connection->numCompletedRequests != connection->numRequests;
+
+	if(sslInstance != NULL){
+		SSL_shutdown(sslInstance);
+		SSL_free(sslInstance);
+	}
+
+	if(socketFileDescriptor != -1){
+		close(socketFileDescriptor);
+	}
+
+	free(buffer);
+
+	return NULL;
+}
+
+local int benchmark_http(const char* port, const uint_fast64_t numConnections, const uint_fast64_t numRequests, const char* path){
+	SSL_CTX* sslContext = SSL_CTX_new(TLS_client_method());
+	if(sslContext == NULL){
+		UTIL_LOG_CONSOLE(LOG_ERR, "Failed to initialise ssl context.");
+
+		return EXIT_FAILURE;
+	}
+
+	SSL_CTX_set_min_proto_version(sslContext, TLS1_3_VERSION);
+
+	BenchmarkConnection* connections = calloc(numConnections, sizeof(*connections));
+	pthread_t* threads = calloc(numConnections, sizeof(*threads));
+
+	if(connections == NULL || threads == NULL){
+		free(connections);
+		free(threads);
+
+		SSL_CTX_free(sslContext);
+
+		return EXIT_FAILURE;
+	}
+
+	const uint_fast64_t start = benchmark_getMonotonicTimeNanos();
+
+	uint_fast64_t i;
+	for(i = 0; i < numConnections; i++){
+		connections[i].sslContext = sslContext;
+		connections[i].port = port;
+		connections[i].path = path;
+		// Spread the remainder over the first connections.
+		connections[i].numRequests = numRequests / numConnections + (i < numRequests % numConnections ? 1 : 0);
+
+		pthread_create(&threads[i], NULL, benchmark_runConnection, &connections[i]);
+	}
+
+	uint_fast64_t numCompletedRequests = 0;
+	uint_fast64_t totalLatencyNanos = 0;
+	uint_fast64_t numFailedConnections = 0;
+
+	for(i = 0; i < numConnections; i++){
+		pthread_join(threads[i], NULL);
+
+		numCompletedRequests += connections[i].numCompletedRequests;
+		totalLatencyNanos += connections[i].totalLatencyNanos;
+		numFailedConnections += connections[i].failed;
+	}
+
+	const double elapsedSeconds = (benchmark_getMonotonicTimeNanos() - start) / 1e9;
+
+	printf("Requests:\t%" PRIuFAST64 "/%" PRIuFAST64 " (%" PRIuFAST64 " failed connections)\n", numCompletedRequests, numRequests, numFailedConnections);
+	printf("Duration:\t%.3fs\n", elapsedSeconds);
+	printf("Throughput:\t%.0f requests/s\n", numCompletedRequests / elapsedSeconds);
+	printf("Mean latency:\t%.1fus\n", numCompletedRequests > 0 ? totalLatencyNanos / 1e3 / numCompletedRequests : 0.0);
+
+	free(connections);
+	free(threads);
+
+	SSL_CTX_free(sslContext);
+
+	return numFailedConnections == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Note: The parser terminates names and values in place, the request gets copied back into the buffer before every iteration. Both are part of the measured time, just like receiving the request would be.
+local int benchmark_parse(const uint_fast64_t numIterations){
+	const char request[] = BENCHMARK_PARSE_REQUEST;
+	const uint_fast64_t requestLength = sizeof(request) - 1;
+
+	char buffer[sizeof(request)];
+
+	int status = EXIT_SUCCESS;
+
+	UtilScanImplementation implementation;
+	for(implementation = UTIL_SCAN_IMPLEMENTATION_PORTABLE; implementation <= util_detectScanImplementation(); implementation++){
+		util_setScanImplementation(implementation);
+
+		uint_fast64_t numFailedRequests = 0;
+
+		const uint_fast64_t start = benchmark_getMonotonicTimeNanos();
+
+		uint_fast64_t i;
+		for(i = 0; i < numIterations; i++){
+			memcpy(buffer, request, requestLength);
+
+			HTTP_Request httpRequest;
+			http_initRequest_(&httpRequest, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+
+			const int_fast64_t headerLength = http_findEndOfHeader(buffer, requestLength);
+
+			if(headerLength == -1 || http_parseHTTP_Request(&httpRequest, buffer, headerLength) != ERROR_NO_ERROR || http_getKnownHeaderField(&httpRequest, HTTP_HEADER_FIELD_IF_NONE_MATCH) == NULL){
+				numFailedRequests++;
+			}
+		}
+
+		const double elapsedSeconds = (benchmark_getMonotonicTimeNanos() - start) / 1e9;
+
+		printf("%s:\n", util_scanImplementationToString(implementation));
+		printf("\tRequests:\t%" PRIuFAST64 " (%" PRIuFAST64 " failed)\n", numIterations, numFailedRequests);
+		printf("\tThroughput:\t%.0f requests/s\n", numIterations / elapsedSeconds);
+		printf("\tThroughput:\t%.3f GB/s\n", numIterations * requestLength / elapsedSeconds / 1e9);
+
+		if(numFailedRequests != 0){
+			status = EXIT_FAILURE;
+		}
+	}
+
+	return status;
+}
+
+// Note: Compares the cache index against walking a list of the same objects, the way the cache looked objects up before it had an index. Only the lookup itself is measured, not the hit statistics 'cache_get' keeps. Lookups cycle through all files, so neither one only ever hits the head of the list.
+local int benchmark_cache(const uint_fast64_t numFiles, const uint_fast64_t numLookups){
+	ERROR_CODE error;
+
+	Cache cache;
+	if((error = cache_init(&cache, 0, GB(1))) != ERROR_NO_ERROR){
+		return EXIT_FAILURE;
+	}
+
+	LinkedList list = {0};
+
+	char (*symbolicFileLocations)[32] = malloc(sizeof(*symbolicFileLocations) * numFiles);
+	uint_fast64_t* symbolicFileLocationLengths = malloc(sizeof(*symbolicFileLocationLengths) * numFiles);
+
+	int status = EXIT_FAILURE;
+
+	if(symbolicFileLocations == NULL || symbolicFileLocationLengths == NULL){
+		goto label_free;
+	}
+
+	uint_fast64_t i;
+	for(i = 0; i < numFiles; i++){
+		symbolicFileLocationLengths[i] = snprintf(symbolicFileLocations[i], sizeof(*symbolicFileLocations), "/img/img_%06" PRIuFAST64 ".png", i);
+
+		uint8_t* data = malloc(sizeof(*data));
+		if(data == NULL){
+			goto label_free;
+		}
+
+		CacheObject* cacheObject;
+		if((error = cache_add(&cache, &cacheObject, data, 1, NULL, 0, symbolicFileLocations[i], symbolicFileLocationLengths[i])) != ERROR_NO_ERROR){
+			free(data);
+
+			goto label_free;
+		}
+
+		linkedList_add(&list, &cacheObject, sizeof(cacheObject));
+	}
+
+	uint_fast64_t numMisses = 0;
+
+	uint_fast64_t start = benchmark_getMonotonicTimeNanos();
+
+	for(i = 0; i < numLookups; i++){
+		if(cache_lookup(cache.index, symbolicFileLocations[i % numFiles], symbolicFileLocationLengths[i % numFiles], cache_hashKey(symbolicFileLocations[i % numFiles], symbolicFileLocationLengths[i % numFiles])) == NULL){
+			numMisses++;
+		}
+	}
+
+	const double indexSeconds = (benchmark_getMonotonicTimeNanos() - start) / 1e9;
+
+	start = benchmark_getMonotonicTimeNanos();
+
+	for(i = 0; i < numLookups; i++){
+		const char* symbolicFileLocation = symbolicFileLocations[i % numFiles];
+		const uint_fast64_t symbolicFileLocationLength = symbolicFileLocationLengths[i % numFiles];
+
+		CacheObject* found = NULL;
+
+		LinkedListIterator it;
+		linkedList_initIterator(&it, &list);
+
+		while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+			CacheObject* cacheObject = LINKED_LIST_ITERATOR_NEXT_PTR(&it, CacheObject);
+
+			if(cacheObject->symbolicFileLocationLength == symbolicFileLocationLength && strncmp(cacheObject->symbolicFileLocation, symbolicFileLocation, symbolicFileLocationLength) == 0){
+				found = cacheObject;
+
+				break;
+			}
+		}
+
+		if(found == NULL){
+			numMisses++;
+		}
+	}
+
+	const double listSeconds = (benchmark_getMonotonicTimeNanos() - start) / 1e9;
+
+	printf("Files:\t\t%" PRIuFAST64 "\n", numFiles);
+	printf("Lookups:\t%" PRIuFAST64 " (%" PRIuFAST64 " missed)\n", numLookups, numMisses);
+	printf("Index:\t\t%.0f lookups/s\t%.1fns/lookup\n", numLookups / indexSeconds, indexSeconds * 1e9 / numLookups);
+	printf("List:\t\t%.0f lookups/s\t%.1fns/lookup\n", numLookups / listSeconds, listSeconds * 1e9 / numLookups);
+
+	status = numMisses == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+label_free:
+	linkedList_free(&list);
+
+	cache_free(&cache);
+
+	free(symbolicFileLocations);
+	free(symbolicFileLocationLengths);
+
+	return status;
+}
+
+// Note: Replays a recorded access trace against a cache of 'cacheSize' bytes, every line of the trace is a request '<path> <size in bytes>'. Misses add the file the way the server would load it, so the hit ratios include what admission turned away.
+local int benchmark_cacheTrace(const char* traceFileLocation, const uint_fast64_t cacheSize){
+	FILE* traceFile;
+	if((traceFile = fopen(traceFileLocation, "r")) == NULL){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to open trace: '%s'.", traceFileLocation);
+
+		return EXIT_FAILURE;
+	}
+
+	Cache cache;
+	if(cache_init(&cache, 0, cacheSize) != ERROR_NO_ERROR){
+		fclose(traceFile);
+
+		return EXIT_FAILURE;
+	}
+
+	uint_fast64_t numRequests = 0;
+	uint_fast64_t numHits = 0;
+	uint_fast64_t numBytes = 0;
+	uint_fast64_t numHitBytes = 0;
+	uint_fast64_t numInvalidLines = 0;
+
+	char line[512];
+	while(fgets(line, sizeof(line), traceFile) != NULL){
+		char* separator = strrchr(line, ' ');
+
+		int_fast64_t size;
+		if(separator == NULL || separator == line || util_stringToInt(separator + 1, &size) != ERROR_NO_ERROR || size <= 0){
+			numInvalidLines++;
+
+			continue;
+		}
+
+		const uint_fast64_t symbolicFileLocationLength = separator - line;
+
+		numRequests++;
+		numBytes += size;
+
+		CacheObject* cacheObject;
+
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
+		if(cache_get(&cache, &cacheObject, line, symbolicFileLocationLength) == ERROR_NO_ERROR){
+			numHits++;
+			numHitBytes += size;
+
+			continue;
+		}
+
+		// Note: The content is never read, untouched pages of large objects are not even backed by memory.
+		uint8_t* data = malloc(size);
+		if(data == NULL){
+			break;
+		}
+
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_CACHE_ADMISSION_DENIED);
+		if(cache_add(&cache, &cacheObject, data, size, NULL, 0, line, symbolicFileLocationLength) != ERROR_NO_ERROR){
+			free(data);
+		}
+	}
+
+	fclose(traceFile);
+
+	printf("Requests:\t%" PRIuFAST64 " (%" PRIuFAST64 " invalid lines)\n", numRequests, numInvalidLines);
+	printf("Hit ratio:\t%.2f%%\n", numRequests > 0 ? numHits * 100.0 / numRequests : 0.0);
+	printf("Byte hit ratio:\t%.2f%%\n", numBytes > 0 ? numHitBytes * 100.0 / numBytes : 0.0);
+	printf("Cached:\t\t%" PRIuFAST64 " objects, %" PRIuFAST64 "/%" PRIuFAST64 " bytes\n", cache.numObjects, cache.currentSize, cache.maxSize);
+
+	cache_free(&cache);
+
+	return EXIT_SUCCESS;
+}
+
+local void benchmark_printUsage(void){
+	printf("Usage 'benchmark <benchmark> <arguments>'.\n");
+	printf("\thttp <port> <connections> <requests> <path>\tTLS keep-alive GET requests against a running server.\n");
+	printf("\tparse <requests>\t\t\t\tParses a request header in memory with every scan implementation the CPU supports.\n");
+	printf("\tcache <files> <lookups>\t\t\tLooks files up in the cache index and in a list of the same files.\n");
+	printf("\tcacheTrace <trace> <cache size>\t\tReplays an access trace of '<path> <size>' lines and reports the hit ratio.\n");
+}
+
+int main(const int argc, const char** argv){
+	openlog("herder_benchmark", LOG_CONS | LOG_NDELAY | LOG_PID, LOG_USER);
+
+	int status = EXIT_FAILURE;
+
+	if(argc == 6 && strcmp(argv[1], "http") == 0){
+		int_fast64_t numConnections;
+		int_fast64_t numRequests;
+
+		if(util_stringToInt(argv[3], &numConnections) == ERROR_NO_ERROR && util_stringToInt(argv[4], &numRequests) == ERROR_NO_ERROR && numConnections > 0 && numRequests > 0){
+			status = benchmark_http(argv[2], numConnections, numRequests, argv[5]);
+		}else{
+			benchmark_printUsage();
+		}
+	}else if(argc == 3 && strcmp(argv[1], "parse") == 0){
+		int_fast64_t numIterations;
+
+		if(util_stringToInt(argv[2], &numIterations) == ERROR_NO_ERROR && numIterations > 0){
+			status = benchmark_parse(numIterations);
+		}else{
+			benchmark_printUsage();
+		}
+	}else if(argc == 4 && strcmp(argv[1], "cache") == 0){
+		int_fast64_t numFiles;
+		int_fast64_t numLookups;
+
+		if(util_stringToInt(argv[2], &numFiles) == ERROR_NO_ERROR && util_stringToInt(argv[3], &numLookups) == ERROR_NO_ERROR && numFiles > 0 && numLookups > 0){
+			status = benchmark_cache(numFiles, numLookups);
+		}else{
+			benchmark_printUsage();
+		}
+	}else if(argc == 4 && strcmp(argv[1], "cacheTrace") == 0){
+		int_fast64_t cacheSize;
+
+		if(util_stringToInt(argv[3], &cacheSize) == ERROR_NO_ERROR && cacheSize > 0){
+			status = benchmark_cacheTrace(argv[2], cacheSize);
+		}else{
+			benchmark_printUsage();
+		}
+	}else{
+		benchmark_printUsage();
+	}
+
+	closelog();
+
+	return status;
+}
@@ -3,26 +3,114 @@
 
 #include "cache.h"
 
-#include "linkedList.h"
+#include <zlib.h>
+
 #include "util.h"
 
 local ERROR_CODE cache_initCacheObject(CacheObject*, uint8_t*, const uint_fast64_t, char*, const uint_fast64_t, char*, const uint_fast64_t);
 
 local void cache_freeCacheObject(CacheObject*);
 
-inline ERROR_CODE cache_init(Cache* cache, const uint_fast64_t numThreads, const uint_fast64_t size){
+local ERROR_CODE cache_newCacheObject(CacheObject**, uint8_t*, const uint_fast64_t, char*, const uint_fast64_t, char*, const uint_fast64_t, const time_t);
+
+local ERROR_CODE cache_insert(Cache*, CacheObject**, const bool);
+
+local CacheIndex* cache_newIndex(const uint_fast64_t);
+
+local void cache_freeIndex(CacheIndex*);
+
+local CacheObject* cache_lookup(const CacheIndex*, const char*, const uint_fast64_t, const uint64_t);
+
+local void cache_indexAdd(CacheIndex*, CacheObject*);
+
+local ERROR_CODE cache_growIndex(Cache*);
+
+local bool cache_unlink(Cache*, CacheObject*);
+
+local void cache_retireObject(Cache*, CacheObject*);
+
+local void cache_retireIndex(Cache*, CacheIndex*);
+
+local void cache_reclaim(Cache*);
+
+local void cache_recordAccess(Cache*, const uint64_t);
+
+local uint_fast64_t cache_estimateFrequency(const Cache*, const uint64_t);
+
+local uint_fast64_t cache_getFrequency(const Cache*, const CacheObject*);
+
+local uint_fast64_t cache_getTimeLastHit(const CacheObject*);
+
+local void cache_ageFrequencies(Cache*);
+
+local CacheObject* cache_sampleVictim(Cache*, CacheObject**, const uint_fast64_t);
+
+local bool cache_admit(Cache*, const char*, const uint_fast64_t, const uint_fast64_t);
+
+local ERROR_CODE cache_readFile(const char*, const uint_fast64_t, uint8_t**);
+
+local ERROR_CODE cache_mapFile(const Cache*, const char*, const uint_fast64_t, uint8_t**, uint_fast64_t*);
+
+local ERROR_CODE cache_loadEncodedVariants(CacheObject*);
+
+local ERROR_CODE cache_buildHeaderBlocks(CacheObject*);
+
+local ERROR_CODE cache_buildHeaderBlock(CacheObject*, const bool, const HTTP_ContentEncoding);
+
+local bool cache_appendHeaderField(char*, uint_fast64_t*, const char*, const char*);
+
+local ERROR_CODE cache_compress(const uint8_t*, const uint_fast64_t, uint8_t**, uint_fast64_t*);
+
+local uint_fast64_t cache_getObjectSize(const CacheObject*);
+
+// Note: Accesses this thread recorded that are not yet part of the sample count of the sketch.
+local _Thread_local uint_fast64_t cache_numPendingSamples = 0;
+
+// Note: Every thread that looks objects up while other threads modify the cache has to be one of the 'numReaders' readers.
+inline ERROR_CODE cache_init(Cache* cache, const uint_fast64_t numReaders, const uint_fast64_t size){
 	memset(cache, 0, sizeof(*cache));
 
-	if(sem_init(&cache->activeAcesses, 0, numThreads)){
-		return ERROR(ERROR_PTHREAD_SEMAPHOR_INITIALISATION_FAILED);
+	if(numReaders > 0){
+		if((cache->readers = aligned_alloc(CACHE_READER_ALIGNMENT, sizeof(*cache->readers) * numReaders)) == NULL){
+			return ERROR(ERROR_OUT_OF_MEMORY);
+		}
+
+		uint_fast64_t i;
+		for(i = 0; i < numReaders; i++){
+			cache->readers[i].epoch = CACHE_READER_OFFLINE;
+		}
 	}
 
+	cache->numReaders = numReaders;
+	cache->epoch = 1;
+
 	if(pthread_mutex_init(&cache->lock, NULL)){
+		free(cache->readers);
+
 		return ERROR(ERROR_PTHREAD_MUTEX_INITIALISATION_FAILED);
 	}
 
+	if((cache->index = cache_newIndex(CACHE_INDEX_INITIAL_CAPACITY)) == NULL){
+		pthread_mutex_destroy(&cache->lock);
+
+		free(cache->readers);
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	if((cache->sketch = calloc(1, sizeof(*cache->sketch))) == NULL){
+		cache_freeIndex(cache->index);
+
+		pthread_mutex_destroy(&cache->lock);
+
+		free(cache->readers);
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
 	cache->maxSize = size;
-	cache->numActiveThreads = numThreads;
+	// Note: Any seed but 0 works for xorshift, the sampled slots only have to be spread over the index.
+	cache->randomState = 0x9E3779B97F4A7C15;
 
 	return ERROR(ERROR_NO_ERROR);
 }
@@ -45,6 +133,8 @@ inline ERROR_CODE cache_initCacheObject(CacheObject* cacheObject, uint8_t* data,
 	// Symbolic fileLocation.
 	cacheObject->symbolicFileLocation = malloc(sizeof(*cacheObject->symbolicFileLocation) * (symbolicFileLocationLength + 1));
 	if(cacheObject->symbolicFileLocation == NULL){
+		free(cacheObject->fileLocation);
+
 		return ERROR(ERROR_OUT_OF_MEMORY);
 	}
 
@@ -52,8 +142,14 @@ inline ERROR_CODE cache_initCacheObject(CacheObject* cacheObject, uint8_t* data,
 	cacheObject->symbolicFileLocation[symbolicFileLocationLength] = '\0';
 
 	cacheObject->symbolicFileLocationLength = symbolicFileLocationLength;
+	cacheObject->symbolicFileLocationHash = cache_hashKey(symbolicFileLocation, symbolicFileLocationLength);
 
 	cacheObject->totalHits = 1;
+	cacheObject->numReferences = 1;
+	cacheObject->mappingLength = 0;
+
+	cacheObject->headerBlock = NULL;
+	cacheObject->headerBlockLength = 0;
 
 	// Note: If there is no fileExtension, the offset will be (-1) + 1, and the HTTP_ContentType hash will just be the entire file path. (jan - 2022.09.16)
 	cacheObject->fileExtensionOffset = util_findLast(fileLocation, fileLocationLength, '.') + 1;
@@ -67,56 +163,94 @@ inline ERROR_CODE cache_initCacheObject(CacheObject* cacheObject, uint8_t* data,
 }
 
 inline void cache_free(Cache* cache){
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &cache->elements);
+	uint_fast64_t i;
+	for(i = 0; i <= cache->index->mask; i++){
+		CacheObject* cacheObject = cache->index->slots[i].object;
+
+		if(cacheObject != NULL && cacheObject != CACHE_INDEX_TOMBSTONE){
+			cache_release(cacheObject);
+		}
+	}
 
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		CacheObject* cacheObject = LINKED_LIST_ITERATOR_NEXT_PTR(&it, CacheObject);
+	cache_freeIndex(cache->index);
 
-		free(cacheObject->data);
-		free(cacheObject->fileLocation);
-		free(cacheObject->symbolicFileLocation);
+	// Note: No reader may be left at this point, everything that got retired can go. Objects that are still leased get freed by their last 'cache_release'.
+	while(cache->retiredObjects != NULL){
+		CacheObject* cacheObject = cache->retiredObjects;
+		cache->retiredObjects = cacheObject->nextRetired;
 
-		free(cacheObject);
+		cache_release(cacheObject);
 	}
 
-	linkedList_free(&cache->elements);
+	while(cache->retiredIndices != NULL){
+		CacheIndex* index = cache->retiredIndices;
+		cache->retiredIndices = index->nextRetired;
 
-	sem_destroy(&cache->activeAcesses);
+		cache_freeIndex(index);
+	}
+
+	free(cache->sketch);
+	free(cache->readers);
 
 	pthread_mutex_destroy(&cache->lock);
 }
 
-inline ERROR_CODE cache_get(Cache* cache, CacheObject** cacheObject, char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength){
-	ERROR_CODE error = ERROR_ENTRY_NOT_FOUND;
+// Note: Only affects files that get loaded afterwards.
+inline void cache_setFileMapping(Cache* cache, const CacheFileMapping fileMapping, const bool hugePages){
+	cache->fileMapping = fileMapping;
+	cache->hugePages = hugePages;
+}
 
-	sem_wait(&cache->activeAcesses);
+// Note: The reader may hold objects until it goes offline again. The fence keeps its lookups from being reordered before the announcement of its epoch, otherwise a writer could miss the reader and free an object the reader is about to find.
+inline void cache_online(Cache* cache, const uint_fast64_t reader){
+	__atomic_store_n(&cache->readers[reader].epoch, CACHE_LOAD_ACQUIRE(&cache->epoch), __ATOMIC_RELAXED);
 
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &cache->elements);
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		CacheObject* o = LINKED_LIST_ITERATOR_NEXT_PTR(&it, CacheObject);
-		
-		if(strncmp(symbolicFileLocation, o->symbolicFileLocation, symbolicFileLocationLength > o->symbolicFileLocationLength ? symbolicFileLocationLength : o->symbolicFileLocationLength) == 0){
-			*cacheObject = o;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
 
-			// Update cache entry access time.
-			clock_gettime(CLOCK_MONOTONIC, &o->timeLastHit);
-			o->totalHits++;
+// Note: A quiescent point, the reader must not use any object it got while it was online afterwards. Frees what got retired in the meantime, unless a writer holds the lock and will do so anyway.
+inline void cache_offline(Cache* cache, const uint_fast64_t reader){
+	CACHE_STORE_RELEASE(&cache->readers[reader].epoch, CACHE_READER_OFFLINE);
 
-			error = ERROR_NO_ERROR;
+	if((__atomic_load_n(&cache->retiredObjects, __ATOMIC_RELAXED) != NULL || __atomic_load_n(&cache->retiredIndices, __ATOMIC_RELAXED) != NULL) && pthread_mutex_trylock(&cache->lock) == 0){
+		cache_reclaim(cache);
 
-			goto label_return;
-		}
+		pthread_mutex_unlock(&cache->lock);
+	}
+}
+
+// Note: Lock free, the object stays valid until the calling reader goes offline. Nothing but the statistics of the object and the sketch get written, with plain stores.
+inline ERROR_CODE cache_get(Cache* cache, CacheObject** cacheObject, char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength){
+	const uint64_t hash = cache_hashKey(symbolicFileLocation, symbolicFileLocationLength);
+
+	// Note: Misses count as well, they are what gets a file admitted once the cache is full.
+	cache_recordAccess(cache, hash);
+
+	CacheObject* o = cache_lookup(CACHE_LOAD_ACQUIRE(&cache->index), symbolicFileLocation, symbolicFileLocationLength, hash);
+	if(o == NULL){
+		return ERROR(ERROR_ENTRY_NOT_FOUND);
 	}
 
-label_return:
-	sem_post(&cache->activeAcesses);
+	*cacheObject = o;
+
+	// Note: Readers that hit the same object at the same time may lose some of their hits.
+	__atomic_store_n(&o->totalHits, __atomic_load_n(&o->totalHits, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+
+	// Note: The coarse clock only ticks every few milliseconds, hits in between leave the cache line of the object alone.
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
 
-	return ERROR(error);
+	if(now.tv_nsec != __atomic_load_n(&o->timeLastHit.tv_nsec, __ATOMIC_RELAXED) || now.tv_sec != __atomic_load_n(&o->timeLastHit.tv_sec, __ATOMIC_RELAXED)){
+		__atomic_store_n(&o->timeLastHit.tv_sec, now.tv_sec, __ATOMIC_RELAXED);
+		__atomic_store_n(&o->timeLastHit.tv_nsec, now.tv_nsec, __ATOMIC_RELAXED);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
 }
 
 inline ERROR_CODE cache_load(Cache* cache, CacheObject** cacheObject, char* fileLocation, const uint_fast64_t fileLocationLength, char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength){
+	ERROR_CODE error;
+
 	struct stat fileInfo;
 	
 	if(lstat(fileLocation, &fileInfo) == -1){
@@ -126,31 +260,167 @@ inline ERROR_CODE cache_load(Cache* cache, CacheObject** cacheObject, char* file
 	if(!S_ISREG(fileInfo.st_mode)){
 		return ERROR_(ERROR_FAILED_TO_RETRIEV_FILE_INFO, "File:'%s'", fileLocation);
 	}
-	
-	const uint_fast64_t fileSize = fileInfo.st_size;
-	
+
+	// Note: Decided before the file gets read and compressed, a file that is not admitted costs nothing but the 'lstat'. The size of the file stands in for the size of the object, the variants only add less than that on top.
+	pthread_mutex_lock(&cache->lock);
+
+	const bool admitted = cache_admit(cache, symbolicFileLocation, symbolicFileLocationLength, fileInfo.st_size);
+
+	pthread_mutex_unlock(&cache->lock);
+
+	if(!admitted){
+		return ERROR_(ERROR_CACHE_ADMISSION_DENIED, "File:'%s'", fileLocation);
+	}
+
+	uint8_t* data;
+	uint_fast64_t mappingLength = 0;
+
+	// Note: Empty files can't be mapped.
+	if(cache->fileMapping != CACHE_FILE_MAPPING_NONE && fileInfo.st_size > 0){
+		error = cache_mapFile(cache, fileLocation, fileInfo.st_size, &data, &mappingLength);
+	}else{
+		error = cache_readFile(fileLocation, fileInfo.st_size, &data);
+	}
+
+	if(error != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	if((error = cache_newCacheObject(cacheObject, data, fileInfo.st_size, fileLocation, fileLocationLength, symbolicFileLocation, symbolicFileLocationLength, fileInfo.st_mtime)) != ERROR_NO_ERROR){
+		if(mappingLength != 0){
+			munmap(data, mappingLength);
+		}else{
+			free(data);
+		}
+
+		return ERROR(error);
+	}
+
+	(*cacheObject)->mappingLength = mappingLength;
+
+	cache_formatFileEntityTag((*cacheObject)->entityTag, &fileInfo);
+
+	// Note: Variants are optional, the object is still served unencoded if they fail to load.
+	if((error = cache_loadEncodedVariants(*cacheObject)) != ERROR_NO_ERROR){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to load encoded variants of: '%s'. [%s]", fileLocation, util_toErrorString(error));
+	}
+
+	if((error = cache_buildHeaderBlocks(*cacheObject)) != ERROR_NO_ERROR){
+		cache_freeCacheObject(*cacheObject);
+		free(*cacheObject);
+
+		return ERROR(error);
+	}
+
+	return cache_insert(cache, cacheObject, false);
+}
+
+// Note: Once the object got added 'data' belongs to the cache, even if another object for the same key made it in first and 'data' got freed together with the new object. On any error 'data' stays with the caller.
+inline ERROR_CODE cache_add(Cache* cache, CacheObject** cacheObject, uint8_t* data, const uint_fast64_t bufferSize, char* fileLocation, const uint_fast64_t fileLocationLength, char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength){
+	ERROR_CODE error;
+
+	pthread_mutex_lock(&cache->lock);
+
+	const bool admitted = cache_admit(cache, symbolicFileLocation, symbolicFileLocationLength, bufferSize);
+
+	pthread_mutex_unlock(&cache->lock);
+
+	// Note: 'data' stays with the caller if the object is not admitted.
+	if(!admitted){
+		return ERROR_(ERROR_CACHE_ADMISSION_DENIED, "File:'%s'", symbolicFileLocation);
+	}
+
+	if((error = cache_newCacheObject(cacheObject, data, bufferSize, fileLocation, fileLocationLength, symbolicFileLocation, symbolicFileLocationLength, time(NULL))) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	// Note: There is no file to identify the object by, only its content.
+	http_formatEntityTag((*cacheObject)->entityTag, util_hash64(data, bufferSize), bufferSize);
+
+	if((error = cache_buildHeaderBlocks(*cacheObject)) != ERROR_NO_ERROR){
+		free((*cacheObject)->fileLocation);
+		free((*cacheObject)->symbolicFileLocation);
+		free((*cacheObject)->headerBlock);
+		free(*cacheObject);
+
+		return ERROR(error);
+	}
+
+	return cache_insert(cache, cacheObject, true);
+}
+
+inline ERROR_CODE cache_readFile(const char* fileLocation, const uint_fast64_t fileSize, uint8_t** data){
 	FILE* file;
 	if((file = fopen(fileLocation, "r")) == NULL){
 		return ERROR(ERROR_FAILED_TO_LOAD_FILE);
 	}	
 
-	uint8_t* data = malloc(sizeof(*data) * fileSize);
-	if(data == NULL){
+	*data = malloc(sizeof(**data) * fileSize);
+	if(*data == NULL){
+		fclose(file);
+
 		return ERROR(ERROR_OUT_OF_MEMORY);
 	}
 
-	if(fread(data, sizeof(uint8_t), fileSize, file) != fileSize){
+	if(fread(*data, sizeof(uint8_t), fileSize, file) != fileSize){
+		fclose(file);
+		free(*data);
+
 		return ERROR(ERROR_FAILED_TO_LOAD_FILE);
 	}
 
 	if(fclose(file) != 0){
+		free(*data);
+
 		return ERROR(ERROR_FAILED_TO_CLOSE_FILE);
 	}
 
-	return cache_add(cache, cacheObject, data, fileSize, fileLocation, fileLocationLength, symbolicFileLocation, symbolicFileLocationLength);
+	return ERROR(ERROR_NO_ERROR);
 }
 
-ERROR_CODE cache_add(Cache* cache, CacheObject** cacheObject, uint8_t* data, const uint_fast64_t bufferSize, char* fileLocation, const uint_fast64_t fileLocationLength, char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength){
+// Note: The mapping outlives the file descriptor. The size is checked again on the open file, a file that got truncated since it was looked at would fault once the missing pages get sent.
+ERROR_CODE cache_mapFile(const Cache* cache, const char* fileLocation, const uint_fast64_t fileSize, uint8_t** data, uint_fast64_t* mappingLength){
+	const int fileDescriptor = open(fileLocation, O_RDONLY);
+	if(fileDescriptor == -1){
+		return ERROR(ERROR_FAILED_TO_LOAD_FILE);
+	}
+
+	struct stat fileInfo;
+	if(fstat(fileDescriptor, &fileInfo) == -1 || (uint_fast64_t) fileInfo.st_size != fileSize){
+		close(fileDescriptor);
+
+		return ERROR_(ERROR_FAILED_TO_LOAD_FILE, "File:'%s' changed on disk.", fileLocation);
+	}
+
+	const int flags = MAP_SHARED | (cache->fileMapping == CACHE_FILE_MAPPING_POPULATE ? MAP_POPULATE : 0);
+
+	void* mapping = mmap(NULL, fileSize, PROT_READ, flags, fileDescriptor, 0);
+
+	close(fileDescriptor);
+
+	if(mapping == MAP_FAILED){
+		return ERROR_(ERROR_FAILED_TO_LOAD_FILE, "File:'%s' %s.", fileLocation, strerror(errno));
+	}
+
+	// Note: Both are only hints, a kernel that does not follow them still serves the mapping.
+	if(cache->hugePages){
+		madvise(mapping, fileSize, MADV_HUGEPAGE);
+	}
+
+	if(cache->fileMapping == CACHE_FILE_MAPPING_WILLNEED){
+		madvise(mapping, fileSize, MADV_WILLNEED);
+	}
+
+	const uint_fast64_t pageSize = sysconf(_SC_PAGESIZE);
+
+	*data = mapping;
+	*mappingLength = (fileSize + pageSize - 1) & ~(pageSize - 1);
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: 'data' stays with the caller if the object can't be created.
+ERROR_CODE cache_newCacheObject(CacheObject** cacheObject, uint8_t* data, const uint_fast64_t bufferSize, char* fileLocation, const uint_fast64_t fileLocationLength, char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength, const time_t lastModified){
 	ERROR_CODE error;
 
 	*cacheObject = malloc(sizeof(**cacheObject));
@@ -159,108 +429,728 @@ ERROR_CODE cache_add(Cache* cache, CacheObject** cacheObject, uint8_t* data, con
 	}
 
 	if((error = cache_initCacheObject(*cacheObject, data, bufferSize, fileLocation, fileLocationLength, symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
+		free(*cacheObject);
+
 		return ERROR(error);
 	}
 
-	// Lock cache.
-	pthread_mutex_lock(&cache->lock);
+	(*cacheObject)->lastModified = lastModified;
 
-	uint_fast64_t i;
-	for(i = 0; i < cache->numActiveThreads; i++){
-		sem_wait(&cache->activeAcesses);
-	}
+	memset((*cacheObject)->encodedVariants, 0, sizeof((*cacheObject)->encodedVariants));
+
+	return ERROR(ERROR_NO_ERROR);
+}
 
-	label_removeStaleCacheObjects:
-	if(cache->currentSize + (*cacheObject)->size > cache->maxSize){
-		// TODO: Implement better algorithem to delete old cacheObjects.
+// Note: Derived from the inode, the modification time and the size instead of the content, so a file carries the same entity tag whether it is served from the cache or streamed from disk. Hashing whole files that get streamed on every request would be too expensive.
+void cache_formatFileEntityTag(char* entityTag, const struct stat* fileInfo){
+	const uint64_t fileIdentity[] = {fileInfo->st_ino, fileInfo->st_mtim.tv_sec, fileInfo->st_mtim.tv_nsec};
 
-		uint_fast64_t maxSize = 0;
-		CacheObject* staleObject = NULL;
+	http_formatEntityTag(entityTag, util_hash64((uint8_t*) fileIdentity, sizeof(fileIdentity)), fileInfo->st_size);
+}
 
-		LinkedListIterator it;
-		linkedList_initIterator(&it, &cache->elements);
+// Note: Prefers a precompressed '.gz' sibling that is at least as new as the file itself, otherwise compresses the content once here. Variants that end up larger than the original are dropped.
+ERROR_CODE cache_loadEncodedVariants(CacheObject* cacheObject){
+	ERROR_CODE error;
 
-		while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-			CacheObject* o = LINKED_LIST_ITERATOR_NEXT(&it);
+	if(cacheObject->fileLocationLength == 0 || !http_isCompressibleContentType(cacheObject->httpContentType)){
+		return ERROR(ERROR_NO_ERROR);
+	}
 
-			if(o->size >= maxSize){
-				staleObject = o;
-			}
-		}
+	const uint_fast64_t gzipFileLocationLength = cacheObject->fileLocationLength + 3/*".gz"*/;
+
+	char* gzipFileLocation = alloca(sizeof(*gzipFileLocation) * (gzipFileLocationLength + 1));
+	memcpy(gzipFileLocation, cacheObject->fileLocation, cacheObject->fileLocationLength);
+	memcpy(gzipFileLocation + cacheObject->fileLocationLength, ".gz", 4);
+
+	uint8_t* data;
+	uint_fast64_t size;
 
-		cache->currentSize -= staleObject->size;
+	struct stat fileInfo;
+	if(lstat(gzipFileLocation, &fileInfo) == 0 && S_ISREG(fileInfo.st_mode) && fileInfo.st_mtime >= cacheObject->lastModified){
+		size = fileInfo.st_size;
 
-		if(cache->currentSize + (*cacheObject)->size > cache->maxSize){
-			goto label_removeStaleCacheObjects;
+		if((error = cache_readFile(gzipFileLocation, size, &data)) != ERROR_NO_ERROR){
+			return ERROR(error);
 		}
-		
-		// Unlock cache to remove entry.
-		for(; i > 0; i--){
-			sem_post(&cache->activeAcesses);
+	}else{
+		// Note: Generated variants have no file to fall back on, so they are never sent with 'sendfile'.
+		gzipFileLocation[0] = '\0';
+
+		if((error = cache_compress(cacheObject->data, cacheObject->size, &data, &size)) != ERROR_NO_ERROR){
+			return ERROR(error);
 		}
+	}
 
-		pthread_mutex_unlock(&cache->lock);
+	if(size >= cacheObject->size){
+		free(data);
 
-		ERROR_CODE error;
-		if((error = cache_remove(cache, staleObject)) != ERROR_NO_ERROR){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	CacheObject* variant;
+	if((error = cache_newCacheObject(&variant, data, size, gzipFileLocation, strlen(gzipFileLocation), cacheObject->symbolicFileLocation, cacheObject->symbolicFileLocationLength, cacheObject->lastModified)) != ERROR_NO_ERROR){
+		free(data);
+
+		return ERROR(error);
+	}
+
+	variant->httpContentType = cacheObject->httpContentType;
+
+	// Note: Generated variants have no file of their own, the content hash keeps them apart from the object and stable across restarts.
+	http_formatEntityTag(variant->entityTag, util_hash64(data, size), size);
+
+	cacheObject->encodedVariants[HTTP_CONTENT_ENCODING_GZIP] = variant;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Variants only exist once 'cache_loadEncodedVariants' ran, and every representation of a resource with variants has to carry 'Vary'.
+ERROR_CODE cache_buildHeaderBlocks(CacheObject* cacheObject){
+	ERROR_CODE error;
+
+	const bool vary = cache_hasEncodedVariants(cacheObject);
+
+	if((error = cache_buildHeaderBlock(cacheObject, vary, HTTP_CONTENT_ENCODING_IDENTITY)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	uint_fast8_t i;
+	for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		if(cacheObject->encodedVariants[i] != NULL && (error = cache_buildHeaderBlock(cacheObject->encodedVariants[i], vary, i)) != ERROR_NO_ERROR){
 			return ERROR(error);
 		}
+	}
 
-		// Relock cache.
-		pthread_mutex_lock(&cache->lock);
+	return ERROR(ERROR_NO_ERROR);
+}
 
-		for(i = 0; i < cache->numActiveThreads; i++){
-			sem_wait(&cache->activeAcesses);
-		}
+// Note: The fields are ordered so that the ones a '304 Not Modified' and a '206 Partial Content' carry are prefixes of the block.
+ERROR_CODE cache_buildHeaderBlock(CacheObject* cacheObject, const bool vary, const HTTP_ContentEncoding contentEncoding){
+	char headerBlock[CACHE_MAX_HEADER_BLOCK_SIZE];
+	uint_fast64_t length = 0;
+
+	char lastModified[HTTP_DATE_LENGTH + 1];
+	http_formatDate(lastModified, cacheObject->lastModified);
+
+	char contentLength[24];
+	snprintf(contentLength, sizeof(contentLength), "%" PRIuFAST64, cacheObject->size);
+
+	bool fits = true;
+
+	if(vary){
+		fits &= cache_appendHeaderField(headerBlock, &length, "Vary", CONSTANTS_HTTP_HEADER_FIELD_ACCEPT_ENCODING_NAME);
 	}
 
-	linkedList_add(&cache->elements, cacheObject, sizeof(CacheObject*));
+	if(contentEncoding != HTTP_CONTENT_ENCODING_IDENTITY){
+		fits &= cache_appendHeaderField(headerBlock, &length, "Content-Encoding", http_contentEncodingToString(contentEncoding));
+	}
 
-	cache->currentSize += (*cacheObject)->size;
+	fits &= cache_appendHeaderField(headerBlock, &length, "ETag", cacheObject->entityTag);
+	fits &= cache_appendHeaderField(headerBlock, &length, "Last-Modified", lastModified);
 
-	// Unlock cache.
-	for(; i > 0; i--){
-		sem_post(&cache->activeAcesses);
+	const uint_fast64_t notModifiedLength = length;
+
+	fits &= cache_appendHeaderField(headerBlock, &length, "Accept-Ranges", "bytes");
+
+	const uint_fast64_t partialLength = length;
+
+	fits &= cache_appendHeaderField(headerBlock, &length, "Content-Length", contentLength);
+	fits &= cache_appendHeaderField(headerBlock, &length, "Content-Type", http_contentTypeToString(cacheObject->httpContentType));
+
+	if(!fits){
+		return ERROR_(ERROR_BUFFER_OVERFLOW, "File:'%s'", cacheObject->symbolicFileLocation);
 	}
 
-	pthread_mutex_unlock(&cache->lock);
+	cacheObject->headerBlock = malloc(sizeof(*cacheObject->headerBlock) * length);
+	if(cacheObject->headerBlock == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	memcpy(cacheObject->headerBlock, headerBlock, length);
+
+	cacheObject->headerBlockLength = length;
+	cacheObject->notModifiedHeaderBlockLength = notModifiedLength;
+	cacheObject->partialHeaderBlockLength = partialLength;
 
 	return ERROR(ERROR_NO_ERROR);
 }
 
-ERROR_CODE cache_remove(Cache* cache, CacheObject* cacheObject){
+// Note: Appends 'name: value\r\n' to a buffer of CACHE_MAX_HEADER_BLOCK_SIZE bytes, returns false if it does not fit.
+bool cache_appendHeaderField(char* buffer, uint_fast64_t* length, const char* name, const char* value){
+	const uint_fast64_t nameLength = strlen(name);
+	const uint_fast64_t valueLength = strlen(value);
+
+	if(CACHE_MAX_HEADER_BLOCK_SIZE - *length < nameLength + 2/*": "*/ + valueLength + 2/*"\r\n"*/){
+		return false;
+	}
+
+	memcpy(buffer + *length, name, nameLength);
+	*length += nameLength;
+
+	memcpy(buffer + *length, ": ", 2);
+	*length += 2;
+
+	memcpy(buffer + *length, value, valueLength);
+	*length += valueLength;
+
+	memcpy(buffer + *length, "\r\n", 2);
+	*length += 2;
+
+	return true;
+}
+
+ERROR_CODE cache_compress(const uint8_t* data, const uint_fast64_t size, uint8_t** compressedData, uint_fast64_t* compressedSize){
+	z_stream stream = {0};
+
+	// Note: 15 + 16 window bits selects the gzip wrapper instead of the zlib one.
+	if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+		return ERROR(ERROR_FAILED_TO_COMPRESS);
+	}
+
+	const uint_fast64_t bufferSize = deflateBound(&stream, size);
+
+	*compressedData = malloc(sizeof(**compressedData) * bufferSize);
+	if(*compressedData == NULL){
+		deflateEnd(&stream);
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	stream.next_in = (Bytef*) data;
+	stream.avail_in = size;
+	stream.next_out = *compressedData;
+	stream.avail_out = bufferSize;
+
+	const int ret = deflate(&stream, Z_FINISH);
+
+	*compressedSize = stream.total_out;
+
+	deflateEnd(&stream);
+
+	if(ret != Z_STREAM_END){
+		free(*compressedData);
+
+		return ERROR(ERROR_FAILED_TO_COMPRESS);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Returns the variant for 'contentEncoding', or the object itself if there is none.
+inline CacheObject* cache_getEncodedVariant(CacheObject* cacheObject, const HTTP_ContentEncoding contentEncoding){
+	if(cacheObject->encodedVariants[contentEncoding] != NULL){
+		return cacheObject->encodedVariants[contentEncoding];
+	}
+
+	return cacheObject;
+}
+
+inline bool cache_hasEncodedVariants(const CacheObject* cacheObject){
+	uint_fast8_t i;
+	for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		if(cacheObject->encodedVariants[i] != NULL){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Memory held by the object and all of its variants.
+// Note: Mapped data is shared with the page cache, but it keeps the pages of the file referenced and takes up a mapping of its own, so it still counts against the size of the cache with every page it spans.
+inline uint_fast64_t cache_getObjectSize(const CacheObject* cacheObject){
+	uint_fast64_t size = (cacheObject->mappingLength != 0 ? cacheObject->mappingLength : cacheObject->size) + cacheObject->headerBlockLength;
+
+	uint_fast8_t i;
+	for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		if(cacheObject->encodedVariants[i] != NULL){
+			size += cacheObject->encodedVariants[i]->size + cacheObject->encodedVariants[i]->headerBlockLength;
+		}
+	}
+
+	return size;
+}
+
+// Note: Two workers may load the same file at the same time, the object that made it into the cache first wins and the other one gets freed, data included. That still counts as a success. If the object can't be added, 'keepDataOnError' leaves its data to the caller.
+ERROR_CODE cache_insert(Cache* cache, CacheObject** cacheObject, const bool keepDataOnError){
 	ERROR_CODE error;
 
+	// Lock cache.
 	pthread_mutex_lock(&cache->lock);
 
-	uint_fast64_t i;
-	for(i = 0; i < cache->numActiveThreads; i++){
-		sem_wait(&cache->activeAcesses);
+	CacheObject* existingObject = cache_lookup(cache->index, (*cacheObject)->symbolicFileLocation, (*cacheObject)->symbolicFileLocationLength, (*cacheObject)->symbolicFileLocationHash);
+	if(existingObject != NULL){
+		pthread_mutex_unlock(&cache->lock);
+
+		cache_freeCacheObject(*cacheObject);
+
+		free(*cacheObject);
+
+		*cacheObject = existingObject;
+
+		return ERROR(ERROR_NO_ERROR);
 	}
 
-	if((error = linkedList_remove(&cache->elements, &cacheObject, sizeof(CacheObject*))) != ERROR_NO_ERROR){
-		return ERROR_(error, "Failed to remove cacheobject '%s' from cache. [%s]", cacheObject->symbolicFileLocation, util_toErrorString(error));
+	// Note: The object got admitted before it was built, room is made for it no matter how frequently the victims were used.
+	const uint_fast64_t size = cache_getObjectSize(*cacheObject);
+
+	while(cache->currentSize + size > cache->maxSize){
+		CacheObject* victim = cache_sampleVictim(cache, NULL, 0);
+		if(victim == NULL){
+			break;
+		}
+
+		cache_unlink(cache, victim);
+
+		cache_retireObject(cache, victim);
 	}
 
-	cache->currentSize += cacheObject->size;
+	if((cache->index->numUsedSlots + 1) * 4 > (cache->index->mask + 1) * 3 && (error = cache_growIndex(cache)) != ERROR_NO_ERROR){
+		pthread_mutex_unlock(&cache->lock);
+
+		if(keepDataOnError){
+			(*cacheObject)->data = NULL;
+			(*cacheObject)->mappingLength = 0;
+		}
+
+		cache_freeCacheObject(*cacheObject);
 
-	for(; i > 0; i--){
-		sem_post(&cache->activeAcesses);
+		free(*cacheObject);
+
+		return ERROR(error);
 	}
 
+	cache_indexAdd(cache->index, *cacheObject);
+
+	cache->numObjects++;
+	cache->currentSize += size;
+
+	cache_reclaim(cache);
+
+	// Unlock cache.
 	pthread_mutex_unlock(&cache->lock);
 
+	return ERROR(ERROR_NO_ERROR);
+}
+
+ERROR_CODE cache_remove(Cache* cache, CacheObject* cacheObject){
+	pthread_mutex_lock(&cache->lock);
+
+	if(!cache_unlink(cache, cacheObject)){
+		pthread_mutex_unlock(&cache->lock);
+
+		return ERROR_(ERROR_ENTRY_NOT_FOUND, "Failed to remove cacheobject '%s' from cache.", cacheObject->symbolicFileLocation);
+	}
+
+	cache_retireObject(cache, cacheObject);
+
+	cache_reclaim(cache);
+
+	pthread_mutex_unlock(&cache->lock);
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Only called while the reader that found the object is online, the reference of the cache can't be gone before. The lease keeps the object, its variants and its header block valid after the reader went offline, until it gets released.
+inline void cache_acquire(CacheObject* cacheObject){
+	__atomic_fetch_add(&cacheObject->numReferences, 1, __ATOMIC_RELAXED);
+}
+
+// Note: Whoever drops the last reference frees the object, a sender that finishes after the object got evicted and reclaimed just as well as 'cache_reclaim'.
+inline void cache_release(CacheObject* cacheObject){
+	if(__atomic_fetch_sub(&cacheObject->numReferences, 1, __ATOMIC_ACQ_REL) != 1){
+		return;
+	}
+
 	cache_freeCacheObject(cacheObject);
 
 	free(cacheObject);
+}
+
+// Note: Only called with the lock held. Takes the object out of the index and the accounting, readers that found it before may still use it.
+bool cache_unlink(Cache* cache, CacheObject* cacheObject){
+	CacheIndex* index = cache->index;
+
+	uint_fast64_t i = cacheObject->symbolicFileLocationHash & index->mask;
+	while(index->slots[i].object != cacheObject){
+		if(index->slots[i].object == NULL){
+			return false;
+		}
+
+		i = (i + 1) & index->mask;
+	}
+
+	// Note: The slot keeps counting as used until the index gets rebuilt, lookups that run into it just probe on.
+	CACHE_STORE_RELEASE(&index->slots[i].object, CACHE_INDEX_TOMBSTONE);
+
+	cache->numObjects--;
+	cache->currentSize -= cache_getObjectSize(cacheObject);
+
+	return true;
+}
+
+// Note: FNV-1a, finished with the MurmurHash3 finalizer so the low bits used as slot index depend on every byte of the key.
+inline uint64_t cache_hashKey(const char* key, const uint_fast64_t keyLength){
+	uint64_t hash = util_hash64((const uint8_t*) key, keyLength);
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCD;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+CacheIndex* cache_newIndex(const uint_fast64_t capacity){
+	CacheIndex* index = malloc(sizeof(*index));
+	if(index == NULL){
+		return NULL;
+	}
+
+	index->slots = aligned_alloc(CACHE_INDEX_SLOTS_ALIGNMENT, sizeof(*index->slots) * capacity);
+	if(index->slots == NULL){
+		free(index);
+
+		return NULL;
+	}
+
+	memset(index->slots, 0, sizeof(*index->slots) * capacity);
+
+	index->nextRetired = NULL;
+	index->mask = capacity - 1;
+	index->numUsedSlots = 0;
+
+	return index;
+}
+
+void cache_freeIndex(CacheIndex* index){
+	free(index->slots);
+	free(index);
+}
+
+// Note: Safe to call without holding the lock. A slot gets its tag before its object is published, an outdated tag only costs a key comparison.
+CacheObject* cache_lookup(const CacheIndex* index, const char* key, const uint_fast64_t keyLength, const uint64_t hash){
+	const uint64_t tag = CACHE_INDEX_TAG(hash, keyLength);
+
+	uint_fast64_t i = hash & index->mask;
+	for(;;){
+		const CacheIndexSlot* slot = &index->slots[i];
+
+		CacheObject* o = CACHE_LOAD_ACQUIRE(&slot->object);
+		if(o == NULL){
+			return NULL;
+		}
+
+		if(o != CACHE_INDEX_TOMBSTONE && __atomic_load_n(&slot->tag, __ATOMIC_RELAXED) == tag && o->symbolicFileLocationLength == keyLength && memcmp(o->symbolicFileLocation, key, keyLength) == 0){
+			return o;
+		}
+
+		i = (i + 1) & index->mask;
+	}
+}
+
+// Note: Only called with the lock held, the index always has a free slot left.
+void cache_indexAdd(CacheIndex* index, CacheObject* cacheObject){
+	uint_fast64_t i = cacheObject->symbolicFileLocationHash & index->mask;
+	while(index->slots[i].object != NULL){
+		i = (i + 1) & index->mask;
+	}
+
+	__atomic_store_n(&index->slots[i].tag, CACHE_INDEX_TAG(cacheObject->symbolicFileLocationHash, cacheObject->symbolicFileLocationLength), __ATOMIC_RELAXED);
+	CACHE_STORE_RELEASE(&index->slots[i].object, cacheObject);
+
+	index->numUsedSlots++;
+}
+
+// Note: Rebuilds the index without tombstones, at twice the size if live objects fill more than half of it. The old table is retired, lookups may still be probing it.
+ERROR_CODE cache_growIndex(Cache* cache){
+	CacheIndex* index = cache->index;
+
+	uint_fast64_t capacity = index->mask + 1;
+	while((cache->numObjects + 1) * 2 > capacity){
+		capacity *= 2;
+	}
+
+	CacheIndex* grownIndex = cache_newIndex(capacity);
+	if(grownIndex == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	uint_fast64_t i;
+	for(i = 0; i <= index->mask; i++){
+		CacheObject* o = index->slots[i].object;
+
+		if(o != NULL && o != CACHE_INDEX_TOMBSTONE){
+			cache_indexAdd(grownIndex, o);
+		}
+	}
+
+	CACHE_STORE_RELEASE(&cache->index, grownIndex);
+
+	cache_retireIndex(cache, index);
 
-	return ERROR(error);
+	return ERROR(ERROR_NO_ERROR);
 }
 
 void cache_freeCacheObject(CacheObject* cacheObject){
-	free(cacheObject->data);
+	uint_fast8_t i;
+	for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		if(cacheObject->encodedVariants[i] != NULL){
+			cache_freeCacheObject(cacheObject->encodedVariants[i]);
+
+			free(cacheObject->encodedVariants[i]);
+		}
+	}
+
+	if(cacheObject->mappingLength != 0){
+		munmap(cacheObject->data, cacheObject->mappingLength);
+	}else{
+		free(cacheObject->data);
+	}
+
 	free(cacheObject->fileLocation);
 	free(cacheObject->symbolicFileLocation);
+	free(cacheObject->headerBlock);
+}
+
+// Note: Conservative update, only the smallest of the key's counters get incremented. The other ones already count accesses of other keys as well, leaving them alone keeps the estimate of those keys from growing.
+void cache_recordAccess(Cache* cache, const uint64_t hash){
+	CacheSketch* sketch = cache->sketch;
+
+	uint8_t* counters[CACHE_SKETCH_DEPTH];
+	uint8_t minCount = CACHE_SKETCH_MAX_COUNT;
+
+	uint_fast8_t i;
+	for(i = 0; i < CACHE_SKETCH_DEPTH; i++){
+		// Note: Every row takes its column from a different 16 bits of the hash.
+		counters[i] = &sketch->counters[i][(hash >> (i * 16)) & (CACHE_SKETCH_WIDTH - 1)];
+
+		const uint8_t count = __atomic_load_n(counters[i], __ATOMIC_RELAXED);
+		if(count < minCount){
+			minCount = count;
+		}
+	}
+
+	if(minCount < CACHE_SKETCH_MAX_COUNT){
+		for(i = 0; i < CACHE_SKETCH_DEPTH; i++){
+			// Note: Readers racing on the same counter may lose an increment, that only makes the estimate a little low.
+			if(__atomic_load_n(counters[i], __ATOMIC_RELAXED) == minCount){
+				__atomic_store_n(counters[i], minCount + 1, __ATOMIC_RELAXED);
+			}
+		}
+	}
+
+	if(++cache_numPendingSamples == CACHE_SKETCH_SAMPLE_BATCH_SIZE){
+		// Note: Batches added by racing readers may get lost, that only delays aging a little.
+		__atomic_store_n(&sketch->numSamples, __atomic_load_n(&sketch->numSamples, __ATOMIC_RELAXED) + cache_numPendingSamples, __ATOMIC_RELAXED);
+
+		cache_numPendingSamples = 0;
+	}
+}
+
+uint_fast64_t cache_estimateFrequency(const Cache* cache, const uint64_t hash){
+	uint_fast64_t frequency = CACHE_SKETCH_MAX_COUNT;
+
+	uint_fast8_t i;
+	for(i = 0; i < CACHE_SKETCH_DEPTH; i++){
+		const uint8_t count = __atomic_load_n(&cache->sketch->counters[i][(hash >> (i * 16)) & (CACHE_SKETCH_WIDTH - 1)], __ATOMIC_RELAXED);
+		if(count < frequency){
+			frequency = count;
+		}
+	}
+
+	return frequency;
+}
+
+inline uint_fast64_t cache_getFrequency(const Cache* cache, const CacheObject* cacheObject){
+	const uint_fast64_t frequency = cache_estimateFrequency(cache, cacheObject->symbolicFileLocationHash);
+	const uint_fast64_t totalHits = __atomic_load_n(&cacheObject->totalHits, __ATOMIC_RELAXED);
+
+	return totalHits < frequency ? totalHits : frequency;
+}
+
+// Note: Nanoseconds, readers update the two halves of 'timeLastHit' one after the other. A time that is off by up to a second only changes which of two equally frequently used objects gets evicted.
+inline uint_fast64_t cache_getTimeLastHit(const CacheObject* cacheObject){
+	return (uint_fast64_t) __atomic_load_n(&cacheObject->timeLastHit.tv_sec, __ATOMIC_RELAXED) * 1000000000 + __atomic_load_n(&cacheObject->timeLastHit.tv_nsec, __ATOMIC_RELAXED);
+}
+
+// Note: Only called with the lock held. Hits that get recorded while the counters are halved may get lost.
+void cache_ageFrequencies(Cache* cache){
+	CacheSketch* sketch = cache->sketch;
+
+	uint_fast64_t i;
+	for(i = 0; i < CACHE_SKETCH_DEPTH; i++){
+		uint_fast64_t j;
+		for(j = 0; j < CACHE_SKETCH_WIDTH; j++){
+			__atomic_store_n(&sketch->counters[i][j], __atomic_load_n(&sketch->counters[i][j], __ATOMIC_RELAXED) >> 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	for(i = 0; i <= cache->index->mask; i++){
+		CacheObject* o = cache->index->slots[i].object;
+
+		if(o != NULL && o != CACHE_INDEX_TOMBSTONE){
+			__atomic_store_n(&o->totalHits, __atomic_load_n(&o->totalHits, __ATOMIC_RELAXED) >> 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	__atomic_store_n(&sketch->numSamples, __atomic_load_n(&sketch->numSamples, __ATOMIC_RELAXED) >> 1, __ATOMIC_RELAXED);
+}
+
+// Note: Only called with the lock held. Returns the least frequently used of the sampled objects that are not in 'excluded', the one that was hit longest ago if several are used equally often. NULL if there is no such object.
+CacheObject* cache_sampleVictim(Cache* cache, CacheObject** excluded, const uint_fast64_t numExcluded){
+	const CacheIndex* index = cache->index;
+
+	cache->randomState ^= cache->randomState << 13;
+	cache->randomState ^= cache->randomState >> 7;
+	cache->randomState ^= cache->randomState << 17;
+
+	CacheObject* victim = NULL;
+	uint_fast64_t victimFrequency = 0;
+	uint_fast64_t victimTimeLastHit = 0;
+
+	uint_fast64_t numSampled = 0;
+
+	uint_fast64_t i = cache->randomState & index->mask;
+
+	uint_fast64_t numProbed;
+	for(numProbed = 0; numProbed <= index->mask && numSampled < CACHE_EVICTION_SAMPLE_SIZE; numProbed++, i = (i + 1) & index->mask){
+		CacheObject* o = index->slots[i].object;
+		if(o == NULL || o == CACHE_INDEX_TOMBSTONE){
+			continue;
+		}
+
+		uint_fast64_t j;
+		for(j = 0; j < numExcluded && excluded[j] != o; j++);
+
+		if(j != numExcluded){
+			continue;
+		}
+
+		numSampled++;
+
+		const uint_fast64_t frequency = cache_getFrequency(cache, o);
+		const uint_fast64_t timeLastHit = cache_getTimeLastHit(o);
+
+		if(victim == NULL || frequency < victimFrequency || (frequency == victimFrequency && timeLastHit < victimTimeLastHit)){
+			victim = o;
+			victimFrequency = frequency;
+			victimTimeLastHit = timeLastHit;
+		}
+	}
+
+	return victim;
+}
+
+// Note: Only called with the lock held. A file that fits into what is left of the cache is always admitted, otherwise it has to be used more frequently than every object it would displace. The larger the file the more victims it has to beat. Files that got cached in the meantime are admitted as well, 'cache_insert' hands out the cached object for them.
+bool cache_admit(Cache* cache, const char* key, const uint_fast64_t keyLength, const uint_fast64_t size){
+	if(size > cache->maxSize){
+		return false;
+	}
+
+	const uint64_t hash = cache_hashKey(key, keyLength);
+
+	if(cache_lookup(cache->index, key, keyLength, hash) != NULL){
+		return true;
+	}
+
+	if(__atomic_load_n(&cache->sketch->numSamples, __ATOMIC_RELAXED) >= CACHE_SKETCH_SAMPLE_SIZE){
+		cache_ageFrequencies(cache);
+	}
+
+	uint_fast64_t freeSize = cache->maxSize - cache->currentSize;
+	if(size <= freeSize){
+		return true;
+	}
+
+	const uint_fast64_t frequency = cache_estimateFrequency(cache, hash);
+
+	CacheObject* victims[CACHE_MAX_ADMISSION_VICTIMS];
+	uint_fast64_t numVictims = 0;
+
+	while(size > freeSize){
+		if(numVictims == CACHE_MAX_ADMISSION_VICTIMS){
+			return false;
+		}
+
+		CacheObject* victim = cache_sampleVictim(cache, victims, numVictims);
+		if(victim == NULL || cache_getFrequency(cache, victim) >= frequency){
+			return false;
+		}
+
+		victims[numVictims++] = victim;
+		freeSize += cache_getObjectSize(victim);
+	}
+
+	return true;
+}
+
+// Note: Only called with the lock held, right after the object got unlinked. Advancing the epoch tells the readers that went online before apart from the ones that can't have found the object anymore.
+void cache_retireObject(Cache* cache, CacheObject* cacheObject){
+	cacheObject->retireEpoch = cache->epoch;
+	cacheObject->nextRetired = cache->retiredObjects;
+
+	__atomic_store_n(&cache->retiredObjects, cacheObject, __ATOMIC_RELAXED);
+
+	CACHE_STORE_RELEASE(&cache->epoch, cache->epoch + 1);
+}
+
+// Note: Only called with the lock held, right after the index got replaced.
+void cache_retireIndex(Cache* cache, CacheIndex* index){
+	index->retireEpoch = cache->epoch;
+	index->nextRetired = cache->retiredIndices;
+
+	__atomic_store_n(&cache->retiredIndices, index, __ATOMIC_RELAXED);
+
+	CACHE_STORE_RELEASE(&cache->epoch, cache->epoch + 1);
+}
+
+// Note: Only called with the lock held. Frees everything that got retired before the oldest epoch an online reader announced, objects that are still leased only lose the reference of the cache. The fence pairs with the one in 'cache_online'.
+void cache_reclaim(Cache* cache){
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	uint64_t minEpoch = CACHE_READER_OFFLINE;
+
+	uint_fast64_t i;
+	for(i = 0; i < cache->numReaders; i++){
+		const uint64_t epoch = CACHE_LOAD_ACQUIRE(&cache->readers[i].epoch);
+		if(epoch < minEpoch){
+			minEpoch = epoch;
+		}
+	}
+
+	CacheObject** retiredObject = &cache->retiredObjects;
+	while(*retiredObject != NULL && (*retiredObject)->retireEpoch >= minEpoch){
+		retiredObject = &(*retiredObject)->nextRetired;
+	}
+
+	CacheObject* cacheObject = *retiredObject;
+	__atomic_store_n(retiredObject, NULL, __ATOMIC_RELAXED);
+
+	while(cacheObject != NULL){
+		CacheObject* nextRetired = cacheObject->nextRetired;
+
+		cache_release(cacheObject);
+
+		cacheObject = nextRetired;
+	}
+
+	CacheIndex** retiredIndex = &cache->retiredIndices;
+	while(*retiredIndex != NULL && (*retiredIndex)->retireEpoch >= minEpoch){
+		retiredIndex = &(*retiredIndex)->nextRetired;
+	}
+
+	CacheIndex* index = *retiredIndex;
+	__atomic_store_n(retiredIndex, NULL, __ATOMIC_RELAXED);
+
+	while(index != NULL){
+		CacheIndex* nextRetired = index->nextRetired;
+
+		cache_freeIndex(index);
+
+		index = nextRetired;
+	}
 }
 
-#endif
\ No newline at end of file
+#endif
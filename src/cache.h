@@ -5,39 +5,147 @@
 
 #include <time.h>
 #include <pthread.h>
-#include <semaphore.h>
-
-#include "linkedList.h"
 
 #include "http.h"
 
+// Note: Upper bound for the serialized header block of a single object.
+#define CACHE_MAX_HEADER_BLOCK_SIZE 1024
+
+// Note: Open addressing with linear probing, four slots share a cache line. The index grows once live objects and tombstones take up more than 3/4 of the slots.
+#define CACHE_INDEX_INITIAL_CAPACITY 1024
+#define CACHE_INDEX_SLOTS_ALIGNMENT 64
+// Note: Marks a slot whose object got removed, lookups have to probe past it.
+#define CACHE_INDEX_TOMBSTONE ((CacheObject*) 1)
+// Note: The upper half of the hash and the length of the key, compared before the key itself.
+#define CACHE_INDEX_TAG(hash, length) (((hash) & 0xFFFFFFFF00000000) | ((uint64_t) (length) & 0xFFFFFFFF))
+
+// Note: Count-Min sketch of how often every key got requested, hits and misses alike. The counters saturate at 15 like 4 bit counters would, but take up a byte each so readers can bump them without taking the lock.
+#define CACHE_SKETCH_DEPTH 4
+#define CACHE_SKETCH_WIDTH 16384
+#define CACHE_SKETCH_MAX_COUNT 15
+// Note: Once this many accesses got recorded all frequencies are halved, so they follow what is popular now instead of what was popular once.
+#define CACHE_SKETCH_SAMPLE_SIZE (CACHE_SKETCH_WIDTH * 10)
+// Note: Eviction picks the least frequently used out of this many consecutive objects of the index, starting at a random slot.
+#define CACHE_EVICTION_SAMPLE_SIZE 8
+// Note: Files that would have to displace more objects than this to fit are not admitted.
+#define CACHE_MAX_ADMISSION_VICTIMS 32
+
+// Note: Readers add the accesses they record to the sample count of the sketch in batches of this many.
+#define CACHE_SKETCH_SAMPLE_BATCH_SIZE 64
+
+// Note: Epoch of a reader that holds no objects and does not get waited for.
+#define CACHE_READER_OFFLINE UINT64_MAX
+#define CACHE_READER_ALIGNMENT 64
+
+#define CACHE_LOAD_ACQUIRE(pointer) __atomic_load_n(pointer, __ATOMIC_ACQUIRE)
+#define CACHE_STORE_RELEASE(pointer, value) __atomic_store_n(pointer, value, __ATOMIC_RELEASE)
+
+// Note: How 'cache_load' brings files into memory. Mapped files are served straight from the page cache instead of a private copy on the heap, which only stays correct as long as the files are replaced (e.g. renamed over) instead of rewritten in place. Truncating a mapped file makes the next access to the missing pages fault.
+typedef enum{
+	// Note: Read into a buffer on the heap.
+	CACHE_FILE_MAPPING_NONE = 0,
+	// Note: Read only mapping, pages are faulted in by the first send.
+	CACHE_FILE_MAPPING_LAZY,
+	// Note: Like 'LAZY', but the kernel starts reading the file ahead in the background (MADV_WILLNEED).
+	CACHE_FILE_MAPPING_WILLNEED,
+	// Note: The whole file is read and mapped before 'cache_load' returns (MAP_POPULATE).
+	CACHE_FILE_MAPPING_POPULATE
+}CacheFileMapping;
+
+struct cacheObject;
+
+typedef struct{
+	uint64_t tag;
+	struct cacheObject* object;
+}CacheIndexSlot;
+
+typedef struct cacheIndex{
+	// Note: Links tables the index grew out of, readers may still probe them until they are reclaimed.
+	struct cacheIndex* nextRetired;
+	uint64_t retireEpoch;
+	uint_fast64_t mask;
+	// Note: Live objects and tombstones.
+	uint_fast64_t numUsedSlots;
+	CacheIndexSlot* slots;
+}CacheIndex;
+
+typedef struct{
+	uint8_t counters[CACHE_SKETCH_DEPTH][CACHE_SKETCH_WIDTH];
+	uint_fast64_t numSamples;
+}CacheSketch;
+
+// Note: Reader state of a thread that looks objects up, one cache line each so no two readers write to the same line.
+typedef struct{
+	_Alignas(CACHE_READER_ALIGNMENT) uint64_t epoch;
+}CacheReader;
+
+// Note: Lookups probe the index without taking 'lock', writers serialize on it and publish slots and tables with release stores.
+// Memory is reclaimed based on quiescent states: Objects and tables that got unlinked are retired with the current epoch, which then gets advanced. A reader holds objects only between 'cache_online' and 'cache_offline' and announces the epoch it saw when it went online. Once every online reader announced a later epoch, nothing retired before can still be in use and it gets freed. Lookups themselves never write to shared reader state.
+// Objects that have to outlive the online window of the reader, e.g. because a response gets sent from them across several rounds of the event loop, are leased with 'cache_acquire'. Reclaiming an object only drops the reference the cache holds on it, the memory is freed once the last lease got released.
+// Admission and eviction follow TinyLFU: A file only gets cached if it was requested more often than each of the objects it has to displace, so a burst of one time requests can't flush the files that are requested all the time.
 typedef struct{
-	LinkedList elements;
+	CacheIndex* index;
+	CacheSketch* sketch;
+	uint_fast64_t numObjects;
 	uint_fast64_t maxSize;
 	uint_fast64_t currentSize;
-	uint_fast64_t numActiveThreads;
-	sem_t activeAcesses;
+	// Note: State of the xorshift generator the eviction samples start from, only touched with the lock held.
+	uint64_t randomState;
+	// Note: Only advanced with the lock held.
+	uint64_t epoch;
+	CacheReader* readers;
+	uint_fast64_t numReaders;
+	// Note: Newest first, so the ones that can be freed are at the end of the lists.
+	struct cacheObject* retiredObjects;
+	CacheIndex* retiredIndices;
+	CacheFileMapping fileMapping;
+	// Note: Ask for transparent huge pages on mappings (MADV_HUGEPAGE), only honored by kernels that support them for the page cache of the file system.
+	bool hugePages;
 	pthread_mutex_t lock;
 }Cache;
 
-typedef struct{
+typedef struct cacheObject{
 	uint8_t* data;
 	uint_fast64_t size;
 	struct timespec timeCheckin;
 	struct timespec timeLastHit;
+	// Note: Modification time of the file, or the time the object got added for everything that didn't come from disk.
+	time_t lastModified;
+	char entityTag[HTTP_ENTITY_TAG_LENGTH + 1];
+	// Note: Hits since the object got added, halved together with the sketch. Caps the frequency the sketch estimates for the object, which may be too high if other keys share its counters.
 	uint_fast64_t totalHits;
 	uint_fast64_t fileLocationLength;
 	uint_fast64_t symbolicFileLocationLength;
+	uint64_t symbolicFileLocationHash;
 	uint_fast64_t fileExtensionOffset;
 	HTTP_ContentType httpContentType;
 	char* fileLocation;
 	char* symbolicFileLocation;
+	// Note: Compressed copies of 'data', indexed by HTTP_ContentEncoding. They share the symbolic file location but have their own size and entity tag.
+	struct cacheObject* encodedVariants[HTTP_NUM_CONTENT_ENCODINGS];
+	// Note: The header fields that only depend on the object, serialized once when it gets loaded. A '304 Not Modified' sends the first 'notModifiedHeaderBlockLength' bytes, a '206 Partial Content' the first 'partialHeaderBlockLength' bytes, everything else the whole block.
+	char* headerBlock;
+	uint_fast64_t headerBlockLength;
+	uint_fast64_t notModifiedHeaderBlockLength;
+	uint_fast64_t partialHeaderBlockLength;
+	struct cacheObject* nextRetired;
+	uint64_t retireEpoch;
+	// Note: Length of the read only mapping 'data' points to, 0 if 'data' is on the heap. Mapped objects are accounted with the whole pages they map instead of 'size'.
+	uint_fast64_t mappingLength;
+	// Note: Leases plus the one reference the cache holds until the object got reclaimed. Variants are leased through the object they belong to.
+	uint_fast64_t numReferences;
 }CacheObject;
 
 ERROR_CODE cache_init(Cache*, const uint_fast64_t, const uint_fast64_t);
 
 void cache_free(Cache*);
 
+void cache_setFileMapping(Cache*, const CacheFileMapping, const bool);
+
+void cache_online(Cache*, const uint_fast64_t);
+
+void cache_offline(Cache*, const uint_fast64_t);
+
 ERROR_CODE cache_get(Cache*, CacheObject**, char*, const uint_fast64_t);
 
 ERROR_CODE cache_load(Cache*, CacheObject**, char*, const uint_fast64_t, char*, const uint_fast64_t);
@@ -46,4 +154,16 @@ ERROR_CODE cache_add(Cache*, CacheObject**, uint8_t*, const uint_fast64_t, char*
 
 ERROR_CODE cache_remove(Cache*, CacheObject*);
 
+void cache_acquire(CacheObject*);
+
+void cache_release(CacheObject*);
+
+CacheObject* cache_getEncodedVariant(CacheObject*, const HTTP_ContentEncoding);
+
+bool cache_hasEncodedVariants(const CacheObject*);
+
+uint64_t cache_hashKey(const char*, const uint_fast64_t);
+
+void cache_formatFileEntityTag(char*, const struct stat*);
+
 #endif
\ No newline at end of file
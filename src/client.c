@@ -1,4 +1,5 @@
 #include "util.c"
+#include "arena.c"
 #include "linkedList.c"
 #include "arrayList.c"
 #include "util.h"
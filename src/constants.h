@@ -11,7 +11,6 @@
 #define CONSTANTS_WORK_DIRECTORY_PROPERTY_NAME "work_directory"
 #define CONSTANTS_HTTP_ROOT_DIRECTORY_PROPERTY_NAME "http_root_directory"
 #define CONSTANTS_HTTP_CACHE_SIZE_PROPERTY_NAME "http_cache_size"
-#define CONSTANTS_ERROR_PAGE_CACHE_SIZE_PROPERTY_NAME "error_page_cache_size"
 #define CONSTANTS_LOGFILE_DIRECTORY_PROPERTY_NAME "logfile_directory"
 #define CONSTANTS_CUSTOM_ERROR_PAGES_DIRECTORY_PROPERTY_NAME "custom_error_pages_directoory"
 #define CONSTANTS_SSL_CERTIFICATE_LOCATION_PROPERTY_NAME "ssl_certificate"
@@ -20,6 +19,50 @@
 #define CONSTANTS_DAEMONIZE_PROPERTY_NAME "daemonize"
 #define CONSTANTS_DAEMONIZE_PROPERTY_DEFAULT_VALUE "false"
 
+#define CONSTANTS_LISTENER_MODE_PROPERTY_NAME "listener_mode"
+#define CONSTANTS_LISTENER_MODE_PROPERTY_DEFAULT_VALUE "shared"
+
+#define CONSTANTS_LISTENER_MODE_SHARED "shared"
+#define CONSTANTS_LISTENER_MODE_SHARDED "sharded"
+
+#define CONSTANTS_NETWORK_BACKEND_PROPERTY_NAME "network_backend"
+#define CONSTANTS_NETWORK_BACKEND_PROPERTY_DEFAULT_VALUE "epoll"
+
+#define CONSTANTS_NETWORK_BACKEND_EPOLL "epoll"
+#define CONSTANTS_NETWORK_BACKEND_IO_URING "io_uring"
+
+#define CONSTANTS_KEEP_ALIVE_TIMEOUT_PROPERTY_NAME "keep_alive_timeout"
+#define CONSTANTS_KEEP_ALIVE_TIMEOUT_PROPERTY_DEFAULT_VALUE "5"
+
+#define CONSTANTS_SEND_TIMEOUT_PROPERTY_NAME "send_timeout"
+#define CONSTANTS_SEND_TIMEOUT_PROPERTY_DEFAULT_VALUE "60"
+
+#define CONSTANTS_KEEP_ALIVE_MAX_REQUESTS_PROPERTY_NAME "keep_alive_max_requests"
+#define CONSTANTS_KEEP_ALIVE_MAX_REQUESTS_PROPERTY_DEFAULT_VALUE "100"
+
+#define CONSTANTS_HTTP_MAX_CACHED_FILE_SIZE_PROPERTY_NAME "http_max_cached_file_size"
+#define CONSTANTS_HTTP_MAX_CACHED_FILE_SIZE_PROPERTY_DEFAULT_VALUE "4096"
+
+#define CONSTANTS_HTTP_CACHE_FILE_MAPPING_PROPERTY_NAME "http_cache_file_mapping"
+#define CONSTANTS_HTTP_CACHE_FILE_MAPPING_PROPERTY_DEFAULT_VALUE "none"
+
+#define CONSTANTS_HTTP_CACHE_FILE_MAPPING_NONE "none"
+#define CONSTANTS_HTTP_CACHE_FILE_MAPPING_LAZY "lazy"
+#define CONSTANTS_HTTP_CACHE_FILE_MAPPING_WILLNEED "willneed"
+#define CONSTANTS_HTTP_CACHE_FILE_MAPPING_POPULATE "populate"
+
+#define CONSTANTS_HTTP_CACHE_HUGE_PAGES_PROPERTY_NAME "http_cache_huge_pages"
+#define CONSTANTS_HTTP_CACHE_HUGE_PAGES_PROPERTY_DEFAULT_VALUE "false"
+
+#define CONSTANTS_SSL_KERNEL_TLS_PROPERTY_NAME "ssl_kernel_tls"
+#define CONSTANTS_SSL_KERNEL_TLS_PROPERTY_DEFAULT_VALUE "true"
+
+#define CONSTANTS_HTTP2_PROPERTY_NAME "http2"
+#define CONSTANTS_HTTP2_PROPERTY_DEFAULT_VALUE "true"
+
+#define CONSTANTS_MIME_TYPES_FILE_PROPERTY_NAME "mime_types_file"
+#define CONSTANTS_MIME_TYPES_FILE_PROPERTY_DEFAULT_VALUE "/etc/mime.types"
+
 #define CONSTANTS_HTTP_MAX_HEADER_FIELDS 32
 
 #define CONSTANTS_HTTP_VERSION_1_0 "HTTP/1.0"
@@ -37,6 +80,17 @@
 #define CONSTANTS_ERROR_PAGE_SEARCH_STRING_PORT "$port"
 
 #define CONSTANTS_HTTP_HEADER_FIELD_HOST_NAME "Host"
+#define CONSTANTS_HTTP_HEADER_FIELD_CONNECTION_NAME "Connection"
+#define CONSTANTS_HTTP_HEADER_FIELD_CONTENT_LENGTH_NAME "Content-Length"
+#define CONSTANTS_HTTP_HEADER_FIELD_TRANSFER_ENCODING_NAME "Transfer-Encoding"
+#define CONSTANTS_HTTP_HEADER_FIELD_RANGE_NAME "Range"
+#define CONSTANTS_HTTP_HEADER_FIELD_IF_RANGE_NAME "If-Range"
+#define CONSTANTS_HTTP_HEADER_FIELD_IF_NONE_MATCH_NAME "If-None-Match"
+#define CONSTANTS_HTTP_HEADER_FIELD_IF_MODIFIED_SINCE_NAME "If-Modified-Since"
+#define CONSTANTS_HTTP_HEADER_FIELD_ACCEPT_ENCODING_NAME "Accept-Encoding"
+
+// Note: Has to be a string that never shows up inside a served file.
+#define CONSTANTS_HTTP_MULTIPART_BYTERANGES_BOUNDARY "herder_byteranges_2c1f5a8e3b9d4706"
 
 #define CONSTANTS_HTTP_HEADER_FIELD_SERVER_VALUE "Herder Server"
 
@@ -0,0 +1,184 @@
+#ifndef ERROR_PAGE_C
+#define ERROR_PAGE_C
+
+#include "errorPage.h"
+
+#include "http.h"
+#include "util.h"
+
+local uint_fast64_t errorPage_matchPlaceholder(const char*, const uint_fast64_t, const char*);
+
+local void errorPage_addLiteral(ErrorPage*, uint_fast64_t*);
+
+ERROR_CODE errorPage_compile(ErrorPage* errorPage, const HTTP_StatusCode httpStatusCode, const char* template, const uint_fast64_t templateLength){
+	memset(errorPage, 0, sizeof(*errorPage));
+
+	char statusCode[4];
+	snprintf(statusCode, sizeof(statusCode), "%03" PRIdFAST16, http_getNumericalStatusCode(httpStatusCode));
+
+	const char* statusMessage = http_getStatusMsg(httpStatusCode);
+	const uint_fast64_t statusMessageLength = strlen(statusMessage);
+
+	errorPage->statusLineLength = snprintf(errorPage->statusLine, sizeof(errorPage->statusLine), "%s %s %s\r\n", http_getVersionString(HTTP_HTTP_VERSION_1_1), statusCode, statusMessage);
+	errorPage->headerBlockLength = snprintf(errorPage->headerBlock, sizeof(errorPage->headerBlock), "Content-Type: %s\r\n", http_contentTypeToString(HTTP_CONTENT_TYPE_TEXT_HTML));
+
+	// Note: Every '$' may start a placeholder, which bounds both the number of segments and how much the substitutions can grow the page.
+	uint_fast64_t numPlaceholders = 0;
+
+	const char* dollar;
+	for(dollar = memchr(template, '$', templateLength); dollar != NULL; dollar = memchr(dollar + 1, '$', template + templateLength - dollar - 1)){
+		numPlaceholders++;
+	}
+
+	errorPage->literals = malloc(sizeof(*errorPage->literals) * (templateLength + numPlaceholders * statusMessageLength + 1));
+	errorPage->segments = malloc(sizeof(*errorPage->segments) * (numPlaceholders * 2 + 1));
+
+	if(errorPage->literals == NULL || errorPage->segments == NULL){
+		errorPage_free(errorPage);
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	uint_fast64_t literalOffset = 0;
+
+	uint_fast64_t i = 0;
+	while(i < templateLength){
+		uint_fast64_t placeholderLength = 0;
+
+		if(template[i] == '$'){
+			if((placeholderLength = errorPage_matchPlaceholder(template + i, templateLength - i, CONSTANTS_ERROR_PAGE_SEARCH_STRING_ERROR_CODE)) != 0){
+				memcpy(errorPage->literals + errorPage->literalsLength, statusCode, 3);
+				errorPage->literalsLength += 3;
+			}else if((placeholderLength = errorPage_matchPlaceholder(template + i, templateLength - i, CONSTANTS_ERROR_PAGE_SEARCH_STRING_ERROR_MESSAGE)) != 0){
+				memcpy(errorPage->literals + errorPage->literalsLength, statusMessage, statusMessageLength);
+				errorPage->literalsLength += statusMessageLength;
+			}else if((placeholderLength = errorPage_matchPlaceholder(template + i, templateLength - i, CONSTANTS_ERROR_PAGE_SEARCH_STRING_ADDRESS)) != 0){
+				errorPage_addLiteral(errorPage, &literalOffset);
+
+				errorPage->segments[errorPage->numSegments++] = (ErrorPageSegment){ERROR_PAGE_SEGMENT_ADDRESS, 0, 0};
+			}else if((placeholderLength = errorPage_matchPlaceholder(template + i, templateLength - i, CONSTANTS_ERROR_PAGE_SEARCH_STRING_PORT)) != 0){
+				errorPage_addLiteral(errorPage, &literalOffset);
+
+				errorPage->segments[errorPage->numSegments++] = (ErrorPageSegment){ERROR_PAGE_SEGMENT_PORT, 0, 0};
+			}
+		}
+
+		if(placeholderLength == 0){
+			errorPage->literals[errorPage->literalsLength++] = template[i++];
+		}else{
+			i += placeholderLength;
+		}
+	}
+
+	errorPage_addLiteral(errorPage, &literalOffset);
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Custom error pages are read once, a file that changes afterwards is only picked up by a restart.
+ERROR_CODE errorPage_load(ErrorPage* errorPage, const HTTP_StatusCode httpStatusCode, const char* fileLocation){
+	ERROR_CODE error;
+
+	struct stat fileInfo;
+	if(stat(fileLocation, &fileInfo) == -1 || !S_ISREG(fileInfo.st_mode)){
+		return ERROR_(ERROR_FAILED_TO_RETRIEV_FILE_INFO, "File:'%s'", fileLocation);
+	}
+
+	FILE* file;
+	if((file = fopen(fileLocation, "r")) == NULL){
+		return ERROR(ERROR_FAILED_TO_LOAD_FILE);
+	}
+
+	char* template = malloc(sizeof(*template) * (fileInfo.st_size + 1));
+	if(template == NULL){
+		fclose(file);
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	if(fread(template, sizeof(*template), fileInfo.st_size, file) != (size_t) fileInfo.st_size){
+		fclose(file);
+		free(template);
+
+		return ERROR(ERROR_FAILED_TO_LOAD_FILE);
+	}
+
+	fclose(file);
+
+	error = errorPage_compile(errorPage, httpStatusCode, template, fileInfo.st_size);
+
+	free(template);
+
+	return ERROR(error);
+}
+
+inline void errorPage_free(ErrorPage* errorPage){
+	free(errorPage->literals);
+	free(errorPage->segments);
+
+	errorPage->literals = NULL;
+	errorPage->segments = NULL;
+	errorPage->numSegments = 0;
+}
+
+// Note: Renders the whole page in a single pass, nothing gets written past 'bufferSize'.
+ERROR_CODE errorPage_render(const ErrorPage* errorPage, const char* address, const uint_fast64_t addressLength, const char* port, const uint_fast64_t portLength, char* buffer, const uint_fast64_t bufferSize, uint_fast64_t* length){
+	*length = 0;
+
+	uint_fast64_t i;
+	for(i = 0; i < errorPage->numSegments; i++){
+		const ErrorPageSegment* segment = &errorPage->segments[i];
+
+		const char* data;
+		uint_fast64_t dataLength;
+
+		switch(segment->type){
+			case ERROR_PAGE_SEGMENT_ADDRESS:
+				data = address;
+				dataLength = addressLength;
+
+				break;
+			case ERROR_PAGE_SEGMENT_PORT:
+				data = port;
+				dataLength = portLength;
+
+				break;
+			default:
+				data = errorPage->literals + segment->offset;
+				dataLength = segment->length;
+
+				break;
+		}
+
+		if(bufferSize - *length < dataLength){
+			return ERROR(ERROR_BUFFER_OVERFLOW);
+		}
+
+		memcpy(buffer + *length, data, dataLength);
+		*length += dataLength;
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Returns the length of 'placeholder' if 'string' starts with it, 0 otherwise.
+uint_fast64_t errorPage_matchPlaceholder(const char* string, const uint_fast64_t stringLength, const char* placeholder){
+	const uint_fast64_t placeholderLength = strlen(placeholder);
+
+	if(stringLength < placeholderLength || memcmp(string, placeholder, placeholderLength) != 0){
+		return 0;
+	}
+
+	return placeholderLength;
+}
+
+// Note: Closes the literal that started at 'literalOffset', empty literals between two placeholders are left out.
+void errorPage_addLiteral(ErrorPage* errorPage, uint_fast64_t* literalOffset){
+	if(errorPage->literalsLength != *literalOffset){
+		errorPage->segments[errorPage->numSegments++] = (ErrorPageSegment){ERROR_PAGE_SEGMENT_LITERAL, *literalOffset, errorPage->literalsLength - *literalOffset};
+	}
+
+	*literalOffset = errorPage->literalsLength;
+}
+
+#endif
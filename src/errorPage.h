@@ -0,0 +1,51 @@
+#ifndef ERROR_PAGE_H
+#define ERROR_PAGE_H
+
+#include "util.h"
+#include "http.h"
+
+// Note: Error page templates get compiled once into a list of segments. '$errorCode' and '$errorMessage' only depend on the status code and are substituted while compiling, '$address' and '$port' are left as placeholders that get filled in from the request when the page is rendered.
+
+#define ERROR_PAGE_FIRST_STATUS_CODE _400_BAD_REQUEST
+#define ERROR_PAGE_NUM_STATUS_CODES (_599_NETWORK_CONNECTION_TIMEOUT_ERROR - _400_BAD_REQUEST + 1)
+
+#define ERROR_PAGE_MAX_STATUS_LINE_LENGTH 64
+#define ERROR_PAGE_MAX_HEADER_BLOCK_LENGTH 64
+// Note: Longest valid port, "65535".
+#define ERROR_PAGE_MAX_PORT_LENGTH 5
+
+typedef enum{
+	ERROR_PAGE_SEGMENT_LITERAL = 0,
+	ERROR_PAGE_SEGMENT_ADDRESS,
+	ERROR_PAGE_SEGMENT_PORT
+}ErrorPageSegmentType;
+
+typedef struct{
+	ErrorPageSegmentType type;
+	// Note: Only used by literals, they point into the 'literals' of the page.
+	uint_fast64_t offset;
+	uint_fast64_t length;
+}ErrorPageSegment;
+
+typedef struct{
+	char* literals;
+	ErrorPageSegment* segments;
+	uint_fast64_t numSegments;
+	// Note: Length of the page without the placeholders.
+	uint_fast64_t literalsLength;
+	// Note: Status line and header fields that are the same for every response with this page, serialized while compiling.
+	char statusLine[ERROR_PAGE_MAX_STATUS_LINE_LENGTH];
+	uint_fast64_t statusLineLength;
+	char headerBlock[ERROR_PAGE_MAX_HEADER_BLOCK_LENGTH];
+	uint_fast64_t headerBlockLength;
+}ErrorPage;
+
+ERROR_CODE errorPage_compile(ErrorPage*, const HTTP_StatusCode, const char*, const uint_fast64_t);
+
+ERROR_CODE errorPage_load(ErrorPage*, const HTTP_StatusCode, const char*);
+
+void errorPage_free(ErrorPage*);
+
+ERROR_CODE errorPage_render(const ErrorPage*, const char*, const uint_fast64_t, const char*, const uint_fast64_t, char*, const uint_fast64_t, uint_fast64_t*);
+
+#endif
@@ -2,6 +2,7 @@
 #include "linkedList.h"
 #include "properties.h"
 #include "util.h"
+#include <stddef.h>
 #include <stdint.h>
 
 inline void http_initheaderField(HTTP_HeaderField* headerField, char* name, const uint_fast64_t nameLength, char* value, const uint_fast64_t valueLength){
@@ -11,25 +12,20 @@ inline void http_initheaderField(HTTP_HeaderField* headerField, char* name, cons
 	headerField->valueLength = valueLength;
 }
 
-inline ERROR_CODE http_initRequest(HTTP_Request* request, const char* url, const uint_fast64_t urlLength, void* buffer, const uint_fast64_t bufferSize, const Version version , const HTTP_RequestType requestType){
+// Note: 'url' is not copied, it has to outlive the request.
+inline ERROR_CODE http_initRequest(HTTP_Request* request, char* url, const uint_fast64_t urlLength, void* buffer, const uint_fast64_t bufferSize, const Version version , const HTTP_RequestType requestType){
 	http_initRequest_(request, buffer, bufferSize, requestType);
 
 	http_setHTTP_Version(request, version);
 
 	request->requestURLLength = urlLength;
-	request->requestURL = malloc(sizeof(request->requestURL) * (urlLength + 1));
-	if(request->requestURL == NULL){
-		return ERROR(ERROR_OUT_OF_MEMORY);
-	}
-
-	memcpy(request->requestURL, url, urlLength);
-	request->requestURL[urlLength] = '\0';
+	request->requestURL = url;
 
 	return ERROR(ERROR_NO_ERROR);
 }
 
 inline void http_initRequest_(HTTP_Request* request, void* buffer, const uint_fast64_t bufferSize, const HTTP_RequestType requestType){
-	memset(request, 0, sizeof(*request));
+	memset(request, 0, offsetof(HTTP_Request, httpHeaderFields));
 
 	request->dataSegment = buffer;
 	request->requestDataSegmentLength = bufferSize;
@@ -37,31 +33,56 @@ inline void http_initRequest_(HTTP_Request* request, void* buffer, const uint_fa
 	request->httpRequestType = requestType;
 }
 
-inline void http_initHttpResponse(HTTP_Response* response, void* buffer, const uint_fast64_t bufferSize){
+inline void http_initHttpResponse(HTTP_Response* response, void* buffer, const uint_fast64_t bufferSize, Arena* arena){
 	memset(response, 0, sizeof(*response));
 
+	response->arena = arena;
+	response->httpHeaderFields.arena = arena;
+
 	response->dataSegment = buffer;
 	response->responseBufferSize = bufferSize;
+	response->fileDescriptor = -1;
 
-	http_setHTTP_Version((HTTP_Request*) response, HTTP_HTTP_VERSION_1_1);
+	response->httpVersion = HTTP_HTTP_VERSION_1_1;
 
 	HTTP_ADD_HEADER_FIELD(response, Server, CONSTANTS_HTTP_HEADER_FIELD_SERVER_VALUE);
 }
 
+// Note: Only stores the view, 'name' and 'value' are not copied.
 inline ERROR_CODE http_addHeaderField(HTTP_Request* request, char* name, const uint_fast64_t nameLength, char* value, const uint_fast64_t valueLength){
-	
-	if(request->httpHeaderFields.length == CONSTANTS_HTTP_MAX_HEADER_FIELDS){
+	if(request->numHeaderFields == CONSTANTS_HTTP_MAX_HEADER_FIELDS){
+		return ERROR(ERROR_MAX_HEADER_FIELDS_REACHED);
+	}
+
+	http_initheaderField(&request->httpHeaderFields[request->numHeaderFields++], name, nameLength, value, valueLength);
+
+	// Note: Repeated header fields keep pointing at the first one.
+	const HTTP_KnownHeaderField knownHeaderField = http_internHeaderFieldName(name, nameLength);
+	if(knownHeaderField != HTTP_HEADER_FIELD_UNKNOWN && request->knownHeaderFields[knownHeaderField] == 0){
+		request->knownHeaderFields[knownHeaderField] = request->numHeaderFields;
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Takes ownership of 'name' and 'value', both get freed together with the response unless it allocates from an arena.
+inline ERROR_CODE http_addResponseHeaderField(HTTP_Response* response, char* name, const uint_fast64_t nameLength, char* value, const uint_fast64_t valueLength){
+	if(response->httpHeaderFields.length == CONSTANTS_HTTP_MAX_HEADER_FIELDS){
 		return ERROR(ERROR_MAX_HEADER_FIELDS_REACHED);
 	}
 
-	HTTP_HeaderField* headerField = malloc(sizeof(*headerField));
+	if(value == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	HTTP_HeaderField* headerField = response->arena != NULL ? arena_alloc(response->arena, sizeof(*headerField)) : malloc(sizeof(*headerField));
 	if(headerField == NULL){
 		return ERROR(ERROR_OUT_OF_MEMORY);
 	}
 
 	http_initheaderField(headerField, name, nameLength, value, valueLength);
 	
-	linkedList_add(&request->httpHeaderFields, &headerField, sizeof(HTTP_HeaderField*));
+	linkedList_add(&response->httpHeaderFields, &headerField, sizeof(HTTP_HeaderField*));
 		
 	return ERROR(ERROR_NO_ERROR);
 }
@@ -76,47 +97,158 @@ inline HTTP_StatusCode http_translateErrorCode(const ERROR_CODE error){
 			return _404_NOT_FOUND;
 		}
 
+		case ERROR_METHOD_NOT_ALLOWED:{
+			return _405_METHOD_NOT_ALLOWED;
+		}
+
 	default:{
 			return _200_OK;
 		}
 	}
 }
 
+// Note: Known header fields get looked up through 'http_getKnownHeaderField', all other names get compared against every header field of the request.
 inline HTTP_HeaderField* http_getHeaderField(HTTP_Request* request, char* name){
-	HTTP_HeaderField* ret = NULL;
-		
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &request->httpHeaderFields);
-	
 	const uint_fast64_t nameLength = strlen(name);
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		HTTP_HeaderField* headerField = LINKED_LIST_ITERATOR_NEXT_PTR(&it, HTTP_HeaderField);
 
-		if(strncasecmp(name, headerField->name, nameLength) == 0){
-			ret = headerField;
+	const HTTP_KnownHeaderField knownHeaderField = http_internHeaderFieldName(name, nameLength);
+	if(knownHeaderField != HTTP_HEADER_FIELD_UNKNOWN){
+		return http_getKnownHeaderField(request, knownHeaderField);
+	}
+
+	uint_fast8_t i;
+	for(i = 0; i < request->numHeaderFields; i++){
+		HTTP_HeaderField* headerField = &request->httpHeaderFields[i];
+
+		if(headerField->nameLength == nameLength && strncasecmp(name, headerField->name, nameLength) == 0){
+			return headerField;
+		}
+	}
+
+	return NULL;
+}
+
+inline HTTP_HeaderField* http_getKnownHeaderField(HTTP_Request* request, const HTTP_KnownHeaderField knownHeaderField){
+	const uint_fast8_t index = request->knownHeaderFields[knownHeaderField];
+
+	return index == 0 ? NULL : &request->httpHeaderFields[index - 1];
+}
+
+// Note: Indexed by HTTP_KnownHeaderField.
+local const char* const HTTP_KNOWN_HEADER_FIELD_NAME_MAPPING_ARRAY[] = {
+	CONSTANTS_HTTP_HEADER_FIELD_HOST_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_CONNECTION_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_CONTENT_LENGTH_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_TRANSFER_ENCODING_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_RANGE_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_IF_RANGE_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_IF_NONE_MATCH_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_IF_MODIFIED_SINCE_NAME,
+	CONSTANTS_HTTP_HEADER_FIELD_ACCEPT_ENCODING_NAME
+};
+
+// Note: The length of the name, and the first character for the two known names of the same length, leave a single candidate. Only that one gets compared.
+inline HTTP_KnownHeaderField http_internHeaderFieldName(const char* name, const uint_fast64_t nameLength){
+	HTTP_KnownHeaderField candidate;
+
+	switch(nameLength){
+		case 4:{
+			candidate = HTTP_HEADER_FIELD_HOST;
+
+			break;
+		}
+		case 5:{
+			candidate = HTTP_HEADER_FIELD_RANGE;
+
+			break;
+		}
+		case 8:{
+			candidate = HTTP_HEADER_FIELD_IF_RANGE;
+
+			break;
+		}
+		case 10:{
+			candidate = HTTP_HEADER_FIELD_CONNECTION;
+
+			break;
+		}
+		case 13:{
+			candidate = HTTP_HEADER_FIELD_IF_NONE_MATCH;
+
+			break;
+		}
+		case 14:{
+			candidate = HTTP_HEADER_FIELD_CONTENT_LENGTH;
 
 			break;
 		}
+		case 15:{
+			candidate = HTTP_HEADER_FIELD_ACCEPT_ENCODING;
+
+			break;
+		}
+		case 17:{
+			candidate = tolower(name[0]) == 't' ? HTTP_HEADER_FIELD_TRANSFER_ENCODING : HTTP_HEADER_FIELD_IF_MODIFIED_SINCE;
+
+			break;
+		}
+		default:{
+			return HTTP_HEADER_FIELD_UNKNOWN;
+		}
 	}
 
-	return ret;
+	return strncasecmp(name, HTTP_KNOWN_HEADER_FIELD_NAME_MAPPING_ARRAY[candidate], nameLength) == 0 ? candidate : HTTP_HEADER_FIELD_UNKNOWN;
 }
 
-void http_freeHTTP_Request(HTTP_Request* request){
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &request->httpHeaderFields);
+inline HTTP_PathParameter* http_getPathParameter(HTTP_Request* request, const char* name){
+	const uint_fast64_t nameLength = strlen(name);
 
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		HTTP_HeaderField* headerField = LINKED_LIST_ITERATOR_NEXT_PTR(&it, HTTP_HeaderField);
+	uint_fast8_t i;
+	for(i = 0; i < request->numPathParameters; i++){
+		HTTP_PathParameter* pathParameter = &request->pathParameters[i];
 
-		free(headerField->name);
-		free(headerField->value);
-		free(headerField);
+		if(pathParameter->nameLength == nameLength && memcmp(pathParameter->name, name, nameLength) == 0){
+			return pathParameter;
+		}
 	}
 
-	free(request->requestURL);
-	
-	linkedList_free(&request->httpHeaderFields);
+	return NULL;
+}
+
+// Note: Drops the views, the buffer they point into belongs to whoever parsed the request.
+inline void http_freeHTTP_Request(HTTP_Request* request){
+	request->numHeaderFields = 0;
+	request->numPathParameters = 0;
+
+	memset(request->knownHeaderFields, 0, sizeof(request->knownHeaderFields));
+
+	request->requestURL = NULL;
+	request->requestURLLength = 0;
+	request->getRequestParameter = NULL;
+	request->getRquestParameterLength = 0;
+}
+
+void http_freeHTTP_Response(HTTP_Response* response){
+	if(response->arena == NULL){
+		LinkedListIterator it;
+		linkedList_initIterator(&it, &response->httpHeaderFields);
+
+		while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+			HTTP_HeaderField* headerField = LINKED_LIST_ITERATOR_NEXT_PTR(&it, HTTP_HeaderField);
+
+			free(headerField->name);
+			free(headerField->value);
+			free(headerField);
+		}
+	}
+
+	linkedList_free(&response->httpHeaderFields);
+
+	if(response->fileDescriptor != -1){
+		close(response->fileDescriptor);
+
+		response->fileDescriptor = -1;
+	}
 }
 
 HTTP_StatusCode http_translateStatusCode(const int_fast16_t statusCode){
@@ -318,92 +450,40 @@ HTTP_StatusCode http_translateStatusCode(const int_fast16_t statusCode){
 	}
 }
 
-/*
-	printf("#define HASH_GET %d\n", util_hashString("GET"));
-	printf("#define HASH_HEAD %d\n", util_hashString("HEAD"));
-	printf("#define HASH_POST %d\n", util_hashString("POST"));
-	printf("#define HASH_PUT %d\n", util_hashString("PUT"));
-	printf("#define HASH_DELETE %d\n", util_hashString("DELETE"));
-	printf("#define HASH_TRACE %d\n", util_hashString("TRACE"));
-	printf("#define HASH_OPTIONS %d\n", util_hashString("OPTIONS"));
-	printf("#define HASH_CONNECT %d\n", util_hashString("CONNECT"));
-	printf("#define HASH_PATCH %d\n", util_hashString("PATCH"));
-*/
-HTTP_RequestType http_parseRequestType(const char* const type, const uint_fast64_t length){
-	#define HASH_GET 591093270
-	#define HASH_HEAD 942011328
-	#define HASH_POST -1319429824
-	#define HASH_PUT 666496399
-	#define HASH_DELETE 617851755
-	#define HASH_TRACE 1359153669
-	#define HASH_OPTIONS -1168929634
-	#define HASH_CONNECT -431736502
-	#define HASH_PATCH 867751912
-
-	HTTP_RequestType ret = HTTP_REQUEST_TYPE_UNKNOWN;
-
-	switch(util_hashString(type, length)){
-		case HASH_GET:{
-			ret = HTTP_REQUEST_TYPE_GET;
-
-			break;
-		}
-		case HASH_POST:{
-			ret = HTTP_REQUEST_TYPE_POST;
-
-			break;
-		}
-		case HASH_HEAD:{
-			ret = HTTP_REQUEST_TYPE_HEAD;
-
-			break;
-		}
-		case HASH_PUT:{
-			ret = HTTP_REQUEST_TYPE_PUT;
-
-			break;
-		}
-		case HASH_DELETE:{
-			ret = HTTP_REQUEST_TYPE_DELETE;
-
-			break;
-		}
-		case HASH_TRACE:{
-			ret = HTTP_REQUEST_TYPE_TRACE;
-
-			break;
-		}
-		case HASH_OPTIONS:{
-			ret = HTTP_REQUEST_TYPE_OPTIONS;
+typedef struct{
+	const char* name;
+	uint_fast8_t length;
+	HTTP_RequestType requestType;
+}HTTP_RequestTypeSlot;
+
+// Note: '(type[0] ^ (length + 3)) & 15' is collision free for the methods below, found by trying every constant. The slot still has to match the whole method, anything else maps to an empty slot or a different name.
+#define HTTP_REQUEST_TYPE_HASH(type, length) (((uint8_t) (type)[0] ^ ((length) + 3)) & 15)
+
+local const HTTP_RequestTypeSlot HTTP_REQUEST_TYPE_HASH_TABLE[16] = {
+	[1] = {"GET", 3, HTTP_REQUEST_TYPE_GET},
+	[5] = {"OPTIONS", 7, HTTP_REQUEST_TYPE_OPTIONS},
+	[6] = {"PUT", 3, HTTP_REQUEST_TYPE_PUT},
+	[7] = {"POST", 4, HTTP_REQUEST_TYPE_POST},
+	[8] = {"PATCH", 5, HTTP_REQUEST_TYPE_PATCH},
+	[9] = {"CONNECT", 7, HTTP_REQUEST_TYPE_CONNECT},
+	[12] = {"TRACE", 5, HTTP_REQUEST_TYPE_TRACE},
+	[13] = {"DELETE", 6, HTTP_REQUEST_TYPE_DELETE},
+	[15] = {"HEAD", 4, HTTP_REQUEST_TYPE_HEAD}
+};
 
-			break;
-		}
-		case HASH_CONNECT:{
-			ret = HTTP_REQUEST_TYPE_CONNECT;
+inline HTTP_RequestType http_parseRequestType(const char* const type, const uint_fast64_t length){
+	if(length == 0){
+		return HTTP_REQUEST_TYPE_UNKNOWN;
+	}
 
-			break;
-		}
-		case HASH_PATCH:{
-			ret = HTTP_REQUEST_TYPE_PATCH;
+	const HTTP_RequestTypeSlot* slot = &HTTP_REQUEST_TYPE_HASH_TABLE[HTTP_REQUEST_TYPE_HASH(type, length)];
 
-			break;
-		}
-		default:{
-			break;
-		}
+	// Note: Empty slots have a length of 0 and never match.
+	if(slot->length != length || memcmp(slot->name, type, length) != 0){
+		return HTTP_REQUEST_TYPE_UNKNOWN;
 	}
 
-	#undef HASH_GET
-	#undef HASH_HEAD
-	#undef HASH_POST
-	#undef HASH_PUT
-	#undef HASH_DELETE
-	#undef HASH_TRACE
-	#undef HASH_OPTIONS
-	#undef HASH_CONNECT
-	#undef HASH_PATCH
-
-	return ret;
+	return slot->requestType;
 }
 
 local const char* const HTTP_STATUS_MESSAGE_MAPPING_ARRAY[] = {
@@ -609,139 +689,561 @@ local const char* HTTP_CONTENT_TYPE_MAPPING_ARRAY[] = {
 	"text/javascript",
 	"text/xml",
 	"application/zip",
+	"video/x-matroska",
+	"video/mp4",
+	"video/webm",
+	"audio/flac",
+	"image/webp",
+	"image/avif"
 };
 
+local HTTP_MimeTypeRegistry http_mimeTypeRegistry;
+
 inline const char* http_contentTypeToString(const HTTP_ContentType contentType){
-	return HTTP_CONTENT_TYPE_MAPPING_ARRAY[contentType];
-}
-
-// printf("#define HASH_TXT %d\n", util_hashString("txt", 3));
-// printf("#define HASH_HTML %d\n", util_hashString("html", 4));
-// printf("#define HASH_CSS %d\n", util_hashString("css", 3));
-// printf("#define HASH_JS %d\n", util_hashString("js", 2));
-// printf("#define HASH_JPG %d\n", util_hashString("jpg", 3));
-// printf("#define HASH_PNG %d\n", util_hashString("png", 3));
-// printf("#define HASH_SVG %d\n", util_hashString("svg", 3));
-// printf("#define HASH_ICO %d\n", util_hashString("ico", 3));
-// printf("#define HASH_ZIP %d\n", util_hashString("zip", 3));
-// printf("#define HASH_GIF %d\n", util_hashString("gif", 3));
-// printf("#define HASH_XML %d\n", util_hashString("xml", 3));
-// printf("#define HASH_TIF %d\n", util_hashString("tif", 3));
-// printf("#define HASH_TIFF %d\n", util_hashString("tiff", 4));
-// printf("#define HASH_CSV %d\n", util_hashString("csv", 3));
+	if(contentType < HTTP_NUM_CONTENT_TYPES){
+		return HTTP_CONTENT_TYPE_MAPPING_ARRAY[contentType];
+	}
 
-inline HTTP_ContentType http_getContentType(const char* fileExtension, const uint_fast64_t fileExtensionLength){
-	#define HASH_TXT 966206576
-	#define HASH_HTML 542175051
-	#define HASH_CSS 825432995
-	#define HASH_JS 6953609
-	#define HASH_JPG 883066721
-	#define HASH_PNG 932504553
-	#define HASH_SVG 957813860
-	#define HASH_ICO 873952437
-	#define HASH_ZIP 1014791617
-	#define HASH_GIF 857823012
-	#define HASH_XML 998530999
-	#define HASH_TIF 965222577
-	#define HASH_TIFF 1227951093
-	#define HASH_CSV 825432998
+	return http_mimeTypeRegistry.mimeTypes[contentType - HTTP_NUM_CONTENT_TYPES].name;
+}
+
+// Note: Image formats and archives are compressed already, deflating them again only costs time.
+inline bool http_isCompressibleContentType(const HTTP_ContentType contentType){
+	switch(contentType){
+	case HTTP_CONTENT_TYPE_TEXT_PLAIN:
+	case HTTP_CONTENT_TYPE_IMAGE_SVG_XML:
+	case HTTP_CONTENT_TYPE_VMD_MICROSOFT_ICON:
+	case HTTP_CONTENT_TYPE_TEXT_CSS:
+	case HTTP_CONTENT_TYPE_TEXT_CSV:
+	case HTTP_CONTENT_TYPE_TEXT_HTML:
+	case HTTP_CONTENT_TYPE_TEXT_JAVASCRIPT:
+	case HTTP_CONTENT_TYPE_TEXT_XML:{
+		return true;
+	}
+	default:{
+		return contentType >= HTTP_NUM_CONTENT_TYPES && http_mimeTypeRegistry.mimeTypes[contentType - HTTP_NUM_CONTENT_TYPES].compressible;
+	}
+	}
+}
+
+local const char* HTTP_CONTENT_ENCODING_MAPPING_ARRAY[] = {
+	"identity",
+	"gzip",
+};
 
-	switch(util_hashString(fileExtension, fileExtensionLength)){
+inline const char* http_contentEncodingToString(const HTTP_ContentEncoding contentEncoding){
+	return HTTP_CONTENT_ENCODING_MAPPING_ARRAY[contentEncoding];
+}
+
+// Note: Picks the supported encoding with the highest quality value from an 'Accept-Encoding' value, ties go to compressed encodings. 'identity' is acceptable unless excluded explicitly.
+HTTP_ContentEncoding http_negotiateContentEncoding(const char* value, const uint_fast64_t valueLength){
+	// Quality values in thousandths, -1 for encodings that are not listed.
+	int_fast16_t qualities[HTTP_NUM_CONTENT_ENCODINGS];
+	int_fast16_t wildcardQuality = -1;
 
-	case HASH_CSS:{
-		return HTTP_CONTENT_TYPE_TEXT_CSS;
+	uint_fast8_t i;
+	for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		qualities[i] = -1;
 	}
-	case HASH_JS:{
-		return HTTP_CONTENT_TYPE_TEXT_JAVASCRIPT;
+
+	uint_fast64_t offset = 0;
+	while(offset < valueLength){
+		while(offset < valueLength && (value[offset] == ' ' || value[offset] == '\t' || value[offset] == ',')){
+			offset++;
+		}
+
+		const uint_fast64_t codingBegin = offset;
+		while(offset < valueLength && value[offset] != ';' && value[offset] != ',' && value[offset] != ' ' && value[offset] != '\t'){
+			offset++;
+		}
+
+		const char* coding = value + codingBegin;
+		const uint_fast64_t codingLength = offset - codingBegin;
+
+		if(codingLength == 0){
+			continue;
+		}
+
+		int_fast16_t quality = 1000;
+
+		// Parameters, only 'q' carries a meaning.
+		while(offset < valueLength && value[offset] != ','){
+			if(valueLength - offset > 2 && value[offset] == ';'){
+				offset++;
+
+				while(offset < valueLength && (value[offset] == ' ' || value[offset] == '\t')){
+					offset++;
+				}
+
+				if(valueLength - offset > 2 && (value[offset] == 'q' || value[offset] == 'Q') && value[offset + 1] == '='){
+					offset += 2;
+
+					quality = 0;
+
+					uint_fast16_t scale = 1000;
+					for(; offset < valueLength && (isdigit(value[offset]) || value[offset] == '.'); offset++){
+						if(value[offset] == '.'){
+							continue;
+						}
+
+						quality += (value[offset] - '0') * scale;
+						scale /= 10;
+					}
+
+					quality = MIN(quality, 1000);
+				}
+
+				continue;
+			}
+
+			offset++;
+		}
+
+		if(codingLength == 1 && coding[0] == '*'){
+			wildcardQuality = quality;
+
+			continue;
+		}
+
+		for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+			const char* encoding = HTTP_CONTENT_ENCODING_MAPPING_ARRAY[i];
+
+			if(strlen(encoding) == codingLength && strncasecmp(coding, encoding, codingLength) == 0){
+				qualities[i] = quality;
+			}
+		}
 	}
-	case HASH_JPG:{
-		return HTTP_CONTENT_TYPE_IMAGE_JPEG;
+
+	for(i = 0; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		if(qualities[i] == -1){
+			qualities[i] = wildcardQuality != -1 ? wildcardQuality : (i == HTTP_CONTENT_ENCODING_IDENTITY ? 1000 : 0);
+		}
 	}
-	case HASH_PNG:{
-		return HTTP_CONTENT_TYPE_IMAGE_PNG;		
+
+	HTTP_ContentEncoding contentEncoding = HTTP_CONTENT_ENCODING_IDENTITY;
+
+	for(i = HTTP_CONTENT_ENCODING_IDENTITY + 1; i < HTTP_NUM_CONTENT_ENCODINGS; i++){
+		if(qualities[i] > 0 && qualities[i] >= qualities[contentEncoding]){
+			contentEncoding = i;
+		}
 	}
-	case HASH_SVG:{
-		return HTTP_CONTENT_TYPE_IMAGE_SVG_XML;
+
+	return contentEncoding;
+}
+
+local const HTTP_MimeTypeExtension HTTP_MIME_TYPE_EXTENSIONS[] = {
+	{"txt", 3, HTTP_CONTENT_TYPE_TEXT_PLAIN},
+	{"html", 4, HTTP_CONTENT_TYPE_TEXT_HTML},
+	{"htm", 3, HTTP_CONTENT_TYPE_TEXT_HTML},
+	{"css", 3, HTTP_CONTENT_TYPE_TEXT_CSS},
+	{"csv", 3, HTTP_CONTENT_TYPE_TEXT_CSV},
+	{"js", 2, HTTP_CONTENT_TYPE_TEXT_JAVASCRIPT},
+	{"xml", 3, HTTP_CONTENT_TYPE_TEXT_XML},
+	{"jpg", 3, HTTP_CONTENT_TYPE_IMAGE_JPEG},
+	{"jpeg", 4, HTTP_CONTENT_TYPE_IMAGE_JPEG},
+	{"png", 3, HTTP_CONTENT_TYPE_IMAGE_PNG},
+	{"gif", 3, HTTP_CONTENT_TYPE_IMAGE_GIF},
+	{"svg", 3, HTTP_CONTENT_TYPE_IMAGE_SVG_XML},
+	{"ico", 3, HTTP_CONTENT_TYPE_VMD_MICROSOFT_ICON},
+	{"tif", 3, HTTP_CONTENT_TYPE_IMAGE_TIFF},
+	{"tiff", 4, HTTP_CONTENT_TYPE_IMAGE_TIFF},
+	{"webp", 4, HTTP_CONTENT_TYPE_IMAGE_WEBP},
+	{"avif", 4, HTTP_CONTENT_TYPE_IMAGE_AVIF},
+	{"zip", 3, HTTP_CONTENT_TYPE_APPLICATION_ZIP},
+	{"mkv", 3, HTTP_CONTENT_TYPE_VIDEO_X_MATROSKA},
+	{"mp4", 3, HTTP_CONTENT_TYPE_VIDEO_MP4},
+	{"webm", 4, HTTP_CONTENT_TYPE_VIDEO_WEBM},
+	{"flac", 4, HTTP_CONTENT_TYPE_AUDIO_FLAC}
+};
+
+// Note: FNV-1a over the lower case extension, finished with the murmur3 mixer so the low bits used for the slot depend on every character.
+local inline uint32_t http_hashFileExtension(const char* extension, uint_fast64_t length, const uint32_t seed){
+	uint32_t hash = 0x811C9DC5 ^ (seed * 0x9E3779B9);
+
+	while(length-- != 0){
+		const uint8_t c = (uint8_t) *extension++;
+
+		hash ^= c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+		hash *= 0x01000193;
 	}
-	case HASH_ICO:{
-		return HTTP_CONTENT_TYPE_VMD_MICROSOFT_ICON;
+
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+inline HTTP_ContentType http_getContentType(const char* fileExtension, const uint_fast64_t fileExtensionLength){
+	const HTTP_MimeTypeRegistry* registry = &http_mimeTypeRegistry;
+
+	if(fileExtensionLength == 0 || fileExtensionLength > HTTP_MAX_FILE_EXTENSION_LENGTH || registry->slots == NULL){
+		return HTTP_CONTENT_TYPE_TEXT_PLAIN;
 	}
-	case HASH_ZIP:{
-		return HTTP_CONTENT_TYPE_APPLICATION_ZIP;
+
+	const uint16_t seed = registry->seeds[http_hashFileExtension(fileExtension, fileExtensionLength, 0) % registry->numBuckets];
+	const HTTP_MimeTypeExtension* slot = &registry->slots[http_hashFileExtension(fileExtension, fileExtensionLength, seed) & registry->slotMask];
+
+	// Note: Empty slots have a length of 0 and never match.
+	if(slot->extensionLength != fileExtensionLength || strncasecmp(slot->extension, fileExtension, fileExtensionLength) != 0){
+		return HTTP_CONTENT_TYPE_TEXT_PLAIN;
 	}
-	case HASH_GIF:{
-		return HTTP_CONTENT_TYPE_IMAGE_GIF;
+
+	return slot->contentType;
+}
+
+// Note: Extension with the position it got registered at, so later definitions of an extension can replace earlier ones.
+typedef struct{
+	HTTP_MimeTypeExtension extension;
+	uint_fast32_t index;
+}HTTP_MimeTypeDefinition;
+
+local int http_compareMimeTypeDefinitions(const void* a, const void* b){
+	const HTTP_MimeTypeDefinition* definitionA = a;
+	const HTTP_MimeTypeDefinition* definitionB = b;
+
+	const int ret = strcasecmp(definitionA->extension.extension, definitionB->extension.extension);
+	if(ret != 0){
+		return ret;
 	}
-	case HASH_XML:{
-		return HTTP_CONTENT_TYPE_TEXT_XML;
+
+	return (definitionA->index > definitionB->index) - (definitionA->index < definitionB->index);
+}
+
+local ERROR_CODE http_buildMimeTypeTable(HTTP_MimeTypeRegistry* registry, const HTTP_MimeTypeExtension* extensions, const uint_fast32_t numExtensions){
+	uint_fast32_t numSlots = 8;
+	while(numSlots < numExtensions + numExtensions / 4){
+		numSlots <<= 1;
 	}
-	case HASH_TIF:
-	case HASH_TIFF:{
-		return HTTP_CONTENT_TYPE_IMAGE_TIFF;
+
+	registry->numBuckets = numExtensions < 4 ? 1 : numExtensions / 4;
+
+	uint_fast32_t* bucketOffsets = calloc(registry->numBuckets + 1, sizeof(*bucketOffsets));
+	uint_fast32_t* bucketOrder = malloc(sizeof(*bucketOrder) * registry->numBuckets);
+	uint_fast32_t* bucketedExtensions = malloc(sizeof(*bucketedExtensions) * numExtensions);
+	uint_fast32_t* bucketSlots = malloc(sizeof(*bucketSlots) * numExtensions);
+	registry->seeds = malloc(sizeof(*registry->seeds) * registry->numBuckets);
+
+	ERROR_CODE error = ERROR_NO_ERROR;
+	if(bucketOffsets == NULL || bucketOrder == NULL || bucketedExtensions == NULL || bucketSlots == NULL || registry->seeds == NULL){
+		error = ERROR_OUT_OF_MEMORY;
+
+		goto label_free;
 	}
-	case HASH_CSV:{
-		return HTTP_CONTENT_TYPE_TEXT_CSV;
+
+	// Note: Counting sort of the extensions by bucket, 'bucketOffsets[i]' ends up as the first extension of bucket 'i'.
+	uint_fast32_t i;
+	for(i = 0; i < numExtensions; i++){
+		bucketOffsets[http_hashFileExtension(extensions[i].extension, extensions[i].extensionLength, 0) % registry->numBuckets + 1]++;
 	}
-	case HASH_HTML:
-	case HASH_TXT:{
-		return HTTP_CONTENT_TYPE_TEXT_HTML;
+
+	for(i = 0; i < registry->numBuckets; i++){
+		bucketOffsets[i + 1] += bucketOffsets[i];
+		bucketOrder[i] = i;
 	}
 
-	default:{
-		return HTTP_CONTENT_TYPE_TEXT_PLAIN;
+	uint_fast32_t* bucketFill = bucketSlots;
+	memcpy(bucketFill, bucketOffsets, sizeof(*bucketFill) * registry->numBuckets);
+
+	for(i = 0; i < numExtensions; i++){
+		bucketedExtensions[bucketFill[http_hashFileExtension(extensions[i].extension, extensions[i].extensionLength, 0) % registry->numBuckets]++] = i;
+	}
+
+	// Note: Large buckets get placed first, while most slots are still free.
+	uint_fast32_t j;
+	for(i = 1; i < registry->numBuckets; i++){
+		const uint_fast32_t bucket = bucketOrder[i];
+		const uint_fast32_t bucketSize = bucketOffsets[bucket + 1] - bucketOffsets[bucket];
+
+		for(j = i; j > 0 && bucketOffsets[bucketOrder[j - 1] + 1] - bucketOffsets[bucketOrder[j - 1]] < bucketSize; j--){
+			bucketOrder[j] = bucketOrder[j - 1];
+		}
+
+		bucketOrder[j] = bucket;
+	}
+
+	for(;;){
+		registry->slots = calloc(numSlots, sizeof(*registry->slots));
+		if(registry->slots == NULL){
+			error = ERROR_OUT_OF_MEMORY;
+
+			goto label_free;
+		}
+
+		registry->slotMask = numSlots - 1;
+
+		for(i = 0; i < registry->numBuckets; i++){
+			const uint_fast32_t bucket = bucketOrder[i];
+			const uint_fast32_t* bucketExtensions = bucketedExtensions + bucketOffsets[bucket];
+			const uint_fast32_t bucketSize = bucketOffsets[bucket + 1] - bucketOffsets[bucket];
+
+			uint_fast32_t seed;
+			for(seed = 0; seed <= UINT16_MAX; seed++){
+				for(j = 0; j < bucketSize; j++){
+					const HTTP_MimeTypeExtension* extension = &extensions[bucketExtensions[j]];
+					bucketSlots[j] = http_hashFileExtension(extension->extension, extension->extensionLength, seed) & registry->slotMask;
+
+					if(registry->slots[bucketSlots[j]].extensionLength != 0){
+						break;
+					}
+
+					uint_fast32_t k;
+					for(k = 0; k < j && bucketSlots[k] != bucketSlots[j]; k++);
+
+					if(k != j){
+						break;
+					}
+				}
+
+				if(j == bucketSize){
+					break;
+				}
+			}
+
+			if(seed > UINT16_MAX){
+				break;
+			}
+
+			registry->seeds[bucket] = seed;
+
+			for(j = 0; j < bucketSize; j++){
+				registry->slots[bucketSlots[j]] = extensions[bucketExtensions[j]];
+			}
+		}
+
+		if(i == registry->numBuckets){
+			break;
+		}
 
-		break;
+		// Note: No seed placed the bucket, start over with twice the slots.
+		free(registry->slots);
+		registry->slots = NULL;
+
+		numSlots <<= 1;
 	}
- }
 
-	#undef HASH_TXT
-	#undef HASH_HTML
-	#undef HASH_CSS
-	#undef HASH_JS
-	#undef HASH_JPG
-	#undef HASH_PNG
-	#undef HASH_SVG
-	#undef HASH_ICO
-	#undef HASH_ZIP
-	#undef HASH_GIF
-	#undef HASH_XML
-	#undef HASH_TIF
-	#undef HASH_TIFF
-	#undef HASH_CUR
-	#undef HASH_CSV
+label_free:
+	free(bucketOffsets);
+	free(bucketOrder);
+	free(bucketedExtensions);
+	free(bucketSlots);
+
+	return ERROR(error);
 }
 
-// printf("#define HASH_1_0 %d\n", util_hashString(CONSTANTS_HTTP_VERSION_1_0, strlen(CONSTANTS_HTTP_VERSION_1_0)));
-// printf("#define HASH_1_1 %d\n", util_hashString(CONSTANTS_HTTP_VERSION_1_1, strlen(CONSTANTS_HTTP_VERSION_1_1)));
-// printf("#define HASH_2_0 %d\n", util_hashString(CONSTANTS_HTTP_VERSION_2_0, strlen(CONSTANTS_HTTP_VERSION_2_0)));
-Version http_parseHTTP_Version(const char* version, const uint_fast64_t versionStringLength){
-	#define HASH_1_0 1183657804
-	#define HASH_1_1 1183657805
-	#define HASH_2_0 1191919309
+local bool http_isCompressibleMimeType(const char* name){
+	const uint_fast64_t nameLength = strlen(name);
+
+	return strncasecmp(name, "text/", 5) == 0 || (nameLength > 4 && strcasecmp(name + nameLength - 4, "+xml") == 0) || (nameLength > 5 && strcasecmp(name + nameLength - 5, "+json") == 0) || strcasecmp(name, "application/json") == 0 || strcasecmp(name, "application/javascript") == 0 || strcasecmp(name, "application/xml") == 0;
+}
 
-	switch (util_hashString(version, versionStringLength)){
-		case HASH_1_0:{
-			return HTTP_HTTP_VERSION_1_0;
+local ERROR_CODE http_parseMimeTypeFile(HTTP_MimeTypeRegistry* registry, char* buffer, HTTP_MimeTypeDefinition** definitions, uint_fast32_t* numDefinitions, uint_fast32_t* definitionsCapacity){
+	uint_fast32_t mimeTypesCapacity = 0;
+
+	char* line = buffer;
+	while(*line != '\0'){
+		char* lineEnd = strchr(line, '\n');
+		char* next = lineEnd == NULL ? line + strlen(line) : lineEnd + 1;
+
+		if(lineEnd != NULL){
+			*lineEnd = '\0';
 		}
 
-		case HASH_1_1:{
-			return HTTP_HTTP_VERSION_1_1;
+		char* comment = strchr(line, '#');
+		if(comment != NULL){
+			*comment = '\0';
 		}
 
-		case HASH_2_0:{
-			return HTTP_HTTP_VERSION_2_0;
+		// Note: '<type> <extension>*', separated by whitespace. Types without extensions can't be looked up and get skipped.
+		char* savePtr;
+		const char* name = strtok_r(line, " \t\r\v\f", &savePtr);
+		char* extension = name == NULL ? NULL : strtok_r(NULL, " \t\r\v\f", &savePtr);
+
+		if(extension != NULL){
+			HTTP_ContentType contentType;
+			for(contentType = 0; contentType < HTTP_NUM_CONTENT_TYPES + registry->numMimeTypes; contentType++){
+				if(strcasecmp(http_contentTypeToString(contentType), name) == 0){
+					break;
+				}
+			}
+
+			if(contentType == HTTP_NUM_CONTENT_TYPES + registry->numMimeTypes){
+				if(registry->numMimeTypes == mimeTypesCapacity){
+					mimeTypesCapacity = mimeTypesCapacity == 0 ? 64 : mimeTypesCapacity * 2;
+
+					HTTP_MimeType* mimeTypes = realloc(registry->mimeTypes, sizeof(*mimeTypes) * mimeTypesCapacity);
+					if(mimeTypes == NULL){
+						return ERROR(ERROR_OUT_OF_MEMORY);
+					}
+
+					registry->mimeTypes = mimeTypes;
+				}
+
+				registry->mimeTypes[registry->numMimeTypes].name = name;
+				registry->mimeTypes[registry->numMimeTypes].compressible = http_isCompressibleMimeType(name);
+				registry->numMimeTypes++;
+			}
+
+			for(; extension != NULL; extension = strtok_r(NULL, " \t\r\v\f", &savePtr)){
+				const uint_fast64_t extensionLength = strlen(extension);
+				if(extensionLength > HTTP_MAX_FILE_EXTENSION_LENGTH){
+					continue;
+				}
+
+				if(*numDefinitions == *definitionsCapacity){
+					*definitionsCapacity *= 2;
+
+					HTTP_MimeTypeDefinition* _definitions = realloc(*definitions, sizeof(**definitions) * *definitionsCapacity);
+					if(_definitions == NULL){
+						return ERROR(ERROR_OUT_OF_MEMORY);
+					}
+
+					*definitions = _definitions;
+				}
+
+				HTTP_MimeTypeDefinition* definition = &(*definitions)[*numDefinitions];
+				definition->extension.extension = extension;
+				definition->extension.extensionLength = extensionLength;
+				definition->extension.contentType = contentType;
+				definition->index = (*numDefinitions)++;
+			}
 		}
 
-		default:{
-			Version ret = {0, 0, 0};
+		line = next;
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Registers the built-in extensions and, unless 'mimeTypeFile' is NULL or empty, the ones of a mime.types file ('<type> <extension>*' per line, '#' starts a comment). Extensions from the file replace built-in ones. Has to be called before any worker looks up a content type, the registry is read without locking afterwards.
+ERROR_CODE http_initMimeTypeRegistry(const char* mimeTypeFile){
+	ERROR_CODE error;
+
+	http_freeMimeTypeRegistry();
+
+	HTTP_MimeTypeRegistry* registry = &http_mimeTypeRegistry;
+
+	uint_fast32_t numDefinitions = UTIL_ARRAY_LENGTH(HTTP_MIME_TYPE_EXTENSIONS);
+	uint_fast32_t definitionsCapacity = numDefinitions;
+
+	HTTP_MimeTypeExtension* extensions = NULL;
+	HTTP_MimeTypeDefinition* definitions = malloc(sizeof(*definitions) * definitionsCapacity);
+	if(definitions == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	uint_fast32_t i;
+	for(i = 0; i < numDefinitions; i++){
+		definitions[i].extension = HTTP_MIME_TYPE_EXTENSIONS[i];
+		definitions[i].index = i;
+	}
+
+	if(mimeTypeFile != NULL && mimeTypeFile[0] != '\0'){
+		uint_fast64_t fileSize;
+		if((error = util_getFileSize(mimeTypeFile, &fileSize)) != ERROR_NO_ERROR){
+			goto label_free;
+		}
+
+		if((registry->buffer = malloc(sizeof(*registry->buffer) * (fileSize + 1))) == NULL){
+			error = ERROR_OUT_OF_MEMORY;
 
-			return ret;
+			goto label_free;
+		}
+
+		FILE* filePtr = fopen(mimeTypeFile, "r");
+		if(filePtr == NULL){
+			error = ERROR_(ERROR_FAILED_TO_OPEN_FILE, "File: '%s'.", mimeTypeFile);
+
+			goto label_free;
+		}
+
+		if(fread(registry->buffer, 1, fileSize, filePtr) != fileSize){
+			fclose(filePtr);
+
+			error = ERROR_(ERROR_FAILED_TO_LOAD_FILE, "Failed to load file: '%s'.", mimeTypeFile);
+
+			goto label_free;
+		}
+
+		fclose(filePtr);
+
+		registry->buffer[fileSize] = '\0';
+
+		if((error = http_parseMimeTypeFile(registry, registry->buffer, &definitions, &numDefinitions, &definitionsCapacity)) != ERROR_NO_ERROR){
+			goto label_free;
 		}
 	}
 
-	#undef HASH_1_0
-	#undef HASH_1_1
-	#undef HASH_2_0
+	// Note: Sorting groups equal extensions, only the last definition of each is kept.
+	qsort(definitions, numDefinitions, sizeof(*definitions), http_compareMimeTypeDefinitions);
+
+	if((extensions = malloc(sizeof(*extensions) * numDefinitions)) == NULL){
+		error = ERROR_OUT_OF_MEMORY;
+
+		goto label_free;
+	}
+
+	uint_fast32_t numExtensions = 0;
+	for(i = 0; i < numDefinitions; i++){
+		if(i + 1 < numDefinitions && strcasecmp(definitions[i].extension.extension, definitions[i + 1].extension.extension) == 0){
+			continue;
+		}
+
+		extensions[numExtensions++] = definitions[i].extension;
+	}
+
+	error = http_buildMimeTypeTable(registry, extensions, numExtensions);
+
+label_free:
+	free(definitions);
+	free(extensions);
+
+	if(error != ERROR_NO_ERROR){
+		http_freeMimeTypeRegistry();
+	}
+
+	return ERROR(error);
+}
+
+void http_freeMimeTypeRegistry(void){
+	free(http_mimeTypeRegistry.mimeTypes);
+	free(http_mimeTypeRegistry.slots);
+	free(http_mimeTypeRegistry.seeds);
+	free(http_mimeTypeRegistry.buffer);
+
+	memset(&http_mimeTypeRegistry, 0, sizeof(http_mimeTypeRegistry));
+}
+
+// printf("#define HASH_1_0 %d\n", util_hashString(CONSTANTS_HTTP_VERSION_1_0, strlen(CONSTANTS_HTTP_VERSION_1_0)));
+// printf("#define HASH_1_1 %d\n", util_hashString(CONSTANTS_HTTP_VERSION_1_1, strlen(CONSTANTS_HTTP_VERSION_1_1)));
+// printf("#define HASH_2_0 %d\n", util_hashString(CONSTANTS_HTTP_VERSION_2_0, strlen(CONSTANTS_HTTP_VERSION_2_0)));
+typedef struct{
+	const char name[8];
+	const Version* version;
+}HTTP_VersionSlot;
+
+// Note: Indexed by '(version[5] ^ version[7]) & 3', the major and minor version digit.
+local const HTTP_VersionSlot HTTP_VERSION_HASH_TABLE[4] = {
+	[0] = {{'H', 'T', 'T', 'P', '/', '1', '.', '1'}, &HTTP_HTTP_VERSION_1_1},
+	[1] = {{'H', 'T', 'T', 'P', '/', '1', '.', '0'}, &HTTP_HTTP_VERSION_1_0},
+	[2] = {{'H', 'T', 'T', 'P', '/', '2', '.', '0'}, &HTTP_HTTP_VERSION_2_0}
+};
+
+inline Version http_parseHTTP_Version(const char* version, const uint_fast64_t versionStringLength){
+	if(versionStringLength == 8){
+		const HTTP_VersionSlot* slot = &HTTP_VERSION_HASH_TABLE[(version[5] ^ version[7]) & 3];
+
+		// Note: The empty slot is all zeros and never matches.
+		if(memcmp(slot->name, version, 8) == 0){
+			return *slot->version;
+		}
+	}
+
+	Version ret = {0, 0, 0};
+
+	return ret;
 }
 
 ERROR_CODE http_parseHTTP_Request(HTTP_Request* request, char* httpProcessingBuffer, const uint_fast64_t httpProcessingBufferSize){
@@ -753,140 +1255,519 @@ ERROR_CODE http_parseHTTP_Request(HTTP_Request* request, char* httpProcessingBuf
 	}
 
 	// RequestLine.
-	uint_fast64_t i;
-	for(i = 1; i < httpProcessingBufferSize; i++){
+	// Note: Lines get found by their '\n' through 'util_findFirst', which scans a whole vector of bytes at a time.
+	const int_fast64_t requestLineLength = util_findFirst(httpProcessingBuffer, httpProcessingBufferSize, '\n') - 1;
+	if(requestLineLength < 0 || httpProcessingBuffer[requestLineLength] != '\r'){
+		return ERROR(ERROR_INVALID_HEADER_FIELD);
+	}
+
+	{
+		int_fast64_t posSplitBegin = 0;
+		int_fast64_t posSplitEnd;
+
+		// RequestType.
+		posSplitEnd = util_findFirst(httpProcessingBuffer, requestLineLength, ' ');
+
+		if(posSplitEnd == -1){
+			return ERROR(ERROR_INVALID_HEADER_FIELD);
+		}
+
+		const char* const requestType = httpProcessingBuffer;
+		const uint_fast64_t requestTypeLength = posSplitEnd;
+
+		request->httpRequestType = http_parseRequestType(requestType, requestTypeLength);
+
+		// Reset search location to after request type.
+		posSplitBegin = posSplitEnd + 1;
+
+		// RequestURL.
+		posSplitEnd = util_findFirst(httpProcessingBuffer + posSplitBegin, requestLineLength - posSplitBegin, ' ');
+
+		if(posSplitEnd == -1){
+			return ERROR(ERROR_INVALID_HEADER_FIELD);
+		}
+
+		request->requestURLLength = posSplitEnd;
+
+		if(request->requestURLLength == 0){
+			return ERROR_(ERROR_INVALID_REQUEST_URL, "URL length can't be of length '%" PRIuFAST64 "'.", request->requestURLLength);
+		}
+
+		// Note: Terminated in place, the space in front of the version is not needed anymore.
+		request->requestURL = httpProcessingBuffer + posSplitBegin;
+		request->requestURL[request->requestURLLength] = '\0';
+
+		// Reset search location to after request url.
+		posSplitBegin += posSplitEnd + 1;
+
+		http_splitRequestURL(request);
+
+		// Version.
+		const char* const version = httpProcessingBuffer + posSplitBegin;
+		const uint_fast64_t versionLength = requestLineLength - posSplitBegin;
+
+		// Note: HTTP/1.0 and HTTP/1.1, HTTP/2 never arrives as a request line.
+		const Version parsedVersion = http_parseHTTP_Version(version, versionLength);
+		if(parsedVersion.release != 1){
+			return ERROR(ERROR_VERSION_MISSMATCH);
+		}
+
+		http_setHTTP_Version(request, parsedVersion);
+	}
+
+	// Header fields.
+	// Note: Parsed in place, the ':' behind every name and the '\r' behind every value get replaced with '\0'. Both can be used as strings without copying them out of the buffer.
+	uint_fast64_t i = requestLineLength + 2;
+	// For each line in the http request.
+	while(i < httpProcessingBufferSize){
 		// Find line break/end of line.
-		if(httpProcessingBuffer[i - 1] == '\n' && httpProcessingBuffer[i - 2] == '\r'){
-			int_fast64_t posSplitBegin = 0;
-			int_fast64_t posSplitEnd;
+		const int_fast64_t lineFeed = util_findFirst(httpProcessingBuffer + i, httpProcessingBufferSize - i, '\n');
+		if(lineFeed == -1){
+			i = httpProcessingBufferSize;
 
-			// RequestType.
-			posSplitEnd = util_findFirst(httpProcessingBuffer, httpProcessingBufferSize, ' ');
+			break;
+		}
 
-			if(posSplitEnd == -1){
-				return ERROR(ERROR_INVALID_HEADER_FIELD);
-			}
+		if(lineFeed == 0 || httpProcessingBuffer[i + lineFeed - 1] != '\r'){
+			return ERROR(ERROR_INVALID_HEADER_FIELD);
+		}
 
-			const char* const requestType = httpProcessingBuffer;
-			const uint_fast64_t requestTypeLength = posSplitEnd;
+		char* line = httpProcessingBuffer + i;
+		// Note: Without the terminating '\r', values like 'Range' get parsed against their exact length.
+		uint_fast64_t lineLength = lineFeed - 1;
 
-			request->httpRequestType = http_parseRequestType(requestType, requestTypeLength);
+		// Move to the beginning of the next line.
+		i += lineFeed + 1;
 
-			// Reset search location to after request type.
-			posSplitBegin = posSplitEnd + 1;
+		// Empty line, end of the header.
+		if(lineLength == 0){
+			break;
+		}
 
-			// RequestURL.
-			posSplitEnd = util_findFirst(httpProcessingBuffer + posSplitBegin, httpProcessingBufferSize - posSplitBegin, ' ');
+		// Header field name.
+		const int_fast64_t nameLength = util_findFirst(line, lineLength,':');
+		if(nameLength == -1){
+			return ERROR(ERROR_INVALID_HEADER_FIELD);
+		}
 
-			if(posSplitEnd == -1){
-				return ERROR(ERROR_INVALID_HEADER_FIELD);
-			}
+		char* name = line;
+		name[nameLength] = '\0';
 
-			request->requestURLLength = posSplitEnd;
+		// Move line beginning after the ':' seperator.
+		line += nameLength + 1;
+		lineLength -= nameLength + 1;
 
-			if(request->requestURLLength == 0){
-				return ERROR_(ERROR_INVALID_REQUEST_URL, "URL length can't be of length '%" PRIuFAST64 "'.", request->requestURLLength);
-			}
+		// Skip trailing whitespace
+		if(lineLength > 0 && isspace(*line) != 0){
+			line += 1;
+			lineLength -= 1;
+		}
 
-			request->requestURL = malloc(sizeof(*request->requestURL) * request->requestURLLength + 1);
-			if(request->requestURL == NULL){
-			 	return ERROR(ERROR_OUT_OF_MEMORY);
-			}
+		// Header field value.
+		char* value = line;
+		value[lineLength] = '\0';
+
+		ERROR_CODE error;
+		if((error = http_addHeaderField(request, name, nameLength, value, lineLength)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}
 
-			memcpy(request->requestURL, httpProcessingBuffer + posSplitBegin, request->requestURLLength);
-			request->requestURL[request->requestURLLength] = '\0';
+	// Data.
+	request->dataSegment = (int8_t*) (httpProcessingBuffer + i);
 
-			// Reset search location to after request url.
-			posSplitBegin += posSplitEnd + 1;
+	return ERROR(ERROR_NO_ERROR);
+}
 
-			const int_fast64_t getRequestParameterOffset = util_findFirst(request->requestURL, request->requestURLLength, '?');
+// Note: Cuts get parameters sent via the url off 'requestURL', 'getRequestParameter' points into the same buffer.
+inline void http_splitRequestURL(HTTP_Request* request){
+	const int_fast64_t getRequestParameterOffset = util_findFirst(request->requestURL, request->requestURLLength, '?');
 
-			// If we have additional get parameters sent via the url.
-			if(getRequestParameterOffset != -1){
-				request->requestURL[getRequestParameterOffset] = '\0';
+	if(getRequestParameterOffset != -1){
+		request->requestURL[getRequestParameterOffset] = '\0';
 
-				request->getRquestParameterLength = request->requestURLLength - getRequestParameterOffset;
-				request->requestURLLength = getRequestParameterOffset;
+		request->getRquestParameterLength = request->requestURLLength - getRequestParameterOffset;
+		request->requestURLLength = getRequestParameterOffset;
 
-				request->getRequestParameter = request->requestURL + (getRequestParameterOffset + 1);
-			}
+		request->getRequestParameter = request->requestURL + (getRequestParameterOffset + 1);
+	}
+}
+
+// Note: Returns the length of the request line and header fields including the terminating empty line, or (-1) if the buffer does not yet hold a complete header.
+inline int_fast64_t http_findEndOfHeader(const char* buffer, const uint_fast64_t bufferSize){
+	const int_fast64_t endOfHeader = util_findFirst_s(buffer, bufferSize, "\r\n\r\n", 4);
+
+	return endOfHeader == -1 ? -1 : endOfHeader + 4;
+}
+
+inline void http_initParser(HTTP_Parser* parser){
+	memset(parser, 0, sizeof(*parser));
+}
+
+// Note: Returns 'ERROR_INCOMPLETE' until the buffer holds the whole header block, 'headerLength' includes the terminating empty line. Data that arrives later has to be appended to the same buffer. Running out of data is expected, 'ERROR_INCOMPLETE' does not go through 'ERROR'.
+inline ERROR_CODE http_parseHeaderBlock(HTTP_Parser* parser, const char* buffer, const uint_fast64_t bufferLength, uint_fast64_t* headerLength){
+	// Note: The end of the header block may have been split across reads, the last 3 bytes that were scanned get scanned again.
+	const uint_fast64_t scanOffset = parser->scanOffset > 3 ? parser->scanOffset - 3 : 0;
+
+	const int_fast64_t endOfHeader = http_findEndOfHeader(buffer + scanOffset, bufferLength - scanOffset);
+	if(endOfHeader == -1){
+		parser->scanOffset = bufferLength;
+
+		return ERROR_INCOMPLETE;
+	}
+
+	*headerLength = scanOffset + endOfHeader;
+
+	parser->scanOffset = 0;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Frames the body of a parsed request (RFC 9112 6.3). Requests with both 'Transfer-Encoding' and 'Content-Length', a transfer coding other than 'chunked' or an invalid 'Content-Length' can't be framed, the connection has to be closed after answering them.
+inline ERROR_CODE http_initBody(HTTP_Parser* parser, HTTP_Request* request){
+	const HTTP_HeaderField* transferEncoding = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_TRANSFER_ENCODING);
+	const HTTP_HeaderField* contentLength = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_CONTENT_LENGTH);
+
+	parser->remaining = 0;
+
+	if(transferEncoding != NULL){
+		if(contentLength != NULL || transferEncoding->valueLength != 7 || strncasecmp(transferEncoding->value, "chunked", 7) != 0){
+			return ERROR(ERROR_INVALID_HEADER_FIELD);
+		}
+
+		parser->state = HTTP_PARSER_STATE_CHUNK_SIZE;
+
+		return ERROR(ERROR_NO_ERROR);
+	}
 
-			// Version.
-			const char* const version = httpProcessingBuffer + posSplitBegin;
-			const uint_fast64_t versionLength = i/*Line length*/ - posSplitBegin - 2/*'\r\n'*/;
+	if(contentLength != NULL){
+		uint_fast64_t length = 0;
 
-			if(strncmp(version, CONSTANTS_HTTP_VERSION_1_1, versionLength) != 0){
-				return ERROR(ERROR_VERSION_MISSMATCH);
-			}else{
-				http_setHTTP_Version(request, HTTP_HTTP_VERSION_1_1);
+		uint_fast64_t i;
+		for(i = 0; i < contentLength->valueLength; i++){
+			const char c = contentLength->value[i];
+
+			if(c < '0' || c > '9' || length > (UINT64_MAX - 9) / 10){
+				return ERROR(ERROR_INVALID_CONTENT_LENGTH);
 			}
 
-			break;
+			length = length * 10 + (c - '0');
+		}
+
+		if(contentLength->valueLength == 0){
+			return ERROR(ERROR_INVALID_CONTENT_LENGTH);
 		}
+
+		parser->remaining = length;
 	}
 
-	// Header fields.
-	uint_fast64_t posLineBegin = i;
-	// For each line in the http request.
-	for(;i < httpProcessingBufferSize; i++){
-		// Find line break/end of line.
-		if(httpProcessingBuffer[i] == '\n' && httpProcessingBuffer[i - 1] == '\r'){
-			if(httpProcessingBuffer[i - 2] == '\n' && httpProcessingBuffer[i - 3] == '\r'){
-				// Skip trailing '\n'.
-				i += 1;
+	parser->state = parser->remaining > 0 ? HTTP_PARSER_STATE_BODY : HTTP_PARSER_STATE_HEADER;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Consumes the body framed by 'http_initBody'. 'consumed' is the number of bytes at the beginning of the buffer that belong to the body, including chunk sizes and trailers. Partial chunk size and trailer lines are not consumed, they have to be passed in again once more data arrived. Returns 'ERROR_INCOMPLETE' until the body ended, the parser is ready for the next header block afterwards.
+inline ERROR_CODE http_parseBody(HTTP_Parser* parser, const char* buffer, const uint_fast64_t bufferLength, uint_fast64_t* consumed){
+	uint_fast64_t offset = 0;
+
+	while(parser->state != HTTP_PARSER_STATE_HEADER){
+		switch(parser->state){
+			case HTTP_PARSER_STATE_BODY:
+			case HTTP_PARSER_STATE_CHUNK_DATA:{
+				const uint_fast64_t length = MIN(parser->remaining, bufferLength - offset);
+
+				offset += length;
+				parser->remaining -= length;
+
+				if(parser->remaining > 0){
+					*consumed = offset;
+
+					return ERROR_INCOMPLETE;
+				}
+
+				parser->state = parser->state == HTTP_PARSER_STATE_BODY ? HTTP_PARSER_STATE_HEADER : HTTP_PARSER_STATE_CHUNK_DATA_END;
 
 				break;
 			}
+			case HTTP_PARSER_STATE_CHUNK_DATA_END:{
+				if(bufferLength - offset < 2){
+					*consumed = offset;
+
+					return ERROR_INCOMPLETE;
+				}
+
+				if(buffer[offset] != '\r' || buffer[offset + 1] != '\n'){
+					return ERROR(ERROR_INVALID_CONTENT_LENGTH);
+				}
+
+				offset += 2;
 
-			char* line = httpProcessingBuffer + posLineBegin;
-			uint_fast64_t lineLength = i - posLineBegin;
+				parser->state = HTTP_PARSER_STATE_CHUNK_SIZE;
 
-			// Header field name.
-			const int_fast64_t nameLength = util_findFirst(line, lineLength,':');
-			if(nameLength == -1){
-				return ERROR(ERROR_INVALID_HEADER_FIELD);
+				break;
 			}
+			case HTTP_PARSER_STATE_CHUNK_SIZE:{
+				const int_fast64_t lineLength = util_findFirst(buffer + offset, bufferLength - offset, '\n') - 1;
+				if(lineLength < 0){
+					*consumed = offset;
+
+					return lineLength == -1 ? ERROR(ERROR_INVALID_CONTENT_LENGTH) : ERROR_INCOMPLETE;
+				}
+
+				const char* line = buffer + offset;
+
+				if(line[lineLength] != '\r'){
+					return ERROR(ERROR_INVALID_CONTENT_LENGTH);
+				}
+
+				// Note: Chunk extensions after ';' are ignored.
+				uint_fast64_t chunkSize = 0;
+
+				int_fast64_t i;
+				for(i = 0; i < lineLength && line[i] != ';'; i++){
+					const int digit = isdigit(line[i]) ? line[i] - '0' : isxdigit(line[i]) ? (tolower(line[i]) - 'a') + 10 : -1;
+
+					if(digit == -1 || chunkSize > (UINT64_MAX >> 4)){
+						return ERROR(ERROR_INVALID_CONTENT_LENGTH);
+					}
+
+					chunkSize = (chunkSize << 4) | digit;
+				}
+
+				if(i == 0){
+					return ERROR(ERROR_INVALID_CONTENT_LENGTH);
+				}
+
+				offset += lineLength + 2;
+
+				parser->remaining = chunkSize;
+				parser->state = chunkSize > 0 ? HTTP_PARSER_STATE_CHUNK_DATA : HTTP_PARSER_STATE_TRAILER;
 
-			char* name = malloc(sizeof(*name) * (nameLength + 1));
-			if(name == NULL){
-				return ERROR(ERROR_OUT_OF_MEMORY);
+				break;
 			}
+			case HTTP_PARSER_STATE_TRAILER:{
+				// Note: Trailer fields are skipped, the empty line ends the body.
+				const int_fast64_t lineLength = util_findFirst(buffer + offset, bufferLength - offset, '\n') - 1;
+				if(lineLength < 0){
+					*consumed = offset;
+
+					return lineLength == -1 ? ERROR(ERROR_INVALID_HEADER_FIELD) : ERROR_INCOMPLETE;
+				}
 
-			memcpy(name, line, nameLength);
-			name[nameLength] = '\0';
+				if(buffer[offset + lineLength] != '\r'){
+					return ERROR(ERROR_INVALID_HEADER_FIELD);
+				}
 
-			// Move line beginning after the ':' seperator.
-			line += nameLength + 1;
-			lineLength -= nameLength + 1;
+				offset += lineLength + 2;
 
-			// Skip trailing whitespace
-			if(isspace(*line) != 0){
-				line += 1;
-				lineLength -= 1;
+				if(lineLength == 0){
+					parser->state = HTTP_PARSER_STATE_HEADER;
+				}
+
+				break;
 			}
+			default:{
+				break;
+			}
+		}
+	}
+
+	*consumed = offset;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Parses a 'Range' header value against a representation of 'contentSize' bytes. ERROR_INVALID_VALUE means the header has to be ignored and the whole representation gets sent, no satisfiable range ('numRanges' == 0) means '416 Range Not Satisfiable'.
+ERROR_CODE http_parseRange(const char* value, const uint_fast64_t valueLength, const uint_fast64_t contentSize, HTTP_ByteRange* ranges, uint_fast8_t* numRanges){
+	*numRanges = 0;
+
+	if(valueLength < 6 || strncasecmp(value, "bytes=", 6) != 0){
+		return ERROR(ERROR_INVALID_VALUE);
+	}
 
-			// Header field value.
-			const int_fast64_t valueLength = lineLength;
-			if(valueLength == -1){
-				return ERROR(ERROR_INVALID_HEADER_FIELD);
+	uint_fast64_t i = 6;
+	for(;;){
+		while(i < valueLength && (value[i] == ' ' || value[i] == '\t')){
+			i++;
+		}
+
+		bool hasFirst = false;
+		bool hasLast = false;
+		uint_fast64_t first = 0;
+		uint_fast64_t last = 0;
+
+		for(; i < valueLength && isdigit(value[i]); i++){
+			// Guard against overflowing values, no representation is that large anyway.
+			if(first > (UINT64_MAX - 9) / 10){
+				return ERROR(ERROR_INVALID_VALUE);
 			}
 
-			char* value = malloc(sizeof(*value) * (valueLength + 1));
-			if(value == NULL){
-				return ERROR(ERROR_OUT_OF_MEMORY);
+			first = first * 10 + (value[i] - '0');
+			hasFirst = true;
+		}
+
+		if(i == valueLength || value[i] != '-'){
+			return ERROR(ERROR_INVALID_VALUE);
+		}
+
+		i++;
+
+		for(; i < valueLength && isdigit(value[i]); i++){
+			if(last > (UINT64_MAX - 9) / 10){
+				return ERROR(ERROR_INVALID_VALUE);
 			}
 
-			memcpy(value, line, valueLength);
-			value[valueLength] = '\0';
+			last = last * 10 + (value[i] - '0');
+			hasLast = true;
+		}
 
-			http_addHeaderField(request, name, nameLength, value, valueLength);
+		if(!hasFirst && !hasLast){
+			return ERROR(ERROR_INVALID_VALUE);
+		}
 
-			posLineBegin = i + 1;
+		if(hasFirst && hasLast && last < first){
+			return ERROR(ERROR_INVALID_VALUE);
 		}
+
+		// Suffix range, the last 'last' bytes.
+		if(!hasFirst){
+			if(last > 0 && contentSize > 0){
+				first = last >= contentSize ? 0 : contentSize - last;
+				last = contentSize - 1;
+
+				hasFirst = true;
+			}
+		}else if(!hasLast || last >= contentSize){
+			last = contentSize - 1;
+		}
+
+		// Note: Ranges starting beyond the end are unsatisfiable, but don't invalidate the others.
+		if(hasFirst && first < contentSize){
+			if(*numRanges == HTTP_MAX_BYTE_RANGES){
+				return ERROR(ERROR_INVALID_VALUE);
+			}
+
+			ranges[*numRanges].first = first;
+			ranges[*numRanges].last = last;
+
+			(*numRanges)++;
+		}
+
+		while(i < valueLength && (value[i] == ' ' || value[i] == '\t')){
+			i++;
+		}
+
+		if(i == valueLength){
+			break;
+		}
+
+		if(value[i] != ','){
+			return ERROR(ERROR_INVALID_VALUE);
+		}
+
+		i++;
 	}
 
-	// Data.
-	request->dataSegment = (int8_t*) (httpProcessingBuffer + i);
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Formats 'time' as IMF-fixdate, 'buffer' has to hold at least HTTP_DATE_LENGTH + 1 bytes.
+inline void http_formatDate(char* buffer, const time_t time){
+	struct tm date;
+	gmtime_r(&time, &date);
+
+	strftime(buffer, HTTP_DATE_LENGTH + 1, "%a, %d %b %Y %H:%M:%S GMT", &date);
+}
+
+// Note: Every thread formats the current date at most once per second and hands out the same string until the second is over.
+local _Thread_local time_t http_currentDateTime = -1;
+local _Thread_local char http_currentDate[HTTP_DATE_LENGTH + 1];
+
+inline const char* http_getCurrentDate(void){
+	const time_t now = time(NULL);
+
+	if(now != http_currentDateTime){
+		http_formatDate(http_currentDate, now);
+
+		http_currentDateTime = now;
+	}
+
+	return http_currentDate;
+}
+
+// Note: Only accepts IMF-fixdate, the obsolete formats are rare enough to just treat the condition as absent.
+inline ERROR_CODE http_parseDate(const char* value, time_t* time){
+	struct tm date = {0};
+
+	const char* end = strptime(value, "%a, %d %b %Y %H:%M:%S GMT", &date);
+	if(end == NULL || *end != '\0'){
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	*time = timegm(&date);
 
 	return ERROR(ERROR_NO_ERROR);
-}
\ No newline at end of file
+}
+
+// Formats a strong entity tag from a 'hash' over the representation and its 'size', 'buffer' has to hold at least HTTP_ENTITY_TAG_LENGTH + 1 bytes.
+inline void http_formatEntityTag(char* buffer, const uint64_t hash, const uint_fast64_t size){
+	snprintf(buffer, HTTP_ENTITY_TAG_LENGTH + 1, "\"%016" PRIx64 "-%" PRIxFAST64 "\"", hash, size);
+}
+
+// Note: Case insensitive comparison against every element of a comma separated list like the value of 'Connection', elements only match as a whole.
+inline bool http_tokenListContains(const char* value, const uint_fast64_t valueLength, const char* token){
+	const uint_fast64_t tokenLength = strlen(token);
+
+	uint_fast64_t i = 0;
+	while(i < valueLength){
+		while(i < valueLength && (value[i] == ' ' || value[i] == '\t' || value[i] == ',')){
+			i++;
+		}
+
+		const uint_fast64_t begin = i;
+		while(i < valueLength && value[i] != ',' && value[i] != ' ' && value[i] != '\t'){
+			i++;
+		}
+
+		if(i - begin == tokenLength && tokenLength != 0 && strncasecmp(value + begin, token, tokenLength) == 0){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Note: Weak comparison of an 'If-None-Match' list against 'entityTag', '*' matches any current representation.
+inline bool http_entityTagListContains(const char* value, const uint_fast64_t valueLength, const char* entityTag){
+	const uint_fast64_t entityTagLength = strlen(entityTag);
+
+	uint_fast64_t i = 0;
+	while(i < valueLength){
+		while(i < valueLength && (value[i] == ' ' || value[i] == '\t' || value[i] == ',')){
+			i++;
+		}
+
+		if(i == valueLength){
+			break;
+		}
+
+		if(value[i] == '*'){
+			return true;
+		}
+
+		if(valueLength - i > 2 && value[i] == 'W' && value[i + 1] == '/'){
+			i += 2;
+		}
+
+		const uint_fast64_t begin = i;
+		while(i < valueLength && value[i] != ',' && value[i] != ' ' && value[i] != '\t'){
+			i++;
+		}
+
+		if(i - begin == entityTagLength && memcmp(value + begin, entityTag, entityTagLength) == 0){
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -3,21 +3,32 @@
 
 #include "properties.h"
 #include "util.h"
+#include "arena.h"
+#include "constants.h"
 
 static Version HTTP_HTTP_VERSION_1_0 = {1, 0, 0};
 static Version HTTP_HTTP_VERSION_1_1 = {1, 1, 0};
 static Version HTTP_HTTP_VERSION_2_0 = {2, 0, 0};
 
+// Note: With an arena the name is not copied, it is a string literal and arena memory never gets freed one by one.
 #define HTTP_ADD_HEADER_FIELD(response, name, value)do{ \
 	uint_fast64_t nameLength = strlen(# name); \
-	char* _name = malloc(sizeof(*_name) * (nameLength + 1)); \
-	strncpy(_name, # name, nameLength + 1); \
-	\
 	uint_fast64_t valueLength = strlen(value); \
-	char* _value = malloc(sizeof(*_value) * (valueLength + 1)); \
-	strncpy(_value, value, valueLength + 1); \
 	\
-	http_addHeaderField((HTTP_Request*) response, _name, nameLength, _value, valueLength); \
+	char* _name; \
+	char* _value; \
+	if((response)->arena != NULL){ \
+		_name = (char*) # name; \
+		_value = arena_copyString((response)->arena, value, valueLength); \
+	}else{ \
+		_name = malloc(sizeof(*_name) * (nameLength + 1)); \
+		strncpy(_name, # name, nameLength + 1); \
+		\
+		_value = malloc(sizeof(*_value) * (valueLength + 1)); \
+		strncpy(_value, value, valueLength + 1); \
+	} \
+	\
+	http_addResponseHeaderField(response, _name, nameLength, _value, valueLength); \
 }while(0)
 
 typedef enum{
@@ -30,7 +41,8 @@ typedef enum{
 	HTTP_REQUEST_TYPE_TRACE,
 	HTTP_REQUEST_TYPE_OPTIONS,
 	HTTP_REQUEST_TYPE_CONNECT,
-	HTTP_REQUEST_TYPE_PATCH 
+	HTTP_REQUEST_TYPE_PATCH,
+	HTTP_NUM_REQUEST_TYPES
 }HTTP_RequestType;
 
 typedef enum{
@@ -113,9 +125,50 @@ typedef enum{
 	HTTP_CONTENT_TYPE_TEXT_HTML,
 	HTTP_CONTENT_TYPE_TEXT_JAVASCRIPT,
 	HTTP_CONTENT_TYPE_TEXT_XML,
-	HTTP_CONTENT_TYPE_APPLICATION_ZIP
+	HTTP_CONTENT_TYPE_APPLICATION_ZIP,
+	HTTP_CONTENT_TYPE_VIDEO_X_MATROSKA,
+	HTTP_CONTENT_TYPE_VIDEO_MP4,
+	HTTP_CONTENT_TYPE_VIDEO_WEBM,
+	HTTP_CONTENT_TYPE_AUDIO_FLAC,
+	HTTP_CONTENT_TYPE_IMAGE_WEBP,
+	HTTP_CONTENT_TYPE_IMAGE_AVIF,
+	// Note: Content types loaded from a mime.types file get the values from here on.
+	HTTP_NUM_CONTENT_TYPES
 }HTTP_ContentType;
 
+// Note: Longer extensions are never looked up, the whole path gets passed in for files without one.
+#define HTTP_MAX_FILE_EXTENSION_LENGTH 32
+
+typedef struct{
+	const char* name;
+	bool compressible;
+}HTTP_MimeType;
+
+typedef struct{
+	const char* extension;
+	uint_fast8_t extensionLength;
+	HTTP_ContentType contentType;
+}HTTP_MimeTypeExtension;
+
+// Note: Maps file extensions to content types through a perfect hash table (hash and displace), built once at startup. Every extension hashes into a bucket, every bucket has a seed that moves all of its extensions into free slots, so a lookup costs two hashes and one compare.
+typedef struct{
+	// Note: Content types loaded in addition to the built-in ones, indexed by 'HTTP_ContentType - HTTP_NUM_CONTENT_TYPES'.
+	HTTP_MimeType* mimeTypes;
+	uint_fast32_t numMimeTypes;
+	HTTP_MimeTypeExtension* slots;
+	uint_fast32_t slotMask;
+	uint16_t* seeds;
+	uint_fast32_t numBuckets;
+	// Note: The loaded file, names and extensions point into it.
+	char* buffer;
+}HTTP_MimeTypeRegistry;
+
+typedef enum{
+	HTTP_CONTENT_ENCODING_IDENTITY = 0,
+	HTTP_CONTENT_ENCODING_GZIP,
+	HTTP_NUM_CONTENT_ENCODINGS
+}HTTP_ContentEncoding;
+
 typedef struct{
 	char* name;
 	char* value;
@@ -123,8 +176,46 @@ typedef struct{
 	uint_fast64_t valueLength;
 }HTTP_HeaderField;
 
+// Note: Header fields the server looks at. They get recognised once while a request is parsed, afterwards they are found by index instead of by name.
+typedef enum{
+	HTTP_HEADER_FIELD_HOST = 0,
+	HTTP_HEADER_FIELD_CONNECTION,
+	HTTP_HEADER_FIELD_CONTENT_LENGTH,
+	HTTP_HEADER_FIELD_TRANSFER_ENCODING,
+	HTTP_HEADER_FIELD_RANGE,
+	HTTP_HEADER_FIELD_IF_RANGE,
+	HTTP_HEADER_FIELD_IF_NONE_MATCH,
+	HTTP_HEADER_FIELD_IF_MODIFIED_SINCE,
+	HTTP_HEADER_FIELD_ACCEPT_ENCODING,
+	HTTP_NUM_KNOWN_HEADER_FIELDS,
+	HTTP_HEADER_FIELD_UNKNOWN = HTTP_NUM_KNOWN_HEADER_FIELDS
+}HTTP_KnownHeaderField;
+
+#define HTTP_MAX_BYTE_RANGES 8
+
+// Length of an IMF-fixdate like 'Sun, 06 Nov 1994 08:49:37 GMT'.
+#define HTTP_DATE_LENGTH 29
+// '"' + 16 hex digits + '-' + 16 hex digits + '"'.
+#define HTTP_ENTITY_TAG_LENGTH 35
+
+// Note: Both offsets are inclusive, like in the 'Range' header.
+typedef struct{
+	uint_fast64_t first;
+	uint_fast64_t last;
+}HTTP_ByteRange;
+
+#define HTTP_MAX_PATH_PARAMETERS 8
+
+// Note: Set by the router for ':name' segments of the matching context. 'name' is owned by the router and 'value' points into the request URL, neither is '\0' terminated.
+typedef struct{
+	const char* name;
+	const char* value;
+	uint_fast16_t nameLength;
+	uint_fast16_t valueLength;
+}HTTP_PathParameter;
+
+// Note: The request owns none of its strings. URL, get parameters and header fields are views into the buffer the request got parsed from, which has to outlive the request.
 typedef struct{
-	LinkedList httpHeaderFields;
 	Version httpVersion;
 	HTTP_RequestType httpRequestType;
 	uint_fast16_t requestURLLength;
@@ -134,12 +225,40 @@ typedef struct{
 	char* requestURL;
 	char* getRequestParameter;
 	int8_t* dataSegment;
+	uint_fast8_t numHeaderFields;
+	uint_fast8_t numPathParameters;
+	// Note: Indexed by HTTP_KnownHeaderField, holds the index + 1 of the first header field with that name, 0 if the request has none.
+	uint8_t knownHeaderFields[HTTP_NUM_KNOWN_HEADER_FIELDS];
+	// Note: Only the members above get reset for a new request, the arrays below stay as they are.
+	HTTP_HeaderField httpHeaderFields[CONSTANTS_HTTP_MAX_HEADER_FIELDS];
+	HTTP_PathParameter pathParameters[HTTP_MAX_PATH_PARAMETERS];
 }HTTP_Request;
 
+// Note: Frames HTTP/1.1 requests arriving in pieces. The end of the header block is searched for only in bytes that were not scanned before, the body gets framed by 'Content-Length' or the chunked transfer coding.
+typedef enum{
+	HTTP_PARSER_STATE_HEADER = 0,
+	HTTP_PARSER_STATE_BODY,
+	HTTP_PARSER_STATE_CHUNK_SIZE,
+	HTTP_PARSER_STATE_CHUNK_DATA,
+	// Note: The '\r\n' that terminates the data of a chunk.
+	HTTP_PARSER_STATE_CHUNK_DATA_END,
+	HTTP_PARSER_STATE_TRAILER
+}HTTP_ParserState;
+
+typedef struct{
+	HTTP_ParserState state;
+	// Note: Bytes of the header block that were already scanned for its end.
+	uint_fast64_t scanOffset;
+	// Note: Bytes of the body or the current chunk that are still to come.
+	uint_fast64_t remaining;
+}HTTP_Parser;
+
 #include "cache.h"
 
 typedef struct{
 	LinkedList httpHeaderFields;
+	// Note: Header fields and their values are allocated from the arena if set, they are gone once it gets reset.
+	Arena* arena;
 	Version httpVersion;
 	// Note: (jan - 2022.10.12)
 	bool staticContent;
@@ -150,6 +269,20 @@ typedef struct{
 	uint_fast64_t responseBufferSize;
 	int8_t* dataSegment;
 	CacheObject* cacheObject;
+	// Note: Lease on 'cacheObject', or on the object it is a variant of. The server releases it once it is done with the response, 'http_freeHTTP_Response' leaves it alone.
+	CacheObject* leasedCacheObject;
+	// Note: Pre-serialized status line, used instead of the one formatted from 'httpVersion' and 'httpStatusCode' if set.
+	const char* statusLine;
+	uint_fast64_t statusLineLength;
+	// Note: Header fields serialized ahead of time, usually part of the cache objects header block. They go out after 'httpHeaderFields' and are not owned by the response.
+	const char* headerBlock;
+	uint_fast64_t headerBlockLength;
+	// Note: (-1) unless the body is streamed straight from disk instead of the cache, 'fileSize' is the size of the whole file.
+	int fileDescriptor;
+	uint_fast64_t fileSize;
+	// Note: Only set for '206 Partial Content', more than one range goes out as 'multipart/byteranges'.
+	HTTP_ByteRange byteRanges[HTTP_MAX_BYTE_RANGES];
+	uint_fast8_t numByteRanges;
 }HTTP_Response;
 
 ERROR_CODE http_receiveRequest(HTTP_Request*, char[]);
@@ -160,6 +293,10 @@ HTTP_RequestType http_parseRequestType(const char* const, const uint_fast64_t);
 
 HTTP_ContentType http_getContentType(const char*, const uint64_t);
 
+ERROR_CODE http_initMimeTypeRegistry(const char*);
+
+void http_freeMimeTypeRegistry(void);
+
 const char* http_getStatusMsg(HTTP_StatusCode);
 
 const char* http_requestTypeToString(HTTP_RequestType);
@@ -170,27 +307,69 @@ void http_initheaderField(HTTP_HeaderField*, char*, const uint_fast64_t, char*,
  
 ERROR_CODE http_addHeaderField(HTTP_Request*, char*, const uint_fast64_t, char*, const uint_fast64_t);
 
+ERROR_CODE http_addResponseHeaderField(HTTP_Response*, char*, const uint_fast64_t, char*, const uint_fast64_t);
+
 HTTP_HeaderField* http_getHeaderField(HTTP_Request*, char*);
 
+HTTP_HeaderField* http_getKnownHeaderField(HTTP_Request*, const HTTP_KnownHeaderField);
+
+HTTP_KnownHeaderField http_internHeaderFieldName(const char*, const uint_fast64_t);
+
+HTTP_PathParameter* http_getPathParameter(HTTP_Request*, const char*);
+
 void http_setHTTP_Version(HTTP_Request*, const Version);
 
 const char* http_contentTypeToString(const HTTP_ContentType);
 
-ERROR_CODE http_initRequest(HTTP_Request*, const char*, const uint_fast64_t, void*, uint_fast64_t, const Version, const HTTP_RequestType);
+bool http_isCompressibleContentType(const HTTP_ContentType);
+
+const char* http_contentEncodingToString(const HTTP_ContentEncoding);
+
+HTTP_ContentEncoding http_negotiateContentEncoding(const char*, const uint_fast64_t);
+
+ERROR_CODE http_initRequest(HTTP_Request*, char*, const uint_fast64_t, void*, uint_fast64_t, const Version, const HTTP_RequestType);
 
 void http_initRequest_(HTTP_Request*, void*, uint_fast64_t, const HTTP_RequestType);
 
 void http_freeHTTP_Request(HTTP_Request*);
 
+void http_freeHTTP_Response(HTTP_Response*);
+
 ERROR_CODE http_parseHTTP_Request(HTTP_Request*, char*, const uint_fast64_t);
 
+void http_splitRequestURL(HTTP_Request*);
+
+int_fast64_t http_findEndOfHeader(const char*, const uint_fast64_t);
+
+void http_initParser(HTTP_Parser*);
+
+ERROR_CODE http_parseHeaderBlock(HTTP_Parser*, const char*, const uint_fast64_t, uint_fast64_t*);
+
+ERROR_CODE http_initBody(HTTP_Parser*, HTTP_Request*);
+
+ERROR_CODE http_parseBody(HTTP_Parser*, const char*, const uint_fast64_t, uint_fast64_t*);
+
 Version http_parseHTTP_Version(const char*, const uint_fast64_t);
 
 const char* http_getVersionString(const Version);
 
 HTTP_StatusCode http_translateErrorCode(const ERROR_CODE);
 
-void http_initHttpResponse(HTTP_Response*, void*, const uint_fast64_t);
+void http_initHttpResponse(HTTP_Response*, void*, const uint_fast64_t, Arena*);
+
+ERROR_CODE http_parseRange(const char*, const uint_fast64_t, const uint_fast64_t, HTTP_ByteRange*, uint_fast8_t*);
+
+void http_formatDate(char*, const time_t);
+
+const char* http_getCurrentDate(void);
+
+ERROR_CODE http_parseDate(const char*, time_t*);
+
+void http_formatEntityTag(char*, const uint64_t, const uint_fast64_t);
+
+bool http_entityTagListContains(const char*, const uint_fast64_t, const char*);
+
+bool http_tokenListContains(const char*, const uint_fast64_t, const char*);
 
 #endif
 
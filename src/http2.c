@@ -0,0 +1,1502 @@
+#ifndef HTTP2_C
+#define HTTP2_C
+
+#include "http2.h"
+
+#include "http.h"
+#include "util.h"
+
+local ERROR_CODE http2_handleFrame(Http2Session*, const uint8_t*, const uint_fast64_t, const Http2FrameType, const uint8_t, const uint32_t);
+
+local ERROR_CODE http2_handleData(Http2Session*, const uint_fast64_t, const uint8_t, const uint32_t);
+
+local ERROR_CODE http2_handleHeaders(Http2Session*, const uint8_t*, const uint_fast64_t, const uint8_t, const uint32_t);
+
+local ERROR_CODE http2_handleContinuation(Http2Session*, const uint8_t*, const uint_fast64_t, const uint8_t, const uint32_t);
+
+local ERROR_CODE http2_handleHeaderBlock(Http2Session*, const uint8_t*, const uint_fast64_t);
+
+local ERROR_CODE http2_handleSettings(Http2Session*, const uint8_t*, const uint_fast64_t, const uint8_t, const uint32_t);
+
+local ERROR_CODE http2_handleWindowUpdate(Http2Session*, const uint8_t*, const uint_fast64_t, const uint32_t);
+
+local ERROR_CODE http2_connectionError(Http2Session*, const Http2ErrorCode, const char*);
+
+local bool http2_queueControlFrame(Http2Session*, const Http2FrameType, const uint8_t, const uint32_t, const uint8_t*, const uint_fast64_t);
+
+local void http2_queueWindowUpdate(Http2Session*, const uint32_t, const uint32_t);
+
+local Http2Stream* http2_getStream(Http2Session*, const uint32_t);
+
+local Http2Stream* http2_openStream(Http2Session*, const uint32_t);
+
+local uint32_t http2_readUint32(const uint8_t*);
+
+local void http2_writeUint32(uint8_t*, const uint32_t);
+
+local ERROR_CODE hpack_decodeString(const uint8_t*, const uint_fast64_t, uint_fast64_t*, char*, const uint_fast64_t, uint_fast64_t*, char**, uint_fast64_t*);
+
+local char* hpack_storeString(char*, const uint_fast64_t, uint_fast64_t*, const char*, const uint_fast64_t);
+
+local ERROR_CODE hpack_getIndexedField(HPACK_DynamicTable*, const uint_fast64_t, const char**, uint_fast64_t*, const char**, uint_fast64_t*);
+
+local ERROR_CODE hpack_addDynamicTableEntry(HPACK_DynamicTable*, const char*, const uint_fast64_t, const char*, const uint_fast64_t);
+
+local void hpack_evictDynamicTableEntries(HPACK_DynamicTable*, const uint_fast64_t);
+
+local ERROR_CODE hpack_addRequestHeaderField(HTTP_Request*, char*, const uint_fast64_t, char*, const uint_fast64_t, bool*);
+
+local uint_fast64_t hpack_encodeLiteralHeaderField(uint8_t*, const uint_fast64_t, const uint_fast64_t, const char*, const uint_fast64_t, const char*, const uint_fast64_t);
+
+local uint_fast64_t hpack_findStaticTableName(const char*, const uint_fast64_t);
+
+local ERROR_CODE hpack_encodeResponseHeaderField(uint8_t*, const uint_fast64_t, uint_fast64_t*, const char*, const uint_fast64_t, const char*, const uint_fast64_t);
+
+// Note: The Huffman code of RFC 7541 Appendix B is canonical, so the number of codes per length and the symbols ordered by code length are enough to decode it.
+local const uint8_t HPACK_HUFFMAN_CODE_LENGTH_COUNTS[HPACK_HUFFMAN_MAX_CODE_LENGTH + 1] = {0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3, 0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29, 0, 4};
+
+local const uint16_t HPACK_HUFFMAN_SYMBOLS[HPACK_HUFFMAN_NUM_SYMBOLS] = {
+	48, 49, 50, 97, 99, 101, 105, 111, 115, 116, 32, 37, 45, 46, 47, 51,
+	52, 53, 54, 55, 56, 57, 61, 65, 95, 98, 100, 102, 103, 104, 108, 109,
+	110, 112, 114, 117, 58, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76,
+	77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 89, 106, 107, 113, 118,
+	119, 120, 121, 122, 38, 42, 44, 59, 88, 90, 33, 34, 40, 41, 63, 39,
+	43, 124, 35, 62, 0, 36, 64, 91, 93, 126, 94, 125, 60, 96, 123, 92,
+	195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+	179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+	163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+	233, 1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+	158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239, 9, 142,
+	144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+	200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+	212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+	2, 3, 4, 5, 6, 7, 8, 11, 12, 14, 15, 16, 17, 18, 19, 20,
+	21, 23, 24, 25, 26, 27, 28, 29, 30, 31, 127, 220, 249, 10, 13, 22,
+	256
+};
+
+local const char* HPACK_STATIC_TABLE[HPACK_STATIC_TABLE_LENGTH][2] = {
+	{":authority", ""},
+	{":method", "GET"},
+	{":method", "POST"},
+	{":path", "/"},
+	{":path", "/index.html"},
+	{":scheme", "http"},
+	{":scheme", "https"},
+	{":status", "200"},
+	{":status", "204"},
+	{":status", "206"},
+	{":status", "304"},
+	{":status", "400"},
+	{":status", "404"},
+	{":status", "500"},
+	{"accept-charset", ""},
+	{"accept-encoding", "gzip, deflate"},
+	{"accept-language", ""},
+	{"accept-ranges", ""},
+	{"accept", ""},
+	{"access-control-allow-origin", ""},
+	{"age", ""},
+	{"allow", ""},
+	{"authorization", ""},
+	{"cache-control", ""},
+	{"content-disposition", ""},
+	{"content-encoding", ""},
+	{"content-language", ""},
+	{"content-length", ""},
+	{"content-location", ""},
+	{"content-range", ""},
+	{"content-type", ""},
+	{"cookie", ""},
+	{"date", ""},
+	{"etag", ""},
+	{"expect", ""},
+	{"expires", ""},
+	{"from", ""},
+	{"host", ""},
+	{"if-match", ""},
+	{"if-modified-since", ""},
+	{"if-none-match", ""},
+	{"if-range", ""},
+	{"if-unmodified-since", ""},
+	{"last-modified", ""},
+	{"link", ""},
+	{"location", ""},
+	{"max-forwards", ""},
+	{"proxy-authenticate", ""},
+	{"proxy-authorization", ""},
+	{"range", ""},
+	{"referer", ""},
+	{"refresh", ""},
+	{"retry-after", ""},
+	{"server", ""},
+	{"set-cookie", ""},
+	{"strict-transport-security", ""},
+	{"transfer-encoding", ""},
+	{"user-agent", ""},
+	{"vary", ""},
+	{"via", ""},
+	{"www-authenticate", ""}
+};
+
+ERROR_CODE http2_initSession(Http2Session* session){
+	memset(session, 0, sizeof(*session));
+
+	hpack_initDynamicTable(&session->headerTable, HPACK_DEFAULT_HEADER_TABLE_SIZE);
+
+	session->sendWindow = HTTP2_DEFAULT_WINDOW_SIZE;
+	session->peerMaxFrameSize = HTTP2_DEFAULT_MAX_FRAME_SIZE;
+	session->peerInitialWindowSize = HTTP2_DEFAULT_WINDOW_SIZE;
+
+	// Note: The server preface is a SETTINGS frame, it can go out before the clients preface arrived.
+	uint8_t settings[18];
+
+	settings[0] = 0;
+	settings[1] = HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS;
+	http2_writeUint32(settings + 2, HTTP2_MAX_CONCURRENT_STREAMS);
+
+	settings[6] = 0;
+	settings[7] = HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE;
+	http2_writeUint32(settings + 8, HTTP2_MAX_HEADER_LIST_SIZE);
+
+	// Note: Server push is not supported.
+	settings[12] = 0;
+	settings[13] = HTTP2_SETTINGS_ENABLE_PUSH;
+	http2_writeUint32(settings + 14, 0);
+
+	http2_queueControlFrame(session, HTTP2_FRAME_TYPE_SETTINGS, 0, 0, settings, sizeof(settings));
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Streams still holding a response buffer have to be released by the server first.
+void http2_freeSession(Http2Session* session){
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		http2_closeStream(&session->streams[i]);
+
+		free(session->streams[i].headerStorage);
+	}
+
+	hpack_freeDynamicTable(&session->headerTable);
+
+	free(session->headerBlock);
+	free(session->headerStorage);
+}
+
+// Note: Processes complete frames only, 'consumed' holds how much of 'input' got processed. 'capacity' is the size of the buffer 'input' lives in, DATA payloads get skipped as they arrive, every other frame has to fit into it. Connection errors queue a GOAWAY and return 'ERROR_HTTP2_PROTOCOL_ERROR', all input after it is discarded.
+ERROR_CODE http2_processInput(Http2Session* session, const int8_t* input, const uint_fast64_t length, const uint_fast64_t capacity, uint_fast64_t* consumed){
+	ERROR_CODE error;
+
+	const uint8_t* data = (const uint8_t*) input;
+
+	*consumed = 0;
+
+	if(session->goAwaySent){
+		*consumed = length;
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(!session->prefaceReceived){
+		if(memcmp(data, HTTP2_CONNECTION_PREFACE, MIN(length, HTTP2_CONNECTION_PREFACE_LENGTH)) != 0){
+			*consumed = length;
+
+			return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "Invalid connection preface.");
+		}
+
+		if(length < HTTP2_CONNECTION_PREFACE_LENGTH){
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		session->prefaceReceived = true;
+
+		*consumed = HTTP2_CONNECTION_PREFACE_LENGTH;
+	}
+
+	for(;;){
+		if(session->discardLength > 0){
+			const uint_fast64_t discardLength = MIN(session->discardLength, length - *consumed);
+
+			*consumed += discardLength;
+			session->discardLength -= discardLength;
+
+			if(session->discardLength > 0){
+				break;
+			}
+		}
+
+		if(length - *consumed < HTTP2_FRAME_HEADER_LENGTH){
+			break;
+		}
+
+		// Wait for the queued control frames to go out first.
+		if(HTTP2_CONTROL_BUFFER_SIZE - session->controlFramesLength < HTTP2_CONTROL_BUFFER_RESERVE){
+			break;
+		}
+
+		const uint8_t* frame = data + *consumed;
+
+		const uint_fast64_t payloadLength = (frame[0] << 16) | (frame[1] << 8) | frame[2];
+		const Http2FrameType type = frame[3];
+		const uint8_t flags = frame[4];
+		const uint32_t streamID = http2_readUint32(frame + 5) & 0x7FFFFFFF;
+
+		if(payloadLength > HTTP2_DEFAULT_MAX_FRAME_SIZE){
+			*consumed = length;
+
+			return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "Frame exceeds SETTINGS_MAX_FRAME_SIZE.");
+		}
+
+		// Note: A header block has to be continued by CONTINUATION frames of the same stream, without anything in between.
+		if(session->headerBlockStreamID != 0 && (type != HTTP2_FRAME_TYPE_CONTINUATION || streamID != session->headerBlockStreamID)){
+			*consumed = length;
+
+			return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "Header block got interrupted.");
+		}
+
+		// Note: Request bodies are not processed, so DATA frames are handled with their frame header alone and the payload gets skipped.
+		if(type == HTTP2_FRAME_TYPE_DATA){
+			*consumed += HTTP2_FRAME_HEADER_LENGTH;
+
+			session->discardLength = payloadLength;
+
+			if((error = http2_handleData(session, payloadLength, flags, streamID)) != ERROR_NO_ERROR){
+				*consumed = length;
+
+				return ERROR(error);
+			}
+
+			continue;
+		}
+
+		if(HTTP2_FRAME_HEADER_LENGTH + payloadLength > capacity){
+			*consumed = length;
+
+			return http2_connectionError(session, HTTP2_ERROR_CODE_ENHANCE_YOUR_CALM, "Frame exceeds the read buffer.");
+		}
+
+		if(length - *consumed < HTTP2_FRAME_HEADER_LENGTH + payloadLength){
+			break;
+		}
+
+		*consumed += HTTP2_FRAME_HEADER_LENGTH + payloadLength;
+
+		if((error = http2_handleFrame(session, frame + HTTP2_FRAME_HEADER_LENGTH, payloadLength, type, flags, streamID)) != ERROR_NO_ERROR){
+			*consumed = length;
+
+			return ERROR(error);
+		}
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local ERROR_CODE http2_handleFrame(Http2Session* session, const uint8_t* payload, const uint_fast64_t payloadLength, const Http2FrameType type, const uint8_t flags, const uint32_t streamID){
+	switch(type){
+		case HTTP2_FRAME_TYPE_HEADERS:{
+			return http2_handleHeaders(session, payload, payloadLength, flags, streamID);
+		}
+
+		case HTTP2_FRAME_TYPE_CONTINUATION:{
+			return http2_handleContinuation(session, payload, payloadLength, flags, streamID);
+		}
+
+		case HTTP2_FRAME_TYPE_PRIORITY:{
+			// Note: Prioritisation is deprecated, every stream gets the same share.
+			if(streamID == 0){
+				return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "PRIORITY on stream 0.");
+			}
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		case HTTP2_FRAME_TYPE_RST_STREAM:{
+			if(streamID == 0 || streamID > session->lastStreamID){
+				return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "RST_STREAM on an idle stream.");
+			}
+
+			if(payloadLength != 4){
+				return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "Invalid RST_STREAM length.");
+			}
+
+			Http2Stream* stream = http2_getStream(session, streamID);
+			if(stream != NULL){
+				stream->state = HTTP2_STREAM_STATE_CLOSED;
+			}
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		case HTTP2_FRAME_TYPE_SETTINGS:{
+			return http2_handleSettings(session, payload, payloadLength, flags, streamID);
+		}
+
+		case HTTP2_FRAME_TYPE_PUSH_PROMISE:{
+			return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "Clients can't push.");
+		}
+
+		case HTTP2_FRAME_TYPE_PING:{
+			if(streamID != 0){
+				return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "PING on a stream.");
+			}
+
+			if(payloadLength != 8){
+				return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "Invalid PING length.");
+			}
+
+			if(!(flags & HTTP2_FLAG_ACK)){
+				http2_queueControlFrame(session, HTTP2_FRAME_TYPE_PING, HTTP2_FLAG_ACK, 0, payload, payloadLength);
+			}
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		case HTTP2_FRAME_TYPE_GOAWAY:{
+			if(streamID != 0){
+				return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "GOAWAY on a stream.");
+			}
+
+			// Note: The streams that are already open get finished, the server closes the connection once they are done.
+			session->goAwayReceived = true;
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		case HTTP2_FRAME_TYPE_WINDOW_UPDATE:{
+			return http2_handleWindowUpdate(session, payload, payloadLength, streamID);
+		}
+
+		default:{
+			// Note: Unknown frame types have to be ignored.
+			return ERROR(ERROR_NO_ERROR);
+		}
+	}
+}
+
+local ERROR_CODE http2_handleData(Http2Session* session, const uint_fast64_t payloadLength, const uint8_t flags, const uint32_t streamID){
+	if(streamID == 0 || streamID > session->lastStreamID){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "DATA on an idle stream.");
+	}
+
+	// Note: Flow control covers every DATA frame, including those of streams that are already gone.
+	session->receivedDataLength += payloadLength;
+
+	if(session->receivedDataLength >= HTTP2_DEFAULT_WINDOW_SIZE / 2){
+		http2_queueWindowUpdate(session, 0, session->receivedDataLength);
+
+		session->receivedDataLength = 0;
+	}
+
+	Http2Stream* stream = http2_getStream(session, streamID);
+	if(stream == NULL || stream->state == HTTP2_STREAM_STATE_CLOSED){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(stream->state != HTTP2_STREAM_STATE_OPEN){
+		http2_resetStream(session, stream, HTTP2_ERROR_CODE_STREAM_CLOSED);
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(flags & HTTP2_FLAG_END_STREAM){
+		stream->state = HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE;
+	}else if(payloadLength > 0){
+		http2_queueWindowUpdate(session, streamID, payloadLength);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local ERROR_CODE http2_handleHeaders(Http2Session* session, const uint8_t* payload, const uint_fast64_t payloadLength, const uint8_t flags, const uint32_t streamID){
+	if(streamID == 0 || (streamID & 1) == 0){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "HEADERS on an invalid stream.");
+	}
+
+	uint_fast64_t offset = 0;
+	uint_fast64_t paddingLength = 0;
+
+	if(flags & HTTP2_FLAG_PADDED){
+		if(payloadLength < 1){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "HEADERS too short.");
+		}
+
+		paddingLength = payload[0];
+		offset = 1;
+	}
+
+	// Note: Stream dependency and weight get ignored.
+	if(flags & HTTP2_FLAG_PRIORITY){
+		offset += 5;
+	}
+
+	if(offset + paddingLength > payloadLength){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "HEADERS padding exceeds payload.");
+	}
+
+	session->headerBlockStreamID = streamID;
+	session->headerBlockEndStream = flags & HTTP2_FLAG_END_STREAM;
+	session->headerBlockLength = 0;
+
+	const uint8_t* fragment = payload + offset;
+	const uint_fast64_t fragmentLength = payloadLength - offset - paddingLength;
+
+	// Note: Most header blocks come in a single frame and get decoded in place.
+	if(flags & HTTP2_FLAG_END_HEADERS){
+		return http2_handleHeaderBlock(session, fragment, fragmentLength);
+	}
+
+	return http2_handleContinuation(session, fragment, fragmentLength, 0, streamID);
+}
+
+local ERROR_CODE http2_handleContinuation(Http2Session* session, const uint8_t* payload, const uint_fast64_t payloadLength, const uint8_t flags, const uint32_t streamID){
+	if(session->headerBlockStreamID == 0){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "CONTINUATION without HEADERS.");
+	}
+
+	if(session->headerBlockLength + payloadLength > HTTP2_MAX_HEADER_BLOCK_SIZE){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_ENHANCE_YOUR_CALM, "Header block too large.");
+	}
+
+	if(session->headerBlock == NULL && (session->headerBlock = malloc(HTTP2_MAX_HEADER_BLOCK_SIZE)) == NULL){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_INTERNAL_ERROR, "Out of memory.");
+	}
+
+	memcpy(session->headerBlock + session->headerBlockLength, payload, payloadLength);
+	session->headerBlockLength += payloadLength;
+
+	if(flags & HTTP2_FLAG_END_HEADERS){
+		return http2_handleHeaderBlock(session, (uint8_t*) session->headerBlock, session->headerBlockLength);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Every header block has to be decoded, even if its stream gets refused, or the header table gets out of sync with the client.
+local ERROR_CODE http2_handleHeaderBlock(Http2Session* session, const uint8_t* block, const uint_fast64_t blockLength){
+	ERROR_CODE error;
+
+	const uint32_t streamID = session->headerBlockStreamID;
+	const bool endStream = session->headerBlockEndStream;
+
+	session->headerBlockStreamID = 0;
+	session->headerBlockLength = 0;
+
+	Http2Stream* stream = http2_getStream(session, streamID);
+
+	// Trailers, or a new stream that can't be served.
+	if(stream != NULL || streamID <= session->lastStreamID || (stream = http2_openStream(session, streamID)) == NULL){
+		if(session->headerStorage == NULL && (session->headerStorage = malloc(HTTP2_MAX_HEADER_LIST_SIZE)) == NULL){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_INTERNAL_ERROR, "Out of memory.");
+		}
+
+		HTTP_Request request;
+		http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_MAX_HEADER_FIELDS_REACHED);
+		error = hpack_decodeHeaderBlock(&session->headerTable, block, blockLength, &request, session->headerStorage, HTTP2_MAX_HEADER_LIST_SIZE);
+		__UTIL_ENABLE_ERROR_LOGGING__();
+
+		http_freeHTTP_Request(&request);
+
+		if(error == ERROR_HPACK_DECOMPRESSION_FAILED || error == ERROR_MAX_MESSAGE_SIZE_EXCEEDED || error == ERROR_OUT_OF_MEMORY){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_COMPRESSION_ERROR, "Failed to decode header block.");
+		}
+
+		if(stream != NULL){
+			if(stream->state != HTTP2_STREAM_STATE_OPEN || !endStream){
+				http2_resetStream(session, stream, HTTP2_ERROR_CODE_PROTOCOL_ERROR);
+			}else{
+				stream->state = HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE;
+			}
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		if(streamID <= session->lastStreamID){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_STREAM_CLOSED, "HEADERS on a closed stream.");
+		}
+
+		session->lastStreamID = streamID;
+
+		uint8_t errorCode[4];
+		http2_writeUint32(errorCode, HTTP2_ERROR_CODE_REFUSED_STREAM);
+
+		http2_queueControlFrame(session, HTTP2_FRAME_TYPE_RST_STREAM, 0, streamID, errorCode, sizeof(errorCode));
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	session->lastStreamID = streamID;
+
+	stream->state = endStream ? HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE : HTTP2_STREAM_STATE_OPEN;
+
+	if(stream->headerStorage == NULL && (stream->headerStorage = malloc(HTTP2_MAX_HEADER_LIST_SIZE)) == NULL){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_INTERNAL_ERROR, "Out of memory.");
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_MAX_HEADER_FIELDS_REACHED);
+	error = hpack_decodeHeaderBlock(&session->headerTable, block, blockLength, &stream->request, stream->headerStorage, HTTP2_MAX_HEADER_LIST_SIZE);
+	__UTIL_ENABLE_ERROR_LOGGING__();
+
+	// Note: A header block that does not fit into the header storage exceeds the advertised SETTINGS_MAX_HEADER_LIST_SIZE, the header table can't be kept in sync after it.
+	if(error == ERROR_HPACK_DECOMPRESSION_FAILED || error == ERROR_MAX_MESSAGE_SIZE_EXCEEDED || error == ERROR_OUT_OF_MEMORY){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_COMPRESSION_ERROR, "Failed to decode header block.");
+	}
+
+	// Note: Requests need at least ':method' and ':path', CONNECT is not supported.
+	if(error != ERROR_NO_ERROR || stream->request.requestURL == NULL || stream->request.httpRequestType == HTTP_REQUEST_TYPE_UNKNOWN){
+		http2_resetStream(session, stream, HTTP2_ERROR_CODE_PROTOCOL_ERROR);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local ERROR_CODE http2_handleSettings(Http2Session* session, const uint8_t* payload, const uint_fast64_t payloadLength, const uint8_t flags, const uint32_t streamID){
+	if(streamID != 0){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "SETTINGS on a stream.");
+	}
+
+	if(flags & HTTP2_FLAG_ACK){
+		if(payloadLength != 0){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "SETTINGS acknowledgement with payload.");
+		}
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(payloadLength % 6 != 0){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "Invalid SETTINGS length.");
+	}
+
+	uint_fast64_t offset;
+	for(offset = 0; offset < payloadLength; offset += 6){
+		const uint_fast16_t setting = (payload[offset] << 8) | payload[offset + 1];
+		const uint32_t value = http2_readUint32(payload + offset + 2);
+
+		switch(setting){
+			case HTTP2_SETTINGS_ENABLE_PUSH:{
+				if(value > 1){
+					return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "Invalid SETTINGS_ENABLE_PUSH.");
+				}
+
+				break;
+			}
+
+			case HTTP2_SETTINGS_INITIAL_WINDOW_SIZE:{
+				if(value > HTTP2_MAX_WINDOW_SIZE){
+					return http2_connectionError(session, HTTP2_ERROR_CODE_FLOW_CONTROL_ERROR, "Invalid SETTINGS_INITIAL_WINDOW_SIZE.");
+				}
+
+				// Note: Applies to the windows of all open streams, relative to what they already used.
+				const int_fast64_t delta = (int_fast64_t) value - session->peerInitialWindowSize;
+
+				uint_fast8_t i;
+				for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+					Http2Stream* stream = &session->streams[i];
+
+					if(stream->state == HTTP2_STREAM_STATE_IDLE){
+						continue;
+					}
+
+					stream->sendWindow += delta;
+
+					if(stream->sendWindow > HTTP2_MAX_WINDOW_SIZE){
+						return http2_connectionError(session, HTTP2_ERROR_CODE_FLOW_CONTROL_ERROR, "Stream window overflow.");
+					}
+				}
+
+				session->peerInitialWindowSize = value;
+
+				break;
+			}
+
+			case HTTP2_SETTINGS_MAX_FRAME_SIZE:{
+				if(value < HTTP2_DEFAULT_MAX_FRAME_SIZE || value > HTTP2_MAX_MAX_FRAME_SIZE){
+					return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "Invalid SETTINGS_MAX_FRAME_SIZE.");
+				}
+
+				session->peerMaxFrameSize = value;
+
+				break;
+			}
+
+			// Note: Response headers never get indexed, so the size of the clients header table does not matter.
+			default:{
+				break;
+			}
+		}
+	}
+
+	http2_queueControlFrame(session, HTTP2_FRAME_TYPE_SETTINGS, HTTP2_FLAG_ACK, 0, NULL, 0);
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local ERROR_CODE http2_handleWindowUpdate(Http2Session* session, const uint8_t* payload, const uint_fast64_t payloadLength, const uint32_t streamID){
+	if(payloadLength != 4){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_FRAME_SIZE_ERROR, "Invalid WINDOW_UPDATE length.");
+	}
+
+	const uint32_t increment = http2_readUint32(payload) & 0x7FFFFFFF;
+
+	if(streamID == 0){
+		if(increment == 0){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "WINDOW_UPDATE without increment.");
+		}
+
+		session->sendWindow += increment;
+
+		if(session->sendWindow > HTTP2_MAX_WINDOW_SIZE){
+			return http2_connectionError(session, HTTP2_ERROR_CODE_FLOW_CONTROL_ERROR, "Connection window overflow.");
+		}
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(streamID > session->lastStreamID){
+		return http2_connectionError(session, HTTP2_ERROR_CODE_PROTOCOL_ERROR, "WINDOW_UPDATE on an idle stream.");
+	}
+
+	Http2Stream* stream = http2_getStream(session, streamID);
+	if(stream == NULL || stream->state == HTTP2_STREAM_STATE_CLOSED){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	stream->sendWindow += increment;
+
+	if(increment == 0){
+		http2_resetStream(session, stream, HTTP2_ERROR_CODE_PROTOCOL_ERROR);
+	}else if(stream->sendWindow > HTTP2_MAX_WINDOW_SIZE){
+		http2_resetStream(session, stream, HTTP2_ERROR_CODE_FLOW_CONTROL_ERROR);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Writes the queued control frames, then the header blocks of finished responses and as many DATA frames as the flow control windows and the buffer allow. DATA frames of concurrent streams get interleaved round robin, one frame per stream and turn.
+ERROR_CODE http2_produceOutput(Http2Session* session, int8_t* buffer, const uint_fast64_t bufferSize, uint_fast64_t* length){
+	memcpy(buffer, session->controlFrames, session->controlFramesLength);
+
+	*length = session->controlFramesLength;
+	session->controlFramesLength = 0;
+
+	if(session->goAwaySent){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		Http2Stream* stream = &session->streams[i];
+
+		if(!stream->responseReady || stream->headersSent || stream->state == HTTP2_STREAM_STATE_CLOSED){
+			continue;
+		}
+
+		if(bufferSize - *length <= HTTP2_FRAME_HEADER_LENGTH){
+			break;
+		}
+
+		const uint_fast64_t space = MIN(bufferSize - *length - HTTP2_FRAME_HEADER_LENGTH, session->peerMaxFrameSize);
+
+		uint_fast64_t headerBlockLength;
+
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+		const ERROR_CODE error = hpack_encodeResponseHeader(&stream->response, (uint8_t*) buffer + *length + HTTP2_FRAME_HEADER_LENGTH, space, &headerBlockLength);
+		__UTIL_ENABLE_ERROR_LOGGING__();
+
+		if(error != ERROR_NO_ERROR){
+			// Note: Header blocks that don't even fit into an empty buffer are not split into CONTINUATION frames, the stream gets reset instead.
+			if(space == MIN(bufferSize - HTTP2_FRAME_HEADER_LENGTH, session->peerMaxFrameSize)){
+				http2_resetStream(session, stream, HTTP2_ERROR_CODE_INTERNAL_ERROR);
+
+				continue;
+			}
+
+			break;
+		}
+
+		const uint8_t flags = HTTP2_FLAG_END_HEADERS | (stream->bodyRemaining == 0 ? HTTP2_FLAG_END_STREAM : 0);
+
+		*length += http2_writeFrameHeader(buffer + *length, headerBlockLength, HTTP2_FRAME_TYPE_HEADERS, flags, stream->id) + headerBlockLength;
+
+		stream->headersSent = true;
+
+		if(stream->bodyRemaining == 0){
+			stream->state = HTTP2_STREAM_STATE_CLOSED;
+		}
+	}
+
+	bool progress = true;
+	while(progress && session->sendWindow > 0){
+		progress = false;
+
+		uint_fast8_t j;
+		for(j = 0; j < HTTP2_MAX_CONCURRENT_STREAMS && session->sendWindow > 0; j++){
+			i = (session->nextStream + j) % HTTP2_MAX_CONCURRENT_STREAMS;
+
+			Http2Stream* stream = &session->streams[i];
+
+			if(!stream->headersSent || stream->state == HTTP2_STREAM_STATE_CLOSED || stream->bodyRemaining == 0 || stream->sendWindow <= 0){
+				continue;
+			}
+
+			// Note: Don't cut the body into tiny frames just to fill the buffer up, the rest goes out with the next buffer.
+			if(bufferSize - *length < HTTP2_FRAME_HEADER_LENGTH + MIN(stream->bodyRemaining, KB(1))){
+				return ERROR(ERROR_NO_ERROR);
+			}
+
+			uint_fast64_t dataLength = MIN(stream->bodyRemaining, bufferSize - *length - HTTP2_FRAME_HEADER_LENGTH);
+			dataLength = MIN(dataLength, (uint_fast64_t) stream->sendWindow);
+			dataLength = MIN(dataLength, (uint_fast64_t) session->sendWindow);
+			dataLength = MIN(dataLength, session->peerMaxFrameSize);
+
+			int8_t* data = buffer + *length + HTTP2_FRAME_HEADER_LENGTH;
+
+			if(stream->body != NULL){
+				memcpy(data, stream->body + stream->bodyOffset, dataLength);
+			}else if(pread(stream->response.fileDescriptor, data, dataLength, stream->bodyOffset) != (ssize_t) dataLength){
+				http2_resetStream(session, stream, HTTP2_ERROR_CODE_INTERNAL_ERROR);
+
+				continue;
+			}
+
+			stream->bodyOffset += dataLength;
+			stream->bodyRemaining -= dataLength;
+			stream->sendWindow -= dataLength;
+			session->sendWindow -= dataLength;
+
+			const uint8_t flags = stream->bodyRemaining == 0 ? HTTP2_FLAG_END_STREAM : 0;
+
+			*length += http2_writeFrameHeader(buffer + *length, dataLength, HTTP2_FRAME_TYPE_DATA, flags, stream->id) + dataLength;
+
+			if(stream->bodyRemaining == 0){
+				stream->state = HTTP2_STREAM_STATE_CLOSED;
+			}
+
+			session->nextStream = (i + 1) % HTTP2_MAX_CONCURRENT_STREAMS;
+
+			progress = true;
+		}
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Picks what to send from the handled response, the same way 'server_prepareResponse' does for HTTP/1.1. Responses to HEAD requests have no body at all.
+void http2_prepareResponseBody(Http2Stream* stream){
+	HTTP_Response* response = &stream->response;
+
+	stream->body = NULL;
+	stream->bodyOffset = 0;
+	stream->bodyRemaining = 0;
+
+	if(stream->request.httpRequestType == HTTP_REQUEST_TYPE_HEAD){
+		// Headers only.
+	}else if(!response->staticContent){
+		stream->body = response->dataSegment;
+		stream->bodyRemaining = response->responseDataSegmentLength;
+	}else{
+		const uint_fast64_t contentSize = response->cacheObject != NULL ? response->cacheObject->size : response->fileSize;
+
+		stream->bodyOffset = response->numByteRanges == 1 ? response->byteRanges[0].first : 0;
+		stream->bodyRemaining = response->numByteRanges == 1 ? response->byteRanges[0].last - stream->bodyOffset + 1 : contentSize;
+
+		if(response->fileDescriptor == -1){
+			stream->body = (int8_t*) response->cacheObject->data;
+		}
+	}
+
+	stream->responseReady = true;
+}
+
+void http2_resetStream(Http2Session* session, Http2Stream* stream, const Http2ErrorCode errorCode){
+	uint8_t payload[4];
+	http2_writeUint32(payload, errorCode);
+
+	http2_queueControlFrame(session, HTTP2_FRAME_TYPE_RST_STREAM, 0, stream->id, payload, sizeof(payload));
+
+	stream->state = HTTP2_STREAM_STATE_CLOSED;
+}
+
+void http2_goAway(Http2Session* session, const Http2ErrorCode errorCode){
+	if(session->goAwaySent){
+		return;
+	}
+
+	uint8_t payload[8];
+	http2_writeUint32(payload, session->lastStreamID);
+	http2_writeUint32(payload + 4, errorCode);
+
+	http2_queueControlFrame(session, HTTP2_FRAME_TYPE_GOAWAY, 0, 0, payload, sizeof(payload));
+
+	session->goAwaySent = true;
+}
+
+// Note: Frees the request and response of the stream and makes its slot available again.
+void http2_closeStream(Http2Stream* stream){
+	if(stream->state == HTTP2_STREAM_STATE_IDLE){
+		return;
+	}
+
+	http_freeHTTP_Request(&stream->request);
+	http_freeHTTP_Response(&stream->response);
+
+	char* headerStorage = stream->headerStorage;
+
+	memset(stream, 0, sizeof(*stream));
+
+	stream->headerStorage = headerStorage;
+}
+
+bool http2_hasActiveStreams(Http2Session* session){
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		if(session->streams[i].state != HTTP2_STREAM_STATE_IDLE){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline uint_fast64_t http2_writeFrameHeader(int8_t* buffer, const uint_fast64_t length, const Http2FrameType type, const uint8_t flags, const uint32_t streamID){
+	uint8_t* frame = (uint8_t*) buffer;
+
+	frame[0] = length >> 16;
+	frame[1] = length >> 8;
+	frame[2] = length;
+	frame[3] = type;
+	frame[4] = flags;
+
+	http2_writeUint32(frame + 5, streamID & 0x7FFFFFFF);
+
+	return HTTP2_FRAME_HEADER_LENGTH;
+}
+
+local ERROR_CODE http2_connectionError(Http2Session* session, const Http2ErrorCode errorCode, const char* reason){
+	http2_goAway(session, errorCode);
+
+	return ERROR_(ERROR_HTTP2_PROTOCOL_ERROR, "%s", reason);
+}
+
+// Note: Input processing keeps 'HTTP2_CONTROL_BUFFER_RESERVE' bytes free, so this only fails if a single frame queued more than that.
+local bool http2_queueControlFrame(Http2Session* session, const Http2FrameType type, const uint8_t flags, const uint32_t streamID, const uint8_t* payload, const uint_fast64_t payloadLength){
+	if(session->controlFramesLength + HTTP2_FRAME_HEADER_LENGTH + payloadLength > HTTP2_CONTROL_BUFFER_SIZE){
+		return false;
+	}
+
+	int8_t* frame = session->controlFrames + session->controlFramesLength;
+
+	http2_writeFrameHeader(frame, payloadLength, type, flags, streamID);
+
+	if(payloadLength > 0){
+		memcpy(frame + HTTP2_FRAME_HEADER_LENGTH, payload, payloadLength);
+	}
+
+	session->controlFramesLength += HTTP2_FRAME_HEADER_LENGTH + payloadLength;
+
+	return true;
+}
+
+local void http2_queueWindowUpdate(Http2Session* session, const uint32_t streamID, const uint32_t increment){
+	uint8_t payload[4];
+	http2_writeUint32(payload, increment);
+
+	http2_queueControlFrame(session, HTTP2_FRAME_TYPE_WINDOW_UPDATE, 0, streamID, payload, sizeof(payload));
+}
+
+local Http2Stream* http2_getStream(Http2Session* session, const uint32_t streamID){
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		if(session->streams[i].state != HTTP2_STREAM_STATE_IDLE && session->streams[i].id == streamID){
+			return &session->streams[i];
+		}
+	}
+
+	return NULL;
+}
+
+// Note: Returns NULL if all stream slots are taken, or the client announced it is going away.
+local Http2Stream* http2_openStream(Http2Session* session, const uint32_t streamID){
+	if(session->goAwayReceived){
+		return NULL;
+	}
+
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		Http2Stream* stream = &session->streams[i];
+
+		if(stream->state != HTTP2_STREAM_STATE_IDLE){
+			continue;
+		}
+
+		char* headerStorage = stream->headerStorage;
+
+		memset(stream, 0, sizeof(*stream));
+
+		stream->headerStorage = headerStorage;
+		stream->id = streamID;
+		stream->state = HTTP2_STREAM_STATE_OPEN;
+		stream->sendWindow = session->peerInitialWindowSize;
+
+		http_initRequest_(&stream->request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+		http_setHTTP_Version(&stream->request, HTTP_HTTP_VERSION_2_0);
+
+		stream->response.fileDescriptor = -1;
+
+		return stream;
+	}
+
+	return NULL;
+}
+
+local inline uint32_t http2_readUint32(const uint8_t* buffer){
+	return ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16) | ((uint32_t) buffer[2] << 8) | buffer[3];
+}
+
+local inline void http2_writeUint32(uint8_t* buffer, const uint32_t value){
+	buffer[0] = value >> 24;
+	buffer[1] = value >> 16;
+	buffer[2] = value >> 8;
+	buffer[3] = value;
+}
+
+inline void hpack_initDynamicTable(HPACK_DynamicTable* table, const uint_fast64_t maxSize){
+	memset(table, 0, sizeof(*table));
+
+	table->maxSize = maxSize;
+}
+
+inline void hpack_freeDynamicTable(HPACK_DynamicTable* table){
+	hpack_evictDynamicTableEntries(table, 0);
+}
+
+// Note: 'offset' points at the first byte of the integer and gets moved behind it. Values that don't fit into 32 bits are rejected.
+ERROR_CODE hpack_decodeInteger(const uint8_t* buffer, const uint_fast64_t length, const uint_fast8_t prefixBits, uint_fast64_t* offset, uint_fast64_t* value){
+	if(*offset >= length){
+		return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+	}
+
+	const uint_fast64_t maxPrefix = (1 << prefixBits) - 1;
+
+	*value = buffer[(*offset)++] & maxPrefix;
+
+	if(*value < maxPrefix){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	uint_fast8_t shift;
+	for(shift = 0; shift <= 28; shift += 7){
+		if(*offset >= length){
+			return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+		}
+
+		const uint8_t byte = buffer[(*offset)++];
+
+		*value += (uint_fast64_t) (byte & 0x7F) << shift;
+
+		if(!(byte & 0x80)){
+			return *value <= UINT32_MAX ? ERROR(ERROR_NO_ERROR) : ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+		}
+	}
+
+	return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+}
+
+// Note: 'pattern' holds the bits in front of the prefix. Returns the number of bytes written, or 0 if the integer does not fit into the buffer.
+uint_fast64_t hpack_encodeInteger(uint8_t* buffer, const uint_fast64_t bufferSize, const uint8_t pattern, const uint_fast8_t prefixBits, uint_fast64_t value){
+	const uint_fast64_t maxPrefix = (1 << prefixBits) - 1;
+
+	if(bufferSize == 0){
+		return 0;
+	}
+
+	if(value < maxPrefix){
+		buffer[0] = pattern | value;
+
+		return 1;
+	}
+
+	buffer[0] = pattern | maxPrefix;
+	value -= maxPrefix;
+
+	uint_fast64_t length = 1;
+	for(;;){
+		if(length == bufferSize){
+			return 0;
+		}
+
+		if(value < 0x80){
+			buffer[length++] = value;
+
+			return length;
+		}
+
+		buffer[length++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+}
+
+// Note: Canonical decoding, one bit at a time. The padding has to be the most significant bits of the EOS code and shorter than a byte.
+ERROR_CODE hpack_decodeHuffman(const uint8_t* input, const uint_fast64_t inputLength, char* output, const uint_fast64_t outputSize, uint_fast64_t* outputLength){
+	*outputLength = 0;
+
+	uint_fast32_t code = 0;
+	uint_fast32_t first = 0;
+	uint_fast32_t index = 0;
+	uint_fast8_t codeLength = 0;
+	bool padding = true;
+
+	uint_fast64_t i;
+	for(i = 0; i < inputLength; i++){
+		int_fast8_t bit;
+		for(bit = 7; bit >= 0; bit--){
+			const uint_fast8_t value = (input[i] >> bit) & 1;
+
+			code |= value;
+			codeLength++;
+			padding = padding && value == 1;
+
+			const uint_fast32_t count = HPACK_HUFFMAN_CODE_LENGTH_COUNTS[codeLength];
+
+			if(code - first < count){
+				const uint_fast16_t symbol = HPACK_HUFFMAN_SYMBOLS[index + (code - first)];
+
+				if(symbol == HPACK_HUFFMAN_EOS){
+					return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+				}
+
+				if(*outputLength == outputSize){
+					return ERROR(ERROR_MAX_MESSAGE_SIZE_EXCEEDED);
+				}
+
+				output[(*outputLength)++] = symbol;
+
+				code = 0;
+				first = 0;
+				index = 0;
+				codeLength = 0;
+				padding = true;
+
+				continue;
+			}
+
+			if(codeLength == HPACK_HUFFMAN_MAX_CODE_LENGTH){
+				return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+			}
+
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+	}
+
+	if(codeLength > 7 || !padding){
+		return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Decodes a complete header block into 'request'. Names and values get written to 'storage', which the request points into and which has to outlive it. Pseudo header fields fill in the request line, ':authority' becomes the 'Host' header field. The whole block gets decoded even if a field can't be added to the request, the header table has to see every field. In that case the error of the first field that could not be added is returned, 'ERROR_HPACK_DECOMPRESSION_FAILED' and 'ERROR_MAX_MESSAGE_SIZE_EXCEEDED' are connection errors.
+ERROR_CODE hpack_decodeHeaderBlock(HPACK_DynamicTable* table, const uint8_t* block, const uint_fast64_t blockLength, HTTP_Request* request, char* storage, const uint_fast64_t storageSize){
+	ERROR_CODE error;
+	ERROR_CODE requestError = ERROR_NO_ERROR;
+
+	bool headerFieldDecoded = false;
+
+	uint_fast64_t storageLength = 0;
+
+	uint_fast64_t offset = 0;
+	while(offset < blockLength){
+		const uint8_t representation = block[offset];
+
+		uint_fast64_t index;
+
+		// Dynamic table size update, only allowed in front of the first header field.
+		if((representation & 0xE0) == 0x20){
+			uint_fast64_t maxSize;
+			if(headerFieldDecoded || hpack_decodeInteger(block, blockLength, 5, &offset, &maxSize) != ERROR_NO_ERROR || maxSize > HPACK_DEFAULT_HEADER_TABLE_SIZE){
+				return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+			}
+
+			table->maxSize = maxSize;
+
+			hpack_evictDynamicTableEntries(table, maxSize);
+
+			continue;
+		}
+
+		headerFieldDecoded = true;
+
+		const uint_fast64_t headerFieldOffset = storageLength;
+
+		char* name;
+		char* value;
+		uint_fast64_t nameLength;
+		uint_fast64_t valueLength;
+
+		const char* indexedName;
+		const char* indexedValue;
+
+		// Indexed header field.
+		if(representation & 0x80){
+			if(hpack_decodeInteger(block, blockLength, 7, &offset, &index) != ERROR_NO_ERROR || hpack_getIndexedField(table, index, &indexedName, &nameLength, &indexedValue, &valueLength) != ERROR_NO_ERROR){
+				return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+			}
+
+			if((name = hpack_storeString(storage, storageSize, &storageLength, indexedName, nameLength)) == NULL || (value = hpack_storeString(storage, storageSize, &storageLength, indexedValue, valueLength)) == NULL){
+				return ERROR(ERROR_MAX_MESSAGE_SIZE_EXCEEDED);
+			}
+		}else{
+			// Literal header field with incremental indexing, without indexing or never indexed.
+			const bool incrementalIndexing = (representation & 0xC0) == 0x40;
+
+			if(hpack_decodeInteger(block, blockLength, incrementalIndexing ? 6 : 4, &offset, &index) != ERROR_NO_ERROR){
+				return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+			}
+
+			if(index == 0){
+				if((error = hpack_decodeString(block, blockLength, &offset, storage, storageSize, &storageLength, &name, &nameLength)) != ERROR_NO_ERROR){
+					return ERROR(error);
+				}
+			}else{
+				if(hpack_getIndexedField(table, index, &indexedName, &nameLength, &indexedValue, &valueLength) != ERROR_NO_ERROR){
+					return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+				}
+
+				if((name = hpack_storeString(storage, storageSize, &storageLength, indexedName, nameLength)) == NULL){
+					return ERROR(ERROR_MAX_MESSAGE_SIZE_EXCEEDED);
+				}
+			}
+
+			if((error = hpack_decodeString(block, blockLength, &offset, storage, storageSize, &storageLength, &value, &valueLength)) != ERROR_NO_ERROR){
+				return ERROR(error);
+			}
+
+			if(incrementalIndexing && (error = hpack_addDynamicTableEntry(table, name, nameLength, value, valueLength)) != ERROR_NO_ERROR){
+				return ERROR(error);
+			}
+		}
+
+		bool referenced;
+		if((error = hpack_addRequestHeaderField(request, name, nameLength, value, valueLength, &referenced)) != ERROR_NO_ERROR && requestError == ERROR_NO_ERROR){
+			requestError = error;
+		}
+
+		// Note: Pseudo header fields that only got parsed, and fields that did not make it into the request, give their storage back.
+		if(!referenced){
+			storageLength = headerFieldOffset;
+		}
+	}
+
+	return ERROR(requestError);
+}
+
+// Note: Every header field is sent as literal without indexing, response headers hardly ever repeat verbatim on a connection except for 'Server'. Names are lower case as HTTP/2 requires, connection specific header fields are left out.
+ERROR_CODE hpack_encodeResponseHeader(HTTP_Response* response, uint8_t* buffer, const uint_fast64_t bufferSize, uint_fast64_t* length){
+	ERROR_CODE error;
+
+	*length = 0;
+
+	char status[4];
+	snprintf(status, sizeof(status), "%03" PRIdFAST16, http_getNumericalStatusCode(response->httpStatusCode));
+
+	// Note: ':status' 200, 204, 206, 304, 400, 404 and 500 are in the static table.
+	uint_fast64_t i;
+	for(i = 8; i <= 14; i++){
+		if(memcmp(HPACK_STATIC_TABLE[i - 1][1], status, 3) == 0){
+			*length = hpack_encodeInteger(buffer, bufferSize, 0x80, 7, i);
+
+			break;
+		}
+	}
+
+	if(*length == 0){
+		*length = hpack_encodeLiteralHeaderField(buffer, bufferSize, 8, ":status", 7, status, 3);
+	}
+
+	if(*length == 0){
+		return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+	}
+
+	LinkedListIterator it;
+	linkedList_initIterator(&it, &response->httpHeaderFields);
+
+	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+		HTTP_HeaderField* headerField = LINKED_LIST_ITERATOR_NEXT_PTR(&it, HTTP_HeaderField);
+
+		if(strcasecmp(headerField->name, CONSTANTS_HTTP_HEADER_FIELD_CONNECTION_NAME) == 0 || strcasecmp(headerField->name, "Keep-Alive") == 0){
+			continue;
+		}
+
+		if((error = hpack_encodeResponseHeaderField(buffer, bufferSize, length, headerField->name, headerField->nameLength, headerField->value, headerField->valueLength)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}
+
+	if((error = hpack_encodeResponseHeaderField(buffer, bufferSize, length, "date", 4, http_getCurrentDate(), HTTP_DATE_LENGTH)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	// Note: Pre-serialized header blocks hold one 'Name: value\r\n' line per field.
+	const char* headerBlockEnd = response->headerBlock + response->headerBlockLength;
+
+	const char* line;
+	for(line = response->headerBlock; line < headerBlockEnd;){
+		const char* lineEnd = memchr(line, '\r', headerBlockEnd - line);
+		const char* separator = memchr(line, ':', lineEnd - line);
+
+		if((error = hpack_encodeResponseHeaderField(buffer, bufferSize, length, line, separator - line, separator + 2, lineEnd - separator - 2)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+
+		line = lineEnd + 2;
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local ERROR_CODE hpack_encodeResponseHeaderField(uint8_t* buffer, const uint_fast64_t bufferSize, uint_fast64_t* length, const char* name, const uint_fast64_t nameLength, const char* value, const uint_fast64_t valueLength){
+	const uint_fast64_t nameIndex = hpack_findStaticTableName(name, nameLength);
+
+	const uint_fast64_t headerFieldLength = hpack_encodeLiteralHeaderField(buffer + *length, bufferSize - *length, nameIndex, name, nameLength, value, valueLength);
+	if(headerFieldLength == 0){
+		return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+	}
+
+	*length += headerFieldLength;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: The string gets written to 'storage' with a terminating '\0', its length is only known once Huffman coded strings got decoded.
+local ERROR_CODE hpack_decodeString(const uint8_t* block, const uint_fast64_t blockLength, uint_fast64_t* offset, char* storage, const uint_fast64_t storageSize, uint_fast64_t* storageLength, char** string, uint_fast64_t* stringLength){
+	if(*offset >= blockLength){
+		return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+	}
+
+	const bool huffman = block[*offset] & 0x80;
+
+	uint_fast64_t length;
+	if(hpack_decodeInteger(block, blockLength, 7, offset, &length) != ERROR_NO_ERROR || length > blockLength - *offset){
+		return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+	}
+
+	if(*storageLength == storageSize){
+		return ERROR(ERROR_MAX_MESSAGE_SIZE_EXCEEDED);
+	}
+
+	*string = storage + *storageLength;
+
+	// Note: One byte stays reserved for the terminating '\0'.
+	const uint_fast64_t available = storageSize - *storageLength - 1;
+
+	if(huffman){
+		ERROR_CODE error;
+		if((error = hpack_decodeHuffman(block + *offset, length, *string, available, stringLength)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}else{
+		if(length > available){
+			return ERROR(ERROR_MAX_MESSAGE_SIZE_EXCEEDED);
+		}
+
+		memcpy(*string, block + *offset, length);
+
+		*stringLength = length;
+	}
+
+	(*string)[*stringLength] = '\0';
+
+	*storageLength += *stringLength + 1;
+	*offset += length;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Copies a header table string to 'storage', returns NULL if it does not fit.
+local char* hpack_storeString(char* storage, const uint_fast64_t storageSize, uint_fast64_t* storageLength, const char* string, const uint_fast64_t stringLength){
+	if(storageSize - *storageLength < stringLength + 1){
+		return NULL;
+	}
+
+	char* storedString = storage + *storageLength;
+
+	memcpy(storedString, string, stringLength);
+	storedString[stringLength] = '\0';
+
+	*storageLength += stringLength + 1;
+
+	return storedString;
+}
+
+local ERROR_CODE hpack_getIndexedField(HPACK_DynamicTable* table, const uint_fast64_t index, const char** name, uint_fast64_t* nameLength, const char** value, uint_fast64_t* valueLength){
+	if(index == 0){
+		return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+	}
+
+	if(index <= HPACK_STATIC_TABLE_LENGTH){
+		*name = HPACK_STATIC_TABLE[index - 1][0];
+		*value = HPACK_STATIC_TABLE[index - 1][1];
+
+		*nameLength = strlen(*name);
+		*valueLength = strlen(*value);
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	const uint_fast64_t dynamicIndex = index - HPACK_STATIC_TABLE_LENGTH - 1;
+	if(dynamicIndex >= table->length){
+		return ERROR(ERROR_HPACK_DECOMPRESSION_FAILED);
+	}
+
+	const HTTP_HeaderField* entry = &table->entries[(table->first + dynamicIndex) % HPACK_MAX_DYNAMIC_TABLE_ENTRIES];
+
+	*name = entry->name;
+	*nameLength = entry->nameLength;
+	*value = entry->value;
+	*valueLength = entry->valueLength;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Entries larger than the whole table empty it and don't get added.
+local ERROR_CODE hpack_addDynamicTableEntry(HPACK_DynamicTable* table, const char* name, const uint_fast64_t nameLength, const char* value, const uint_fast64_t valueLength){
+	const uint_fast64_t entrySize = nameLength + valueLength + HPACK_ENTRY_OVERHEAD;
+
+	if(entrySize > table->maxSize){
+		hpack_evictDynamicTableEntries(table, 0);
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	hpack_evictDynamicTableEntries(table, table->maxSize - entrySize);
+
+	char* entryName = malloc(sizeof(*entryName) * (nameLength + 1));
+	char* entryValue = malloc(sizeof(*entryValue) * (valueLength + 1));
+	if(entryName == NULL || entryValue == NULL){
+		free(entryName);
+		free(entryValue);
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	memcpy(entryName, name, nameLength + 1);
+	memcpy(entryValue, value, valueLength + 1);
+
+	table->first = (table->first + HPACK_MAX_DYNAMIC_TABLE_ENTRIES - 1) % HPACK_MAX_DYNAMIC_TABLE_ENTRIES;
+	table->length++;
+	table->size += entrySize;
+
+	http_initheaderField(&table->entries[table->first], entryName, nameLength, entryValue, valueLength);
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Evicts the oldest entries until the table is no larger than 'maxSize'.
+local void hpack_evictDynamicTableEntries(HPACK_DynamicTable* table, const uint_fast64_t maxSize){
+	while(table->size > maxSize){
+		HTTP_HeaderField* entry = &table->entries[(table->first + table->length - 1) % HPACK_MAX_DYNAMIC_TABLE_ENTRIES];
+
+		table->size -= entry->nameLength + entry->valueLength + HPACK_ENTRY_OVERHEAD;
+		table->length--;
+
+		free(entry->name);
+		free(entry->value);
+	}
+}
+
+// Note: 'referenced' tells whether the request points into 'name' or 'value' afterwards.
+local ERROR_CODE hpack_addRequestHeaderField(HTTP_Request* request, char* name, const uint_fast64_t nameLength, char* value, const uint_fast64_t valueLength, bool* referenced){
+	ERROR_CODE error;
+
+	*referenced = false;
+
+	if(name[0] == ':'){
+		if(strcmp(name, ":method") == 0){
+			request->httpRequestType = http_parseRequestType(value, valueLength);
+		}else if(strcmp(name, ":path") == 0){
+			if(request->requestURL != NULL || valueLength == 0 || valueLength > UINT16_MAX){
+				return ERROR(ERROR_INVALID_REQUEST_URL);
+			}
+
+			request->requestURL = value;
+			request->requestURLLength = valueLength;
+
+			http_splitRequestURL(request);
+
+			*referenced = true;
+		}else if(strcmp(name, ":authority") == 0){
+			// Note: ':authority' is longer than 'Host', the name gets overwritten in place.
+			const uint_fast64_t hostLength = strlen(CONSTANTS_HTTP_HEADER_FIELD_HOST_NAME);
+
+			memcpy(name, CONSTANTS_HTTP_HEADER_FIELD_HOST_NAME, hostLength + 1);
+
+			if((error = http_addHeaderField(request, name, hostLength, value, valueLength)) != ERROR_NO_ERROR){
+				return ERROR(error);
+			}
+
+			*referenced = true;
+		}
+
+		// Note: ':scheme' is implied by the connection.
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if((error = http_addHeaderField(request, name, nameLength, value, valueLength)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	*referenced = true;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Literal header field without indexing, with an indexed name if 'nameIndex' is not 0. Strings are not Huffman coded. Returns the number of bytes written, or 0 if the field does not fit into the buffer.
+local uint_fast64_t hpack_encodeLiteralHeaderField(uint8_t* buffer, const uint_fast64_t bufferSize, const uint_fast64_t nameIndex, const char* name, const uint_fast64_t nameLength, const char* value, const uint_fast64_t valueLength){
+	uint_fast64_t length = hpack_encodeInteger(buffer, bufferSize, 0x00, 4, nameIndex);
+	if(length == 0){
+		return 0;
+	}
+
+	if(nameIndex == 0){
+		const uint_fast64_t nameLengthLength = hpack_encodeInteger(buffer + length, bufferSize - length, 0x00, 7, nameLength);
+		if(nameLengthLength == 0 || bufferSize - length - nameLengthLength < nameLength){
+			return 0;
+		}
+
+		length += nameLengthLength;
+
+		uint_fast64_t i;
+		for(i = 0; i < nameLength; i++){
+			buffer[length++] = tolower(name[i]);
+		}
+	}
+
+	const uint_fast64_t valueLengthLength = hpack_encodeInteger(buffer + length, bufferSize - length, 0x00, 7, valueLength);
+	if(valueLengthLength == 0 || bufferSize - length - valueLengthLength < valueLength){
+		return 0;
+	}
+
+	length += valueLengthLength;
+
+	memcpy(buffer + length, value, valueLength);
+
+	return length + valueLength;
+}
+
+// Note: Returns the first static table index with the given name, or 0.
+local uint_fast64_t hpack_findStaticTableName(const char* name, const uint_fast64_t nameLength){
+	uint_fast64_t i;
+	for(i = 0; i < HPACK_STATIC_TABLE_LENGTH; i++){
+		if(strncasecmp(HPACK_STATIC_TABLE[i][0], name, nameLength) == 0 && HPACK_STATIC_TABLE[i][0][nameLength] == '\0'){
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
+#endif
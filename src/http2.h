@@ -0,0 +1,180 @@
+#ifndef HTTP2_H
+#define HTTP2_H
+
+#include "util.h"
+#include "http.h"
+
+// Note: HTTP/2 framing (RFC 9113) and HPACK header compression (RFC 7541). The session only turns bytes into requests and responses into bytes, reading from and writing to the connection is left to the server.
+
+#define HTTP2_CONNECTION_PREFACE "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define HTTP2_CONNECTION_PREFACE_LENGTH 24
+
+#define HTTP2_FRAME_HEADER_LENGTH 9
+#define HTTP2_DEFAULT_MAX_FRAME_SIZE 16384
+#define HTTP2_MAX_MAX_FRAME_SIZE 16777215
+#define HTTP2_DEFAULT_WINDOW_SIZE 65535
+#define HTTP2_MAX_WINDOW_SIZE 0x7FFFFFFF
+#define HTTP2_MAX_CONCURRENT_STREAMS 32
+// Note: Advertised to the client, no larger than what a HTTP/1.1 request header may take up. The decoded names and values of a header block always fit into HTTP2_MAX_HEADER_LIST_SIZE bytes of header storage, the list size counts 32 bytes per field on top of them.
+#define HTTP2_MAX_HEADER_LIST_SIZE KB(8)
+// Note: Header blocks that span CONTINUATION frames get reassembled up to this size.
+#define HTTP2_MAX_HEADER_BLOCK_SIZE KB(16)
+// Note: Control frames queued while processing input, e.g. SETTINGS and PING acknowledgements or WINDOW_UPDATEs.
+#define HTTP2_CONTROL_BUFFER_SIZE 512
+// Note: Input processing pauses until the queued control frames went out, once less than this is left in the control buffer. Enough for the frames a single input frame can cause.
+#define HTTP2_CONTROL_BUFFER_RESERVE 64
+// Note: The connection buffers have to hold the control frames and a response header block next to each other.
+#define HTTP2_MIN_BUFFER_SIZE KB(4)
+
+#define HTTP2_FLAG_END_STREAM 0x1
+#define HTTP2_FLAG_ACK 0x1
+#define HTTP2_FLAG_END_HEADERS 0x4
+#define HTTP2_FLAG_PADDED 0x8
+#define HTTP2_FLAG_PRIORITY 0x20
+
+#define HPACK_DEFAULT_HEADER_TABLE_SIZE 4096
+#define HPACK_STATIC_TABLE_LENGTH 61
+// Note: Every dynamic table entry is accounted with 32 bytes on top of its name and value.
+#define HPACK_ENTRY_OVERHEAD 32
+#define HPACK_MAX_DYNAMIC_TABLE_ENTRIES (HPACK_DEFAULT_HEADER_TABLE_SIZE / HPACK_ENTRY_OVERHEAD)
+#define HPACK_HUFFMAN_NUM_SYMBOLS 257
+#define HPACK_HUFFMAN_MAX_CODE_LENGTH 30
+#define HPACK_HUFFMAN_EOS 256
+
+typedef enum{
+	HTTP2_FRAME_TYPE_DATA = 0,
+	HTTP2_FRAME_TYPE_HEADERS,
+	HTTP2_FRAME_TYPE_PRIORITY,
+	HTTP2_FRAME_TYPE_RST_STREAM,
+	HTTP2_FRAME_TYPE_SETTINGS,
+	HTTP2_FRAME_TYPE_PUSH_PROMISE,
+	HTTP2_FRAME_TYPE_PING,
+	HTTP2_FRAME_TYPE_GOAWAY,
+	HTTP2_FRAME_TYPE_WINDOW_UPDATE,
+	HTTP2_FRAME_TYPE_CONTINUATION
+}Http2FrameType;
+
+typedef enum{
+	HTTP2_SETTINGS_HEADER_TABLE_SIZE = 1,
+	HTTP2_SETTINGS_ENABLE_PUSH,
+	HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS,
+	HTTP2_SETTINGS_INITIAL_WINDOW_SIZE,
+	HTTP2_SETTINGS_MAX_FRAME_SIZE,
+	HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE
+}Http2Setting;
+
+typedef enum{
+	HTTP2_ERROR_CODE_NO_ERROR = 0,
+	HTTP2_ERROR_CODE_PROTOCOL_ERROR,
+	HTTP2_ERROR_CODE_INTERNAL_ERROR,
+	HTTP2_ERROR_CODE_FLOW_CONTROL_ERROR,
+	HTTP2_ERROR_CODE_SETTINGS_TIMEOUT,
+	HTTP2_ERROR_CODE_STREAM_CLOSED,
+	HTTP2_ERROR_CODE_FRAME_SIZE_ERROR,
+	HTTP2_ERROR_CODE_REFUSED_STREAM,
+	HTTP2_ERROR_CODE_CANCEL,
+	HTTP2_ERROR_CODE_COMPRESSION_ERROR,
+	HTTP2_ERROR_CODE_CONNECT_ERROR,
+	HTTP2_ERROR_CODE_ENHANCE_YOUR_CALM,
+	HTTP2_ERROR_CODE_INADEQUATE_SECURITY,
+	HTTP2_ERROR_CODE_HTTP_1_1_REQUIRED
+}Http2ErrorCode;
+
+// Note: Only the states a server side stream passes through without server push. 'CLOSED' streams still hold their slot until the server released them.
+typedef enum{
+	HTTP2_STREAM_STATE_IDLE = 0,
+	HTTP2_STREAM_STATE_OPEN,
+	HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE,
+	HTTP2_STREAM_STATE_CLOSED
+}Http2StreamState;
+
+// Note: Entries are owned by the table, the newest entry has the lowest index.
+typedef struct{
+	HTTP_HeaderField entries[HPACK_MAX_DYNAMIC_TABLE_ENTRIES];
+	uint_fast16_t first;
+	uint_fast16_t length;
+	uint_fast64_t size;
+	uint_fast64_t maxSize;
+}HPACK_DynamicTable;
+
+typedef struct{
+	uint32_t id;
+	Http2StreamState state;
+	// Note: Signed, a smaller SETTINGS_INITIAL_WINDOW_SIZE can push it below zero.
+	int_fast64_t sendWindow;
+	bool responseReady;
+	bool headersSent;
+	HTTP_Request request;
+	HTTP_Response response;
+	// Note: Decoded names and values the request points into. Allocated the first time the stream slot gets used and kept for all streams that use the slot after that.
+	char* headerStorage;
+	// Note: Pool buffer the response gets build in, owned by the server.
+	int8_t* responseBuffer;
+	// Note: The body is sent from 'body' + 'bodyOffset', or read from the responses file at 'bodyOffset' if 'body' is NULL.
+	const int8_t* body;
+	uint_fast64_t bodyOffset;
+	uint_fast64_t bodyRemaining;
+}Http2Stream;
+
+typedef struct{
+	Http2Stream streams[HTTP2_MAX_CONCURRENT_STREAMS];
+	HPACK_DynamicTable headerTable;
+	uint32_t lastStreamID;
+	int_fast64_t sendWindow;
+	uint32_t peerMaxFrameSize;
+	uint32_t peerInitialWindowSize;
+	// Note: DATA received since the last connection level WINDOW_UPDATE.
+	uint_fast64_t receivedDataLength;
+	// Note: Bytes of a DATA payload that are still to be skipped.
+	uint_fast64_t discardLength;
+	// Note: Header block being reassembled from a HEADERS frame and its CONTINUATION frames.
+	int8_t* headerBlock;
+	uint_fast64_t headerBlockLength;
+	uint32_t headerBlockStreamID;
+	bool headerBlockEndStream;
+	// Note: Header storage for blocks that get decoded just to keep the header table in sync, trailers and refused streams.
+	char* headerStorage;
+	int8_t controlFrames[HTTP2_CONTROL_BUFFER_SIZE];
+	uint_fast64_t controlFramesLength;
+	bool prefaceReceived;
+	bool goAwayReceived;
+	bool goAwaySent;
+	// Note: Streams get their DATA frames round robin, starting after the stream that went last.
+	uint_fast8_t nextStream;
+}Http2Session;
+
+ERROR_CODE http2_initSession(Http2Session*);
+
+void http2_freeSession(Http2Session*);
+
+ERROR_CODE http2_processInput(Http2Session*, const int8_t*, const uint_fast64_t, const uint_fast64_t, uint_fast64_t*);
+
+ERROR_CODE http2_produceOutput(Http2Session*, int8_t*, const uint_fast64_t, uint_fast64_t*);
+
+void http2_prepareResponseBody(Http2Stream*);
+
+void http2_resetStream(Http2Session*, Http2Stream*, const Http2ErrorCode);
+
+void http2_goAway(Http2Session*, const Http2ErrorCode);
+
+void http2_closeStream(Http2Stream*);
+
+bool http2_hasActiveStreams(Http2Session*);
+
+uint_fast64_t http2_writeFrameHeader(int8_t*, const uint_fast64_t, const Http2FrameType, const uint8_t, const uint32_t);
+
+void hpack_initDynamicTable(HPACK_DynamicTable*, const uint_fast64_t);
+
+void hpack_freeDynamicTable(HPACK_DynamicTable*);
+
+ERROR_CODE hpack_decodeInteger(const uint8_t*, const uint_fast64_t, const uint_fast8_t, uint_fast64_t*, uint_fast64_t*);
+
+uint_fast64_t hpack_encodeInteger(uint8_t*, const uint_fast64_t, const uint8_t, const uint_fast8_t, uint_fast64_t);
+
+ERROR_CODE hpack_decodeHuffman(const uint8_t*, const uint_fast64_t, char*, const uint_fast64_t, uint_fast64_t*);
+
+ERROR_CODE hpack_decodeHeaderBlock(HPACK_DynamicTable*, const uint8_t*, const uint_fast64_t, HTTP_Request*, char*, const uint_fast64_t);
+
+ERROR_CODE hpack_encodeResponseHeader(HTTP_Response*, uint8_t*, const uint_fast64_t, uint_fast64_t*);
+
+#endif
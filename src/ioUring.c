@@ -0,0 +1,258 @@
+#ifndef IO_URING_C
+#define IO_URING_C
+
+#include "ioUring.h"
+
+local int ioUring_setup(const uint32_t numEntries, struct io_uring_params* parameters){
+	return (int) syscall(__NR_io_uring_setup, numEntries, parameters);
+}
+
+local int ioUring_enter(const int fileDescriptor, const uint32_t toSubmit, const uint32_t minCompletions, const uint32_t flags, const sigset_t* signalMask){
+	return (int) syscall(__NR_io_uring_enter, fileDescriptor, toSubmit, minCompletions, flags, signalMask, _NSIG / 8);
+}
+
+local int ioUring_register(const int fileDescriptor, const uint32_t opcode, void* arg, const uint32_t numArgs){
+	return (int) syscall(__NR_io_uring_register, fileDescriptor, opcode, arg, numArgs);
+}
+
+ERROR_CODE ioUring_init(IoUring* ring, const uint32_t numEntries){
+	memset(ring, 0, sizeof(*ring));
+
+	struct io_uring_params parameters = {0};
+	// Note: Only the worker thread that created the ring submits to it, which lets the kernel defer completion work until we ask for completions.
+	parameters.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+
+	ring->fileDescriptor = ioUring_setup(numEntries, &parameters);
+
+	// Older kernels don't know about these flags, retry without them.
+	if(ring->fileDescriptor < 0 && errno == EINVAL){
+		memset(&parameters, 0, sizeof(parameters));
+
+		ring->fileDescriptor = ioUring_setup(numEntries, &parameters);
+	}
+
+	if(ring->fileDescriptor < 0){
+		return ERROR_(ERROR_FAILED_TO_INITIALISE_IO_URING, "io_uring_setup: '%s'.", strerror(errno));
+	}
+
+	ring->setupFlags = parameters.flags;
+
+	ring->submissionQueueRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(uint32_t);
+	ring->completionQueueRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe);
+
+	if(parameters.features & IORING_FEAT_SINGLE_MMAP){
+		ring->submissionQueueRingSize = ring->completionQueueRingSize = MAX(ring->submissionQueueRingSize, ring->completionQueueRingSize);
+	}
+
+	ring->submissionQueueRing = mmap(NULL, ring->submissionQueueRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fileDescriptor, IORING_OFF_SQ_RING);
+	if(ring->submissionQueueRing == MAP_FAILED){
+		close(ring->fileDescriptor);
+
+		return ERROR_(ERROR_FAILED_TO_INITIALISE_IO_URING, "SQ ring mmap: '%s'.", strerror(errno));
+	}
+
+	if(parameters.features & IORING_FEAT_SINGLE_MMAP){
+		ring->completionQueueRing = ring->submissionQueueRing;
+	}else{
+		ring->completionQueueRing = mmap(NULL, ring->completionQueueRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fileDescriptor, IORING_OFF_CQ_RING);
+		if(ring->completionQueueRing == MAP_FAILED){
+			munmap(ring->submissionQueueRing, ring->submissionQueueRingSize);
+			close(ring->fileDescriptor);
+
+			return ERROR_(ERROR_FAILED_TO_INITIALISE_IO_URING, "CQ ring mmap: '%s'.", strerror(errno));
+		}
+	}
+
+	ring->submissionQueueEntriesSize = parameters.sq_entries * sizeof(struct io_uring_sqe);
+
+	ring->submissionQueueEntries = mmap(NULL, ring->submissionQueueEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fileDescriptor, IORING_OFF_SQES);
+	if(ring->submissionQueueEntries == MAP_FAILED){
+		if(ring->completionQueueRing != ring->submissionQueueRing){
+			munmap(ring->completionQueueRing, ring->completionQueueRingSize);
+		}
+
+		munmap(ring->submissionQueueRing, ring->submissionQueueRingSize);
+		close(ring->fileDescriptor);
+
+		return ERROR_(ERROR_FAILED_TO_INITIALISE_IO_URING, "SQE mmap: '%s'.", strerror(errno));
+	}
+
+	int8_t* submissionQueueRing = ring->submissionQueueRing;
+	ring->submissionQueueHead = (uint32_t*) (submissionQueueRing + parameters.sq_off.head);
+	ring->submissionQueueTail = (uint32_t*) (submissionQueueRing + parameters.sq_off.tail);
+	ring->submissionQueueArray = (uint32_t*) (submissionQueueRing + parameters.sq_off.array);
+	ring->submissionQueueMask = *(uint32_t*) (submissionQueueRing + parameters.sq_off.ring_mask);
+	ring->submissionQueueNumEntries = parameters.sq_entries;
+	ring->submissionQueueLocalTail = *ring->submissionQueueTail;
+
+	int8_t* completionQueueRing = ring->completionQueueRing;
+	ring->completionQueueHead = (uint32_t*) (completionQueueRing + parameters.cq_off.head);
+	ring->completionQueueTail = (uint32_t*) (completionQueueRing + parameters.cq_off.tail);
+	ring->completionQueueMask = *(uint32_t*) (completionQueueRing + parameters.cq_off.ring_mask);
+	ring->completionQueueEntries = (struct io_uring_cqe*) (completionQueueRing + parameters.cq_off.cqes);
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+void ioUring_free(IoUring* ring){
+	if(ring->bufferRing != NULL){
+		munmap(ring->bufferRing, ring->bufferRingSize);
+	}
+
+	free(ring->buffers);
+
+	munmap(ring->submissionQueueEntries, ring->submissionQueueEntriesSize);
+
+	if(ring->completionQueueRing != ring->submissionQueueRing){
+		munmap(ring->completionQueueRing, ring->completionQueueRingSize);
+	}
+
+	munmap(ring->submissionQueueRing, ring->submissionQueueRingSize);
+
+	close(ring->fileDescriptor);
+}
+
+// Note: Returns NULL only if the queue is still full after handing all queued entries to the kernel.
+struct io_uring_sqe* ioUring_getSubmissionQueueEntry(IoUring* ring){
+	if(ring->submissionQueueLocalTail - IO_URING_LOAD_ACQUIRE(ring->submissionQueueHead) >= ring->submissionQueueNumEntries){
+		ioUring_submitAndWait(ring, 0, NULL);
+
+		if(ring->submissionQueueLocalTail - IO_URING_LOAD_ACQUIRE(ring->submissionQueueHead) >= ring->submissionQueueNumEntries){
+			return NULL;
+		}
+	}
+
+	const uint32_t index = ring->submissionQueueLocalTail & ring->submissionQueueMask;
+
+	struct io_uring_sqe* entry = &ring->submissionQueueEntries[index];
+	memset(entry, 0, sizeof(*entry));
+
+	ring->submissionQueueArray[index] = index;
+	ring->submissionQueueLocalTail++;
+
+	return entry;
+}
+
+// Note: Submits all queued entries and waits for at least 'minCompletions' completions in a single system call. Returns -errno on failure.
+int ioUring_submitAndWait(IoUring* ring, const uint32_t minCompletions, const sigset_t* signalMask){
+	IO_URING_STORE_RELEASE(ring->submissionQueueTail, ring->submissionQueueLocalTail);
+
+	const uint32_t toSubmit = ring->submissionQueueLocalTail - IO_URING_LOAD_ACQUIRE(ring->submissionQueueHead);
+
+	uint32_t flags = 0;
+	if(minCompletions > 0 || (ring->setupFlags & IORING_SETUP_DEFER_TASKRUN)){
+		flags |= IORING_ENTER_GETEVENTS;
+	}
+
+	if(toSubmit == 0 && minCompletions == 0 && !(ring->setupFlags & IORING_SETUP_DEFER_TASKRUN)){
+		return 0;
+	}
+
+	const int ret = ioUring_enter(ring->fileDescriptor, toSubmit, minCompletions, flags, signalMask);
+
+	return ret < 0 ? -errno : ret;
+}
+
+struct io_uring_cqe* ioUring_peekCompletionQueueEntry(IoUring* ring){
+	const uint32_t head = *ring->completionQueueHead;
+
+	if(head == IO_URING_LOAD_ACQUIRE(ring->completionQueueTail)){
+		return NULL;
+	}
+
+	return &ring->completionQueueEntries[head & ring->completionQueueMask];
+}
+
+void ioUring_advanceCompletionQueue(IoUring* ring){
+	IO_URING_STORE_RELEASE(ring->completionQueueHead, *ring->completionQueueHead + 1);
+}
+
+// Note: Registers a ring of 'numBuffers' (power of two) receive buffers, the kernel picks one per completed receive.
+ERROR_CODE ioUring_registerBuffers(IoUring* ring, const uint16_t bufferGroup, const uint16_t numBuffers, const uint32_t bufferSize){
+	ring->bufferRingSize = numBuffers * sizeof(struct io_uring_buf);
+
+	ring->bufferRing = mmap(NULL, ring->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(ring->bufferRing == MAP_FAILED){
+		ring->bufferRing = NULL;
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	ring->buffers = malloc(sizeof(*ring->buffers) * numBuffers * bufferSize);
+	if(ring->buffers == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	struct io_uring_buf_reg registration = {0};
+	registration.ring_addr = (uint64_t) (uintptr_t) ring->bufferRing;
+	registration.ring_entries = numBuffers;
+	registration.bgid = bufferGroup;
+
+	if(ioUring_register(ring->fileDescriptor, IORING_REGISTER_PBUF_RING, &registration, 1) != 0){
+		return ERROR_(ERROR_FAILED_TO_INITIALISE_IO_URING, "IORING_REGISTER_PBUF_RING: '%s'.", strerror(errno));
+	}
+
+	ring->bufferGroup = bufferGroup;
+	ring->numBuffers = numBuffers;
+	ring->bufferSize = bufferSize;
+	ring->bufferRingTail = 0;
+
+	uint16_t i;
+	for(i = 0; i < numBuffers; i++){
+		ioUring_recycleBuffer(ring, i);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+inline int8_t* ioUring_getBuffer(IoUring* ring, const uint16_t bufferID){
+	return ring->buffers + (uint_fast64_t) bufferID * ring->bufferSize;
+}
+
+// Hands a buffer the kernel filled back to it.
+inline void ioUring_recycleBuffer(IoUring* ring, const uint16_t bufferID){
+	struct io_uring_buf* buffer = &ring->bufferRing->bufs[ring->bufferRingTail & (ring->numBuffers - 1)];
+
+	buffer->addr = (uint64_t) (uintptr_t) ioUring_getBuffer(ring, bufferID);
+	buffer->len = ring->bufferSize;
+	buffer->bid = bufferID;
+
+	ring->bufferRingTail++;
+
+	IO_URING_STORE_RELEASE(&ring->bufferRing->tail, ring->bufferRingTail);
+}
+
+inline void ioUring_prepareMultishotAccept(struct io_uring_sqe* entry, const int socketFileDescriptor, const uint64_t userData){
+	entry->opcode = IORING_OP_ACCEPT;
+	entry->fd = socketFileDescriptor;
+	entry->ioprio = IORING_ACCEPT_MULTISHOT;
+	entry->user_data = userData;
+}
+
+inline void ioUring_prepareMultishotReceive(struct io_uring_sqe* entry, const int socketFileDescriptor, const uint16_t bufferGroup, const uint64_t userData){
+	entry->opcode = IORING_OP_RECV;
+	entry->fd = socketFileDescriptor;
+	entry->flags = IOSQE_BUFFER_SELECT;
+	entry->buf_group = bufferGroup;
+	entry->ioprio = IORING_RECV_MULTISHOT;
+	entry->user_data = userData;
+}
+
+inline void ioUring_prepareSend(struct io_uring_sqe* entry, const int socketFileDescriptor, const void* buffer, const uint32_t length, const uint64_t userData){
+	entry->opcode = IORING_OP_SEND;
+	entry->fd = socketFileDescriptor;
+	entry->addr = (uint64_t) (uintptr_t) buffer;
+	entry->len = length;
+	entry->msg_flags = MSG_NOSIGNAL;
+	entry->user_data = userData;
+}
+
+inline void ioUring_prepareTimeout(struct io_uring_sqe* entry, struct __kernel_timespec* timeout, const uint64_t userData){
+	entry->opcode = IORING_OP_TIMEOUT;
+	entry->fd = -1;
+	entry->addr = (uint64_t) (uintptr_t) timeout;
+	entry->len = 1;
+	entry->user_data = userData;
+}
+
+#endif
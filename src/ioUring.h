@@ -0,0 +1,74 @@
+#ifndef IO_URING_H
+#define IO_URING_H
+
+#include "util.h"
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <signal.h>
+
+// Note: Thin wrapper around the raw io_uring system calls, so we don't have to depend on liburing.
+
+#define IO_URING_LOAD_ACQUIRE(pointer) __atomic_load_n(pointer, __ATOMIC_ACQUIRE)
+#define IO_URING_STORE_RELEASE(pointer, value) __atomic_store_n(pointer, value, __ATOMIC_RELEASE)
+
+typedef struct{
+	int fileDescriptor;
+	uint32_t setupFlags;
+	// Submission queue.
+	void* submissionQueueRing;
+	uint_fast64_t submissionQueueRingSize;
+	uint32_t* submissionQueueHead;
+	uint32_t* submissionQueueTail;
+	uint32_t* submissionQueueArray;
+	uint32_t submissionQueueMask;
+	uint32_t submissionQueueNumEntries;
+	// Note: Entries get queued locally and are only published to the kernel on submit.
+	uint32_t submissionQueueLocalTail;
+	struct io_uring_sqe* submissionQueueEntries;
+	uint_fast64_t submissionQueueEntriesSize;
+	// Completion queue.
+	void* completionQueueRing;
+	uint_fast64_t completionQueueRingSize;
+	uint32_t* completionQueueHead;
+	uint32_t* completionQueueTail;
+	uint32_t completionQueueMask;
+	struct io_uring_cqe* completionQueueEntries;
+	// Provided receive buffers.
+	struct io_uring_buf_ring* bufferRing;
+	uint_fast64_t bufferRingSize;
+	int8_t* buffers;
+	uint32_t bufferSize;
+	uint16_t numBuffers;
+	uint16_t bufferGroup;
+	uint16_t bufferRingTail;
+}IoUring;
+
+ERROR_CODE ioUring_init(IoUring*, const uint32_t);
+
+void ioUring_free(IoUring*);
+
+struct io_uring_sqe* ioUring_getSubmissionQueueEntry(IoUring*);
+
+int ioUring_submitAndWait(IoUring*, const uint32_t, const sigset_t*);
+
+struct io_uring_cqe* ioUring_peekCompletionQueueEntry(IoUring*);
+
+void ioUring_advanceCompletionQueue(IoUring*);
+
+ERROR_CODE ioUring_registerBuffers(IoUring*, const uint16_t, const uint16_t, const uint32_t);
+
+int8_t* ioUring_getBuffer(IoUring*, const uint16_t);
+
+void ioUring_recycleBuffer(IoUring*, const uint16_t);
+
+void ioUring_prepareMultishotAccept(struct io_uring_sqe*, const int, const uint64_t);
+
+void ioUring_prepareMultishotReceive(struct io_uring_sqe*, const int, const uint16_t, const uint64_t);
+
+void ioUring_prepareSend(struct io_uring_sqe*, const int, const void*, const uint32_t, const uint64_t);
+
+void ioUring_prepareTimeout(struct io_uring_sqe*, struct __kernel_timespec*, const uint64_t);
+
+#endif
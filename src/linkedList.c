@@ -4,7 +4,7 @@
 #include "linkedList.h"
 
 inline ERROR_CODE linkedList_add(LinkedList* list, void * data, uint_fast64_t size){
-	LinkedList_Node* node = malloc(sizeof(*node) + size);
+	LinkedList_Node* node = list->arena != NULL ? arena_alloc(list->arena, sizeof(*node) + size) : malloc(sizeof(*node) + size);
 	if(node == NULL){
 		return ERROR(ERROR_OUT_OF_MEMORY);
 	}
@@ -31,14 +31,20 @@ inline void linkedList_addNode(LinkedList* list, LinkedList_Node* node){
 }
 
 inline void linkedList_free(LinkedList* list){
-	LinkedListIterator it;
-	linkedList_initIterator(&it, list);
+	// Note: The arena may have been reset already, its nodes must not be touched anymore.
+	if(list->arena == NULL){
+		LinkedListIterator it;
+		linkedList_initIterator(&it, list);
 
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		LinkedList_Node* node = LINKED_LIST_ITERATOR_NEXT_NODE(&it);
+		while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+			LinkedList_Node* node = LINKED_LIST_ITERATOR_NEXT_NODE(&it);
 
-		free(node);
+			free(node);
+		}
 	}
+
+	list->tail = NULL;
+	list->length = 0;
 }
 
 ERROR_CODE linkedList_remove(LinkedList* list, void* data, const uint_fast64_t size){
@@ -54,7 +60,9 @@ ERROR_CODE linkedList_remove(LinkedList* list, void* data, const uint_fast64_t s
 
 			list->length--;
 
-			free(current);
+			if(list->arena == NULL){
+				free(current);
+			}
 
 			return ERROR(ERROR_NO_ERROR);
 		}else{
@@ -2,6 +2,7 @@
 #define LINKED_LIST_H
 
 #include "util.h"
+#include "arena.h"
 
 #define LINKED_LIST_ITERATOR_HAS_NEXT(it) LinkedListIteratorHasNext(it)
 #define LINKED_LIST_ITERATOR_NEXT_NODE(it) LinkedListIteratorNextNode(it)
@@ -25,6 +26,8 @@ typedef struct linkedList_node LinkedList_Node;
 typedef struct{
 	LinkedList_Node* tail;
 	uint_fast64_t length;
+	// Note: Nodes come from the arena instead of the heap if set. They are never freed, 'linkedList_free' only empties the list.
+	Arena* arena;
 }LinkedList;
 
 typedef struct{
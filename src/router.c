@@ -0,0 +1,430 @@
+#ifndef ROUTER_C
+#define ROUTER_C
+
+#include "router.h"
+
+#include "http.h"
+#include "util.h"
+
+local RouterBuildNode* router_newBuildNode(const char*, const uint_fast64_t, const bool);
+
+local void router_freeBuildNode(RouterBuildNode*);
+
+local RouterBuildNode* router_findBuildChild(RouterBuildNode*, const char);
+
+local ERROR_CODE router_splitBuildNode(RouterBuildNode*, const uint_fast64_t);
+
+local void router_countBuildNodes(RouterBuildNode*, uint_fast64_t*, uint_fast64_t*);
+
+local void router_flattenBuildNode(Router*, RouterBuildNode*, const uint_fast64_t, uint_fast64_t*, uint_fast64_t*);
+
+local const RouterNode* router_matchParameter(const Router*, const uint_fast64_t, const char*, const uint_fast64_t, const uint_fast64_t, uint_fast64_t*, HTTP_PathParameter*, uint_fast8_t*);
+
+inline void router_init(Router* router){
+	memset(router, 0, sizeof(*router));
+}
+
+inline void router_free(Router* router){
+	router_freeBuildNode(router->root);
+
+	free(router->nodes);
+	free(router->labels);
+
+	memset(router, 0, sizeof(*router));
+}
+
+ERROR_CODE router_add(Router* router, const HTTP_RequestType requestType, const char* path, const uint_fast64_t pathLength, void* value){
+	if(pathLength == 0 || path[0] != '/' || pathLength > UINT16_MAX){
+		return ERROR_(ERROR_INVALID_REQUEST_URL, "Invalid route '%.*s'.", (int) pathLength, path);
+	}
+
+	if(router->nodes != NULL){
+		return ERROR_(ERROR_INVALID_VALUE, "Route '%.*s' added after the router got compiled.", (int) pathLength, path);
+	}
+
+	if(router->root == NULL){
+		if((router->root = router_newBuildNode(path, 0, false)) == NULL){
+			return ERROR(ERROR_OUT_OF_MEMORY);
+		}
+	}
+
+	ERROR_CODE error;
+
+	RouterBuildNode* node = router->root;
+
+	uint_fast64_t offset = 0;
+	while(offset < pathLength){
+		if(path[offset] == ':'){
+			if(path[offset - 1] != '/'){
+				return ERROR_(ERROR_INVALID_REQUEST_URL, "Path parameter has to span a whole segment '%.*s'.", (int) pathLength, path);
+			}
+
+			const char* name = path + offset + 1;
+
+			uint_fast64_t nameLength = 0;
+			while(offset + 1 + nameLength < pathLength && name[nameLength] != '/'){
+				if(name[nameLength] == ':'){
+					return ERROR_(ERROR_INVALID_REQUEST_URL, "Path parameter has to span a whole segment '%.*s'.", (int) pathLength, path);
+				}
+
+				nameLength++;
+			}
+
+			if(nameLength == 0){
+				return ERROR_(ERROR_INVALID_REQUEST_URL, "Unnamed path parameter '%.*s'.", (int) pathLength, path);
+			}
+
+			if(node->parameterChild == NULL){
+				if((node->parameterChild = router_newBuildNode(name, nameLength, true)) == NULL){
+					return ERROR(ERROR_OUT_OF_MEMORY);
+				}
+			}else if(node->parameterChild->labelLength != nameLength || memcmp(node->parameterChild->label, name, nameLength) != 0){
+				// Note: Both names would end up capturing the same segment.
+				return ERROR_(ERROR_NAME_MISSMATCH, "Path parameter of route '%.*s' conflicts with ':%.*s'.", (int) pathLength, path, (int) node->parameterChild->labelLength, node->parameterChild->label);
+			}
+
+			node = node->parameterChild;
+			offset += 1 + nameLength;
+
+			continue;
+		}
+
+		uint_fast64_t staticLength = 0;
+		while(offset + staticLength < pathLength && path[offset + staticLength] != ':'){
+			staticLength++;
+		}
+
+		RouterBuildNode* child = router_findBuildChild(node, path[offset]);
+		if(child == NULL){
+			if((child = router_newBuildNode(path + offset, staticLength, false)) == NULL){
+				return ERROR(ERROR_OUT_OF_MEMORY);
+			}
+
+			child->nextSibling = node->children;
+			node->children = child;
+
+			node = child;
+			offset += staticLength;
+
+			continue;
+		}
+
+		uint_fast64_t commonLength = 0;
+		while(commonLength < child->labelLength && commonLength < staticLength && child->label[commonLength] == path[offset + commonLength]){
+			commonLength++;
+		}
+
+		if(commonLength < child->labelLength){
+			if((error = router_splitBuildNode(child, commonLength)) != ERROR_NO_ERROR){
+				return ERROR(error);
+			}
+		}
+
+		node = child;
+		offset += commonLength;
+	}
+
+	if(node->values[requestType] != NULL){
+		return ERROR_(ERROR_DUPLICATE_ENTRY, "Route '%.*s' registered twice.", (int) pathLength, path);
+	}
+
+	node->values[requestType] = value;
+	node->hasValue = true;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Lays the trie out breadth first per node, so all static children of a node are adjacent and get picked by a single 'memchr' over their first characters.
+ERROR_CODE router_compile(Router* router){
+	if(router->root == NULL){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	uint_fast64_t numNodes = 0;
+	uint_fast64_t labelsLength = 0;
+	router_countBuildNodes(router->root, &numNodes, &labelsLength);
+
+	if(numNodes > UINT32_MAX || labelsLength > UINT32_MAX){
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	router->nodes = calloc(numNodes, sizeof(*router->nodes));
+	router->labels = malloc(sizeof(*router->labels) * (labelsLength + 1));
+	if(router->nodes == NULL || router->labels == NULL){
+		free(router->nodes);
+		free(router->labels);
+
+		router->nodes = NULL;
+		router->labels = NULL;
+
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	router->numNodes = numNodes;
+
+	uint_fast64_t nextNode = ROUTER_ROOT_NODE + 1;
+	uint_fast64_t nextLabel = 0;
+	router_flattenBuildNode(router, router->root, ROUTER_ROOT_NODE, &nextNode, &nextLabel);
+
+	router_freeBuildNode(router->root);
+	router->root = NULL;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Static segments take precedence over path parameters. When the static branch turns out to be a dead end the lookup resumes once at the deepest parameter it passed over, shallower alternatives are not revisited.
+ERROR_CODE router_lookup(const Router* router, HTTP_Request* request, void** value){
+	*value = NULL;
+
+	request->numPathParameters = 0;
+
+	if(router->nodes == NULL){
+		return ERROR(ERROR_ENTRY_NOT_FOUND);
+	}
+
+	const char* path = request->requestURL;
+	const uint_fast64_t pathLength = request->requestURLLength;
+
+	HTTP_PathParameter parameters[HTTP_MAX_PATH_PARAMETERS];
+	uint_fast8_t numParameters = 0;
+
+	uint_fast64_t fallbackNode = ROUTER_ROOT_NODE;
+	uint_fast64_t fallbackOffset = 0;
+	uint_fast8_t fallbackNumParameters = 0;
+
+	const RouterNode* match = NULL;
+	uint_fast64_t matchLength = 0;
+
+	const RouterNode* node = &router->nodes[ROUTER_ROOT_NODE];
+	uint_fast64_t offset = 0;
+	for(;;){
+		if(node->hasValue && (match == NULL || offset > matchLength) && (offset == pathLength || path[offset] == '/' || (offset > 0 && path[offset - 1] == '/'))){
+			match = node;
+			matchLength = offset;
+
+			memcpy(request->pathParameters, parameters, sizeof(*parameters) * numParameters);
+			request->numPathParameters = numParameters;
+		}
+
+		const RouterNode* next = NULL;
+		uint_fast64_t nextOffset = offset;
+
+		if(offset < pathLength && node->numChildren > 0){
+			const char* index = memchr(router->labels + node->indices, path[offset], node->numChildren);
+			if(index != NULL){
+				const RouterNode* child = &router->nodes[node->firstChild + (index - (router->labels + node->indices))];
+
+				if(child->labelLength <= pathLength - offset && memcmp(router->labels + child->label, path + offset, child->labelLength) == 0){
+					next = child;
+					nextOffset = offset + child->labelLength;
+				}
+			}
+		}
+
+		if(offset < pathLength && node->parameterChild != ROUTER_ROOT_NODE){
+			if(next == NULL){
+				next = router_matchParameter(router, node->parameterChild, path, pathLength, offset, &nextOffset, parameters, &numParameters);
+			}else{
+				fallbackNode = node->parameterChild;
+				fallbackOffset = offset;
+				fallbackNumParameters = numParameters;
+			}
+		}
+
+		// Note: Dead end, unless the path is matched already in full.
+		if(next == NULL && fallbackNode != ROUTER_ROOT_NODE && (match == NULL || matchLength < pathLength)){
+			numParameters = fallbackNumParameters;
+
+			next = router_matchParameter(router, fallbackNode, path, pathLength, fallbackOffset, &nextOffset, parameters, &numParameters);
+
+			fallbackNode = ROUTER_ROOT_NODE;
+		}
+
+		if(next == NULL){
+			break;
+		}
+
+		node = next;
+		offset = nextOffset;
+	}
+
+	if(match == NULL){
+		return ERROR(ERROR_ENTRY_NOT_FOUND);
+	}
+
+	const HTTP_RequestType requestType = request->httpRequestType;
+
+	if(requestType < HTTP_NUM_REQUEST_TYPES){
+		*value = match->values[requestType];
+	}
+
+	// Note: A route for GET answers HEAD as well.
+	if(*value == NULL && requestType == HTTP_REQUEST_TYPE_HEAD){
+		*value = match->values[HTTP_REQUEST_TYPE_GET];
+	}
+
+	if(*value == NULL){
+		*value = match->values[HTTP_REQUEST_TYPE_UNKNOWN];
+	}
+
+	if(*value == NULL){
+		request->numPathParameters = 0;
+
+		return ERROR(ERROR_METHOD_NOT_ALLOWED);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local RouterBuildNode* router_newBuildNode(const char* label, const uint_fast64_t labelLength, const bool parameter){
+	RouterBuildNode* node = calloc(1, sizeof(*node));
+	if(node == NULL){
+		return NULL;
+	}
+
+	node->label = label;
+	node->labelLength = labelLength;
+	node->parameter = parameter;
+
+	return node;
+}
+
+local void router_freeBuildNode(RouterBuildNode* node){
+	if(node == NULL){
+		return;
+	}
+
+	RouterBuildNode* child = node->children;
+	while(child != NULL){
+		RouterBuildNode* nextSibling = child->nextSibling;
+
+		router_freeBuildNode(child);
+
+		child = nextSibling;
+	}
+
+	router_freeBuildNode(node->parameterChild);
+
+	free(node);
+}
+
+local RouterBuildNode* router_findBuildChild(RouterBuildNode* node, const char c){
+	RouterBuildNode* child;
+	for(child = node->children; child != NULL; child = child->nextSibling){
+		if(child->label[0] == c){
+			return child;
+		}
+	}
+
+	return NULL;
+}
+
+// Note: Keeps 'node' in place with the first 'length' characters of its label, everything else moves into a new only child.
+local ERROR_CODE router_splitBuildNode(RouterBuildNode* node, const uint_fast64_t length){
+	RouterBuildNode* suffix = router_newBuildNode(node->label + length, node->labelLength - length, false);
+	if(suffix == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	suffix->children = node->children;
+	suffix->parameterChild = node->parameterChild;
+	suffix->hasValue = node->hasValue;
+	memcpy(suffix->values, node->values, sizeof(node->values));
+
+	node->labelLength = length;
+	node->children = suffix;
+	node->parameterChild = NULL;
+	node->hasValue = false;
+	memset(node->values, 0, sizeof(node->values));
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+local void router_countBuildNodes(RouterBuildNode* node, uint_fast64_t* numNodes, uint_fast64_t* labelsLength){
+	*numNodes += 1;
+	*labelsLength += node->labelLength;
+
+	RouterBuildNode* child;
+	for(child = node->children; child != NULL; child = child->nextSibling){
+		// Note: One index character per static child.
+		*labelsLength += 1;
+
+		router_countBuildNodes(child, numNodes, labelsLength);
+	}
+
+	if(node->parameterChild != NULL){
+		router_countBuildNodes(node->parameterChild, numNodes, labelsLength);
+	}
+}
+
+local void router_flattenBuildNode(Router* router, RouterBuildNode* buildNode, const uint_fast64_t index, uint_fast64_t* nextNode, uint_fast64_t* nextLabel){
+	RouterNode* node = &router->nodes[index];
+
+	memcpy(node->values, buildNode->values, sizeof(node->values));
+	node->hasValue = buildNode->hasValue;
+	node->parameter = buildNode->parameter;
+
+	node->label = *nextLabel;
+	node->labelLength = buildNode->labelLength;
+	memcpy(router->labels + *nextLabel, buildNode->label, buildNode->labelLength);
+	*nextLabel += buildNode->labelLength;
+
+	uint_fast64_t numChildren = 0;
+
+	RouterBuildNode* child;
+	for(child = buildNode->children; child != NULL; child = child->nextSibling){
+		router->labels[*nextLabel + numChildren] = child->label[0];
+
+		numChildren++;
+	}
+
+	node->numChildren = numChildren;
+	node->indices = *nextLabel;
+	node->firstChild = *nextNode;
+
+	*nextLabel += numChildren;
+	*nextNode += numChildren;
+
+	if(buildNode->parameterChild != NULL){
+		node->parameterChild = (*nextNode)++;
+	}
+
+	// Note: 'node' must not be used past this point, the recursion writes to the same array.
+	const uint_fast64_t firstChild = node->firstChild;
+	const uint_fast64_t parameterChild = node->parameterChild;
+
+	uint_fast64_t i = 0;
+	for(child = buildNode->children; child != NULL; child = child->nextSibling){
+		router_flattenBuildNode(router, child, firstChild + i++, nextNode, nextLabel);
+	}
+
+	if(buildNode->parameterChild != NULL){
+		router_flattenBuildNode(router, buildNode->parameterChild, parameterChild, nextNode, nextLabel);
+	}
+}
+
+// Note: A path parameter captures the rest of the segment, it never matches an empty one.
+local const RouterNode* router_matchParameter(const Router* router, const uint_fast64_t index, const char* path, const uint_fast64_t pathLength, const uint_fast64_t offset, uint_fast64_t* nextOffset, HTTP_PathParameter* parameters, uint_fast8_t* numParameters){
+	uint_fast64_t end = offset;
+	while(end < pathLength && path[end] != '/'){
+		end++;
+	}
+
+	if(end == offset || *numParameters == HTTP_MAX_PATH_PARAMETERS){
+		return NULL;
+	}
+
+	const RouterNode* node = &router->nodes[index];
+
+	HTTP_PathParameter* parameter = &parameters[(*numParameters)++];
+	parameter->name = router->labels + node->label;
+	parameter->nameLength = node->labelLength;
+	parameter->value = path + offset;
+	parameter->valueLength = end - offset;
+
+	*nextOffset = end;
+
+	return node;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "util.h"
+#include "http.h"
+
+// Note: Compressed radix trie mapping request paths to values. Routes get registered with 'router_add' and compiled once by 'router_compile' into a flat node array, lookups afterwards neither allocate nor lock.
+// Routes match by longest prefix on segment boundaries, '/img' matches '/img', '/img/' and '/img/a/b.png' but not '/imgs'. Segments of the form ':name' match any single non empty segment and are handed to the request as path parameter.
+
+// Note: The root has an empty label and is never a child, so 0 doubles as 'no parameter child'.
+#define ROUTER_ROOT_NODE 0
+
+typedef struct routerBuildNode{
+	// Note: Points into the registered path, which has to stay valid until 'router_compile' returned.
+	const char* label;
+	uint_fast64_t labelLength;
+	bool parameter;
+	struct routerBuildNode* children;
+	struct routerBuildNode* nextSibling;
+	struct routerBuildNode* parameterChild;
+	void* values[HTTP_NUM_REQUEST_TYPES];
+	bool hasValue;
+}RouterBuildNode;
+
+typedef struct{
+	// Note: Indexed by HTTP_RequestType, 'HTTP_REQUEST_TYPE_UNKNOWN' holds the value for every method.
+	void* values[HTTP_NUM_REQUEST_TYPES];
+	uint32_t label;
+	uint32_t labelLength;
+	// Note: Static children are stored next to each other, 'indices' holds the first character of each of their labels.
+	uint32_t firstChild;
+	uint32_t indices;
+	uint32_t parameterChild;
+	uint16_t numChildren;
+	bool parameter;
+	bool hasValue;
+}RouterNode;
+
+typedef struct{
+	RouterBuildNode* root;
+	RouterNode* nodes;
+	char* labels;
+	uint_fast64_t numNodes;
+}Router;
+
+void router_init(Router*);
+
+void router_free(Router*);
+
+ERROR_CODE router_add(Router*, const HTTP_RequestType, const char*, const uint_fast64_t, void*);
+
+ERROR_CODE router_compile(Router*);
+
+ERROR_CODE router_lookup(const Router*, HTTP_Request*, void**);
+
+#endif
@@ -15,15 +15,25 @@
 
 #include "util.c"
 #include "server.h"
+#include "arena.c"
 #include "linkedList.c"
 #include "arrayList.c"
 #include "threadPool.c"
 #include "properties.c"
 #include "http.c"
+#include "http2.c"
+#include "router.c"
 #include "cache.c"
+#include "errorPage.c"
 #include "argumentParser.c"
+#include "ioUring.c"
 
-THREAD_POOL_RUNNABLE_(epoll_run, Server, server);
+#include <linux/filter.h>
+#include <netinet/tcp.h>
+
+THREAD_POOL_RUNNABLE_(epoll_run, EpollWorker, worker);
+
+THREAD_POOL_RUNNABLE_(ioUring_run, EpollWorker, worker);
 
 local Server* server;
 
@@ -35,6 +45,9 @@ local Server* server;
 #endif
 	ERROR_CODE error;
 
+	// Note: Has to happen before any thread gets started.
+	util_setScanImplementation(util_detectScanImplementation());
+
 		ArgumentParser parser;
 		if((error = argumentParser_init(&parser)) != ERROR_NO_ERROR){
 			goto label_return;
@@ -163,19 +176,39 @@ ERROR_CODE server_writeTemplatePropertyFileToDisk(char* propertyFileLocation, co
 port = \n \
 daemonize = false\n \
 num_worker_threads = 1\n \
+// 'shared' one accept loop feeding all workers, 'sharded' one SO_REUSEPORT listener and epoll instance per worker.\n \
+listener_mode = shared\n \
 http_root_directory = \n \
 custom_error_pages_directoory = \n \
 logfile_directory = \n \
 epoll_event_buffer_size = 32\n \
 // Size in MB.\n \
 http_cache_size = 256\n \
-error_page_cache_size = 4\n \
+// Size in KB. Larger files are streamed from disk instead of being cached.\n \
+http_max_cached_file_size = 4096\n \
+// 'none' cached files are copied onto the heap, 'lazy', 'willneed' and 'populate' serve them from read only mappings of the page cache that are faulted in on first use, read ahead in the background or read completely while loading. Mapped files must be replaced instead of rewritten in place.\n \
+http_cache_file_mapping = none\n \
+// Ask for transparent huge pages on mapped files.\n \
+http_cache_huge_pages = false\n \
 // Max architecture independant guaranteed size is 2pow(16) or 65_535 Bytes.\n \
 http_read_buffer_size = 8096\n \
+// Seconds a connection may wait for the client before it gets closed.\n \
+keep_alive_timeout = 5\n \
+// Seconds a response may wait for the client to take more of it, e.g. while a download is paused, before the connection gets closed.\n \
+send_timeout = 60\n \
+keep_alive_max_requests = 100\n \
+// 'epoll' readiness based event loops, 'io_uring' completion based event loops with multishot accept and receive.\n \
+network_backend = epoll\n \
+// File extensions and content types ('<type> <extension>*' per line) on top of the built-in ones, the server falls back to the built-in ones alone if the file can't be loaded.\n \
+mime_types_file = /etc/mime.types\n \
 \n \
 # Security\n \
 ssl_privateKeyFile = \n \
 ssl_certificate = \n \
+// Let the kernel encrypt and send static files with 'sendfile' where supported (epoll backend only).\n \
+ssl_kernel_tls = true\n \
+// Offer HTTP/2 during the TLS handshake (ALPN), clients without it keep using HTTP/1.1.\n \
+http2 = true\n \
 \n \
 work_directory = \n \
 system_log_id = herder_server";
@@ -243,6 +276,43 @@ ERROR_CODE server_init(Server* server, char* propertyFileLocation, const int_fas
 		server_daemonize();
 	}
 
+	// ListenerMode.
+	const char* listenerMode = SERVER_GET_PROPERTY_OR_DEFAULT(server, LISTENER_MODE);
+
+	if(strncmp(listenerMode, CONSTANTS_LISTENER_MODE_SHARED, strlen(CONSTANTS_LISTENER_MODE_SHARED) + 1) == 0){
+		server->listenerMode = SERVER_LISTENER_MODE_SHARED;
+	}else if(strncmp(listenerMode, CONSTANTS_LISTENER_MODE_SHARDED, strlen(CONSTANTS_LISTENER_MODE_SHARDED) + 1) == 0){
+		server->listenerMode = SERVER_LISTENER_MODE_SHARDED;
+	}else{
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tProperty '%s' value '%s' has to be either '%s' or '%s'.", CONSTANTS_LISTENER_MODE_PROPERTY_NAME, listenerMode, CONSTANTS_LISTENER_MODE_SHARED, CONSTANTS_LISTENER_MODE_SHARDED);
+
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	// NetworkBackend.
+	const char* networkBackend = SERVER_GET_PROPERTY_OR_DEFAULT(server, NETWORK_BACKEND);
+
+	if(strncmp(networkBackend, CONSTANTS_NETWORK_BACKEND_EPOLL, strlen(CONSTANTS_NETWORK_BACKEND_EPOLL) + 1) == 0){
+		server->networkBackend = SERVER_NETWORK_BACKEND_EPOLL;
+	}else if(strncmp(networkBackend, CONSTANTS_NETWORK_BACKEND_IO_URING, strlen(CONSTANTS_NETWORK_BACKEND_IO_URING) + 1) == 0){
+		server->networkBackend = SERVER_NETWORK_BACKEND_IO_URING;
+	}else{
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tProperty '%s' value '%s' has to be either '%s' or '%s'.", CONSTANTS_NETWORK_BACKEND_PROPERTY_NAME, networkBackend, CONSTANTS_NETWORK_BACKEND_EPOLL, CONSTANTS_NETWORK_BACKEND_IO_URING);
+
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	// MimeTypesFile.
+	const char* mimeTypesFile = SERVER_GET_PROPERTY_OR_DEFAULT(server, MIME_TYPES_FILE);
+
+	if((error = http_initMimeTypeRegistry(mimeTypesFile)) != ERROR_NO_ERROR){
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tFailed to load '%s' (%s), only the built-in content types are available.", mimeTypesFile, util_toErrorString(error));
+
+		if((error = http_initMimeTypeRegistry(NULL)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}
+
 	// WorkDirectory.
 	PROPERTIES_GET(&server->properties, server->workDirectory, WORK_DIRECTORY);
 
@@ -279,6 +349,44 @@ ERROR_CODE server_init(Server* server, char* propertyFileLocation, const int_fas
 		return ERROR(error);
 	}
 
+	// HTTP read buffer size.
+	Property* httpReadBufferSizeProperty;
+	PROPERTIES_GET(&server->properties, httpReadBufferSizeProperty, HTTP_READ_BUFFER_SIZE);
+
+	int_fast64_t httpReadBufferSize;
+	if((error = util_stringToInt(httpReadBufferSizeProperty->value, &httpReadBufferSize)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	server->httpReadBufferSize = httpReadBufferSize;
+
+	// KeepAlive.
+	int_fast64_t keepAliveTimeout;
+	if((error = util_stringToInt(SERVER_GET_PROPERTY_OR_DEFAULT(server, KEEP_ALIVE_TIMEOUT), &keepAliveTimeout)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	int_fast64_t keepAliveMaxRequests;
+	if((error = util_stringToInt(SERVER_GET_PROPERTY_OR_DEFAULT(server, KEEP_ALIVE_MAX_REQUESTS), &keepAliveMaxRequests)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	int_fast64_t sendTimeout;
+	if((error = util_stringToInt(SERVER_GET_PROPERTY_OR_DEFAULT(server, SEND_TIMEOUT), &sendTimeout)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	if(keepAliveTimeout < 1 || keepAliveMaxRequests < 1 || sendTimeout < 1){
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tProperties '%s', '%s' and '%s' have to be at least '1'.", CONSTANTS_KEEP_ALIVE_TIMEOUT_PROPERTY_NAME, CONSTANTS_KEEP_ALIVE_MAX_REQUESTS_PROPERTY_NAME, CONSTANTS_SEND_TIMEOUT_PROPERTY_NAME);
+
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	// Note: Stored in milliseconds to match 'util_getMonotonicTimeMillis'.
+	server->keepAliveTimeout = keepAliveTimeout * 1000;
+	server->sendTimeout = sendTimeout * 1000;
+	server->keepAliveMaxRequests = keepAliveMaxRequests;
+
 	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tInitialising worker thread poll...");
 	if((error = threadPool_init(&server->epollWorkerThreads, numWorkerThreads)) != ERROR_NO_ERROR){
 		return ERROR(error);
@@ -288,41 +396,83 @@ ERROR_CODE server_init(Server* server, char* propertyFileLocation, const int_fas
 		return ERROR(error);
 	}
 
-	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tCreating server socket...");
-	
-	// Create server socket.
-	struct sockaddr_in6 serverSocketAddress = {0};
-	serverSocketAddress.sin6_flowinfo = 0;
-	serverSocketAddress.sin6_family = AF_INET6;
-	serverSocketAddress.sin6_port = htons(1869);
-	serverSocketAddress.sin6_addr = in6addr_any;
+	// Port.
+	PROPERTIES_GET(&server->properties, server->port, PORT);
 
-	server->socketFileDescriptor = socket(serverSocketAddress.sin6_family, SOCK_STREAM, 0);
-	if(server->socketFileDescriptor == 0){		
-		return ERROR(ERROR_UNIX_DOMAIN_SOCKET_INITIALISATION_FAILED);
-	}
- 	if(bind(server->socketFileDescriptor, (struct sockaddr*) &serverSocketAddress, sizeof(serverSocketAddress)) != 0){
-		return ERROR(ERROR_FAILED_TO_BIND_SERVER_SOCKET);
+	int_fast64_t port;
+	if((error = util_stringToInt(server->port->value, &port)) != ERROR_NO_ERROR){
+		return ERROR(error);
 	}
 
-	if(listen(server->socketFileDescriptor, 1) < 0){
-		return ERROR(ERROR_FAILED_TO_LISTEN_ON_SERVER_SOCKET);
+	if(server->listenerMode == SERVER_LISTENER_MODE_SHARED){
+		UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tCreating server socket...");
+
+		if((error = server_createListeningSocket(&server->socketFileDescriptor, port, false)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+
+		// Note: io_uring workers arm their accepts directly on the shared socket.
+		if(server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+			if((error = server_initEpoll(server)) != ERROR_NO_ERROR){
+				return ERROR(error);
+			}
+		}else{
+			server->epollAcceptFileDescriptor = -1;
+			server->epollClientHandlingFileDescriptor = -1;
+		}
+	}else{
+		server->socketFileDescriptor = -1;
+		server->epollAcceptFileDescriptor = -1;
+		server->epollClientHandlingFileDescriptor = -1;
 	}
-	if((error = server_initEpoll(server)) != ERROR_NO_ERROR){
+
+	if((error = server_initEpollWorkers(server, port)) != ERROR_NO_ERROR){
 		return ERROR(error);
 	}
 
 	// TODO: Pull cache size from settings. (jan - 2022.10.01)
-	// 'www' directory cache.
+	// 'www' directory cache, every worker is one of its readers.
 	if((error = cache_init(&server->cache, server->epollWorkerThreads.numWorkers, MB(64)))){
 		return ERROR(error);
 	}
 
-	// Error page cache.
-	if((error = cache_init(&server->errorPageCache, server->epollWorkerThreads.numWorkers, MB(2)))){
+	if((error = server_compileErrorPages(server)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	int_fast64_t maxCachedFileSize;
+	if((error = util_stringToInt(SERVER_GET_PROPERTY_OR_DEFAULT(server, HTTP_MAX_CACHED_FILE_SIZE), &maxCachedFileSize)) != ERROR_NO_ERROR){
 		return ERROR(error);
 	}
 
+	if(maxCachedFileSize < 0 || (uint_fast64_t) maxCachedFileSize > server->cache.maxSize >> 10){
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tProperty '%s' has to be between '0' and the cache size.", CONSTANTS_HTTP_MAX_CACHED_FILE_SIZE_PROPERTY_NAME);
+
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	server->maxCachedFileSize = KB(maxCachedFileSize);
+
+	// CacheFileMapping.
+	const char* fileMapping = SERVER_GET_PROPERTY_OR_DEFAULT(server, HTTP_CACHE_FILE_MAPPING);
+
+	CacheFileMapping cacheFileMapping;
+	if(strncmp(fileMapping, CONSTANTS_HTTP_CACHE_FILE_MAPPING_NONE, strlen(CONSTANTS_HTTP_CACHE_FILE_MAPPING_NONE) + 1) == 0){
+		cacheFileMapping = CACHE_FILE_MAPPING_NONE;
+	}else if(strncmp(fileMapping, CONSTANTS_HTTP_CACHE_FILE_MAPPING_LAZY, strlen(CONSTANTS_HTTP_CACHE_FILE_MAPPING_LAZY) + 1) == 0){
+		cacheFileMapping = CACHE_FILE_MAPPING_LAZY;
+	}else if(strncmp(fileMapping, CONSTANTS_HTTP_CACHE_FILE_MAPPING_WILLNEED, strlen(CONSTANTS_HTTP_CACHE_FILE_MAPPING_WILLNEED) + 1) == 0){
+		cacheFileMapping = CACHE_FILE_MAPPING_WILLNEED;
+	}else if(strncmp(fileMapping, CONSTANTS_HTTP_CACHE_FILE_MAPPING_POPULATE, strlen(CONSTANTS_HTTP_CACHE_FILE_MAPPING_POPULATE) + 1) == 0){
+		cacheFileMapping = CACHE_FILE_MAPPING_POPULATE;
+	}else{
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tProperty '%s' value '%s' has to be one of '%s', '%s', '%s' or '%s'.", CONSTANTS_HTTP_CACHE_FILE_MAPPING_PROPERTY_NAME, fileMapping, CONSTANTS_HTTP_CACHE_FILE_MAPPING_NONE, CONSTANTS_HTTP_CACHE_FILE_MAPPING_LAZY, CONSTANTS_HTTP_CACHE_FILE_MAPPING_WILLNEED, CONSTANTS_HTTP_CACHE_FILE_MAPPING_POPULATE);
+
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	cache_setFileMapping(&server->cache, cacheFileMapping, strncmp(SERVER_GET_PROPERTY_OR_DEFAULT(server, HTTP_CACHE_HUGE_PAGES), "true", 5) == 0);
+
 	// HTML/Static pages
 	server_addContext(server, "/", server_defaultContextHandler);
 	server_addContext(server, "/img", server_defaultContextHandler);
@@ -331,35 +481,34 @@ ERROR_CODE server_init(Server* server, char* propertyFileLocation, const int_fas
 	return ERROR(ERROR_NO_ERROR);
 }
 
-THREAD_POOL_RUNNABLE_(epoll_run, Server, server){
-	ERROR_CODE error;
+THREAD_POOL_RUNNABLE_(epoll_run, EpollWorker, worker){
+	ERROR_CODE error = ERROR_NO_ERROR;
 
-	Property* httpReadBufferSizeProperty;
-	PROPERTIES_GET(&server->properties, httpReadBufferSizeProperty, HTTP_READ_BUFFER_SIZE);
+	Server* server = worker->server;
 
-	char* httpReadBufferSizeString = alloca(sizeof(*httpReadBufferSizeString) * (httpReadBufferSizeProperty->dataLength + 1));
-	memcpy(httpReadBufferSizeString, httpReadBufferSizeProperty->value, httpReadBufferSizeProperty->dataLength);
-	httpReadBufferSizeString[httpReadBufferSizeProperty->dataLength] = '\0';
+	server_pinWorkerToCPU(worker);
 
-	int_fast64_t httpReadBufferSize;
-	if((error = util_stringToInt(httpReadBufferSizeString, &httpReadBufferSize)) != ERROR_NO_ERROR){
+	Property* epollEventBufferSizeProperty;
+	PROPERTIES_GET(&server->properties, epollEventBufferSizeProperty, EPOLL_EVENT_BUFFER_SIZE);
+
+	int_fast64_t epollEventBufferSize;
+	if((error = util_stringToInt(epollEventBufferSizeProperty->value, &epollEventBufferSize)) != ERROR_NO_ERROR){
 		THREAD_POOL_RUNNABLE_RETURN(error);
 	}
 
-	Property* epollReadBufferSizePoroperty;
-	PROPERTIES_GET(&server->properties, epollReadBufferSizePoroperty, HTTP_READ_BUFFER_SIZE);
-
-	char* epollReadBufferSizeString = alloca(sizeof(*epollReadBufferSizeString) * (epollReadBufferSizePoroperty->dataLength + 1));
-	memcpy(epollReadBufferSizeString, epollReadBufferSizePoroperty->value, epollReadBufferSizePoroperty->dataLength);
-	epollReadBufferSizeString[epollReadBufferSizePoroperty->dataLength] = '\0';
+	struct epoll_event* epollEventBuffer = malloc(sizeof(*epollEventBuffer) * epollEventBufferSize);
+	if(epollEventBuffer == NULL){
+		error = ERROR_OUT_OF_MEMORY;
 
-	int_fast64_t epollReadBufferSize;
-	if((error = util_stringToInt(epollReadBufferSizeString, &epollReadBufferSize)) != ERROR_NO_ERROR){
-		THREAD_POOL_RUNNABLE_RETURN_(int, ERROR_FAILED_TO_RETRIEV_FILE_INFO);
+		THREAD_POOL_RUNNABLE_RETURN(error);
 	}
 
-	struct epoll_event* epollEventBuffer;
-	epollEventBuffer = malloc(sizeof(struct epoll_event) * epollReadBufferSize);
+	// Note: Allocated by the worker thread itself, so its pages end up close to the core it is pinned to.
+	if((error = arena_init(&worker->arena, SERVER_ARENA_BLOCK_SIZE)) != ERROR_NO_ERROR){
+		free(epollEventBuffer);
+
+		THREAD_POOL_RUNNABLE_RETURN(error);
+	}
 
 	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: Epoll worker entering event loop...");
 
@@ -367,360 +516,1920 @@ THREAD_POOL_RUNNABLE_(epoll_run, Server, server){
 		sigset_t signalMask;
 		sigemptyset(&signalMask);
 		
-		int numberEvents = epoll_pwait(server->epollClientHandlingFileDescriptor, epollEventBuffer, epollReadBufferSize, -1, &signalMask);
+		// Note: Cache objects are only held while events get processed, a worker that waits for events holds none.
+		cache_offline(&server->cache, worker->id);
 
-		if(numberEvents == -1){
-			break;
-		}
+		const int numberEvents = epoll_pwait(worker->epollFileDescriptor, epollEventBuffer, epollEventBufferSize, SERVER_IDLE_SWEEP_INTERVAL, &signalMask);
 
-		char readBuffer[httpReadBufferSize];
+		cache_online(&server->cache, worker->id);
 
-		for(int i = 0; i < numberEvents; ++i){
-			// Init SSL.
-			SSL* sslInstance = SSL_new(server->sslContext);
-			SSL_set_ciphersuites(sslInstance, "TLS_AES_256_GCM_SHA384");
-			SSL_set_fd(sslInstance, epollEventBuffer[i].data.fd);
+		if(numberEvents <= 0){
+			int running;
+			if((numberEvents == 0 || errno == EINTR) && sem_getvalue(&server->running, &running) == 0 && running == 0){
+				server_expireIdleConnections(worker);
 
-			for(;;){
-				const int accept = SSL_accept(sslInstance);
+				continue;
+			}
 
-				// Success.
-				if(accept == 1){
-					break;
-				}else if(accept == -1){
-					const int sslError = SSL_get_error(sslInstance, accept);
+			break;
+		}
 
-					if(sslError == SSL_ERROR_WANT_READ || sslError == SSL_ERROR_WANT_WRITE){
-						// The action depends on the underlying BIO . When using a non-blocking socket, nothing is to be done, but select() can be used to check for the required condition.					
-						struct timespec sleepRequest = {1, 0};
-						struct timespec sleepRemaining;
-						
-						nanosleep(&sleepRequest, &sleepRemaining);		
+		int i;
+		for(i = 0; i < numberEvents; ++i){
+			Connection* connection = epollEventBuffer[i].data.ptr;
 
-						continue;				
-					}
-				}else{
-					goto label_closeSSL_Connection;
-				}
-			}
+			// Sharded listener, accept all pending connections into this workers epoll instance.
+			if(connection == NULL){
+				server_acceptConnections(worker, worker->socketFileDescriptor);
 
-			uint_fast64_t readBufferOffset = 0;
-			for(;;){
-				// Note: SSL_read...with a maximum record size of 16kB for SSLv3/TLSv1).
-				int_fast32_t bytesRead = SSL_read(sslInstance, readBuffer + readBufferOffset, httpReadBufferSize / 4);
+				continue;
+			}
 
-				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tSSL_read (%" PRIdFAST32 ") bytes.", bytesRead);
+			server_processConnection(worker, connection);
+		}
 
-				if(bytesRead > 0){
-					readBufferOffset += bytesRead;
+		server_expireIdleConnections(worker);
+	}
 
-					continue;
-				}else if(bytesRead == 0){
-					const int sslError = SSL_get_error(sslInstance, bytesRead);
+	cache_offline(&server->cache, worker->id);
 
-					UTIL_LOG_CONSOLE_(LOG_ERR, "Worker: \tbytesRead = 0 '%s'.", ERR_error_string(SSL_get_error(sslInstance, bytesRead), NULL));
+	arena_free(&worker->arena);
 
-					if(sslError ==SSL_ERROR_WANT_READ){
-						// When using a non-blocking socket, nothing is to be done, but select() can be used to check for the required condition.
-						UTIL_LOG_CONSOLE(LOG_DEBUG, "SSL_ERROR_WANT_READ.");
+	free(epollEventBuffer);
+	
+	THREAD_POOL_RUNNABLE_RETURN_(int, error);
+}
 
-						sched_yield();
-					}else if(sslError == SSL_ERROR_WANT_WRITE){
-						UTIL_LOG_CONSOLE(LOG_DEBUG, "SSL_ERROR_WANT_WRITE.");
+THREAD_POOL_RUNNABLE_(ioUring_run, EpollWorker, worker){
+	ERROR_CODE error = ERROR_NO_ERROR;
 
-						sched_yield();
-					}else if(sslError == SSL_RECEIVED_SHUTDOWN){
-						UTIL_LOG_CONSOLE(LOG_DEBUG, "SSL_RECEIVED_SHUTDOWN.");
+	Server* server = worker->server;
 
-						break;
-					}else if(sslError == SSL_ERROR_ZERO_RETURN){
-						UTIL_LOG_CONSOLE(LOG_DEBUG, "SSL_ERROR_ZERO_RETURN.");
+	server_pinWorkerToCPU(worker);
 
-						break;
-					}
-				}else{
-					const int sslError = SSL_get_error(sslInstance, bytesRead);
+	// Note: The ring has to be created by the thread that submits to it.
+	IoUring ring;
+	if((error = ioUring_init(&ring, SERVER_IO_URING_QUEUE_DEPTH)) != ERROR_NO_ERROR){
+		THREAD_POOL_RUNNABLE_RETURN(error);
+	}
 
-					if(sslError == SSL_ERROR_NONE){
-						UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tSSL_ERROR_NONE.");
-					}else if(sslError == SSL_RECEIVED_SHUTDOWN){
-						UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tSSL_RECEIVED_SHUTDOWN.");
+	if((error = ioUring_registerBuffers(&ring, SERVER_IO_URING_RECEIVE_BUFFER_GROUP, SERVER_IO_URING_NUM_RECEIVE_BUFFERS, SERVER_IO_URING_RECEIVE_BUFFER_SIZE)) != ERROR_NO_ERROR){
+		ioUring_free(&ring);
 
-						sleep(1);
-					}
+		THREAD_POOL_RUNNABLE_RETURN(error);
+	}
 
-					UTIL_LOG_CONSOLE_(LOG_ERR, "%s", ERR_error_string(sslError, NULL));
+	if((error = arena_init(&worker->arena, SERVER_ARENA_BLOCK_SIZE)) != ERROR_NO_ERROR){
+		ioUring_free(&ring);
 
-					break;
-				}
-			}
+		THREAD_POOL_RUNNABLE_RETURN(error);
+	}
 
-			uint_fast64_t bytesRead = readBufferOffset;
-			if(bytesRead > 0){
-				HTTP_Request request = {0};
-				if((error = http_parseHTTP_Request(&request, readBuffer, bytesRead)) != ERROR_NO_ERROR){
-					UTIL_LOG_CONSOLE_(LOG_DEBUG, "Failed to parse HTTP request. [%s]", util_toErrorString(error));
-				} 
+	worker->ring = &ring;
 
-				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tRequest URL:'%s'.", request.requestURL);
+	server_ioUringArmAccept(worker);
 
-				HTTP_Response response;
-				http_initHttpResponse(&response, readBuffer, httpReadBufferSize);
+	// Wakes the worker up to expire idle connections and to check if the server is still running.
+	struct __kernel_timespec sweepInterval = {0};
+	sweepInterval.tv_sec = SERVER_IDLE_SWEEP_INTERVAL / 1000;
+	sweepInterval.tv_nsec = (SERVER_IDLE_SWEEP_INTERVAL % 1000) * 1000000;
 
-				UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tRetrieving context handler...");
+	server_ioUringArmTimeout(worker, &sweepInterval);
 
-				ContextHandler* contextHandler;
-				if((error = server_getContextHandler(server, &contextHandler, &request)) != ERROR_NO_ERROR){
-					UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to retrieve http context handler. [%s]", util_toErrorString(error));
+	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: io_uring worker entering event loop...");
 
-					if((error = server_constructErrorPage(server, &request, &response, _401_UNAUTHORIZED)) != ERROR_NO_ERROR){
-						UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to construct error page. (%s)." , util_toErrorString(error));
-					}
-				}
+	bool running = true;
+	while(running){
+		sigset_t signalMask;
+		sigemptyset(&signalMask);
 
-				// Only if we are not sending an error page call the apropriate context handler.
-				if(contextHandler != NULL){
-					if((error = contextHandler(server, &request, &response)) != ERROR_NO_ERROR){
-						if(error == ERROR_FAILED_TO_RETRIEV_FILE_INFO){
-								if((error = server_constructErrorPage(server, &request, &response, _401_UNAUTHORIZED)) != ERROR_NO_ERROR){
-						UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to construct error page. (%s)." , util_toErrorString(error));
-					}
-						}
-					}
-				}
+		if(worker->acceptPending){
+			server_ioUringArmAccept(worker);
+		}
 
-				server_sendResponse(sslInstance, &response);
-			}
+		if(worker->timeoutPending){
+			server_ioUringArmTimeout(worker, &sweepInterval);
+		}
 
-		label_closeSSL_Connection:
-			UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tClosing client connection. [FD:%d].\n", epollEventBuffer[i].data.fd);
+		cache_offline(&server->cache, worker->id);
 
-			epoll_ctl(server->epollClientHandlingFileDescriptor, EPOLL_CTL_DEL, epollEventBuffer[i].data.fd, NULL);
-			close(epollEventBuffer[i].data.fd);
+		// Note: Everything queued while handling the last batch of completions gets submitted with the same system call that waits for the next one.
+		const int ret = ioUring_submitAndWait(&ring, 1, &signalMask);
 
-			SSL_shutdown(sslInstance);
-			SSL_free(sslInstance);
+		cache_online(&server->cache, worker->id);
 
-			error = ERROR_INVALID_SIGNAL;
+		if(ret < 0 && ret != -EINTR && ret != -EBUSY){
+			UTIL_LOG_CONSOLE_(LOG_ERR, "Worker: io_uring_enter failed: '%s'.", strerror(-ret));
 
 			break;
 		}
-	}
-	
-	THREAD_POOL_RUNNABLE_RETURN_(int, error);
-}
 
-ERROR_CODE server_sendResponse(SSL* sslInstance, HTTP_Response* response){
-	ERROR_CODE error = ERROR_NO_ERROR;
-
-	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tSending response...");
-
-	// Note: We use the response buffer which is just the request buffer to build the reposen. If the response content is static the whole buffer is available, if not the response header information gets attached to the end of the data segment. (jan 2022.10.14)
-	int8_t* responseBuffer = response->dataSegment + response->responseDataSegmentLength;
-	const int responseBufferSize = response->responseBufferSize - response->responseDataSegmentLength;
-
-	// Response line.
-	uint_fast64_t writeOffset = snprintf((char*) responseBuffer, responseBufferSize, "%s %" PRIdFAST16 " %s\r\n", http_getVersionString(response->httpVersion), http_getNumericalStatusCode(response->httpStatusCode), http_getStatusMsg(response->httpStatusCode));
+		struct io_uring_cqe* completionQueueEntry;
+		while((completionQueueEntry = ioUring_peekCompletionQueueEntry(&ring)) != NULL){
+			const uint64_t userData = completionQueueEntry->user_data;
+			const int result = completionQueueEntry->res;
+			const uint32_t flags = completionQueueEntry->flags;
 
-	// Header fields.
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &response->httpHeaderFields);
+			ioUring_advanceCompletionQueue(&ring);
 
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		HTTP_HeaderField* headerField = LINKED_LIST_ITERATOR_NEXT_PTR(&it, HTTP_HeaderField);
+			Connection* connection = (Connection*) (uintptr_t) (userData & ~((uint64_t) SERVER_IO_URING_OPERATION_MASK));
 
-		memcpy(responseBuffer + writeOffset, headerField->name, headerField->nameLength);
-		writeOffset += headerField->nameLength;
+			switch(userData & SERVER_IO_URING_OPERATION_MASK){
+				case SERVER_IO_URING_OPERATION_ACCEPT:{
+					server_ioUringHandleAccept(worker, result, flags);
 
-		memcpy(responseBuffer + writeOffset, ": ", 2);
-		writeOffset += 2;
+					break;
+				}
 
-		memcpy(responseBuffer + writeOffset, headerField->value, headerField->valueLength);
-		writeOffset += headerField->valueLength;
+				case SERVER_IO_URING_OPERATION_RECEIVE:{
+					server_ioUringHandleReceive(worker, connection, result, flags);
 
-		memcpy(responseBuffer + writeOffset, "\r\n", 2);
-		writeOffset += 2;
-	}
+					break;
+				}
 
-	// Trailing new line to signal begining of data segment.
-	memcpy(responseBuffer + writeOffset, "\r\n", 2);
-	writeOffset += 2;
+				case SERVER_IO_URING_OPERATION_SEND:{
+					server_ioUringHandleSend(worker, connection, result);
 
-	uint_fast64_t bytesWritten = SSL_write(sslInstance, response->dataSegment + response->responseDataSegmentLength, writeOffset);
-	if(bytesWritten != writeOffset){
-		UTIL_LOG_ERROR_("SSL_Write ERROR, failed to write %" PRIuFAST64 " out of %" PRIuFAST64 " bytes.", writeOffset - bytesWritten, writeOffset);
+					break;
+				}
 
-		error = ERROR_WRITE_ERROR;
-	}
+				case SERVER_IO_URING_OPERATION_TIMEOUT:{
+					server_ioUringArmTimeout(worker, &sweepInterval);
 
-	if(response->staticContent){
-		bytesWritten = SSL_write(sslInstance, response->cacheObject->data, response->cacheObject->size);
-		if(bytesWritten != response->cacheObject->size){
-			UTIL_LOG_ERROR_("SSL_Write ERROR, failed to write %" PRIuFAST64 " out of %" PRIuFAST64 " bytes.", bytesWritten, response->cacheObject->size);
+					break;
+				}
+			}
 		}
-	}else{
-		bytesWritten = SSL_write(sslInstance, response->dataSegment, response->responseDataSegmentLength);
-		if(bytesWritten != response->responseDataSegmentLength){
-			UTIL_LOG_ERROR_("SSL_Write ERROR, failed to write %" PRIuFAST64 " out of %" PRIuFAST64 " bytes.", bytesWritten, response->responseDataSegmentLength);
 
-			error = ERROR_WRITE_ERROR;
+		int serverRunning;
+		if(sem_getvalue(&server->running, &serverRunning) != 0 || serverRunning != 0){
+			running = false;
 		}
+
+		server_expireIdleConnections(worker);
 	}
 
-	return ERROR(error);
-}
+	cache_offline(&server->cache, worker->id);
 
-ERROR_CODE server_constructErrorPage(Server* server, HTTP_Request* request, HTTP_Response* response, HTTP_StatusCode httpStatusCode){
-	ERROR_CODE error;
+	// Note: Closing the ring cancels all operations still in flight.
+	worker->ring = NULL;
 
-	const int_fast16_t nummericalHTTP_StatusCode = http_getNumericalStatusCode(httpStatusCode);
+	ioUring_free(&ring);
 
-	char httpStatusCodeString[4];
-	snprintf(httpStatusCodeString, 4, "%03" PRIdFAST16 "", nummericalHTTP_StatusCode);
+	arena_free(&worker->arena);
 
-	const uint_fast64_t symbolicFileLocationLength = + 5/*".html"*/ + 1/*'/'*/ + 1/*_*/+ 3/*http status code*/;
-	char* symbolicFileLocation = alloca(sizeof(*symbolicFileLocation) * (symbolicFileLocationLength + 1));
-	snprintf(symbolicFileLocation, symbolicFileLocationLength + 1, "/%s.html", httpStatusCodeString);
+	THREAD_POOL_RUNNABLE_RETURN_(int, error);
+}
 
-	SERVER_TRANSLATE_SYMBOLIC_FILE_LOCATION_ERROR_PAGE(fileLocation, server, symbolicFileLocation, symbolicFileLocationLength);
-	
-	CacheObject* cacheObject = NULL;
-	// TODO: Clean up this type cast and see if we cant make the "symbolicFileLocation" parameter in 'cache_get' a constant char pointer.(jan - 2022.09.07)
-	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
-	if((error = cache_get(&server->errorPageCache, &cacheObject, (char*) symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
-		if(error != ERROR_ENTRY_NOT_FOUND){
-			return ERROR(error);
-		}
-		else{
-			SERVER_TRANSLATE_SYMBOLIC_FILE_LOCATION_ERROR_PAGE(fileLocation, server, symbolicFileLocation, symbolicFileLocationLength);
+void server_pinWorkerToCPU(EpollWorker* worker){
+	// Keep every connection of a sharded worker on the same CPU, from accept to close.
+	if(worker->server->listenerMode != SERVER_LISTENER_MODE_SHARDED){
+		return;
+	}
 
-			__UTIL_ENABLE_ERROR_LOGGING__();
-			__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_RETRIEV_FILE_INFO);
-			if((error = cache_load(&server->errorPageCache, &cacheObject, fileLocation, fileLocationLength, (char*) symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
-				if(error != ERROR_FAILED_TO_RETRIEV_FILE_INFO){
-					return ERROR(error);
-				}else{
-					// Load default error page into cache.
-					cache_add(&server->errorPageCache, &cacheObject,(uint8_t*) CONSTANTS_MINIMAL_HTTP_ERROR_PAGE, strlen(CONSTANTS_MINIMAL_HTTP_ERROR_PAGE) + 1, NULL, 0, symbolicFileLocation, symbolicFileLocationLength);
-				}
-			}
-		}
-		__UTIL_ENABLE_ERROR_LOGGING__();
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(worker->id % util_getNumAvailableProcessorCores(), &cpuSet);
+
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Worker: Failed to pin worker [%" PRIuFAST16 "] to CPU.", worker->id);
 	}
+}
 
-	memcpy(response->dataSegment, cacheObject->data, cacheObject->size);
-	response->responseDataSegmentLength = strlen(CONSTANTS_MINIMAL_HTTP_ERROR_PAGE);
+// Note: Drives the connection forward until it either has to wait for the socket, in which case it gets re-armed and must not be touched anymore, or until it got closed.
+void server_processConnection(EpollWorker* worker, Connection* connection){
+	Server* server = worker->server;
 
-	// $errorCode
-	util_replace((char*) response->dataSegment, response->responseBufferSize, &response->responseDataSegmentLength, CONSTANTS_ERROR_PAGE_SEARCH_STRING_ERROR_CODE, strlen(CONSTANTS_ERROR_PAGE_SEARCH_STRING_ERROR_CODE), httpStatusCodeString, 3);
+	server_unmarkConnectionIdle(worker, connection);
 
-	// $errrorMessage
-	const char* errorMessage = http_getStatusMsg(httpStatusCode);
-	const uint_fast64_t errorMessageLength = strlen(errorMessage);
+	for(;;){
+		switch(connection->state){
+			case SERVER_CONNECTION_STATE_HANDSHAKING:{
+				const int accept = SSL_accept(connection->sslInstance);
 
-	util_replace((char*) response->dataSegment, response->responseBufferSize, &response->responseDataSegmentLength, CONSTANTS_ERROR_PAGE_SEARCH_STRING_ERROR_MESSAGE, strlen(CONSTANTS_ERROR_PAGE_SEARCH_STRING_ERROR_MESSAGE), errorMessage, errorMessageLength);
+				// Success.
+				if(accept == 1){
+					const unsigned char* protocol;
+					unsigned int protocolLength;
+					SSL_get0_alpn_selected(connection->sslInstance, &protocol, &protocolLength);
 
-	// $address
-	const HTTP_HeaderField* headerFieldHost = http_getHeaderField(request, CONSTANTS_HTTP_HEADER_FIELD_HOST_NAME);
+					if(protocolLength != 2 || memcmp(protocol, "h2", 2) != 0){
+						connection->state = SERVER_CONNECTION_STATE_READING;
 
-	if(headerFieldHost != NULL){
-		util_replace((char*) response->dataSegment, response->responseBufferSize, &response->responseDataSegmentLength, CONSTANTS_ERROR_PAGE_SEARCH_STRING_ADDRESS, strlen(CONSTANTS_ERROR_PAGE_SEARCH_STRING_ADDRESS), headerFieldHost->value, headerFieldHost->valueLength);
-	}
+						break;
+					}
 
-	// $port
-	if(headerFieldHost != NULL){
-		const int_fast64_t posSplit = util_findLast(headerFieldHost->value, headerFieldHost->valueLength, ':') + 1;
+					if((connection->http2Session = malloc(sizeof(*connection->http2Session))) == NULL){
+						connection->state = SERVER_CONNECTION_STATE_CLOSING;
 
-		if(posSplit != 0){
-			char portString[5];
+						break;
+					}
 
-			int_fast16_t port;						
-			if((error = util_stringToInt(headerFieldHost->value + posSplit, &port)) != ERROR_NO_ERROR){
-				UTIL_LOG_ERROR(util_toErrorString(error));
-			}
-			const int_fast64_t portLength = snprintf(portString, 5, "%" PRIdFAST16 "", port);
-		
-			util_replace((char*) response->dataSegment, response->responseBufferSize, &response->responseDataSegmentLength, CONSTANTS_ERROR_PAGE_SEARCH_STRING_PORT, strlen(CONSTANTS_ERROR_PAGE_SEARCH_STRING_PORT), portString, portLength);
-		}
-	}
+					http2_initSession(connection->http2Session);
 
-	response->httpStatusCode = httpStatusCode;
+					connection->state = SERVER_CONNECTION_STATE_HTTP2;
 
-	response->httpContentType = HTTP_CONTENT_TYPE_TEXT_HTML;
+					break;
+				}
 
-	UTIL_INT_TO_STRING_HEAP_ALLOCATED(contentLengthString, response->responseDataSegmentLength);
-	HTTP_ADD_HEADER_FIELD(response, Content-Length, contentLengthString);
+				const int sslError = SSL_get_error(connection->sslInstance, accept);
 
-	HTTP_ADD_HEADER_FIELD(response, Content-Type, http_contentTypeToString(response->httpContentType));
+				if(sslError == SSL_ERROR_WANT_READ){
+					server_awaitClient(worker, connection, EPOLLIN, false);
 
-	HTTP_ADD_HEADER_FIELD(response, Connection, "Closed");
-	
-	return ERROR(ERROR_NO_ERROR);
-}
+					return;
+				}else if(sslError == SSL_ERROR_WANT_WRITE){
+					server_awaitClient(worker, connection, EPOLLOUT, false);
 
-SERVER_CONTEXT_HANDLER(server_defaultContextHandler){
-	ERROR_CODE error;
+					return;
+				}
 
-	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tEntering default context handler...");
+				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tTLS handshake failed. [FD:%d].", connection->socketFileDescriptor);
 
-	// Handle that 'index.html' can be reached without '/index.html' in the url.
-	uint_fast64_t symbolicFileLocationLength;
-	char* symbolicFileLocation;
-	if(request->requestURLLength == 1 && request->requestURL[0] == '/'){
-		symbolicFileLocationLength = 11/*"/index.html"*/;
-		symbolicFileLocation = alloca(sizeof(*symbolicFileLocation) * (symbolicFileLocationLength + 1));
+				connection->state = SERVER_CONNECTION_STATE_CLOSING;
 
-		memcpy(symbolicFileLocation, "/index.html", symbolicFileLocationLength);
-		symbolicFileLocation[symbolicFileLocationLength] = '\0';
-	}else{
-		symbolicFileLocationLength = request->requestURLLength;
-		 
-		symbolicFileLocation = alloca(sizeof(*symbolicFileLocation) * (symbolicFileLocationLength + 1));
-		memcpy(symbolicFileLocation, request->requestURL, symbolicFileLocationLength);
-		symbolicFileLocation[symbolicFileLocationLength] = '\0';
-	}
+				break;
+			}
 
-	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tChecking cache for entries...");
+			case SERVER_CONNECTION_STATE_READING:{
+				// Pipelined requests are handled straight out of the read buffer, without waiting for the socket.
+				if(connection->parser.state != HTTP_PARSER_STATE_HEADER){
+					// Note: The rest of the body of a request that got answered already, it gets discarded as it arrives.
+					if(connection->readBufferOffset > 0){
+						uint_fast64_t consumed;
+						const ERROR_CODE error = http_parseBody(&connection->parser, (char*) connection->readBuffer, connection->readBufferOffset, &consumed);
 
-	CacheObject* cacheObject = NULL;
-	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
-	if((error = cache_get(&server->errorPageCache, &cacheObject, (char*) symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
-		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tCache did not contaion an entry for: '%s'.", symbolicFileLocation);
+						memmove(connection->readBuffer, connection->readBuffer + consumed, connection->readBufferOffset - consumed);
+						connection->readBufferOffset -= consumed;
 
-		if(error != ERROR_ENTRY_NOT_FOUND){
-			return ERROR(error);
-		}
-		else{
-			SERVER_TRANSLATE_SYMBOLIC_FILE_LOCATION(fileLocation, server, symbolicFileLocation, symbolicFileLocationLength);
+						if(error == ERROR_NO_ERROR){
+							break;
+						}
 
-			__UTIL_ENABLE_ERROR_LOGGING__();
-			__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_RETRIEV_FILE_INFO);
+						if(error != ERROR_INCOMPLETE){
+							UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tInvalid request body framing. [FD:%d].", connection->socketFileDescriptor);
 
-			UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tLoading cacheobject: '%s' from file: '%s'.", symbolicFileLocation, fileLocation);
-			if((error = cache_load(&server->errorPageCache, &cacheObject, fileLocation, fileLocationLength, (char*) symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
-				UTIL_LOG_CONSOLE(LOG_ERR, "Failed to load cacheObject.");
+							connection->state = SERVER_CONNECTION_STATE_CLOSING;
 
-				return ERROR(error);
-			}
-		}
-		__UTIL_ENABLE_ERROR_LOGGING__();
+							break;
+						}
+					}
+				}else{
+					uint_fast64_t headerLength;
+					if(http_parseHeaderBlock(&connection->parser, (char*) connection->readBuffer, connection->readBufferOffset, &headerLength) == ERROR_NO_ERROR){
+						connection->requestLength = headerLength;
+						connection->state = SERVER_CONNECTION_STATE_HANDLING;
+
+						break;
+					}
+				}
+
+				if(connection->readBufferOffset == connection->readBufferSize){
+					UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tRequest header exceeds read buffer size. [FD:%d].", connection->socketFileDescriptor);
+
+					connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+					break;
+				}
+
+				if(connection->readBuffer == NULL && server_acquireBuffer(worker->connectionPool, &connection->readBuffer) != ERROR_NO_ERROR){
+					connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+					break;
+				}
+
+				// Note: SSL_read...with a maximum record size of 16kB for SSLv3/TLSv1).
+				const int bytesRead = SSL_read(connection->sslInstance, connection->readBuffer + connection->readBufferOffset, connection->readBufferSize - connection->readBufferOffset);
+
+				if(bytesRead > 0){
+					UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tSSL_read (%d) bytes.", bytesRead);
+
+					connection->readBufferOffset += bytesRead;
+
+					break;
+				}
+
+				const int sslError = SSL_get_error(connection->sslInstance, bytesRead);
+
+				if(sslError == SSL_ERROR_WANT_READ || sslError == SSL_ERROR_WANT_WRITE){
+					// Don't hold on to an empty buffer while waiting for the client.
+					if(connection->readBufferOffset == 0){
+						server_releaseBuffer(worker->connectionPool, connection->readBuffer);
+
+						connection->readBuffer = NULL;
+					}
+
+					server_awaitClient(worker, connection, sslError == SSL_ERROR_WANT_READ ? EPOLLIN : EPOLLOUT, false);
+
+					return;
+				}else{
+					if(sslError != SSL_ERROR_ZERO_RETURN && sslError != SSL_ERROR_SYSCALL){
+						UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tSSL_read failed '%s'.", ERR_error_string(ERR_get_error(), NULL));
+					}
+
+					connection->state = SERVER_CONNECTION_STATE_CLOSING;
+				}
+
+				break;
+			}
+
+			case SERVER_CONNECTION_STATE_HANDLING:{
+				if(server_acquireBuffer(worker->connectionPool, &connection->responseBuffer) != ERROR_NO_ERROR){
+					connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+					break;
+				}
+
+				server_handleRequest(server, connection, &worker->arena);
+
+				UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tSending response...");
+
+				const ERROR_CODE error = server_prepareResponse(connection);
+
+				// Note: The header block is serialised, the header fields in the workers arena are not needed anymore. The rest of the response may go out after the connection moved on to another worker.
+				linkedList_free(&connection->response.httpHeaderFields);
+				arena_reset(&worker->arena);
+
+				if(error != ERROR_NO_ERROR){
+					server_finishRequest(connection);
+
+					server_releaseBuffer(worker->connectionPool, connection->responseBuffer);
+					connection->responseBuffer = NULL;
+
+					connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+					break;
+				}
+
+				connection->state = SERVER_CONNECTION_STATE_WRITING;
+
+				break;
+			}
+
+			case SERVER_CONNECTION_STATE_WRITING:{
+				uint32_t awaitEvents;
+				ERROR_CODE error = server_writeResponse(connection, worker->connectionPool, &awaitEvents);
+
+				// The socket buffer is full, continue once the client caught up.
+				if(error == ERROR_NO_ERROR && awaitEvents != 0){
+					server_awaitClient(worker, connection, awaitEvents, true);
+
+					return;
+				}
+
+				server_finishRequest(connection);
+
+				server_releaseBuffer(worker->connectionPool, connection->responseBuffer);
+				connection->responseBuffer = NULL;
+
+				if(error != ERROR_NO_ERROR || !connection->keepAlive){
+					connection->state = SERVER_CONNECTION_STATE_CLOSING;
+				}else{
+					connection->state = SERVER_CONNECTION_STATE_READING;
+				}
+
+				break;
+			}
+
+			case SERVER_CONNECTION_STATE_HTTP2:{
+				if(!server_processHttp2Connection(worker, connection)){
+					return;
+				}
+
+				break;
+			}
+
+			case SERVER_CONNECTION_STATE_CLOSING:{
+				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tClosing client connection. [FD:%d].", connection->socketFileDescriptor);
+
+				// Note: The close notify still has to be sent and the receive has to complete, 'server_ioUringFlush' releases the connection once that happened.
+				if(server->networkBackend == SERVER_NETWORK_BACKEND_IO_URING){
+					SSL_shutdown(connection->sslInstance);
+
+					connection->state = SERVER_CONNECTION_STATE_DRAINING;
+
+					return;
+				}
+
+				epoll_ctl(worker->epollFileDescriptor, EPOLL_CTL_DEL, connection->socketFileDescriptor, NULL);
+
+				SSL_shutdown(connection->sslInstance);
+
+				close(connection->socketFileDescriptor);
+
+				server_releaseConnection(worker, connection);
+
+				return;
+			}
+
+			case SERVER_CONNECTION_STATE_DRAINING:{
+				return;
+			}
+		}
+	}
+}
+
+// Note: Parks the connection until the client is ready for the given events. io_uring connections keep their multishot receive armed, so there is nothing to re-arm. A client that is slow to take a response, e.g. a paused download, gets 'sendTimeout' instead of 'keepAliveTimeout'.
+void server_awaitClient(EpollWorker* worker, Connection* connection, const uint32_t events, const bool sending){
+	server_markConnectionIdle(worker, connection, sending);
+
+	if(worker->server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+		server_rearmConnection(worker, connection, events);
+	}
+}
+
+void server_ioUringHandleAccept(EpollWorker* worker, const int result, const uint32_t flags){
+	if(result >= 0){
+		const int enable = 1;
+		setsockopt(result, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+		Connection* connection;
+		if(server_acquireConnection(worker, &connection, result) != ERROR_NO_ERROR){
+			close(result);
+		}else{
+			// The client speaks first, wait for its 'ClientHello'.
+			server_markConnectionIdle(worker, connection, false);
+
+			if(!server_ioUringArmReceive(worker, connection)){
+				server_unmarkConnectionIdle(worker, connection);
+
+				close(result);
+
+				server_releaseConnection(worker, connection);
+			}else{
+				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tClient connected. [FD:%d].", result);
+			}
+		}
+	}else{
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to accept client connection: '%s'.", strerror(-result));
+	}
+
+	// The kernel ends a multishot accept on errors, re-arm it.
+	if(!(flags & IORING_CQE_F_MORE)){
+		server_ioUringArmAccept(worker);
+	}
+}
+
+void server_ioUringHandleReceive(EpollWorker* worker, Connection* connection, const int result, const uint32_t flags){
+	if(!(flags & IORING_CQE_F_MORE)){
+		connection->receiveArmed = false;
+	}
+
+	if(result > 0){
+		const uint16_t bufferID = flags >> IORING_CQE_BUFFER_SHIFT;
+
+		if(connection->state != SERVER_CONNECTION_STATE_DRAINING){
+			BIO_write(SSL_get_rbio(connection->sslInstance), ioUring_getBuffer(worker->ring, bufferID), result);
+		}
+
+		ioUring_recycleBuffer(worker->ring, bufferID);
+	}else if(result != -ENOBUFS && connection->state != SERVER_CONNECTION_STATE_DRAINING){
+		// Client hung up, or the idle sweep shut the socket down.
+		connection->state = SERVER_CONNECTION_STATE_CLOSING;
+	}
+
+	if(connection->state != SERVER_CONNECTION_STATE_DRAINING){
+		server_processConnection(worker, connection);
+
+		if(connection->state != SERVER_CONNECTION_STATE_DRAINING && !connection->receiveArmed && !server_ioUringArmReceive(worker, connection)){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			server_processConnection(worker, connection);
+		}
+	}
+
+	server_ioUringFlush(worker, connection);
+}
+
+void server_ioUringHandleSend(EpollWorker* worker, Connection* connection, const int result){
+	connection->sendInFlight = false;
+
+	if(result >= 0){
+		connection->sendBufferOffset += result;
+	}
+
+	// Short send, queue the remainder.
+	struct io_uring_sqe* submissionQueueEntry = NULL;
+	if(result >= 0 && connection->sendBufferOffset < connection->sendBufferLength && (submissionQueueEntry = ioUring_getSubmissionQueueEntry(worker->ring)) != NULL){
+		ioUring_prepareSend(submissionQueueEntry, connection->socketFileDescriptor, connection->sendBuffer + connection->sendBufferOffset, connection->sendBufferLength - connection->sendBufferOffset, (uintptr_t) connection | SERVER_IO_URING_OPERATION_SEND);
+
+		connection->sendInFlight = true;
+
+		return;
+	}
+
+	if(result < 0 || connection->sendBufferOffset < connection->sendBufferLength){
+		connection->sendFailed = true;
+
+		if(connection->state != SERVER_CONNECTION_STATE_DRAINING){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			server_processConnection(worker, connection);
+		}
+	}else if(connection->state == SERVER_CONNECTION_STATE_WRITING || connection->state == SERVER_CONNECTION_STATE_HTTP2){
+		// The connection waits for its memory BIO to drain, continue writing the response.
+		server_processConnection(worker, connection);
+	}
+
+	server_ioUringFlush(worker, connection);
+}
+
+// Note: Both leave a flag behind if the submission queue is full, so the event loop arms them once it has room again.
+bool server_ioUringArmAccept(EpollWorker* worker){
+	struct io_uring_sqe* submissionQueueEntry = ioUring_getSubmissionQueueEntry(worker->ring);
+
+	worker->acceptPending = submissionQueueEntry == NULL;
+
+	if(submissionQueueEntry == NULL){
+		return false;
+	}
+
+	ioUring_prepareMultishotAccept(submissionQueueEntry, worker->socketFileDescriptor, SERVER_IO_URING_OPERATION_ACCEPT);
+
+	return true;
+}
+
+bool server_ioUringArmTimeout(EpollWorker* worker, struct __kernel_timespec* interval){
+	struct io_uring_sqe* submissionQueueEntry = ioUring_getSubmissionQueueEntry(worker->ring);
+
+	worker->timeoutPending = submissionQueueEntry == NULL;
+
+	if(submissionQueueEntry == NULL){
+		return false;
+	}
+
+	ioUring_prepareTimeout(submissionQueueEntry, interval, SERVER_IO_URING_OPERATION_TIMEOUT);
+
+	return true;
+}
+
+bool server_ioUringArmReceive(EpollWorker* worker, Connection* connection){
+	struct io_uring_sqe* submissionQueueEntry = ioUring_getSubmissionQueueEntry(worker->ring);
+	if(submissionQueueEntry == NULL){
+		return false;
+	}
+
+	ioUring_prepareMultishotReceive(submissionQueueEntry, connection->socketFileDescriptor, SERVER_IO_URING_RECEIVE_BUFFER_GROUP, (uintptr_t) connection | SERVER_IO_URING_OPERATION_RECEIVE);
+
+	connection->receiveArmed = true;
+
+	return true;
+}
+
+// Note: Sends whatever OpenSSL produced since the last send, one send per connection in flight at a time. Releases draining connections once nothing is in flight anymore.
+void server_ioUringFlush(EpollWorker* worker, Connection* connection){
+	if(connection->sendInFlight){
+		return;
+	}
+
+	BIO* writeBIO = SSL_get_wbio(connection->sslInstance);
+
+	if(connection->sendFailed){
+		BIO_reset(writeBIO);
+	}
+
+	if(BIO_ctrl_pending(writeBIO) > 0){
+		if(connection->sendBuffer == NULL && server_acquireBuffer(worker->connectionPool, &connection->sendBuffer) != ERROR_NO_ERROR){
+			connection->sendFailed = true;
+
+			BIO_reset(writeBIO);
+		}else{
+			const int length = BIO_read(writeBIO, connection->sendBuffer, worker->connectionPool->bufferSize);
+
+			struct io_uring_sqe* submissionQueueEntry = ioUring_getSubmissionQueueEntry(worker->ring);
+
+			if(length > 0 && submissionQueueEntry != NULL){
+				ioUring_prepareSend(submissionQueueEntry, connection->socketFileDescriptor, connection->sendBuffer, length, (uintptr_t) connection | SERVER_IO_URING_OPERATION_SEND);
+
+				connection->sendBufferLength = length;
+				connection->sendBufferOffset = 0;
+				connection->sendInFlight = true;
+
+				return;
+			}
+
+			connection->sendFailed = true;
+		}
+
+		if(connection->state != SERVER_CONNECTION_STATE_DRAINING){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			server_processConnection(worker, connection);
+
+			BIO_reset(writeBIO);
+		}
+	}
+
+	server_releaseBuffer(worker->connectionPool, connection->sendBuffer);
+	connection->sendBuffer = NULL;
+
+	if(connection->state != SERVER_CONNECTION_STATE_DRAINING){
+		return;
+	}
+
+	// Everything has been sent, end the receive before the socket can be closed.
+	if(connection->receiveArmed){
+		if(!connection->socketShutdown){
+			shutdown(connection->socketFileDescriptor, SHUT_RDWR);
+
+			connection->socketShutdown = true;
+		}
+
+		return;
+	}
+
+	close(connection->socketFileDescriptor);
+
+	server_releaseConnection(worker, connection);
+}
+
+void server_handleRequest(Server* server, Connection* connection, Arena* arena){
+	ERROR_CODE error;
+
+	HTTP_Request* request = &connection->request;
+	HTTP_Response* response = &connection->response;
+
+	http_initRequest_(request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+
+	// Note: The response gets build in its own buffer, the read buffer may still hold pipelined requests after this one.
+	http_initHttpResponse(response, connection->responseBuffer, connection->readBufferSize, arena);
+
+	connection->numRequests++;
+	connection->keepAlive = connection->numRequests < server->keepAliveMaxRequests;
+
+	if((error = http_parseHTTP_Request(request, (char*) connection->readBuffer, connection->requestLength)) != ERROR_NO_ERROR){
+		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Failed to parse HTTP request. [%s]", util_toErrorString(error));
+
+		// We can't tell where the next request would start.
+		connection->keepAlive = false;
+
+		if((error = server_constructErrorPage(server, request, response, _400_BAD_REQUEST)) != ERROR_NO_ERROR){
+			UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to construct error page. (%s)." , util_toErrorString(error));
+		}
+	}else{
+		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tRequest URL:'%s'.", request->requestURL);
+
+		// Note: HTTP/1.1 connections persist unless the client asks to close them, HTTP/1.0 connections only if it asks to keep them alive (RFC 9112, Section 9.3).
+		const bool persistentByDefault = !(request->httpVersion.release == 1 && request->httpVersion.update == 0);
+
+		const HTTP_HeaderField* headerFieldConnection = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_CONNECTION);
+		if(headerFieldConnection != NULL && http_tokenListContains(headerFieldConnection->value, headerFieldConnection->valueLength, "close")){
+			connection->keepAlive = false;
+		}else if(!persistentByDefault && (headerFieldConnection == NULL || !http_tokenListContains(headerFieldConnection->value, headerFieldConnection->valueLength, "keep-alive"))){
+			connection->keepAlive = false;
+		}
+
+		// Skip over the request body, if the client sent one.
+		// Note: No handler reads request bodies. The part that already arrived gets consumed with the request, the rest is discarded in 'SERVER_CONNECTION_STATE_READING' once the response is out.
+		if((error = http_initBody(&connection->parser, request)) == ERROR_NO_ERROR && connection->parser.state != HTTP_PARSER_STATE_HEADER){
+			uint_fast64_t consumed;
+			error = http_parseBody(&connection->parser, (char*) connection->readBuffer + connection->requestLength, connection->readBufferOffset - connection->requestLength, &consumed);
+
+			connection->requestLength += consumed;
+
+			if(error == ERROR_INCOMPLETE){
+				error = ERROR_NO_ERROR;
+			}
+		}
+
+		if(error != ERROR_NO_ERROR){
+			UTIL_LOG_CONSOLE_(LOG_DEBUG, "Invalid request body framing. [%s]", util_toErrorString(error));
+
+			// Note: The end of the body is unknown, so is the beginning of the next request.
+			http_initParser(&connection->parser);
+
+			connection->keepAlive = false;
+			connection->requestLength = connection->readBufferOffset;
+		}
+
+		server_dispatchRequest(server, request, response);
+	}
+
+	if(connection->keepAlive){
+		HTTP_ADD_HEADER_FIELD(response, Connection, "keep-alive");
+
+		char keepAlive[64];
+		snprintf(keepAlive, sizeof(keepAlive), "timeout=%" PRIuFAST64 ", max=%" PRIuFAST64, server->keepAliveTimeout / 1000, server->keepAliveMaxRequests - connection->numRequests);
+
+		HTTP_ADD_HEADER_FIELD(response, Keep-Alive, keepAlive);
+	}else{
+		HTTP_ADD_HEADER_FIELD(response, Connection, "close");
+	}
+}
+
+// Note: Runs the context handler responsible for the request, or builds the error page. Shared by HTTP/1.1 and HTTP/2, the connection specific header fields are added by the caller.
+void server_dispatchRequest(Server* server, HTTP_Request* request, HTTP_Response* response){
+	ERROR_CODE error;
+
+	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tRetrieving context handler...");
+
+	ContextHandler* contextHandler = NULL;
+
+	if((error = server_getContextHandler(server, &contextHandler, request)) != ERROR_NO_ERROR){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to retrieve http context handler. [%s]", util_toErrorString(error));
+
+		if((error = server_constructErrorPage(server, request, response, error == ERROR_METHOD_NOT_ALLOWED ? _405_METHOD_NOT_ALLOWED : _401_UNAUTHORIZED)) != ERROR_NO_ERROR){
+			UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to construct error page. (%s)." , util_toErrorString(error));
+		}
+
+		return;
+	}
+
+	if((error = contextHandler(server, request, response)) != ERROR_NO_ERROR){
+		if(error == ERROR_FAILED_TO_RETRIEV_FILE_INFO){
+			if((error = server_constructErrorPage(server, request, response, _401_UNAUTHORIZED)) != ERROR_NO_ERROR){
+				UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to construct error page. (%s)." , util_toErrorString(error));
+			}
+		}
+	}
+}
+
+// Note: Gives up the responses lease on its cache object, has to happen before the response itself gets freed.
+void server_releaseCacheLease(HTTP_Response* response){
+	if(response->leasedCacheObject != NULL){
+		cache_release(response->leasedCacheObject);
+
+		response->leasedCacheObject = NULL;
+	}
+}
+
+// Releases the current request and moves pipelined data that followed it to the beginning of the read buffer.
+void server_finishRequest(Connection* connection){
+	server_releaseCacheLease(&connection->response);
+
+	http_freeHTTP_Request(&connection->request);
+	http_freeHTTP_Response(&connection->response);
+
+	connection->fileBufferOffset = 0;
+	connection->fileBufferLength = 0;
+
+	const uint_fast64_t remaining = connection->readBufferOffset - connection->requestLength;
+
+	memmove(connection->readBuffer, connection->readBuffer + connection->requestLength, remaining);
+
+	connection->readBufferOffset = remaining;
+	connection->requestLength = 0;
+}
+
+// Note: Drives a HTTP/2 connection: writes the frames staged last time, processes the input that arrived, runs the context handlers of complete requests and stages the next frames. Returns false if the connection got parked to wait for the client, true once it has to be closed.
+bool server_processHttp2Connection(EpollWorker* worker, Connection* connection){
+	ConnectionPool* pool = worker->connectionPool;
+	Http2Session* session = connection->http2Session;
+
+	for(;;){
+		// The staging buffer gets reused, so everything in it has to be out first.
+		if(connection->writeSegmentIndex < connection->numWriteSegments){
+			uint32_t awaitEvents;
+			if(server_writeResponse(connection, pool, &awaitEvents) != ERROR_NO_ERROR){
+				connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+				return true;
+			}
+
+			if(awaitEvents != 0){
+				server_awaitClient(worker, connection, awaitEvents, true);
+
+				return false;
+			}
+
+			connection->numWriteSegments = 0;
+			connection->writeSegmentIndex = 0;
+			connection->writeOffset = 0;
+		}
+
+		// The GOAWAY is out.
+		if(session->goAwaySent){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			return true;
+		}
+
+		if(connection->readBufferOffset > 0){
+			uint_fast64_t consumed;
+
+			// Note: Connection errors queue a GOAWAY, which gets sent below.
+			__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_HTTP2_PROTOCOL_ERROR);
+			http2_processInput(session, connection->readBuffer, connection->readBufferOffset, connection->readBufferSize, &consumed);
+			__UTIL_ENABLE_ERROR_LOGGING__();
+
+			memmove(connection->readBuffer, connection->readBuffer + consumed, connection->readBufferOffset - consumed);
+			connection->readBufferOffset -= consumed;
+		}
+
+		server_handleHttp2Streams(worker, connection);
+
+		if(connection->responseBuffer == NULL && server_acquireBuffer(pool, &connection->responseBuffer) != ERROR_NO_ERROR){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			return true;
+		}
+
+		uint_fast64_t length;
+		http2_produceOutput(session, connection->responseBuffer, pool->bufferSize, &length);
+
+		server_releaseHttp2Streams(pool, session, false);
+
+		if(length > 0){
+			server_addWriteSegment(connection, connection->responseBuffer, 0, length);
+
+			continue;
+		}
+
+		server_releaseBuffer(pool, connection->responseBuffer);
+		connection->responseBuffer = NULL;
+
+		// Note: Once the client announced it is going away, the connection gets closed as soon as the open streams are done.
+		if(session->goAwayReceived && !http2_hasActiveStreams(session)){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			return true;
+		}
+
+		// Note: Frames always fit into the read buffer, so a full buffer would already have been processed.
+		if(connection->readBufferOffset == connection->readBufferSize){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			return true;
+		}
+
+		if(connection->readBuffer == NULL && server_acquireBuffer(pool, &connection->readBuffer) != ERROR_NO_ERROR){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			return true;
+		}
+
+		const int bytesRead = SSL_read(connection->sslInstance, connection->readBuffer + connection->readBufferOffset, connection->readBufferSize - connection->readBufferOffset);
+
+		if(bytesRead > 0){
+			connection->readBufferOffset += bytesRead;
+
+			continue;
+		}
+
+		const int sslError = SSL_get_error(connection->sslInstance, bytesRead);
+
+		if(sslError != SSL_ERROR_WANT_READ && sslError != SSL_ERROR_WANT_WRITE){
+			connection->state = SERVER_CONNECTION_STATE_CLOSING;
+
+			return true;
+		}
+
+		if(connection->readBufferOffset == 0){
+			server_releaseBuffer(pool, connection->readBuffer);
+
+			connection->readBuffer = NULL;
+		}
+
+		server_awaitClient(worker, connection, sslError == SSL_ERROR_WANT_READ ? EPOLLIN : EPOLLOUT, false);
+
+		return false;
+	}
+}
+
+// Note: Runs the context handlers of all streams whose request is complete. Responses are built in a pool buffer of their own, which is only held on to while the body lives in it.
+void server_handleHttp2Streams(EpollWorker* worker, Connection* connection){
+	ConnectionPool* pool = worker->connectionPool;
+	Http2Session* session = connection->http2Session;
+
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		Http2Stream* stream = &session->streams[i];
+
+		if(stream->state != HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE || stream->responseReady){
+			continue;
+		}
+
+		if(server_acquireBuffer(pool, &stream->responseBuffer) != ERROR_NO_ERROR){
+			http2_resetStream(session, stream, HTTP2_ERROR_CODE_INTERNAL_ERROR);
+
+			continue;
+		}
+
+		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tHTTP/2 stream [%" PRIu32 "] URL:'%s'.", stream->id, stream->request.requestURL);
+
+		// Note: The header block of a stream may only get encoded in a later pass, so its header fields can't live in the workers arena.
+		http_initHttpResponse(&stream->response, stream->responseBuffer, pool->bufferSize, NULL);
+		stream->response.httpVersion = HTTP_HTTP_VERSION_2_0;
+
+		server_dispatchRequest(worker->server, &stream->request, &stream->response);
+
+		http2_prepareResponseBody(stream);
+
+		if(stream->response.staticContent || stream->bodyRemaining == 0){
+			server_releaseBuffer(pool, stream->responseBuffer);
+
+			stream->responseBuffer = NULL;
+		}
+	}
+}
+
+// Note: Releases the streams that are done, or all of them if the connection goes away.
+void server_releaseHttp2Streams(ConnectionPool* pool, Http2Session* session, const bool all){
+	uint_fast8_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		Http2Stream* stream = &session->streams[i];
+
+		if(stream->state == HTTP2_STREAM_STATE_IDLE || (!all && stream->state != HTTP2_STREAM_STATE_CLOSED)){
+			continue;
+		}
+
+		server_releaseBuffer(pool, stream->responseBuffer);
+
+		server_releaseCacheLease(&stream->response);
+
+		http2_closeStream(stream);
+	}
+}
+
+void server_rearmConnection(EpollWorker* worker, Connection* connection, const uint32_t events){
+	struct epoll_event event = {0};
+	event.events = events | EPOLLONESHOT;
+	event.data.ptr = connection;
+
+	if(epoll_ctl(worker->epollFileDescriptor, EPOLL_CTL_MOD, connection->socketFileDescriptor, &event) != 0){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Worker: \tFailed to re-arm connection [FD:%d] '%s'.", connection->socketFileDescriptor, strerror(errno));
+	}
+}
+
+// Note: Has to happen before the connection gets (re-)armed, after that another worker might already own it.
+void server_markConnectionIdle(EpollWorker* worker, Connection* connection, const bool sending){
+	ConnectionIdleList* idleList = sending ? worker->sendingConnections : worker->idleConnections;
+
+	pthread_mutex_lock(&idleList->lock);
+
+	connection->idle = true;
+	connection->sending = sending;
+	connection->idleDeadline = util_getMonotonicTimeMillis() + idleList->timeout;
+
+	connection->idleNext = NULL;
+	connection->idlePrevious = idleList->tail;
+
+	if(idleList->tail != NULL){
+		idleList->tail->idleNext = connection;
+	}else{
+		idleList->head = connection;
+	}
+
+	idleList->tail = connection;
+
+	pthread_mutex_unlock(&idleList->lock);
+}
+
+void server_unmarkConnectionIdle(EpollWorker* worker, Connection* connection){
+	ConnectionIdleList* idleList = connection->sending ? worker->sendingConnections : worker->idleConnections;
+
+	pthread_mutex_lock(&idleList->lock);
+
+	// Note: The connection might have already been expired while we were waiting for the lock.
+	if(connection->idle){
+		if(connection->idlePrevious != NULL){
+			connection->idlePrevious->idleNext = connection->idleNext;
+		}else{
+			idleList->head = connection->idleNext;
+		}
+
+		if(connection->idleNext != NULL){
+			connection->idleNext->idlePrevious = connection->idlePrevious;
+		}else{
+			idleList->tail = connection->idlePrevious;
+		}
+
+		connection->idle = false;
+	}
+
+	pthread_mutex_unlock(&idleList->lock);
+}
+
+// Note: Expired connections only get their socket shut down, the resulting hang up gets them closed and freed by whichever worker receives the event.
+void server_expireIdleConnections(EpollWorker* worker){
+	const uint_fast64_t now = util_getMonotonicTimeMillis();
+
+	if(now < worker->nextIdleSweep){
+		return;
+	}
+
+	worker->nextIdleSweep = now + SERVER_IDLE_SWEEP_INTERVAL;
+
+	ConnectionIdleList* idleLists[] = {worker->idleConnections, worker->sendingConnections};
+
+	uint_fast8_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(idleLists); i++){
+		ConnectionIdleList* idleList = idleLists[i];
+
+		pthread_mutex_lock(&idleList->lock);
+
+		while(idleList->head != NULL && idleList->head->idleDeadline <= now){
+			Connection* connection = idleList->head;
+
+			UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tConnection idle timeout. [FD:%d].", connection->socketFileDescriptor);
+
+			shutdown(connection->socketFileDescriptor, SHUT_RDWR);
+
+			idleList->head = connection->idleNext;
+
+			if(idleList->head != NULL){
+				idleList->head->idlePrevious = NULL;
+			}else{
+				idleList->tail = NULL;
+			}
+
+			connection->idle = false;
+		}
+
+		pthread_mutex_unlock(&idleList->lock);
+	}
+}
+
+ERROR_CODE server_initConnectionPool(ConnectionPool* pool, const uint_fast64_t bufferSize){
+	memset(pool, 0, sizeof(*pool));
+
+	if(pthread_mutex_init(&pool->lock, NULL) != 0){
+		return ERROR(ERROR_PTHREAD_MUTEX_INITIALISATION_FAILED);
+	}
+
+	pool->bufferSize = bufferSize;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+void server_freeConnectionPool(ConnectionPool* pool){
+	while(pool->freeConnections != NULL){
+		Connection* connection = pool->freeConnections;
+		pool->freeConnections = connection->idleNext;
+
+		server_freeConnection(connection);
+	}
+
+	while(pool->freeBuffers != NULL){
+		void* buffer = pool->freeBuffers;
+		pool->freeBuffers = *(void**) buffer;
+
+		free(buffer);
+	}
+
+	pthread_mutex_destroy(&pool->lock);
+}
+
+ERROR_CODE server_acquireBuffer(ConnectionPool* pool, int8_t** buffer){
+	pthread_mutex_lock(&pool->lock);
+
+	*buffer = pool->freeBuffers;
+
+	if(*buffer != NULL){
+		pool->freeBuffers = *(void**) *buffer;
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+
+	if(*buffer == NULL){
+		*buffer = malloc(sizeof(**buffer) * pool->bufferSize);
+		if(*buffer == NULL){
+			return ERROR(ERROR_OUT_OF_MEMORY);
+		}
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+void server_releaseBuffer(ConnectionPool* pool, int8_t* buffer){
+	if(buffer == NULL){
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+
+	*(void**) buffer = pool->freeBuffers;
+	pool->freeBuffers = buffer;
+
+	pthread_mutex_unlock(&pool->lock);
+}
+
+ERROR_CODE server_acquireConnection(EpollWorker* worker, Connection** connection, const int socketFileDescriptor){
+	ConnectionPool* pool = worker->connectionPool;
+
+	pthread_mutex_lock(&pool->lock);
+
+	*connection = pool->freeConnections;
+
+	if(*connection != NULL){
+		pool->freeConnections = (*connection)->idleNext;
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+
+	if(*connection != NULL){
+		// Note: 'SSL_clear' keeps the BIOs, the socket BIO only has to be pointed at the new socket.
+		if(worker->server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+			BIO_set_fd(SSL_get_rbio((*connection)->sslInstance), socketFileDescriptor, BIO_NOCLOSE);
+		}else{
+			BIO_reset(SSL_get_rbio((*connection)->sslInstance));
+			BIO_reset(SSL_get_wbio((*connection)->sslInstance));
+		}
+	}else{
+		*connection = malloc(sizeof(**connection));
+		if(*connection == NULL){
+			return ERROR(ERROR_OUT_OF_MEMORY);
+		}
+
+		// Init SSL.
+		(*connection)->sslInstance = SSL_new(worker->server->sslContext);
+		if((*connection)->sslInstance == NULL){
+			free(*connection);
+
+			return ERROR(ERROR_SSL_INITIALISATION_ERROR);
+		}
+
+		if(worker->server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+			SSL_set_fd((*connection)->sslInstance, socketFileDescriptor);
+		}else{
+			BIO* readBIO = BIO_new(BIO_s_mem());
+			BIO* writeBIO = BIO_new(BIO_s_mem());
+
+			if(readBIO == NULL || writeBIO == NULL){
+				BIO_free(readBIO);
+				BIO_free(writeBIO);
+
+				SSL_free((*connection)->sslInstance);
+				free(*connection);
+
+				return ERROR(ERROR_SSL_INITIALISATION_ERROR);
+			}
+
+			SSL_set_bio((*connection)->sslInstance, readBIO, writeBIO);
+		}
+	}
+
+	SSL* sslInstance = (*connection)->sslInstance;
+
+	memset(*connection, 0, sizeof(**connection));
+
+	(*connection)->sslInstance = sslInstance;
+	(*connection)->readBufferSize = pool->bufferSize;
+	(*connection)->socketFileDescriptor = socketFileDescriptor;
+	(*connection)->state = SERVER_CONNECTION_STATE_HANDSHAKING;
+	// Note: No response is pending yet, 'server_releaseConnection' must not close a descriptor that isn't ours.
+	(*connection)->response.fileDescriptor = -1;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+void server_releaseConnection(EpollWorker* worker, Connection* connection){
+	ConnectionPool* pool = worker->connectionPool;
+
+	// Note: The connection may get closed before its response went out completely, the response may still hold a lease and the file it streams from.
+	server_releaseCacheLease(&connection->response);
+
+	http_freeHTTP_Response(&connection->response);
+
+	if(connection->http2Session != NULL){
+		server_releaseHttp2Streams(pool, connection->http2Session, true);
+
+		http2_freeSession(connection->http2Session);
+		free(connection->http2Session);
+
+		connection->http2Session = NULL;
+	}
+
+	server_releaseBuffer(pool, connection->readBuffer);
+	server_releaseBuffer(pool, connection->responseBuffer);
+	server_releaseBuffer(pool, connection->sendBuffer);
+	server_releaseBuffer(pool, connection->fileBuffer);
+
+	connection->readBuffer = NULL;
+	connection->responseBuffer = NULL;
+	connection->sendBuffer = NULL;
+	connection->fileBuffer = NULL;
+
+#ifndef OPENSSL_NO_KTLS
+	const bool kernelTLS = BIO_get_ktls_send(SSL_get_wbio(connection->sslInstance)) || BIO_get_ktls_recv(SSL_get_rbio(connection->sslInstance));
+#else
+	const bool kernelTLS = false;
+#endif
+
+	// Note: 'SSL_clear' does not reset the kTLS state of the socket BIO, so offloaded instances can't be reused for the next socket.
+	if(kernelTLS || SSL_clear(connection->sslInstance) != 1){
+		server_freeConnection(connection);
+
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+
+	connection->idleNext = pool->freeConnections;
+	pool->freeConnections = connection;
+
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void server_freeConnection(Connection* connection){
+	SSL_free(connection->sslInstance);
+
+	free(connection->readBuffer);
+	free(connection->responseBuffer);
+	free(connection->sendBuffer);
+	free(connection->fileBuffer);
+
+	free(connection);
+}
+
+ERROR_CODE server_serializeResponseHeader(HTTP_Response* response, int8_t* buffer, const uint_fast64_t bufferSize, uint_fast64_t* length){
+	uint_fast64_t writeOffset;
+
+	// Response line.
+	if(response->statusLine != NULL){
+		if(response->statusLineLength >= bufferSize){
+			return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+		}
+
+		memcpy(buffer, response->statusLine, response->statusLineLength);
+		writeOffset = response->statusLineLength;
+	}else{
+		const int statusLineLength = snprintf((char*) buffer, bufferSize, "%s %" PRIdFAST16 " %s\r\n", http_getVersionString(response->httpVersion), http_getNumericalStatusCode(response->httpStatusCode), http_getStatusMsg(response->httpStatusCode));
+		if(statusLineLength < 0 || (uint_fast64_t) statusLineLength >= bufferSize){
+			return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+		}
+
+		writeOffset = statusLineLength;
+	}
+
+	// Header fields.
+	LinkedListIterator it;
+	linkedList_initIterator(&it, &response->httpHeaderFields);
+
+	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+		HTTP_HeaderField* headerField = LINKED_LIST_ITERATOR_NEXT_PTR(&it, HTTP_HeaderField);
+
+		// Leave room for the trailing new line.
+		if(writeOffset + headerField->nameLength + 2/*": "*/ + headerField->valueLength + 2/*"\r\n"*/ + 2 > bufferSize){
+			return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+		}
+
+		memcpy(buffer + writeOffset, headerField->name, headerField->nameLength);
+		writeOffset += headerField->nameLength;
+
+		memcpy(buffer + writeOffset, ": ", 2);
+		writeOffset += 2;
+
+		memcpy(buffer + writeOffset, headerField->value, headerField->valueLength);
+		writeOffset += headerField->valueLength;
+
+		memcpy(buffer + writeOffset, "\r\n", 2);
+		writeOffset += 2;
+	}
+
+	// Note: 'Date' is patched in from the per second cached string, the pre-serialized fields are copied as they are.
+	if(writeOffset + 6/*"Date: "*/ + HTTP_DATE_LENGTH + 2/*"\r\n"*/ + response->headerBlockLength + 2 > bufferSize){
+		return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+	}
+
+	memcpy(buffer + writeOffset, "Date: ", 6);
+	writeOffset += 6;
+
+	memcpy(buffer + writeOffset, http_getCurrentDate(), HTTP_DATE_LENGTH);
+	writeOffset += HTTP_DATE_LENGTH;
+
+	memcpy(buffer + writeOffset, "\r\n", 2);
+	writeOffset += 2;
+
+	if(response->headerBlockLength != 0){
+		memcpy(buffer + writeOffset, response->headerBlock, response->headerBlockLength);
+		writeOffset += response->headerBlockLength;
+	}
+
+	// Trailing new line to signal begining of data segment.
+	memcpy(buffer + writeOffset, "\r\n", 2);
+	writeOffset += 2;
+
+	*length = writeOffset;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Lays the response out as write segments. The header block and as much of the body as fits into the response buffer go out with a single 'SSL_write', so small responses end up in a single TLS record.
+ERROR_CODE server_prepareResponse(Connection* connection){
+	ERROR_CODE error;
+
+	HTTP_Response* response = &connection->response;
+
+	connection->numWriteSegments = 0;
+	connection->writeSegmentIndex = 0;
+	connection->writeOffset = 0;
+
+	// Note: Dynamic content already occupies the beginning of the response buffer, the header block gets serialised behind it.
+	int8_t* header = response->dataSegment + response->responseDataSegmentLength;
+
+	uint_fast64_t headerLength;
+	if((error = server_serializeResponseHeader(response, header, response->responseBufferSize - response->responseDataSegmentLength, &headerLength)) != ERROR_NO_ERROR){
+		return ERROR(error);
+	}
+
+	// Note: Responses to HEAD requests end with the header block, 'Content-Length' still announces the body a GET would get. Anything sent after it would be read as the beginning of the next response.
+	if(connection->request.httpRequestType == HTTP_REQUEST_TYPE_HEAD){
+		return server_addWriteSegment(connection, header, 0, headerLength);
+	}
+
+	if(!response->staticContent){
+		// Move the header block in front of the body.
+		int8_t* headerCopy = alloca(headerLength);
+		memcpy(headerCopy, header, headerLength);
+
+		memmove(response->dataSegment + headerLength, response->dataSegment, response->responseDataSegmentLength);
+		memcpy(response->dataSegment, headerCopy, headerLength);
+
+		return server_addWriteSegment(connection, response->dataSegment, 0, headerLength + response->responseDataSegmentLength);
+	}
+
+	server_addWriteSegment(connection, header, 0, headerLength);
+
+	const uint_fast64_t contentSize = response->cacheObject != NULL ? response->cacheObject->size : response->fileSize;
+
+	// Note: The rest of the response buffer holds the multipart headers, or the beginning of the body.
+	int8_t* buffer = header + headerLength;
+	uint_fast64_t bufferSpace = response->responseBufferSize - headerLength;
+
+	if(response->numByteRanges <= 1){
+		const uint_fast64_t first = response->numByteRanges == 1 ? response->byteRanges[0].first : 0;
+		const uint_fast64_t length = response->numByteRanges == 1 ? response->byteRanges[0].last - first + 1 : contentSize;
+
+		const uint_fast64_t coalescedLength = MIN(length, bufferSpace);
+
+		if(response->cacheObject != NULL){
+			memcpy(buffer, response->cacheObject->data + first, coalescedLength);
+		}else if(pread(response->fileDescriptor, buffer, coalescedLength, first) != (ssize_t) coalescedLength){
+			return ERROR_(ERROR_FAILED_TO_LOAD_FILE, "%s", strerror(errno));
+		}
+
+		server_addWriteSegment(connection, buffer, 0, coalescedLength);
+
+		server_useSendFile(connection, length - coalescedLength);
+
+		return server_addBodySegment(connection, first + coalescedLength, length - coalescedLength);
+	}
+
+	uint_fast64_t totalLength = 0;
+
+	uint_fast8_t i;
+	for(i = 0; i < response->numByteRanges; i++){
+		totalLength += response->byteRanges[i].last - response->byteRanges[i].first + 1;
+	}
+
+	server_useSendFile(connection, totalLength);
+
+	const char* contentType = http_contentTypeToString(response->httpContentType);
+
+	for(i = 0; i < response->numByteRanges; i++){
+		const HTTP_ByteRange* range = &response->byteRanges[i];
+
+		const uint_fast64_t partHeaderLength = server_formatByteRangePartHeader((char*) buffer, bufferSpace, contentType, range, contentSize);
+		if(partHeaderLength >= bufferSpace){
+			return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+		}
+
+		if((error = server_addWriteSegment(connection, buffer, 0, partHeaderLength)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+
+		buffer += partHeaderLength;
+		bufferSpace -= partHeaderLength;
+
+		if((error = server_addBodySegment(connection, range->first, range->last - range->first + 1)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}
+
+	const uint_fast64_t closingBoundaryLength = snprintf((char*) buffer, bufferSpace, "\r\n--%s--\r\n", CONSTANTS_HTTP_MULTIPART_BYTERANGES_BOUNDARY);
+	if(closingBoundaryLength >= bufferSpace){
+		return ERROR(ERROR_HTTP_RESPONSE_SIZE_EXCEEDED);
+	}
+
+	return server_addWriteSegment(connection, buffer, 0, closingBoundaryLength);
+}
+
+// Note: Segments that continue right where the previous one ended get merged, so they go out with the same 'SSL_write'. 'data' is NULL for segments read from the responses file.
+ERROR_CODE server_addWriteSegment(Connection* connection, const int8_t* data, const uint_fast64_t fileOffset, const uint_fast64_t length){
+	if(length == 0){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(connection->numWriteSegments > 0){
+		WriteSegment* previous = &connection->writeSegments[connection->numWriteSegments - 1];
+
+		if(data != NULL && previous->data != NULL && previous->data + previous->length == data){
+			previous->length += length;
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+	}
+
+	if(connection->numWriteSegments == SERVER_MAX_WRITE_SEGMENTS){
+		return ERROR(ERROR_TO_MANY_ELEMENTS);
+	}
+
+	WriteSegment* segment = &connection->writeSegments[connection->numWriteSegments++];
+	segment->data = data;
+	segment->fileOffset = fileOffset;
+	segment->length = length;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Adds 'length' bytes of the body starting at 'offset', from the file if there is one open, otherwise from the cache.
+inline ERROR_CODE server_addBodySegment(Connection* connection, const uint_fast64_t offset, const uint_fast64_t length){
+	HTTP_Response* response = &connection->response;
+
+	if(response->fileDescriptor != -1){
+		return server_addWriteSegment(connection, NULL, offset, length);
+	}
+
+	return server_addWriteSegment(connection, (int8_t*) response->cacheObject->data + offset, 0, length);
+}
+
+// Note: With kTLS the kernel encrypts, so large cached bodies are better sent straight from the page cache than copied through user space. Keeps using the cached copy if the file is gone.
+void server_useSendFile(Connection* connection, const uint_fast64_t length){
+#ifndef OPENSSL_NO_KTLS
+	HTTP_Response* response = &connection->response;
+
+	if(response->cacheObject == NULL || response->cacheObject->fileLocationLength == 0 || length < SERVER_KERNEL_TLS_SENDFILE_MIN_SIZE || !BIO_get_ktls_send(SSL_get_wbio(connection->sslInstance))){
+		return;
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_OPEN_FILE);
+	server_openFile(response->cacheObject, &response->fileDescriptor);
+	__UTIL_ENABLE_ERROR_LOGGING__();
+#endif
+}
+
+// Returns the length of the part header, like 'snprintf'.
+inline uint_fast64_t server_formatByteRangePartHeader(char* buffer, const uint_fast64_t bufferSize, const char* contentType, const HTTP_ByteRange* range, const uint_fast64_t contentSize){
+	return snprintf(buffer, bufferSize, "\r\n--%s\r\nContent-Type: %s\r\nContent-Range: bytes %" PRIuFAST64 "-%" PRIuFAST64 "/%" PRIuFAST64 "\r\n\r\n", CONSTANTS_HTTP_MULTIPART_BYTERANGES_BOUNDARY, contentType, range->first, range->last, contentSize);
+}
+
+// Note: Writes until the response is out or the socket would block. In the latter case 'awaitEvents' holds what to wait for before calling again, otherwise it is 0.
+ERROR_CODE server_writeResponse(Connection* connection, ConnectionPool* pool, uint32_t* awaitEvents){
+	*awaitEvents = 0;
+
+	HTTP_Response* response = &connection->response;
+
+	int ret = 1;
+
+	while(connection->writeSegmentIndex < connection->numWriteSegments){
+		const WriteSegment* segment = &connection->writeSegments[connection->writeSegmentIndex];
+
+		if(connection->writeOffset == segment->length){
+			connection->writeSegmentIndex++;
+			connection->writeOffset = 0;
+
+			continue;
+		}
+
+		// Note: io_uring connections write into a memory BIO, which never blocks. Continue once the records already in there got sent, so large bodies don't pile up in memory.
+		BIO* writeBIO = SSL_get_wbio(connection->sslInstance);
+		if(BIO_method_type(writeBIO) == BIO_TYPE_MEM && BIO_ctrl_pending(writeBIO) >= pool->bufferSize){
+			*awaitEvents = EPOLLOUT;
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		// Note: With 'SSL_MODE_ENABLE_PARTIAL_WRITE' every full record written counts, so a write that would block only has to repeat what is left.
+		if(segment->data != NULL){
+			if((ret = SSL_write(connection->sslInstance, segment->data + connection->writeOffset, MIN(segment->length - connection->writeOffset, INT_MAX))) <= 0){
+				break;
+			}
+
+			connection->writeOffset += ret;
+
+			continue;
+		}
+
+#ifndef OPENSSL_NO_KTLS
+		if(BIO_get_ktls_send(SSL_get_wbio(connection->sslInstance))){
+			const ossl_ssize_t bytesWritten = SSL_sendfile(connection->sslInstance, response->fileDescriptor, segment->fileOffset + connection->writeOffset, segment->length - connection->writeOffset, 0);
+			if(bytesWritten <= 0){
+				ret = -1;
+
+				break;
+			}
+
+			connection->writeOffset += bytesWritten;
+
+			continue;
+		}
+#endif
+
+		// Without kTLS the file gets staged through a pool buffer, which has to stay untouched until 'SSL_write' took all of it.
+		if(connection->fileBufferOffset == connection->fileBufferLength){
+			if(connection->fileBuffer == NULL && server_acquireBuffer(pool, &connection->fileBuffer) != ERROR_NO_ERROR){
+				return ERROR(ERROR_OUT_OF_MEMORY);
+			}
+
+			const ssize_t bytesRead = pread(response->fileDescriptor, connection->fileBuffer, MIN(segment->length - connection->writeOffset, pool->bufferSize), segment->fileOffset + connection->writeOffset);
+			if(bytesRead <= 0){
+				return ERROR_(ERROR_FAILED_TO_LOAD_FILE, "%s", bytesRead == 0 ? "File got truncated." : strerror(errno));
+			}
+
+			connection->fileBufferOffset = 0;
+			connection->fileBufferLength = bytesRead;
+		}
+
+		if((ret = SSL_write(connection->sslInstance, connection->fileBuffer + connection->fileBufferOffset, connection->fileBufferLength - connection->fileBufferOffset)) <= 0){
+			break;
+		}
+
+		connection->fileBufferOffset += ret;
+		connection->writeOffset += ret;
+	}
+
+	if(ret > 0){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	const int sslError = SSL_get_error(connection->sslInstance, ret);
+
+	if(sslError == SSL_ERROR_WANT_WRITE){
+		*awaitEvents = EPOLLOUT;
+	}else if(sslError == SSL_ERROR_WANT_READ){
+		*awaitEvents = EPOLLIN;
+	}else{
+		return ERROR_(ERROR_WRITE_ERROR, "SSL error %d.", sslError);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+ERROR_CODE server_openFile(CacheObject* cacheObject, int* fileDescriptor){
+	*fileDescriptor = open(cacheObject->fileLocation, O_RDONLY);
+	if(*fileDescriptor == -1){
+		return ERROR_(ERROR_FAILED_TO_OPEN_FILE, "File:'%s'", cacheObject->fileLocation);
+	}
+
+	// Note: The file may have changed since it got cached, but the 'Content-Length' sent was taken from the cache object.
+	struct stat fileInfo;
+	if(fstat(*fileDescriptor, &fileInfo) == -1 || (uint_fast64_t) fileInfo.st_size != cacheObject->size){
+		close(*fileDescriptor);
+
+		*fileDescriptor = -1;
+
+		return ERROR_(ERROR_FAILED_TO_OPEN_FILE, "File:'%s' changed on disk.", cacheObject->fileLocation);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Custom error pages are named after their status code, e.g. '404.html'. Status codes without one get the built-in page.
+ERROR_CODE server_compileErrorPages(Server* server){
+	ERROR_CODE error;
+
+	uint_fast64_t i;
+	for(i = 0; i < ERROR_PAGE_NUM_STATUS_CODES; i++){
+		const HTTP_StatusCode httpStatusCode = ERROR_PAGE_FIRST_STATUS_CODE + i;
+
+		error = ERROR_FAILED_TO_RETRIEV_FILE_INFO;
+
+		if(server->customErrorPageDirectory->valueLength != 0){
+			char symbolicFileLocation[16];
+			const uint_fast64_t symbolicFileLocationLength = snprintf(symbolicFileLocation, sizeof(symbolicFileLocation), "/%03" PRIdFAST16 ".html", http_getNumericalStatusCode(httpStatusCode));
+
+			SERVER_TRANSLATE_SYMBOLIC_FILE_LOCATION_ERROR_PAGE(fileLocation, server, symbolicFileLocation, symbolicFileLocationLength);
+
+			__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_RETRIEV_FILE_INFO);
+			error = errorPage_load(&server->errorPages[i], httpStatusCode, fileLocation);
+			__UTIL_ENABLE_ERROR_LOGGING__();
+		}
+
+		if(error == ERROR_FAILED_TO_RETRIEV_FILE_INFO){
+			error = errorPage_compile(&server->errorPages[i], httpStatusCode, CONSTANTS_MINIMAL_HTTP_ERROR_PAGE, strlen(CONSTANTS_MINIMAL_HTTP_ERROR_PAGE));
+		}
+
+		if(error != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: '$address' is the 'Host' header field as sent, '$port' the port it names or the one the server listens on.
+ERROR_CODE server_constructErrorPage(Server* server, HTTP_Request* request, HTTP_Response* response, HTTP_StatusCode httpStatusCode){
+	ERROR_CODE error;
+
+	const ErrorPage* errorPage = &server->errorPages[httpStatusCode - ERROR_PAGE_FIRST_STATUS_CODE];
+
+	const char* address = "";
+	uint_fast64_t addressLength = 0;
+
+	const char* port = server->port->value;
+	uint_fast64_t portLength = server->port->valueLength;
+
+	const HTTP_HeaderField* headerFieldHost = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_HOST);
+	if(headerFieldHost != NULL){
+		address = headerFieldHost->value;
+		addressLength = headerFieldHost->valueLength;
+
+		const uint_fast64_t hostPortOffset = util_findLast(headerFieldHost->value, headerFieldHost->valueLength, ':') + 1;
+		const uint_fast64_t hostPortLength = headerFieldHost->valueLength - hostPortOffset;
+
+		// Note: A ':' inside an IPv6 literal is not followed by digits only.
+		if(hostPortOffset != 0 && hostPortLength != 0 && hostPortLength <= ERROR_PAGE_MAX_PORT_LENGTH && strspn(headerFieldHost->value + hostPortOffset, "0123456789") == hostPortLength){
+			port = headerFieldHost->value + hostPortOffset;
+			portLength = hostPortLength;
+		}
+	}
+
+	response->httpStatusCode = httpStatusCode;
+	response->httpContentType = HTTP_CONTENT_TYPE_TEXT_HTML;
+
+	// Note: The error page replaces the representation, so do the header fields it comes with.
+	response->statusLine = errorPage->statusLine;
+	response->statusLineLength = errorPage->statusLineLength;
+	response->headerBlock = errorPage->headerBlock;
+	response->headerBlockLength = errorPage->headerBlockLength;
+
+	// Note: The status still goes out if the page does not fit into the response buffer, just without a body.
+	if((error = errorPage_render(errorPage, address, addressLength, port, portLength, (char*) response->dataSegment, response->responseBufferSize, &response->responseDataSegmentLength)) != ERROR_NO_ERROR){
+		response->responseDataSegmentLength = 0;
+	}
+
+	char contentLengthString[24];
+	snprintf(contentLengthString, sizeof(contentLengthString), "%" PRIuFAST64, response->responseDataSegmentLength);
+	HTTP_ADD_HEADER_FIELD(response, Content-Length, contentLengthString);
+
+	return ERROR(error);
+}
+
+SERVER_CONTEXT_HANDLER(server_defaultContextHandler){
+	ERROR_CODE error;
+
+	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tEntering default context handler...");
+
+	// Handle that 'index.html' can be reached without '/index.html' in the url.
+	uint_fast64_t symbolicFileLocationLength;
+	char* symbolicFileLocation;
+	if(request->requestURLLength == 1 && request->requestURL[0] == '/'){
+		symbolicFileLocationLength = 11/*"/index.html"*/;
+		symbolicFileLocation = alloca(sizeof(*symbolicFileLocation) * (symbolicFileLocationLength + 1));
+
+		memcpy(symbolicFileLocation, "/index.html", symbolicFileLocationLength);
+		symbolicFileLocation[symbolicFileLocationLength] = '\0';
+	}else{
+		symbolicFileLocationLength = request->requestURLLength;
+		 
+		symbolicFileLocation = alloca(sizeof(*symbolicFileLocation) * (symbolicFileLocationLength + 1));
+		memcpy(symbolicFileLocation, request->requestURL, symbolicFileLocationLength);
+		symbolicFileLocation[symbolicFileLocationLength] = '\0';
+	}
+
+	UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tChecking cache for entries...");
+
+	uint_fast64_t contentSize = 0;
+	time_t lastModified = 0;
+	char entityTag[HTTP_ENTITY_TAG_LENGTH + 1];
+
+	CacheObject* cacheObject = NULL;
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
+	if((error = cache_get(&server->cache, &cacheObject, (char*) symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
+		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tCache did not contaion an entry for: '%s'.", symbolicFileLocation);
+
+		if(error != ERROR_ENTRY_NOT_FOUND){
+			return ERROR(error);
+		}
+		else{
+			SERVER_TRANSLATE_SYMBOLIC_FILE_LOCATION(fileLocation, server, symbolicFileLocation, symbolicFileLocationLength);
+
+			__UTIL_ENABLE_ERROR_LOGGING__();
+			__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_RETRIEV_FILE_INFO);
+
+			struct stat fileInfo;
+			if(lstat(fileLocation, &fileInfo) == -1 || !S_ISREG(fileInfo.st_mode)){
+				return ERROR_(ERROR_FAILED_TO_RETRIEV_FILE_INFO, "File:'%s'", fileLocation);
+			}
+
+			// Note: Files too large for the cache and files the cache did not admit get streamed from disk.
+			bool streamFile = (uint_fast64_t) fileInfo.st_size > server->maxCachedFileSize;
+
+			if(!streamFile){
+				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tLoading cacheobject: '%s' from file: '%s'.", symbolicFileLocation, fileLocation);
+
+				__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_CACHE_ADMISSION_DENIED);
+				if((error = cache_load(&server->cache, &cacheObject, fileLocation, fileLocationLength, (char*) symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
+					if(error != ERROR_CACHE_ADMISSION_DENIED){
+						UTIL_LOG_CONSOLE(LOG_ERR, "Failed to load cacheObject.");
+
+						return ERROR(error);
+					}
+
+					cacheObject = NULL;
+
+					streamFile = true;
+				}
+			}
+
+			if(streamFile){
+				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tStreaming file: '%s' from disk.", fileLocation);
+
+				if((response->fileDescriptor = open(fileLocation, O_RDONLY)) == -1 || fstat(response->fileDescriptor, &fileInfo) == -1){
+					return ERROR_(ERROR_FAILED_TO_RETRIEV_FILE_INFO, "File:'%s'", fileLocation);
+				}
+
+				response->fileSize = fileInfo.st_size;
+
+				contentSize = fileInfo.st_size;
+				lastModified = fileInfo.st_mtime;
+
+				// Note: Same validator the file would get from the cache, clients that validate against either one keep matching.
+				cache_formatFileEntityTag(entityTag, &fileInfo);
+
+				const uint_fast64_t fileExtensionOffset = util_findLast(fileLocation, fileLocationLength, '.') + 1;
+
+				response->httpContentType = http_getContentType(fileLocation + fileExtensionOffset, fileLocationLength - fileExtensionOffset);
+			}
+		}
+		__UTIL_ENABLE_ERROR_LOGGING__();
 	}else{
 		UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tCache entry found.");
 	}
 
-	response->cacheObject = cacheObject;
-	response->staticContent = true;
+	// Note: The response may still be sent from the object after the worker went offline, e.g. while it waits for the socket to become writable again.
+	if(cacheObject != NULL){
+		cache_acquire(cacheObject);
+
+		response->leasedCacheObject = cacheObject;
+	}
+
+	// Note: 'Vary' and 'Content-Encoding' are part of the header block of the object and its variants.
+	if(cacheObject != NULL && cache_hasEncodedVariants(cacheObject)){
+		const HTTP_HeaderField* headerFieldAcceptEncoding = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_ACCEPT_ENCODING);
+		if(headerFieldAcceptEncoding != NULL){
+			const HTTP_ContentEncoding contentEncoding = http_negotiateContentEncoding(headerFieldAcceptEncoding->value, headerFieldAcceptEncoding->valueLength);
+
+			cacheObject = cache_getEncodedVariant(cacheObject, contentEncoding);
+		}
+	}
+
+	if(cacheObject != NULL){
+		response->cacheObject = cacheObject;
+
+		contentSize = cacheObject->size;
+		lastModified = cacheObject->lastModified;
+		memcpy(entityTag, cacheObject->entityTag, sizeof(entityTag));
+
+		response->httpContentType = cacheObject->httpContentType;
+	}
+
+	response->staticContent = true;
+
+	response->httpStatusCode = _200_OK;
+
+	char lastModifiedString[HTTP_DATE_LENGTH + 1];
+	http_formatDate(lastModifiedString, lastModified);
+
+	if(cacheObject != NULL){
+		response->headerBlock = cacheObject->headerBlock;
+		response->headerBlockLength = cacheObject->notModifiedHeaderBlockLength;
+	}else{
+		HTTP_ADD_HEADER_FIELD(response, ETag, entityTag);
+		HTTP_ADD_HEADER_FIELD(response, Last-Modified, lastModifiedString);
+	}
+
+	if(server_isNotModified(request, entityTag, lastModified)){
+		UTIL_LOG_CONSOLE(LOG_DEBUG, "Worker: \tNot modified.");
+
+		response->httpStatusCode = _304_NOT_MODIFIED;
+		response->staticContent = false;
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	if(cacheObject != NULL){
+		response->headerBlockLength = cacheObject->partialHeaderBlockLength;
+	}else{
+		HTTP_ADD_HEADER_FIELD(response, Accept-Ranges, "bytes");
+	}
+
+	return server_handleRangeRequest(server, request, response, contentSize, entityTag, lastModifiedString);
+}
+
+// Note: 'If-None-Match' takes precedence, 'If-Modified-Since' is only evaluated without it. Both only apply to GET and HEAD.
+bool server_isNotModified(HTTP_Request* request, const char* entityTag, const time_t lastModified){
+	if(request->httpRequestType != HTTP_REQUEST_TYPE_GET && request->httpRequestType != HTTP_REQUEST_TYPE_HEAD){
+		return false;
+	}
+
+	const HTTP_HeaderField* headerFieldIfNoneMatch = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_IF_NONE_MATCH);
+	if(headerFieldIfNoneMatch != NULL){
+		return http_entityTagListContains(headerFieldIfNoneMatch->value, headerFieldIfNoneMatch->valueLength, entityTag);
+	}
+
+	const HTTP_HeaderField* headerFieldIfModifiedSince = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_IF_MODIFIED_SINCE);
+	if(headerFieldIfModifiedSince != NULL){
+		time_t ifModifiedSince;
+
+		// Note: Unparsable dates are treated as if the header was absent.
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_VALUE);
+		const ERROR_CODE error = http_parseDate(headerFieldIfModifiedSince->value, &ifModifiedSince);
+		__UTIL_ENABLE_ERROR_LOGGING__();
+
+		return error == ERROR_NO_ERROR && lastModified <= ifModifiedSince;
+	}
+
+	return false;
+}
+
+// Note: Turns a static response into '206 Partial Content' or '416 Range Not Satisfiable' if the request asks for byte ranges, and adds the content headers. Ranges only apply as long as 'If-Range' still matches the entity tag, or the modification date.
+ERROR_CODE server_handleRangeRequest(Server* server, HTTP_Request* request, HTTP_Response* response, const uint_fast64_t contentSize, const char* entityTag, const char* lastModified){
+	response->numByteRanges = 0;
+
+	const HTTP_HeaderField* headerFieldRange = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_RANGE);
+	const HTTP_HeaderField* headerFieldIfRange = http_getKnownHeaderField(request, HTTP_HEADER_FIELD_IF_RANGE);
+
+	bool applyRange = headerFieldRange != NULL && request->httpRequestType == HTTP_REQUEST_TYPE_GET;
+
+	if(applyRange && headerFieldIfRange != NULL){
+		// Note: Entity tags are quoted, dates are not. Weak entity tags never match.
+		const char* validator = headerFieldIfRange->value[0] == '"' ? entityTag : lastModified;
+
+		applyRange = headerFieldIfRange->valueLength == strlen(validator) && memcmp(headerFieldIfRange->value, validator, headerFieldIfRange->valueLength) == 0;
+	}
+
+	uint_fast8_t numByteRanges = 0;
 
-	response->httpStatusCode = _200_OK;
+	// Note: Malformed or excessive ranges get ignored, the whole representation is sent instead.
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_VALUE);
+	if(applyRange && http_parseRange(headerFieldRange->value, headerFieldRange->valueLength, contentSize, response->byteRanges, &numByteRanges) != ERROR_NO_ERROR){
+		applyRange = false;
+	}
+	__UTIL_ENABLE_ERROR_LOGGING__();
 
-	response->httpContentType = cacheObject->httpContentType;
+	// Note: HTTP/2 streams only carry a single range, servers may ignore 'Range' altogether.
+	if(applyRange && numByteRanges > 1 && request->httpVersion.release == 2){
+		applyRange = false;
+	}
 
-	UTIL_INT_TO_STRING_HEAP_ALLOCATED(contentLengthString, response->cacheObject->size);
-	HTTP_ADD_HEADER_FIELD(response, Content-Length, contentLengthString);
+	char contentLengthString[24];
+
+	if(!applyRange){
+		// Note: Cached objects carry 'Content-Length' and 'Content-Type' at the end of their header block.
+		if(response->cacheObject != NULL){
+			response->headerBlockLength = response->cacheObject->headerBlockLength;
+
+			return ERROR(ERROR_NO_ERROR);
+		}
+
+		snprintf(contentLengthString, sizeof(contentLengthString), "%" PRIuFAST64, contentSize);
+		HTTP_ADD_HEADER_FIELD(response, Content-Length, contentLengthString);
+
+		HTTP_ADD_HEADER_FIELD(response, Content-Type, http_contentTypeToString(response->httpContentType));
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	char contentRange[64];
+
+	if(numByteRanges == 0){
+		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tRange not satisfiable: '%s'.", headerFieldRange->value);
+
+		response->staticContent = false;
+
+		snprintf(contentRange, sizeof(contentRange), "bytes */%" PRIuFAST64, contentSize);
+		HTTP_ADD_HEADER_FIELD(response, Content-Range, contentRange);
+
+		return server_constructErrorPage(server, request, response, _416_REQUEST_RANGE_NOT_SATISFIABLE);
+	}
+
+	response->httpStatusCode = _206_PARTIAL_CONTENT;
+	response->numByteRanges = numByteRanges;
+
+	if(numByteRanges == 1){
+		const HTTP_ByteRange* range = &response->byteRanges[0];
+
+		snprintf(contentRange, sizeof(contentRange), "bytes %" PRIuFAST64 "-%" PRIuFAST64 "/%" PRIuFAST64, range->first, range->last, contentSize);
+		HTTP_ADD_HEADER_FIELD(response, Content-Range, contentRange);
+
+		const uint_fast64_t contentLength = range->last - range->first + 1;
+
+		snprintf(contentLengthString, sizeof(contentLengthString), "%" PRIuFAST64, contentLength);
+		HTTP_ADD_HEADER_FIELD(response, Content-Length, contentLengthString);
+
+		HTTP_ADD_HEADER_FIELD(response, Content-Type, http_contentTypeToString(response->httpContentType));
+
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	// Note: 'server_prepareResponse' formats the same part headers again when it lays out the body.
+	const char* contentType = http_contentTypeToString(response->httpContentType);
 
-	HTTP_ADD_HEADER_FIELD(response, Content-Type, http_contentTypeToString(response->httpContentType));
+	uint_fast64_t contentLength = snprintf(NULL, 0, "\r\n--%s--\r\n", CONSTANTS_HTTP_MULTIPART_BYTERANGES_BOUNDARY);
 
-	HTTP_ADD_HEADER_FIELD(response, Connection, "Closed");
+	uint_fast8_t i;
+	for(i = 0; i < numByteRanges; i++){
+		const HTTP_ByteRange* range = &response->byteRanges[i];
+
+		contentLength += server_formatByteRangePartHeader(NULL, 0, contentType, range, contentSize) + range->last - range->first + 1;
+	}
+
+	snprintf(contentLengthString, sizeof(contentLengthString), "%" PRIuFAST64, contentLength);
+	HTTP_ADD_HEADER_FIELD(response, Content-Length, contentLengthString);
+
+	HTTP_ADD_HEADER_FIELD(response, Content-Type, "multipart/byteranges; boundary=" CONSTANTS_HTTP_MULTIPART_BYTERANGES_BOUNDARY);
 
 	return ERROR(ERROR_NO_ERROR);
 }
@@ -742,7 +2451,6 @@ ERROR_CODE server_loadProperties(Server* server, char* propertyFileLocation, con
 	PROPERTY_EXISTS(server, LOGFILE_DIRECTORY);
 	INTEGER_PROPERTY_EXISTS(server, EPOLL_EVENT_BUFFER_SIZE);
 	INTEGER_PROPERTY_EXISTS(server, HTTP_CACHE_SIZE);
-	INTEGER_PROPERTY_EXISTS(server, ERROR_PAGE_CACHE_SIZE);
 
 	INTEGER_PROPERTY_EXISTS(server, HTTP_READ_BUFFER_SIZE);
 	
@@ -820,7 +2528,35 @@ ERROR_CODE server_initSSL_Context(Server* server){
 	}
 
 	SSL_CTX_set_min_proto_version(server->sslContext, TLS1_3_VERSION);
+
+	// Note: Set once on the context, every 'SSL' object created from it inherits the ciphersuite.
+	SSL_CTX_set_ciphersuites(server->sslContext, "TLS_AES_256_GCM_SHA384");
+
+	// Let idle connections give their record buffers back to OpenSSL, and let writes that would block report the records they already wrote.
+	SSL_CTX_set_mode(server->sslContext, SSL_MODE_RELEASE_BUFFERS | SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+	// Note: OpenSSL hands the session keys to the kernel after the handshake if the kernel supports it, otherwise it silently keeps encrypting in user space. io_uring connections run over memory BIOs, which can't be offloaded.
+	const char* kernelTLS = SERVER_GET_PROPERTY_OR_DEFAULT(server, SSL_KERNEL_TLS);
+
+	if(strncmp(kernelTLS, "true", 5) == 0 && server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+#ifndef OPENSSL_NO_KTLS
+		SSL_CTX_set_options(server->sslContext, SSL_OP_ENABLE_KTLS);
+#else
+		UTIL_LOG_CONSOLE(LOG_INFO, "Server: \tOpenSSL was built without kTLS support.");
+#endif
+	}
 	
+	// Note: HTTP/2 gets negotiated with ALPN during the handshake.
+	server->http2 = strncmp(SERVER_GET_PROPERTY_OR_DEFAULT(server, HTTP2), "true", 5) == 0;
+
+	if(server->http2 && server->httpReadBufferSize < HTTP2_MIN_BUFFER_SIZE){
+		UTIL_LOG_CONSOLE_(LOG_INFO, "Server:\t\tProperty '%s' has to be at least '%d' for HTTP/2.", CONSTANTS_HTTP_READ_BUFFER_SIZE_PROPERTY_NAME, HTTP2_MIN_BUFFER_SIZE);
+
+		return ERROR(ERROR_INVALID_VALUE);
+	}
+
+	SSL_CTX_set_alpn_select_cb(server->sslContext, server_selectApplicationProtocol, server);
+
 	// Generate certificate.
 	// openssl req -x509 -nodes -days 365 -newkey rsa:2048 -keyout testCertificate.pem -out testCertificate.pem
 
@@ -862,6 +2598,19 @@ ERROR_CODE server_initSSL_Context(Server* server){
 	return ERROR(ERROR_NO_ERROR);
 }
 
+// Note: Prefers HTTP/2, clients that don't offer it get HTTP/1.1. Without a common protocol the handshake continues without ALPN.
+int server_selectApplicationProtocol(SSL* sslInstance, const unsigned char** out, unsigned char* outLength, const unsigned char* in, unsigned int inLength, void* data){
+	Server* server = data;
+
+	const uint_fast8_t offset = server->http2 ? 0 : SERVER_ALPN_PROTOCOLS_HTTP_1_1_OFFSET;
+
+	if(SSL_select_next_proto((unsigned char**) out, outLength, (const unsigned char*) SERVER_ALPN_PROTOCOLS + offset, sizeof(SERVER_ALPN_PROTOCOLS) - 1 - offset, in, inLength) != OPENSSL_NPN_NEGOTIATED){
+		return SSL_TLSEXT_ERR_NOACK;
+	}
+
+	return SSL_TLSEXT_ERR_OK;
+}
+
 ERROR_CODE server_initEpoll(Server* server){
 	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tInitialising epoll...");
 
@@ -883,11 +2632,245 @@ ERROR_CODE server_initEpoll(Server* server){
 	return ERROR(ERROR_NO_ERROR);
 }
 
+ERROR_CODE server_initEpollWorkers(Server* server, const uint_fast16_t port){
+	ERROR_CODE error;
+
+	const uint_fast16_t numWorkers = server->epollWorkerThreads.numWorkers;
+
+	server->epollWorkers = malloc(sizeof(*server->epollWorkers) * numWorkers);
+	if(server->epollWorkers == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	// One idle list, one list of connections that stalled while sending and one connection pool per event loop.
+	const uint_fast16_t numEventLoops = server_getNumEventLoops(server);
+
+	server->idleConnectionLists = calloc(numEventLoops * 2, sizeof(*server->idleConnectionLists));
+	if(server->idleConnectionLists == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	server->connectionPools = calloc(numEventLoops, sizeof(*server->connectionPools));
+	if(server->connectionPools == NULL){
+		return ERROR(ERROR_OUT_OF_MEMORY);
+	}
+
+	uint_fast16_t i;
+	for(i = 0; i < numEventLoops * 2; i++){
+		if(pthread_mutex_init(&server->idleConnectionLists[i].lock, NULL) != 0){
+			return ERROR(ERROR_PTHREAD_MUTEX_INITIALISATION_FAILED);
+		}
+
+		server->idleConnectionLists[i].timeout = i < numEventLoops ? server->keepAliveTimeout : server->sendTimeout;
+	}
+
+	for(i = 0; i < numEventLoops; i++){
+		if((error = server_initConnectionPool(&server->connectionPools[i], server->httpReadBufferSize)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+	}
+
+	for(i = 0; i < numWorkers; i++){
+		EpollWorker* worker = &server->epollWorkers[i];
+
+		worker->server = server;
+		worker->id = i;
+		worker->nextIdleSweep = 0;
+
+		worker->ring = NULL;
+
+		if(server->listenerMode == SERVER_LISTENER_MODE_SHARED && server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+			worker->socketFileDescriptor = -1;
+			worker->epollFileDescriptor = server->epollClientHandlingFileDescriptor;
+			worker->idleConnections = &server->idleConnectionLists[0];
+			worker->sendingConnections = &server->idleConnectionLists[numEventLoops];
+			worker->connectionPool = &server->connectionPools[0];
+		}else if(server->listenerMode == SERVER_LISTENER_MODE_SHARED){
+			// Note: Every io_uring worker has its own ring, so only the listener is shared.
+			worker->socketFileDescriptor = server->socketFileDescriptor;
+			worker->epollFileDescriptor = -1;
+			worker->idleConnections = &server->idleConnectionLists[i];
+			worker->sendingConnections = &server->idleConnectionLists[numEventLoops + i];
+			worker->connectionPool = &server->connectionPools[i];
+		}else{
+			worker->socketFileDescriptor = -1;
+			worker->epollFileDescriptor = -1;
+			worker->idleConnections = &server->idleConnectionLists[i];
+			worker->sendingConnections = &server->idleConnectionLists[numEventLoops + i];
+			worker->connectionPool = &server->connectionPools[i];
+		}
+	}
+
+	if(server->listenerMode == SERVER_LISTENER_MODE_SHARED){
+		return ERROR(ERROR_NO_ERROR);
+	}
+
+	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tCreating sharded worker sockets...");
+
+	for(i = 0; i < numWorkers; i++){
+		EpollWorker* worker = &server->epollWorkers[i];
+
+		if((error = server_createListeningSocket(&worker->socketFileDescriptor, port, true)) != ERROR_NO_ERROR){
+			return ERROR(error);
+		}
+
+		if(server->networkBackend == SERVER_NETWORK_BACKEND_IO_URING){
+			continue;
+		}
+
+		worker->epollFileDescriptor = epoll_create1(0x0000);
+		if(worker->epollFileDescriptor == -1){
+			return ERROR(ERROR_FAILED_TO_INITIALISE_EPOLL);
+		}
+
+		// Note: Client connections carry their 'Connection' in the event data, the listener is the only entry without one.
+		struct epoll_event event = {0};
+		event.events = EPOLLIN;
+		event.data.ptr = NULL;
+		epoll_ctl(worker->epollFileDescriptor, EPOLL_CTL_ADD, worker->socketFileDescriptor, &event);
+	}
+
+	// Note: The filter indexes the reuseport group by CPU, which only maps onto the right worker if there is exactly one worker per core.
+	if((int_fast32_t) numWorkers == util_getNumAvailableProcessorCores()){
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_BIND_SERVER_SOCKET);
+		if(server_attachReusePortCPU_Filter(server->epollWorkers[0].socketFileDescriptor) != ERROR_NO_ERROR){
+			UTIL_LOG_CONSOLE(LOG_INFO, "Server: \tFailed to attach reuseport CPU filter, falling back to hash based load balancing.");
+		}
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+// Note: Shared epoll workers all serve the same epoll instance, every other worker runs its own event loop.
+inline uint_fast16_t server_getNumEventLoops(Server* server){
+	if(server->listenerMode == SERVER_LISTENER_MODE_SHARED && server->networkBackend == SERVER_NETWORK_BACKEND_EPOLL){
+		return 1;
+	}
+
+	return server->epollWorkerThreads.numWorkers;
+}
+
+ERROR_CODE server_createListeningSocket(int* socketFileDescriptor, const uint_fast16_t port, const bool reusePort){
+	struct sockaddr_in6 serverSocketAddress = {0};
+	serverSocketAddress.sin6_flowinfo = 0;
+	serverSocketAddress.sin6_family = AF_INET6;
+	serverSocketAddress.sin6_port = htons(port);
+	serverSocketAddress.sin6_addr = in6addr_any;
+
+	// Note: Listeners are non blocking, so accept loops can drain the whole backlog without stalling a worker.
+	*socketFileDescriptor = socket(serverSocketAddress.sin6_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if(*socketFileDescriptor == -1){
+		return ERROR(ERROR_UNIX_DOMAIN_SOCKET_INITIALISATION_FAILED);
+	}
+
+	const int enable = 1;
+
+	// Connections the server closed itself (idle, max requests) linger in TIME_WAIT, don't let them block a restart.
+	if(setsockopt(*socketFileDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0){
+		return ERROR_(ERROR_FAILED_TO_BIND_SERVER_SOCKET, "SO_REUSEADDR: '%s'.", strerror(errno));
+	}
+
+	if(reusePort){
+		if(setsockopt(*socketFileDescriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0){
+			return ERROR_(ERROR_FAILED_TO_BIND_SERVER_SOCKET, "SO_REUSEPORT: '%s'.", strerror(errno));
+		}
+	}
+
+ 	if(bind(*socketFileDescriptor, (struct sockaddr*) &serverSocketAddress, sizeof(serverSocketAddress)) != 0){
+		return ERROR_(ERROR_FAILED_TO_BIND_SERVER_SOCKET, "Port: %" PRIuFAST16 " '%s'.", port, strerror(errno));
+	}
+
+	if(listen(*socketFileDescriptor, SOMAXCONN) < 0){
+		return ERROR(ERROR_FAILED_TO_LISTEN_ON_SERVER_SOCKET);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+ERROR_CODE server_attachReusePortCPU_Filter(const int socketFileDescriptor){
+	// Return the CPU the packet was received on, the kernel uses the value as index into the reuseport group.
+	struct sock_filter code[] = {
+		{BPF_LD | BPF_W | BPF_ABS, 0, 0, SKF_AD_OFF + SKF_AD_CPU},
+		{BPF_RET | BPF_A, 0, 0, 0}
+	};
+
+	struct sock_fprog program = {0};
+	program.len = UTIL_ARRAY_LENGTH(code);
+	program.filter = code;
+
+	if(setsockopt(socketFileDescriptor, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) != 0){
+		return ERROR_(ERROR_FAILED_TO_BIND_SERVER_SOCKET, "SO_ATTACH_REUSEPORT_CBPF: '%s'.", strerror(errno));
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+void server_acceptConnections(EpollWorker* worker, const int socketFileDescriptor){
+	for(;;){
+		struct sockaddr_in6 clientSocketAddress;
+		socklen_t socketAddressLength = sizeof(clientSocketAddress);
+
+		const int clientSocketFD = accept4(socketFileDescriptor, (struct sockaddr*) &clientSocketAddress, &socketAddressLength, SOCK_NONBLOCK);
+		if(clientSocketFD == -1){
+			if(errno == EINTR || errno == ECONNABORTED){
+				continue;
+			}
+
+			if(errno != EAGAIN && errno != EWOULDBLOCK){
+				UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to accept client connection: '%s'.", strerror(errno));
+			}
+
+			break;
+		}
+
+		// Note: Responses on a kept alive connection are small writes that would otherwise wait for the clients delayed ACK.
+		const int enable = 1;
+		setsockopt(clientSocketFD, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+		Connection* connection;
+		if(server_acquireConnection(worker, &connection, clientSocketFD) != ERROR_NO_ERROR){
+			close(clientSocketFD);
+
+			continue;
+		}
+
+		// The client speaks first, wait for its 'ClientHello'.
+		struct epoll_event event = {0};
+		event.events = EPOLLIN | EPOLLONESHOT;
+		event.data.ptr = connection;
+
+		server_markConnectionIdle(worker, connection, false);
+
+		if(epoll_ctl(worker->epollFileDescriptor, EPOLL_CTL_ADD, clientSocketFD, &event) != 0){
+			UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to register client connection: '%s'.", strerror(errno));
+
+			server_unmarkConnectionIdle(worker, connection);
+			server_releaseConnection(worker, connection);
+			close(clientSocketFD);
+
+			continue;
+		}
+
+		char clientIP_Address[INET6_ADDRSTRLEN];
+		inet_ntop(AF_INET6, &clientSocketAddress.sin6_addr, clientIP_Address, INET6_ADDRSTRLEN);
+		UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tClient connected, '%s' [FD:%d].", clientIP_Address, clientSocketFD);
+	}
+}
+
+const char* server_getPropertyOrDefault(Server* server, const char* name, const char* defaultValue){
+	Property* property;
+	if(properties_get(&server->properties, &property, name, strlen(name)) != ERROR_NO_ERROR || property->valueLength == 0){
+		return defaultValue;
+	}
+
+	return property->value;
+}
+
 inline void server_free(Server* server){
 	ERROR_CODE** returnValues = (ERROR_CODE**) threadPool_free(&server->epollWorkerThreads);
 
+	uint_fast64_t i;
 	if(*returnValues != NULL){
-		uint_fast64_t i;
 		for(i = 0; i < server->epollWorkerThreads.numWorkers; i++){
 			ERROR_CODE* errorCode = (ERROR_CODE*) returnValues[i];
 
@@ -897,19 +2880,85 @@ inline void server_free(Server* server){
 		}
 	}
 
+	if(server->listenerMode == SERVER_LISTENER_MODE_SHARDED && server->epollWorkers != NULL){
+		for(i = 0; i < server->epollWorkerThreads.numWorkers; i++){
+			close(server->epollWorkers[i].socketFileDescriptor);
+			close(server->epollWorkers[i].epollFileDescriptor);
+		}
+	}
+
+	const uint_fast64_t numEventLoops = server_getNumEventLoops(server);
+
+	// Connections still waiting for their clients, all others have been closed by the workers.
+	if(server->idleConnectionLists != NULL){
+		for(i = 0; i < numEventLoops * 2; i++){
+			ConnectionIdleList* idleList = &server->idleConnectionLists[i];
+
+			while(idleList->head != NULL){
+				Connection* connection = idleList->head;
+				idleList->head = connection->idleNext;
+
+				close(connection->socketFileDescriptor);
+
+				server_freeConnection(connection);
+			}
+
+			pthread_mutex_destroy(&idleList->lock);
+		}
+	}
+
+	if(server->connectionPools != NULL){
+		for(i = 0; i < numEventLoops; i++){
+			server_freeConnectionPool(&server->connectionPools[i]);
+		}
+	}
+
+	free(server->connectionPools);
+	free(server->idleConnectionLists);
+	free(server->epollWorkers);
+
 	close(server->socketFileDescriptor);
 	close(server->epollAcceptFileDescriptor);
 	close(server->epollClientHandlingFileDescriptor);
 
 	SSL_CTX_free(server->sslContext);
 
+	router_free(&server->router);
+
+	for(i = 0; i < ERROR_PAGE_NUM_STATUS_CODES; i++){
+		errorPage_free(&server->errorPages[i]);
+	}
+
+	http_freeMimeTypeRegistry();
+
+	LinkedListIterator it;
+	linkedList_initIterator(&it, &server->contexts);
+	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+		Context* context = LINKED_LIST_ITERATOR_NEXT_PTR(&it, Context);
+
+		server_freeContext(context);
+
+		free(context);
+	}
+
+	linkedList_free(&server->contexts);
+
 	sem_destroy(&server->running);
 
 	closelog();
 }
 
 inline void server_start(Server* server){
+	ERROR_CODE error;
+
 	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: Starting server...");
+
+	if((error = server_compileRouter(server)) != ERROR_NO_ERROR){
+		UTIL_LOG_CONSOLE_(LOG_ERR, "Server: Failed to compile router. '%s'.", util_toErrorString(error));
+
+		return;
+	}
+
 	server_run(server);
 }
 
@@ -920,7 +2969,7 @@ void server_sigHandler(int signal){
 		}
 
 		case SIGINT:{
-			server_stop(&server);
+			server_stop(server);
 
 			break;
 		}
@@ -958,8 +3007,32 @@ void server_run(Server* server){
 	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tStarting worker threads...");
 
 	uint_fast16_t i;
+	Runnable* workerRunnable = server->networkBackend == SERVER_NETWORK_BACKEND_IO_URING ? (Runnable*) ioUring_run : (Runnable*) epoll_run;
+
 	for(i = 0; i < server->epollWorkerThreads.numWorkers; i++){
-		threadPool_run(&server->epollWorkerThreads, (Runnable*) epoll_run, server);
+		threadPool_run(&server->epollWorkerThreads, workerRunnable, &server->epollWorkers[i]);
+	}
+
+	sigset_t signalMask;
+	sigemptyset(&signalMask);
+
+	int running;
+
+	// Sharded and io_uring workers do their own accepting, just wait until the server gets stopped.
+	if(server->listenerMode == SERVER_LISTENER_MODE_SHARDED || server->networkBackend == SERVER_NETWORK_BACKEND_IO_URING){
+		UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tWaiting for workers...");
+
+		do{
+			sigsuspend(&signalMask);
+
+			if(sem_getvalue(&server->running, &running) != 0){
+				UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to retrieve server running state: '%s'.", strerror(errno));
+
+				break;
+			}
+		}while(running == 0);
+
+		return;
 	}
 
 	Property* epollReadBufferSizePoroperty;
@@ -977,12 +3050,8 @@ void server_run(Server* server){
 	struct epoll_event* epollEventBuffer;
 	epollEventBuffer = malloc(sizeof(struct epoll_event) * epollReadBufferSize);
 
-	sigset_t signalMask;
-	sigemptyset(&signalMask);
-
 	UTIL_LOG_CONSOLE(LOG_DEBUG, "Server: \tEntering server epoll event loop...");
 
-	int running;
 	do{
 		if(sem_getvalue(&server->running, &running) != 0){
 			UTIL_LOG_CONSOLE_(LOG_ERR, "Failed to retrieve server running state: '%s'.", strerror(errno));
@@ -1003,39 +3072,64 @@ void server_run(Server* server){
 		int i;
 		for(i = 0; i < numberEvents; ++i){
 			if(epollEventBuffer[i].data.fd == server->socketFileDescriptor){
-				struct sockaddr_in clientSocketAddress;
-				socklen_t socketAddressLength = sizeof(clientSocketAddress);
-				int clientSocketFD = accept(server->socketFileDescriptor, (struct sockaddr*) &clientSocketAddress, &socketAddressLength);
-
-				const int flag = fcntl(clientSocketFD, F_GETFL, 0);
-				fcntl(clientSocketFD, F_SETFL, flag | O_NONBLOCK);
-
-				struct epoll_event event = {0};
-				event.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLONESHOT;
-				event.data.fd = clientSocketFD;
-				epoll_ctl(server->epollClientHandlingFileDescriptor, EPOLL_CTL_ADD, clientSocketFD, &event);
-
-				char clientIP_Address[INET6_ADDRSTRLEN];
-				inet_ntop(AF_INET6, &clientSocketAddress, clientIP_Address, INET6_ADDRSTRLEN);
-				UTIL_LOG_CONSOLE_(LOG_DEBUG, "Worker: \tClient connected, '%s' [FD:%d].", clientIP_Address, clientSocketFD);
+				// Note: All workers share the same epoll instance and idle list, any of them will do.
+				server_acceptConnections(&server->epollWorkers[0], server->socketFileDescriptor);
 			}
 		}
 	}while(running == 0);
 }
 
 inline ERROR_CODE server_addContext(Server* server, const char* location, ContextHandler* contextHandler){
+	return server_addContext_(server, HTTP_REQUEST_TYPE_UNKNOWN, location, contextHandler);
+}
+
+inline ERROR_CODE server_addContext_(Server* server, const HTTP_RequestType requestType, const char* location, ContextHandler* contextHandler){
 	Context* context = malloc(sizeof(*context));
 	if(context == NULL){
 		return ERROR(ERROR_OUT_OF_MEMORY);
 	}
 
-	server_initContext(context, location, strlen(location), contextHandler);
+	ERROR_CODE error;
+	if((error = server_initContext(context, location, strlen(location), contextHandler)) != ERROR_NO_ERROR){
+		free(context);
+
+		return ERROR(error);
+	}
+
+	context->requestType = requestType;
 
 	linkedList_add(&server->contexts, &context, sizeof(Context*));
 
 	return ERROR(ERROR_NO_ERROR);
 }
 
+// Note: Has to run once all contexts got added and before the first request gets dispatched.
+ERROR_CODE server_compileRouter(Server* server){
+	ERROR_CODE error;
+
+	router_init(&server->router);
+
+	LinkedListIterator it;
+	linkedList_initIterator(&it, &server->contexts);
+	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
+		Context* context = LINKED_LIST_ITERATOR_NEXT_PTR(&it, Context);
+
+		if((error = router_add(&server->router, context->requestType, context->symbolicFileLocation, context->symbolicFileLocationLength, context)) != ERROR_NO_ERROR){
+			router_free(&server->router);
+
+			return ERROR(error);
+		}
+	}
+
+	if((error = router_compile(&server->router)) != ERROR_NO_ERROR){
+		router_free(&server->router);
+
+		return ERROR(error);
+	}
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
 inline ERROR_CODE server_initContext(Context* context, const char* symbolicFileLocation, const uint_fast64_t symbolicFileLocationLength, ContextHandler* contextHandler){
 	context->symbolicFileLocationLength = symbolicFileLocationLength;
 
@@ -1046,37 +3140,25 @@ inline ERROR_CODE server_initContext(Context* context, const char* symbolicFileL
 
 	strncpy(context->symbolicFileLocation, symbolicFileLocation, symbolicFileLocationLength + 1);
 
+	context->requestType = HTTP_REQUEST_TYPE_UNKNOWN;
 	context->contextHandler = contextHandler;
 
 	return ERROR(ERROR_NO_ERROR);
 }
 
 inline ERROR_CODE server_getContextHandler(Server* server, ContextHandler** contextHandler, HTTP_Request* request){
-	char* baseDirectory;
-	uint_fast64_t baseDirectoryLength;
-	if(util_getBaseDirectory(&baseDirectory, &baseDirectoryLength, request->requestURL, request->requestURLLength) != ERROR_NO_ERROR){
-		*contextHandler = NULL;
-
-		return ERROR_(ERROR_INVALID_REQUEST_URL, "Failed to find baseDirectory URL:'%s'.", request->requestURL);
-	}
-
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &server->contexts);
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		Context* context = LINKED_LIST_ITERATOR_NEXT_PTR(&it, Context);
+	ERROR_CODE error;
 
-		if(strncmp(baseDirectory, context->symbolicFileLocation, baseDirectoryLength) == 0){
-			if(context->symbolicFileLocation[baseDirectoryLength] == '\0'){
-				*contextHandler = context->contextHandler;
+	*contextHandler = NULL;
 
-				return ERROR(ERROR_NO_ERROR);
-			}
-		}
+	Context* context;
+	if((error = router_lookup(&server->router, request, (void**) &context)) != ERROR_NO_ERROR){
+		return ERROR(error);
 	}
 
-	*contextHandler = NULL;
+	*contextHandler = context->contextHandler;
 
-	return ERROR(ERROR_ENTRY_NOT_FOUND);
+	return ERROR(ERROR_NO_ERROR);
 }
 
 inline void server_freeContext(Context* context){
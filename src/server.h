@@ -2,12 +2,17 @@
 #define SERVER_H
 
 #include "http.h"
+#include "http2.h"
+#include "router.h"
+#include "errorPage.h"
 #include "linkedList.h"
+#include "arena.h"
 #include "threadPool.h"
 #include "util.h"
 #include "properties.h"
 #include "resources.h"
 #include "constants.h"
+#include "ioUring.h"
 
 #include <netdb.h>
 #include <openssl/crypto.h>
@@ -27,20 +32,177 @@
 #define SERVER_GET_SSL_ERROR_STRING(name) char name[SERVER_SSL_ERROR_STRING_BUFFER_LENGTH]; \
 ERR_error_string_n(ERR_get_error(), name, SERVER_SSL_ERROR_STRING_BUFFER_LENGTH);
 
-typedef struct {
+// Milliseconds between two idle connection sweeps of a worker.
+#define SERVER_IDLE_SWEEP_INTERVAL 1000
+
+// Note: Below this size a single write from the cached copy is cheaper than opening the file for 'SSL_sendfile'.
+#define SERVER_KERNEL_TLS_SENDFILE_MIN_SIZE KB(16)
+
+// Note: The header block, followed by a part header and body segment per byte range and the closing boundary.
+#define SERVER_MAX_WRITE_SEGMENTS (2 + 2 * HTTP_MAX_BYTE_RANGES)
+
+// Note: ALPN protocol list in wire format, in order of preference. Without HTTP/2 the list starts after 'h2'.
+#define SERVER_ALPN_PROTOCOLS "\x02h2\x08http/1.1"
+#define SERVER_ALPN_PROTOCOLS_HTTP_1_1_OFFSET 3
+
+// Note: Enough for the response header fields of a typical request, larger responses chain further blocks.
+#define SERVER_ARENA_BLOCK_SIZE KB(4)
+
+#define SERVER_IO_URING_QUEUE_DEPTH 256
+#define SERVER_IO_URING_NUM_RECEIVE_BUFFERS 256
+#define SERVER_IO_URING_RECEIVE_BUFFER_SIZE 4096
+#define SERVER_IO_URING_RECEIVE_BUFFER_GROUP 0
+
+// Note: The operation is encoded in the lower bits of the completion user data, the remaining bits hold the 'Connection' pointer.
+#define SERVER_IO_URING_OPERATION_RECEIVE 0
+#define SERVER_IO_URING_OPERATION_SEND 1
+#define SERVER_IO_URING_OPERATION_ACCEPT 2
+#define SERVER_IO_URING_OPERATION_TIMEOUT 3
+#define SERVER_IO_URING_OPERATION_MASK 3
+
+#define SERVER_GET_PROPERTY_OR_DEFAULT(server, name) server_getPropertyOrDefault(server, CONSTANTS_ ## name ## _PROPERTY_NAME, CONSTANTS_ ## name ## _PROPERTY_DEFAULT_VALUE)
+
+typedef enum{
+	SERVER_LISTENER_MODE_SHARED = 0,
+	SERVER_LISTENER_MODE_SHARDED
+}ServerListenerMode;
+
+typedef enum{
+	SERVER_NETWORK_BACKEND_EPOLL = 0,
+	SERVER_NETWORK_BACKEND_IO_URING
+}ServerNetworkBackend;
+
+// Note: Connections waiting for the client, ordered by their idle deadline since every connection on a list uses the same timeout.
+typedef struct{
+	pthread_mutex_t lock;
+	struct connection* head;
+	struct connection* tail;
+	uint_fast64_t timeout;
+}ConnectionIdleList;
+
+// Note: Recycles connections together with their 'SSL' objects and the I/O buffers, which are all of size 'bufferSize'.
+typedef struct{
+	pthread_mutex_t lock;
+	struct connection* freeConnections;
+	// Note: Free buffers are linked through their first bytes.
+	void* freeBuffers;
+	uint_fast64_t bufferSize;
+}ConnectionPool;
+
+typedef struct{
+	struct server* server;
+	// Note: In 'SERVER_LISTENER_MODE_SHARED' the socket is (-1), the epoll instance is the servers shared 'epollClientHandlingFileDescriptor' and the idle list as well as the connection pool are shared by all workers.
+	int socketFileDescriptor;
+	int epollFileDescriptor;
+	ConnectionIdleList* idleConnections;
+	// Note: Connections that wait for the client to take more of a response, they get 'sendTimeout' instead of 'keepAliveTimeout'.
+	ConnectionIdleList* sendingConnections;
+	ConnectionPool* connectionPool;
+	// Note: Only set for 'SERVER_NETWORK_BACKEND_IO_URING', every worker owns its ring.
+	IoUring* ring;
+	// Note: Set if the multishot accept or the sweep timeout could not be armed because the submission queue was full, the event loop retries before it waits for completions again.
+	bool acceptPending;
+	bool timeoutPending;
+	// Note: Per request allocations, reset once the response header is serialised.
+	Arena arena;
+	uint_fast64_t nextIdleSweep;
+	uint_fast16_t id;
+}EpollWorker;
+
+// Note: Segments without 'data' are read from the responses file, starting at 'fileOffset'.
+typedef struct{
+	const int8_t* data;
+	uint_fast64_t fileOffset;
+	uint_fast64_t length;
+}WriteSegment;
+
+typedef enum{
+	SERVER_CONNECTION_STATE_HANDSHAKING = 0,
+	SERVER_CONNECTION_STATE_READING,
+	SERVER_CONNECTION_STATE_HANDLING,
+	SERVER_CONNECTION_STATE_WRITING,
+	SERVER_CONNECTION_STATE_CLOSING,
+	// Note: HTTP/2 got negotiated, the connection multiplexes its streams until it gets closed.
+	SERVER_CONNECTION_STATE_HTTP2,
+	// Note: io_uring only, the connection waits for its in flight operations before it can be released.
+	SERVER_CONNECTION_STATE_DRAINING
+}ConnectionState;
+
+typedef struct connection{
+	SSL* sslInstance;
+	int socketFileDescriptor;
+	ConnectionState state;
+	bool keepAlive;
+	bool idle;
+	// Note: Set while the connection is on its workers 'sendingConnections' instead of its 'idleConnections'.
+	bool sending;
+	uint_fast64_t numRequests;
+	uint_fast64_t idleDeadline;
+	struct connection* idlePrevious;
+	// Note: Also links the connection into its pools free list while it is not in use.
+	struct connection* idleNext;
+	uint_fast64_t readBufferSize;
+	uint_fast64_t readBufferOffset;
+	// Note: Length of the request at the beginning of the read buffer, everything after it belongs to pipelined requests.
+	uint_fast64_t requestLength;
+	// Note: Both buffers are only held while there is data to process, idle connections give them back to the pool.
+	int8_t* readBuffer;
+	int8_t* responseBuffer;
+	// Note: io_uring only, outgoing TLS records get copied out of the connections memory BIO into the send buffer.
+	int8_t* sendBuffer;
+	uint_fast64_t sendBufferLength;
+	uint_fast64_t sendBufferOffset;
+	bool sendInFlight;
+	bool sendFailed;
+	bool receiveArmed;
+	bool socketShutdown;
+	// Note: Progress of the response being written, a write that would block resumes from here once the socket is writable again.
+	WriteSegment writeSegments[SERVER_MAX_WRITE_SEGMENTS];
+	uint_fast8_t numWriteSegments;
+	uint_fast8_t writeSegmentIndex;
+	uint_fast64_t writeOffset;
+	// Note: Stages file segments when they can't be sent with 'SSL_sendfile'.
+	int8_t* fileBuffer;
+	uint_fast64_t fileBufferOffset;
+	uint_fast64_t fileBufferLength;
+	// Note: Keeps track of the header block and the body of the request at the beginning of the read buffer across reads. The body may still be arriving after the request got answered.
+	HTTP_Parser parser;
+	HTTP_Request request;
+	HTTP_Response response;
+	// Note: Only set for HTTP/2 connections, which use 'responseBuffer' to stage the frames they write.
+	Http2Session* http2Session;
+}Connection;
+
+typedef struct server{
 	LinkedList contexts;
+	// Note: Compiled from 'contexts' when the server starts, contexts added afterwards are not routed.
+	Router router;
 	PropertyFile properties;
 	SSL_CTX* sslContext;
 	int socketFileDescriptor;
 	int epollAcceptFileDescriptor;
 	int epollClientHandlingFileDescriptor;
 	ThreadPool epollWorkerThreads;
+	EpollWorker* epollWorkers;
+	ServerListenerMode listenerMode;
+	ServerNetworkBackend networkBackend;
+	// Note: The idle lists of all event loops, followed by their lists of connections that stalled while sending.
+	ConnectionIdleList* idleConnectionLists;
+	ConnectionPool* connectionPools;
+	uint_fast64_t httpReadBufferSize;
+	uint_fast64_t keepAliveTimeout;
+	uint_fast64_t sendTimeout;
+	uint_fast64_t keepAliveMaxRequests;
+	uint_fast64_t maxCachedFileSize;
+	bool http2;
 	sem_t running;
-	Cache errorPageCache;
+	// Note: Indexed by the status code, starting at ERROR_PAGE_FIRST_STATUS_CODE.
+	ErrorPage errorPages[ERROR_PAGE_NUM_STATUS_CODES];
 	Cache cache;
 	Property* workDirectory;
 	Property* httpRootDirectory;
 	Property* customErrorPageDirectory;
+	Property* port;
 }Server;
 
 #define SERVER_CONTEXT_HANDLER(functionName) ERROR_CODE functionName(Server* server, HTTP_Request* request, HTTP_Response* response)
@@ -69,6 +231,8 @@ typedef SERVER_CONTEXT_HANDLER(ContextHandler);
 typedef struct{
 	char* symbolicFileLocation;
 	uint_fast64_t symbolicFileLocationLength;
+	// Note: 'HTTP_REQUEST_TYPE_UNKNOWN' for contexts that handle every method.
+	HTTP_RequestType requestType;
 	ContextHandler* contextHandler;
 }Context;
 
@@ -86,6 +250,76 @@ ERROR_CODE server_createPropertyFile(char*, const uint_fast64_t);
 
 ERROR_CODE server_initEpoll(Server*);
 
+ERROR_CODE server_initEpollWorkers(Server*, const uint_fast16_t);
+
+ERROR_CODE server_createListeningSocket(int*, const uint_fast16_t, const bool);
+
+ERROR_CODE server_attachReusePortCPU_Filter(const int);
+
+void server_acceptConnections(EpollWorker*, const int);
+
+void server_processConnection(EpollWorker*, Connection*);
+
+void server_awaitClient(EpollWorker*, Connection*, const uint32_t, const bool);
+
+void server_pinWorkerToCPU(EpollWorker*);
+
+uint_fast16_t server_getNumEventLoops(Server*);
+
+void server_ioUringHandleAccept(EpollWorker*, const int, const uint32_t);
+
+void server_ioUringHandleReceive(EpollWorker*, Connection*, const int, const uint32_t);
+
+void server_ioUringHandleSend(EpollWorker*, Connection*, const int);
+
+bool server_ioUringArmReceive(EpollWorker*, Connection*);
+
+bool server_ioUringArmAccept(EpollWorker*);
+
+bool server_ioUringArmTimeout(EpollWorker*, struct __kernel_timespec*);
+
+void server_ioUringFlush(EpollWorker*, Connection*);
+
+void server_handleRequest(Server*, Connection*, Arena*);
+
+void server_dispatchRequest(Server*, HTTP_Request*, HTTP_Response*);
+
+bool server_processHttp2Connection(EpollWorker*, Connection*);
+
+void server_handleHttp2Streams(EpollWorker*, Connection*);
+
+void server_releaseHttp2Streams(ConnectionPool*, Http2Session*, const bool);
+
+int server_selectApplicationProtocol(SSL*, const unsigned char**, unsigned char*, const unsigned char*, unsigned int, void*);
+
+void server_rearmConnection(EpollWorker*, Connection*, const uint32_t);
+
+void server_markConnectionIdle(EpollWorker*, Connection*, const bool);
+
+void server_unmarkConnectionIdle(EpollWorker*, Connection*);
+
+void server_expireIdleConnections(EpollWorker*);
+
+void server_releaseCacheLease(HTTP_Response*);
+
+void server_finishRequest(Connection*);
+
+ERROR_CODE server_initConnectionPool(ConnectionPool*, const uint_fast64_t);
+
+void server_freeConnectionPool(ConnectionPool*);
+
+ERROR_CODE server_acquireBuffer(ConnectionPool*, int8_t**);
+
+void server_releaseBuffer(ConnectionPool*, int8_t*);
+
+ERROR_CODE server_acquireConnection(EpollWorker*, Connection**, const int);
+
+void server_releaseConnection(EpollWorker*, Connection*);
+
+void server_freeConnection(Connection*);
+
+const char* server_getPropertyOrDefault(Server*, const char*, const char*);
+
 void server_start(Server*);
 
 void server_run(Server*);
@@ -100,13 +334,37 @@ void server_freeContext(Context*);
 
 ERROR_CODE server_addContext(Server*, const char*, ContextHandler*);
 
+ERROR_CODE server_addContext_(Server*, const HTTP_RequestType, const char*, ContextHandler*);
+
+ERROR_CODE server_compileRouter(Server*);
+
 ERROR_CODE server_getContextHandler(Server*, ContextHandler**, HTTP_Request*);
 
 ERROR_CODE server_defaultContextHandler(Server*, HTTP_Request*, HTTP_Response*);
 
+ERROR_CODE server_compileErrorPages(Server*);
+
 ERROR_CODE server_constructErrorPage(Server*, HTTP_Request*, HTTP_Response*, HTTP_StatusCode);
 
-ERROR_CODE server_sendResponse(SSL*, HTTP_Response*);
+ERROR_CODE server_serializeResponseHeader(HTTP_Response*, int8_t*, const uint_fast64_t, uint_fast64_t*);
+
+ERROR_CODE server_prepareResponse(Connection*);
+
+ERROR_CODE server_addWriteSegment(Connection*, const int8_t*, const uint_fast64_t, const uint_fast64_t);
+
+ERROR_CODE server_addBodySegment(Connection*, const uint_fast64_t, const uint_fast64_t);
+
+void server_useSendFile(Connection*, const uint_fast64_t);
+
+uint_fast64_t server_formatByteRangePartHeader(char*, const uint_fast64_t, const char*, const HTTP_ByteRange*, const uint_fast64_t);
+
+ERROR_CODE server_handleRangeRequest(Server*, HTTP_Request*, HTTP_Response*, const uint_fast64_t, const char*, const char*);
+
+bool server_isNotModified(HTTP_Request*, const char*, const time_t);
+
+ERROR_CODE server_writeResponse(Connection*, ConnectionPool*, uint32_t*);
+
+ERROR_CODE server_openFile(CacheObject*, int*);
 
 void server_daemonize(void);
 
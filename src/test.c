@@ -10,6 +10,10 @@
 void test_testBegin(void){
 	openlog(TEST_SYSLOG_IDENTIFIER, LOG_CONS | LOG_NDELAY | LOG_PID, LOG_USER);
 
+	util_setScanImplementation(util_detectScanImplementation());
+
+	http_initMimeTypeRegistry(NULL);
+
 	arrayList_init(&testSuits, 16, sizeof(TestSuit), arrayList_defaultExpandFunction);
 }
 
@@ -142,6 +146,7 @@ void test_test(test_testFunction* func, const char* name){
 
 #include "test/arrayList_test.c"
 #include "test/linkedList_test.c"
+#include "test/arena_test.c"
 #include "test/doublyLinkedList_test.c"
 #include "test/argumentParser_test.c"
 #include "test/que_test.c"
@@ -149,8 +154,12 @@ void test_test(test_testFunction* func, const char* name){
 #include "test/util_test.c"
 #include "test/properties_test.c"
 #include "test/http_test.c"
+#include "test/http2_test.c"
+#include "test/router_test.c"
 #include "test/cache_test.c"
+#include "test/errorPage_test.c"
 #include "test/server_test.c"
+#include "test/ioUring_test.c"
 
 // main
 #ifndef TEST_BUILD
@@ -185,6 +194,11 @@ TEST_BEGIN();
 		TEST(linkedList_contains);
 	TEST_SUIT_END();
 
+	TEST_SUIT_BEGIN("arena");
+		TEST(arena_alloc);
+		TEST(arena_reset);
+	TEST_SUIT_END();
+
 	TEST_SUIT_BEGIN_(doublyLinkedList);
 		TEST(doublyLinkedList_add);
 		TEST(doublyLinkedList_iteration);
@@ -214,6 +228,7 @@ TEST_BEGIN();
 		// String utils.
 		TEST(util_findFirst);
 		TEST(util_findFirst_s);
+		TEST(util_scanImplementations);
 		TEST(util_findLast);
 		TEST(util_replace);
 		TEST(util_trim);
@@ -246,6 +261,7 @@ TEST_BEGIN();
 
 		// Other.
 		TEST(util_hash);
+		TEST(util_hash64);
 		TEST(util_blockAlloc);
 		TEST(util_formatNumber);
 	TEST_SUIT_END();
@@ -260,17 +276,54 @@ TEST_BEGIN();
 		TEST(http_initheaderField);
 		TEST(http_addHeaderField);
 		TEST(http_getHeaderField);
+		TEST(http_internHeaderFieldName);
 		TEST(http_parseHTTP_Request);
 		TEST(http_parseRequestType);
 		TEST(http_parseHTTP_Version);
+		TEST(http_findEndOfHeader);
+		TEST(http_parseHeaderBlock);
+		TEST(http_initBody);
+		TEST(http_parseBody);
+		TEST(http_parseRange);
+		TEST(http_parseDate);
+		TEST(http_entityTagListContains);
+		TEST(http_tokenListContains);
+		TEST(http_negotiateContentEncoding);
 		TEST(HTTP_contentTypeToString);
+		TEST(http_getContentType);
+		TEST(http_initMimeTypeRegistry);
+	TEST_SUIT_END();
+
+	TEST_SUIT_BEGIN("http2");
+		TEST(hpack_encodeInteger);
+		TEST(hpack_decodeInteger);
+		TEST(hpack_decodeHuffman);
+		TEST(hpack_decodeHeaderBlock);
+		TEST(hpack_encodeResponseHeader);
+		TEST(http2_processInput);
+	TEST_SUIT_END();
+
+	TEST_SUIT_BEGIN("router");
+		TEST(router_add);
+		TEST(router_lookup);
 	TEST_SUIT_END();
 
 	TEST_SUIT_BEGIN_(cache);
 		TEST(cache_add);
 		TEST(cache_load);
+		TEST(cache_loadEncodedVariants);
 		TEST(cache_remove);
 		TEST(cache_get);
+		TEST(cache_growIndex);
+		TEST(cache_evict);
+		TEST(cache_reclaim);
+		TEST(cache_acquire);
+		TEST(cache_mapFile);
+	TEST_SUIT_END();
+
+	TEST_SUIT_BEGIN("errorPage");
+		TEST(errorPage_compile);
+		TEST(errorPage_render);
 	TEST_SUIT_END();
 
 	TEST_SUIT_BEGIN_(server);
@@ -278,6 +331,17 @@ TEST_BEGIN();
 		TEST(server_getContextHandler);
 		TEST(server_translateSymbolicFileLocation);
 		TEST(server_translateSymbolicFileLocationErrorPage);
+		TEST(server_createListeningSocket);
+		TEST(server_connectionPoolBuffer);
+		TEST(server_openFile);
+		TEST(server_prepareResponse);
+		TEST(server_expireIdleConnections);
+		TEST(server_ioUringCloseMidResponse);
+	TEST_SUIT_END();
+
+	TEST_SUIT_BEGIN("ioUring");
+		TEST(ioUring_timeout);
+		TEST(ioUring_multishotReceive);
 	TEST_SUIT_END();
 
 	TEST_END();
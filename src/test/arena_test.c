@@ -0,0 +1,118 @@
+#ifndef ARENA_TEST_C
+#define ARENA_TEST_C
+
+#include "../test.c"
+
+TEST_TEST_FUNCTION(arena_alloc){
+	ERROR_CODE error;
+
+	Arena arena;
+	if((error = arena_init(&arena, 64)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to initialise arena. '%s'.", util_toErrorString(error));
+	}
+
+	uint8_t* a = arena_alloc(&arena, 1);
+	uint8_t* b = arena_alloc(&arena, 24);
+	uint8_t* c = arena_alloc(&arena, 16);
+
+	if(a == NULL || b == NULL || c == NULL){
+		return TEST_FAILURE("%s", "Failed to allocate from arena.");
+	}
+
+	if((uintptr_t) a % ARENA_ALIGNMENT != 0 || (uintptr_t) b % ARENA_ALIGNMENT != 0 || (uintptr_t) c % ARENA_ALIGNMENT != 0){
+		return TEST_FAILURE("Allocations have to be aligned to %d bytes.", ARENA_ALIGNMENT);
+	}
+
+	if(b != a + ARENA_ALIGNMENT || c != b + 2 * ARENA_ALIGNMENT){
+		return TEST_FAILURE("%s", "Allocations that fit into the block have to follow each other.");
+	}
+
+	// Note: Neither fits into what is left of the block, the larger one gets a block of its own.
+	uint8_t* d = arena_alloc(&arena, 32);
+	uint8_t* e = arena_alloc(&arena, 256);
+
+	if(d == NULL || e == NULL || arena.blocks->next == NULL || arena.blocks->next->next == NULL || arena.blocks->next->next->size != 256){
+		return TEST_FAILURE("%s", "Failed to chain blocks.");
+	}
+
+	memset(e, 0xFF, 256);
+
+	char* s = arena_copyString(&arena, "keep-alive", 10);
+	if(s == NULL || strcmp(s, "keep-alive") != 0){
+		return TEST_FAILURE("%s", "Failed to copy string into arena.");
+	}
+
+	arena_free(&arena);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(arena_reset){
+	ERROR_CODE error;
+
+	Arena arena;
+	if((error = arena_init(&arena, 64)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to initialise arena. '%s'.", util_toErrorString(error));
+	}
+
+	uint8_t* a = arena_alloc(&arena, 48);
+	uint8_t* b = arena_alloc(&arena, 48);
+	uint8_t* c = arena_alloc(&arena, 128);
+
+	arena_reset(&arena);
+
+	// Note: Blocks are kept and handed out in the same order again, a block too small for an allocation gets skipped.
+	if(arena_alloc(&arena, 48) != a || arena_alloc(&arena, 48) != b || arena_alloc(&arena, 128) != c){
+		return TEST_FAILURE("%s", "Reset arena has to reuse its blocks.");
+	}
+
+	arena_reset(&arena);
+
+	if(arena_alloc(&arena, 64) != a || arena_alloc(&arena, 128) != c || arena.blocks->next->next->next != NULL){
+		return TEST_FAILURE("%s", "Reset arena has to skip blocks that are too small.");
+	}
+
+	// Note: Nodes of an arena backed list are never freed, freeing the list only empties it.
+	arena_reset(&arena);
+
+	LinkedList list = {0};
+	list.arena = &arena;
+
+	int value = 7;
+	LINKED_LIST_ADD(&list, value);
+	LINKED_LIST_ADD(&list, value);
+
+	if(list.length != 2 || (uint8_t*) list.tail < (uint8_t*) (arena.blocks + 1) || (uint8_t*) list.tail >= (uint8_t*) (arena.blocks + 1) + arena.blocks->size){
+		return TEST_FAILURE("%s", "List nodes have to be allocated from the arena.");
+	}
+
+	linkedList_free(&list);
+
+	if(list.tail != NULL || list.length != 0){
+		return TEST_FAILURE("%s", "Failed to empty arena backed list.");
+	}
+
+	// Note: Response header fields and their values live in the arena, the name is the literal itself.
+	HTTP_Response response;
+	int8_t buffer[256];
+
+	arena_reset(&arena);
+	http_initHttpResponse(&response, buffer, sizeof(buffer), &arena);
+
+	char keepAlive[] = "timeout=5, max=99";
+	HTTP_ADD_HEADER_FIELD(&response, Keep-Alive, keepAlive);
+
+	HTTP_HeaderField* headerField = *(HTTP_HeaderField**) (response.httpHeaderFields.tail + 1);
+
+	if(response.httpHeaderFields.length != 2 || headerField->value == keepAlive || strcmp(headerField->value, keepAlive) != 0 || strcmp(headerField->name, "Keep-Alive") != 0){
+		return TEST_FAILURE("%s", "Failed to add response header field from arena.");
+	}
+
+	http_freeHTTP_Response(&response);
+
+	arena_free(&arena);
+
+	return TEST_SUCCESS;
+}
+
+#endif
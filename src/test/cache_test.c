@@ -33,11 +33,8 @@ TEST_TEST_FUNCTION_(cache_add, Cache, cache){
 		return TEST_FAILURE("ERROR: Failed to add data['%s'] to cache. (%s)", data, util_toErrorString(error));
 	}
 
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &cache->elements);
-
-	CacheObject* _cacheObject = LINKED_LIST_ITERATOR_NEXT_PTR(&it, CacheObject);
-	if(memcmp(cacheObject->data, _cacheObject->data, cacheObject->size) != 0){
+	CacheObject* _cacheObject = cache_lookup(cache->index, "/data", 5, cache_hashKey("/data", 5));
+	if(_cacheObject == NULL || memcmp(cacheObject->data, _cacheObject->data, cacheObject->size) != 0){
 		return TEST_FAILURE("ERROR: Failed to add cach object to cache '%s'!= '%s'.", cacheObject->data, _cacheObject->data);
 	}
 
@@ -105,6 +102,19 @@ TEST_TEST_FUNCTION_(cache_load, Cache, cache){
 		}
 	}
 
+	// The entity tag has to match the one of the file when it gets streamed from disk instead.
+	struct stat fileInfo;
+	if(stat(filePath, &fileInfo) != 0){
+		return TEST_FAILURE("Failed to retrieve file info of '%s'. '%s'.", filePath, strerror(errno));
+	}
+
+	char entityTag[HTTP_ENTITY_TAG_LENGTH + 1];
+	cache_formatFileEntityTag(entityTag, &fileInfo);
+
+	if(strcmp(cacheObject->entityTag, entityTag) != 0){
+		return TEST_FAILURE("Cache object entity tag '%s' != '%s'", cacheObject->entityTag, entityTag);
+	}
+
 	if((error = util_deleteFile(filePath)) != ERROR_NO_ERROR){
 		return TEST_FAILURE("Failed to delete test file: '%s'. '%s'.", filePath, util_toErrorString(error));
 	}
@@ -114,6 +124,105 @@ TEST_TEST_FUNCTION_(cache_load, Cache, cache){
 	return TEST_SUCCESS;
 }
 
+TEST_TEST_FUNCTION_(cache_loadEncodedVariants, Cache, cache){
+	ERROR_CODE error;
+
+	#define TEST_FILE_NAME "/tmp/herder_cache_test_variants_XXXXXX.html"
+
+	char* filePath = alloca(sizeof(*filePath) * (strlen(TEST_FILE_NAME) + 3/*".gz"*/ + 1));
+	strcpy(filePath, TEST_FILE_NAME);
+
+	#undef TEST_FILE_NAME
+
+	int tempFileDescriptor = mkstemps(filePath, 5/*".html"*/);
+	if(tempFileDescriptor < 1){
+		return TEST_FAILURE("Failed to create temporary file '%s' [%s].", filePath, strerror(errno));
+	}
+
+	char content[4096];
+	uint_fast64_t i;
+	for(i = 0; i < sizeof(content); i++){
+		content[i] = "<p>herder</p>"[i % 13];
+	}
+
+	if(write(tempFileDescriptor, content, sizeof(content)) != sizeof(content)){
+		return TEST_FAILURE("Failed to write test file. Expected to write %zu bytes.", sizeof(content));
+	}
+
+	close(tempFileDescriptor);
+
+	// Compressed on load.
+	CacheObject* cacheObject;
+	if((error = cache_load(cache, &cacheObject, filePath, strlen(filePath), "/variants.html", 14)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to load cache object. '%s'", util_toErrorString(error));
+	}
+
+	CacheObject* variant = cache_getEncodedVariant(cacheObject, HTTP_CONTENT_ENCODING_GZIP);
+	if(variant == cacheObject || variant->fileLocationLength != 0 || variant->httpContentType != HTTP_CONTENT_TYPE_TEXT_HTML || strcmp(variant->entityTag, cacheObject->entityTag) == 0){
+		return TEST_FAILURE("%s", "Expected a generated gzip variant with its own entity tag.");
+	}
+
+	char decompressed[sizeof(content)];
+
+	z_stream stream = {0};
+	inflateInit2(&stream, 15 + 16);
+	stream.next_in = variant->data;
+	stream.avail_in = variant->size;
+	stream.next_out = (Bytef*) decompressed;
+	stream.avail_out = sizeof(decompressed);
+
+	const int ret = inflate(&stream, Z_FINISH);
+	inflateEnd(&stream);
+
+	if(ret != Z_STREAM_END || stream.total_out != sizeof(content) || memcmp(decompressed, content, sizeof(content)) != 0){
+		return TEST_FAILURE("%s", "Failed to decompress gzip variant.");
+	}
+
+	// Precompressed sibling takes precedence.
+	const uint_fast64_t filePathLength = strlen(filePath);
+	char* gzipFilePath = alloca(sizeof(*gzipFilePath) * (filePathLength + 3/*".gz"*/ + 1));
+	memcpy(gzipFilePath, filePath, filePathLength);
+	strcpy(gzipFilePath + filePathLength, ".gz");
+
+	FILE* gzipFile = fopen(gzipFilePath, "w");
+	if(gzipFile == NULL || fwrite("precompressed", 1, 13, gzipFile) != 13 || fclose(gzipFile) != 0){
+		return TEST_FAILURE("Failed to write test file '%s'.", gzipFilePath);
+	}
+
+	if((error = cache_load(cache, &cacheObject, filePath, filePathLength, "/precompressed.html", 19)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to load cache object. '%s'", util_toErrorString(error));
+	}
+
+	variant = cache_getEncodedVariant(cacheObject, HTTP_CONTENT_ENCODING_GZIP);
+	if(variant->size != 13 || memcmp(variant->data, "precompressed", 13) != 0 || strcmp(variant->fileLocation, gzipFilePath) != 0){
+		return TEST_FAILURE("%s", "Expected the precompressed sibling as gzip variant.");
+	}
+
+	// Note: Both representations carry 'Vary', only the variant 'Content-Encoding'.
+	char lastModified[HTTP_DATE_LENGTH + 1];
+	http_formatDate(lastModified, variant->lastModified);
+
+	char expectedHeaderBlock[CACHE_MAX_HEADER_BLOCK_SIZE];
+	snprintf(expectedHeaderBlock, sizeof(expectedHeaderBlock), "Vary: Accept-Encoding\r\nContent-Encoding: gzip\r\nETag: %s\r\nLast-Modified: %s\r\nAccept-Ranges: bytes\r\nContent-Length: 13\r\nContent-Type: %s\r\n", variant->entityTag, lastModified, http_contentTypeToString(HTTP_CONTENT_TYPE_TEXT_HTML));
+
+	if(variant->headerBlockLength != strlen(expectedHeaderBlock) || memcmp(variant->headerBlock, expectedHeaderBlock, variant->headerBlockLength) != 0){
+		return TEST_FAILURE("Header block '%.*s' != '%s'.", (int) variant->headerBlockLength, variant->headerBlock, expectedHeaderBlock);
+	}
+
+	if(memcmp(variant->headerBlock + variant->notModifiedHeaderBlockLength, "Accept-Ranges", 13) != 0 || memcmp(variant->headerBlock + variant->partialHeaderBlockLength, "Content-Length", 14) != 0){
+		return TEST_FAILURE("%s", "'304 Not Modified' and '206 Partial Content' have to end right before 'Accept-Ranges' and 'Content-Length'.");
+	}
+
+	if(memcmp(cacheObject->headerBlock, "Vary: Accept-Encoding\r\nETag: ", 29) != 0){
+		return TEST_FAILURE("Header block '%.*s' has to start with 'Vary'.", (int) cacheObject->headerBlockLength, cacheObject->headerBlock);
+	}
+
+	util_deleteFile(gzipFilePath);
+	util_deleteFile(filePath);
+
+	return TEST_SUCCESS;
+}
+
 TEST_TEST_FUNCTION_(cache_get, Cache, cache){
 	char* data = malloc(sizeof(*data) * 7);
 	strncpy(data, "123abc", 7);
@@ -160,17 +269,357 @@ TEST_TEST_FUNCTION_(cache_remove, Cache, cache){
 		return TEST_FAILURE("ERROR: Failed to remove cache object '%s' from cache. (%s)", cacheObject_a->symbolicFileLocation, util_toErrorString(error));
 	}
 
-	LinkedListIterator it;
-	linkedList_initIterator(&it, &cache->elements);
+	if(cache_lookup(cache->index, "/data_a", 7, cache_hashKey("/data_a", 7)) != NULL){
+		return TEST_FAILURE("Cache object '%s' still in the cache after it got removed.", "/data_a");
+	}
+
+	// Note: '/data_b' may sit behind the tombstone '/data_a' left.
+	if(cache_lookup(cache->index, "/data_b", 7, cache_hashKey("/data_b", 7)) != cacheObject_b){
+		return TEST_FAILURE("Cache object '%s' got lost removing '%s'.", "/data_b", "/data_a");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(cache_growIndex, Cache, cache){
+	ERROR_CODE error;
+
+	#define CACHE_TEST_NUM_OBJECTS (CACHE_INDEX_INITIAL_CAPACITY * 2)
+
+	char symbolicFileLocation[32];
+
+	uint_fast64_t i;
+	for(i = 0; i < CACHE_TEST_NUM_OBJECTS; i++){
+		const uint_fast64_t symbolicFileLocationLength = snprintf(symbolicFileLocation, sizeof(symbolicFileLocation), "/file_%" PRIuFAST64, i);
+
+		uint8_t* data = malloc(sizeof(*data));
+		*data = i;
+
+		CacheObject* cacheObject;
+		if((error = cache_add(cache, &cacheObject, data, 1, NULL, 0, symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to add '%s' to cache. (%s)", symbolicFileLocation, util_toErrorString(error));
+		}
+
+		// Note: Every other object gets removed again, the index has to be rebuilt without their tombstones.
+		if(i % 2 == 1 && (error = cache_remove(cache, cacheObject)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to remove '%s' from cache. (%s)", symbolicFileLocation, util_toErrorString(error));
+		}
+	}
+
+	if(cache->numObjects != CACHE_TEST_NUM_OBJECTS / 2 || cache->index->numUsedSlots * 4 > (cache->index->mask + 1) * 3){
+		return TEST_FAILURE("Index holds %" PRIuFAST64 " objects in %" PRIuFAST64 " used of %" PRIuFAST64 " slots.", cache->numObjects, cache->index->numUsedSlots, cache->index->mask + 1);
+	}
+
+	for(i = 0; i < CACHE_TEST_NUM_OBJECTS; i++){
+		const uint_fast64_t symbolicFileLocationLength = snprintf(symbolicFileLocation, sizeof(symbolicFileLocation), "/file_%" PRIuFAST64, i);
+
+		CacheObject* cacheObject = NULL;
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
+		error = cache_get(cache, &cacheObject, symbolicFileLocation, symbolicFileLocationLength);
+		__UTIL_ENABLE_ERROR_LOGGING__();
+
+		if(i % 2 == 0 && (error != ERROR_NO_ERROR || *cacheObject->data != (uint8_t) i)){
+			return TEST_FAILURE("Failed to look up '%s'. (%s)", symbolicFileLocation, util_toErrorString(error));
+		}
+
+		if(i % 2 == 1 && error != ERROR_ENTRY_NOT_FOUND){
+			return TEST_FAILURE("Removed object '%s' still in the cache.", symbolicFileLocation);
+		}
+	}
+
+	// Note: Adding an object that is already cached hands out the cached one.
+	uint8_t* data = malloc(sizeof(*data));
+
+	CacheObject* cacheObject;
+	if((error = cache_add(cache, &cacheObject, data, 1, NULL, 0, "/file_0", 7)) != ERROR_NO_ERROR || cache->numObjects != CACHE_TEST_NUM_OBJECTS / 2 || *cacheObject->data != 0){
+		return TEST_FAILURE("%s", "Duplicate object has to be replaced with the cached one.");
+	}
+
+	#undef CACHE_TEST_NUM_OBJECTS
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(cache_evict, Cache, cache){
+	ERROR_CODE error;
+
+	// Note: Ten objects fill the cache, an eleventh one needs the room of one of them.
+	#define CACHE_TEST_NUM_OBJECTS 10
+	#define CACHE_TEST_OBJECT_SIZE KB(100)
 
-	while(LINKED_LIST_ITERATOR_HAS_NEXT(&it)){
-		CacheObject* _cacheObject = LINKED_LIST_ITERATOR_NEXT_PTR(&it, CacheObject);
+	char symbolicFileLocation[32];
+	uint_fast64_t symbolicFileLocationLength;
 
-		if(memcmp("123abc", _cacheObject->data, _cacheObject->size) == 0){
-			return TEST_FAILURE("ERROR: Failed to add cach object to cache '%s'!= '%s'.", "123abc", _cacheObject->data);
+	CacheObject* cacheObjects[CACHE_TEST_NUM_OBJECTS];
+
+	uint_fast64_t i;
+	for(i = 0; i < CACHE_TEST_NUM_OBJECTS; i++){
+		symbolicFileLocationLength = snprintf(symbolicFileLocation, sizeof(symbolicFileLocation), "/file_%" PRIuFAST64, i);
+
+		if((error = cache_add(cache, &cacheObjects[i], calloc(CACHE_TEST_OBJECT_SIZE, 1), CACHE_TEST_OBJECT_SIZE, NULL, 0, symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to add '%s' to cache. (%s)", symbolicFileLocation, util_toErrorString(error));
 		}
 	}
 
+	// Note: The first half of the objects is requested frequently, the other half never.
+	for(i = 0; i < CACHE_TEST_NUM_OBJECTS / 2 * 8; i++){
+		symbolicFileLocationLength = snprintf(symbolicFileLocation, sizeof(symbolicFileLocation), "/file_%" PRIuFAST64, i % (CACHE_TEST_NUM_OBJECTS / 2));
+
+		CacheObject* cacheObject;
+		if((error = cache_get(cache, &cacheObject, symbolicFileLocation, symbolicFileLocationLength)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to look up '%s'. (%s)", symbolicFileLocation, util_toErrorString(error));
+		}
+	}
+
+	uint8_t* data = calloc(CACHE_TEST_OBJECT_SIZE, 1);
+
+	// Note: A file that was never requested is not worth more than the objects that were never requested either.
+	CacheObject* cacheObject;
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_CACHE_ADMISSION_DENIED);
+	if(cache_add(cache, &cacheObject, data, CACHE_TEST_OBJECT_SIZE, NULL, 0, "/new", 4) != ERROR_CACHE_ADMISSION_DENIED){
+		return TEST_FAILURE("'%s' admitted without having been requested.", "/new");
+	}
+
+	// Note: Files larger than the whole cache never get admitted.
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_CACHE_ADMISSION_DENIED);
+	if(cache_add(cache, &cacheObject, data, MB(2), NULL, 0, "/large", 6) != ERROR_CACHE_ADMISSION_DENIED){
+		return TEST_FAILURE("'%s' admitted although it is larger than the cache.", "/large");
+	}
+
+	for(i = 0; i < 3; i++){
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
+		cache_get(cache, &cacheObject, "/new", 4);
+	}
+
+	if((error = cache_add(cache, &cacheObject, data, CACHE_TEST_OBJECT_SIZE, NULL, 0, "/new", 4)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("'%s' not admitted after it got requested. (%s)", "/new", util_toErrorString(error));
+	}
+
+	if(cache->numObjects != CACHE_TEST_NUM_OBJECTS || cache->currentSize > cache->maxSize){
+		return TEST_FAILURE("Cache holds %" PRIuFAST64 " objects with %" PRIuFAST64 " of %" PRIuFAST64 " bytes.", cache->numObjects, cache->currentSize, cache->maxSize);
+	}
+
+	// Note: The victim has to be one of the objects nobody requested.
+	for(i = 0; i < CACHE_TEST_NUM_OBJECTS / 2; i++){
+		symbolicFileLocationLength = snprintf(symbolicFileLocation, sizeof(symbolicFileLocation), "/file_%" PRIuFAST64, i);
+
+		if(cache_lookup(cache->index, symbolicFileLocation, symbolicFileLocationLength, cache_hashKey(symbolicFileLocation, symbolicFileLocationLength)) != cacheObjects[i]){
+			return TEST_FAILURE("Frequently requested object '%s' got evicted.", symbolicFileLocation);
+		}
+	}
+
+	// Note: Removing an object gives back its room.
+	const uint_fast64_t currentSize = cache->currentSize;
+	const uint_fast64_t objectSize = cache_getObjectSize(cacheObject);
+
+	if((error = cache_remove(cache, cacheObject)) != ERROR_NO_ERROR || cache->currentSize != currentSize - objectSize){
+		return TEST_FAILURE("Cache size %" PRIuFAST64 " after removing an object of %" PRIuFAST64 " bytes from %" PRIuFAST64 " bytes.", cache->currentSize, objectSize, currentSize);
+	}
+
+	#undef CACHE_TEST_NUM_OBJECTS
+	#undef CACHE_TEST_OBJECT_SIZE
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(cache_reclaim, Cache, cache){
+	ERROR_CODE error;
+
+	char* data = malloc(sizeof(*data) * 7);
+	strncpy(data, "123abc", 7);
+
+	CacheObject* cacheObject;
+	if((error = cache_add(cache, &cacheObject, (uint8_t*) data, 7, NULL, 0, "/data", 5)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add '%s' to cache. (%s)", "/data", util_toErrorString(error));
+	}
+
+	cache_online(cache, 0);
+
+	if((error = cache_get(cache, &cacheObject, "/data", 5)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to look up '%s'. (%s)", "/data", util_toErrorString(error));
+	}
+
+	// Note: The reader is still online and may use the object, removing it only retires it.
+	if((error = cache_remove(cache, cacheObject)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to remove '%s' from cache. (%s)", "/data", util_toErrorString(error));
+	}
+
+	if(cache->retiredObjects != cacheObject || memcmp(cacheObject->data, "123abc", 7) != 0){
+		return TEST_FAILURE("'%s' got freed while a reader still held it.", "/data");
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
+	if(cache_get(cache, &cacheObject, "/data", 5) != ERROR_ENTRY_NOT_FOUND){
+		return TEST_FAILURE("Retired object '%s' still found.", "/data");
+	}
+
+	cache_offline(cache, 0);
+
+	if(cache->retiredObjects != NULL){
+		return TEST_FAILURE("'%s' not reclaimed after the reader went offline.", "/data");
+	}
+
+	// Note: A reader that goes online after an object got retired can't find it anymore, it does not hold up reclaiming the object.
+	Cache readers;
+	if((error = cache_init(&readers, 2, MB(1))) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to initialise cache. (%s)", util_toErrorString(error));
+	}
+
+	data = malloc(sizeof(*data) * 7);
+	strncpy(data, "123abc", 7);
+
+	if((error = cache_add(&readers, &cacheObject, (uint8_t*) data, 7, NULL, 0, "/data", 5)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add '%s' to cache. (%s)", "/data", util_toErrorString(error));
+	}
+
+	cache_online(&readers, 0);
+
+	cache_remove(&readers, cacheObject);
+
+	cache_online(&readers, 1);
+	cache_offline(&readers, 0);
+
+	if(readers.retiredObjects != NULL){
+		return TEST_FAILURE("%s", "Reader that went online after the object got retired holds up reclaiming it.");
+	}
+
+	cache_offline(&readers, 1);
+
+	cache_free(&readers);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(cache_acquire, Cache, cache){
+	ERROR_CODE error;
+
+	char* data = malloc(sizeof(*data) * 7);
+	strncpy(data, "123abc", 7);
+
+	CacheObject* cacheObject;
+	if((error = cache_add(cache, &cacheObject, (uint8_t*) data, 7, NULL, 0, "/data", 5)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add '%s' to cache. (%s)", "/data", util_toErrorString(error));
+	}
+
+	cache_online(cache, 0);
+
+	if((error = cache_get(cache, &cacheObject, "/data", 5)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to look up '%s'. (%s)", "/data", util_toErrorString(error));
+	}
+
+	cache_acquire(cacheObject);
+
+	cache_offline(cache, 0);
+
+	// Note: Nobody is online anymore, the object gets reclaimed right away but the lease keeps it alive.
+	if((error = cache_remove(cache, cacheObject)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to remove '%s' from cache. (%s)", "/data", util_toErrorString(error));
+	}
+
+	if(cache->retiredObjects != NULL){
+		return TEST_FAILURE("'%s' not reclaimed after it got removed.", "/data");
+	}
+
+	if(cacheObject->numReferences != 1 || memcmp(cacheObject->data, "123abc", 7) != 0){
+		return TEST_FAILURE("Leased object '%s' got freed.", "/data");
+	}
+
+	// Note: Frees the object, the address sanitizer catches it if it got freed before.
+	cache_release(cacheObject);
+
+	// Note: Leases that are released before the object gets evicted leave it alone.
+	data = malloc(sizeof(*data) * 7);
+	strncpy(data, "123abc", 7);
+
+	if((error = cache_add(cache, &cacheObject, (uint8_t*) data, 7, NULL, 0, "/data", 5)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add '%s' to cache. (%s)", "/data", util_toErrorString(error));
+	}
+
+	cache_acquire(cacheObject);
+	cache_release(cacheObject);
+
+	if(cacheObject->numReferences != 1 || cache_get(cache, &cacheObject, "/data", 5) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Releasing a lease on '%s' freed the cached object.", "/data");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(cache_mapFile, Cache, cache){
+	ERROR_CODE error;
+
+	char filePath[] = "/tmp/herder_cache_test_file_XXXXXX";
+
+	int tempFileDescriptor = mkstemp(filePath);
+	if(tempFileDescriptor < 1){
+		return TEST_FAILURE("Failed to create temporary file '%s' [%s].", filePath, strerror(errno));
+	}
+
+	uint8_t buffer[5000];
+	uint_fast64_t i;
+	for(i = 0; i < sizeof(buffer); i++){
+		buffer[i] = i & 0xFF;
+	}
+
+	if(write(tempFileDescriptor, buffer, sizeof(buffer)) != sizeof(buffer)){
+		return TEST_FAILURE("Failed to write test file. Expected to write %zu bytes.", sizeof(buffer));
+	}
+
+	close(tempFileDescriptor);
+
+	const CacheFileMapping fileMappings[] = {CACHE_FILE_MAPPING_LAZY, CACHE_FILE_MAPPING_WILLNEED, CACHE_FILE_MAPPING_POPULATE};
+
+	const uint_fast64_t pageSize = sysconf(_SC_PAGESIZE);
+
+	for(i = 0; i < UTIL_ARRAY_LENGTH(fileMappings); i++){
+		cache_setFileMapping(cache, fileMappings[i], i == 0);
+
+		CacheObject* cacheObject;
+		if((error = cache_load(cache, &cacheObject, filePath, strlen(filePath), "/mapped", 7)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to load mapped cache object. '%s'", util_toErrorString(error));
+		}
+
+		if(cacheObject->size != sizeof(buffer) || memcmp(cacheObject->data, buffer, sizeof(buffer)) != 0){
+			return TEST_FAILURE("Mapped cache object (%" PRIuFAST64 ") does not match the file.", i);
+		}
+
+		// Note: Accounted with the whole pages it maps.
+		if(cacheObject->mappingLength != (sizeof(buffer) + pageSize - 1) / pageSize * pageSize || cache->currentSize != cache_getObjectSize(cacheObject)){
+			return TEST_FAILURE("Mapping of %" PRIuFAST64 " bytes accounted as %" PRIuFAST64 " bytes.", cacheObject->mappingLength, cache->currentSize);
+		}
+
+		if((error = cache_remove(cache, cacheObject)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to remove mapped cache object. '%s'", util_toErrorString(error));
+		}
+	}
+
+	// Note: The file changed since it was looked at.
+	uint8_t* data;
+	uint_fast64_t mappingLength;
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_LOAD_FILE);
+	if(cache_mapFile(cache, filePath, sizeof(buffer) + 1, &data, &mappingLength) != ERROR_FAILED_TO_LOAD_FILE){
+		return TEST_FAILURE("%s", "Mapped a file whose size changed.");
+	}
+
+	// Note: Empty files are read like before, they can't be mapped.
+	if(truncate(filePath, 0) != 0){
+		return TEST_FAILURE("Failed to truncate '%s' [%s].", filePath, strerror(errno));
+	}
+
+	CacheObject* cacheObject;
+	if((error = cache_load(cache, &cacheObject, filePath, strlen(filePath), "/empty", 6)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to load empty cache object. '%s'", util_toErrorString(error));
+	}
+
+	if(cacheObject->size != 0 || cacheObject->mappingLength != 0){
+		return TEST_FAILURE("%s", "Empty file got mapped.");
+	}
+
+	if((error = util_deleteFile(filePath)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to delete test file: '%s'. '%s'.", filePath, util_toErrorString(error));
+	}
+
 	return TEST_SUCCESS;
 }
 
@@ -0,0 +1,92 @@
+#ifndef ERROR_PAGE_TEST_C
+#define ERROR_PAGE_TEST_C
+
+#include "../test.c"
+#include <string.h>
+
+TEST_TEST_FUNCTION(errorPage_compile){
+	ERROR_CODE error;
+
+	const char template[] = "<h1>$errorCode $errorMessage</h1><a href=\"http://$address\">$address</a>:$port$port $unknown$";
+
+	ErrorPage errorPage;
+	if((error = errorPage_compile(&errorPage, _404_NOT_FOUND, template, strlen(template))) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to compile error page. '%s'.", util_toErrorString(error));
+	}
+
+	const char expectedStatusLine[] = "HTTP/1.1 404 Not Found\r\n";
+	if(errorPage.statusLineLength != strlen(expectedStatusLine) || memcmp(errorPage.statusLine, expectedStatusLine, errorPage.statusLineLength) != 0){
+		return TEST_FAILURE("Status line '%.*s' != '%s'.", (int) errorPage.statusLineLength, errorPage.statusLine, expectedStatusLine);
+	}
+
+	// Note: Status code and message are substituted right away, the two adjacent ports must not leave an empty literal between them and unknown placeholders stay as they are.
+	const struct{
+		ErrorPageSegmentType type;
+		const char* literal;
+	}expectedSegments[] = {
+		{ERROR_PAGE_SEGMENT_LITERAL, "<h1>404 Not Found</h1><a href=\"http://"},
+		{ERROR_PAGE_SEGMENT_ADDRESS, NULL},
+		{ERROR_PAGE_SEGMENT_LITERAL, "\">"},
+		{ERROR_PAGE_SEGMENT_ADDRESS, NULL},
+		{ERROR_PAGE_SEGMENT_LITERAL, "</a>:"},
+		{ERROR_PAGE_SEGMENT_PORT, NULL},
+		{ERROR_PAGE_SEGMENT_PORT, NULL},
+		{ERROR_PAGE_SEGMENT_LITERAL, " $unknown$"}
+	};
+
+	if(errorPage.numSegments != UTIL_ARRAY_LENGTH(expectedSegments)){
+		return TEST_FAILURE("Expected %zu segments but got %" PRIuFAST64 ".", UTIL_ARRAY_LENGTH(expectedSegments), errorPage.numSegments);
+	}
+
+	uint_fast64_t i;
+	for(i = 0; i < errorPage.numSegments; i++){
+		const ErrorPageSegment* segment = &errorPage.segments[i];
+
+		if(segment->type != expectedSegments[i].type){
+			return TEST_FAILURE("Segment %" PRIuFAST64 " has the wrong type.", i);
+		}
+
+		if(segment->type == ERROR_PAGE_SEGMENT_LITERAL && (segment->length != strlen(expectedSegments[i].literal) || memcmp(errorPage.literals + segment->offset, expectedSegments[i].literal, segment->length) != 0)){
+			return TEST_FAILURE("Segment %" PRIuFAST64 " '%.*s' != '%s'.", i, (int) segment->length, errorPage.literals + segment->offset, expectedSegments[i].literal);
+		}
+	}
+
+	errorPage_free(&errorPage);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(errorPage_render){
+	ERROR_CODE error;
+
+	const char template[] = "$errorCode $address:$port";
+
+	ErrorPage errorPage;
+	if((error = errorPage_compile(&errorPage, _401_UNAUTHORIZED, template, strlen(template))) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to compile error page. '%s'.", util_toErrorString(error));
+	}
+
+	char buffer[32];
+	uint_fast64_t length;
+	if((error = errorPage_render(&errorPage, "localhost", 9, "1869", 4, buffer, sizeof(buffer), &length)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to render error page. '%s'.", util_toErrorString(error));
+	}
+
+	if(length != 18 || memcmp(buffer, "401 localhost:1869", 18) != 0){
+		return TEST_FAILURE("Rendered page '%.*s' != '%s'.", (int) length, buffer, "401 localhost:1869");
+	}
+
+	// Note: Nothing may be written past the buffer.
+	buffer[12] = 'x';
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_BUFFER_OVERFLOW);
+	if(errorPage_render(&errorPage, "localhost", 9, "1869", 4, buffer, 12, &length) != ERROR_BUFFER_OVERFLOW || buffer[12] != 'x'){
+		return TEST_FAILURE("%s", "Page larger than the buffer has to be rejected.");
+	}
+
+	errorPage_free(&errorPage);
+
+	return TEST_SUCCESS;
+}
+
+#endif
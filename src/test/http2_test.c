@@ -0,0 +1,265 @@
+#ifndef HTTP2_TEST_C
+#define HTTP2_TEST_C
+
+#include "../test.c"
+#include <string.h>
+
+TEST_TEST_FUNCTION(hpack_encodeInteger){
+	uint8_t buffer[8];
+	uint_fast64_t length;
+
+	// RFC 7541 C.1.1
+	if((length = hpack_encodeInteger(buffer, sizeof(buffer), 0x00, 5, 10)) != 1 || buffer[0] != 0x0A){
+		return TEST_FAILURE("Failed to encode '%d' with a 5 bit prefix.", 10);
+	}
+
+	// RFC 7541 C.1.2
+	if((length = hpack_encodeInteger(buffer, sizeof(buffer), 0x00, 5, 1337)) != 3 || buffer[0] != 0x1F || buffer[1] != 0x9A || buffer[2] != 0x0A){
+		return TEST_FAILURE("Failed to encode '%d' with a 5 bit prefix.", 1337);
+	}
+
+	if(hpack_encodeInteger(buffer, 2, 0x00, 5, 1337) != 0){
+		return TEST_FAILURE("%s", "Encoded integer does not fit into the buffer.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(hpack_decodeInteger){
+	ERROR_CODE error;
+
+	const uint8_t buffer[] = {0x1F, 0x9A, 0x0A, 0x2A};
+
+	uint_fast64_t offset = 0;
+	uint_fast64_t value;
+	if((error = hpack_decodeInteger(buffer, sizeof(buffer), 5, &offset, &value)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to decode integer. '%s'.", util_toErrorString(error));
+	}
+
+	if(value != 1337 || offset != 3){
+		return TEST_FAILURE("Decoded integer '%" PRIuFAST64 "' != '%d'.", value, 1337);
+	}
+
+	// RFC 7541 C.1.3
+	if((error = hpack_decodeInteger(buffer, sizeof(buffer), 8, &offset, &value)) != ERROR_NO_ERROR || value != 42 || offset != 4){
+		return TEST_FAILURE("Decoded integer '%" PRIuFAST64 "' != '%d'.", value, 42);
+	}
+
+	offset = 0;
+	if(hpack_decodeInteger(buffer, 2, 5, &offset, &value) == ERROR_NO_ERROR){
+		return TEST_FAILURE("%s", "Truncated integer has to be rejected.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(hpack_decodeHuffman){
+	ERROR_CODE error;
+
+	// RFC 7541 C.4.1
+	const uint8_t encoded[] = {0xF1, 0xE3, 0xC2, 0xE5, 0xF2, 0x3A, 0x6B, 0xA0, 0xAB, 0x90, 0xF4, 0xFF};
+
+	char decoded[32];
+	uint_fast64_t decodedLength;
+	if((error = hpack_decodeHuffman(encoded, sizeof(encoded), decoded, sizeof(decoded), &decodedLength)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to decode Huffman string. '%s'.", util_toErrorString(error));
+	}
+
+	if(decodedLength != strlen("www.example.com") || memcmp(decoded, "www.example.com", decodedLength) != 0){
+		return TEST_FAILURE("Decoded string '%.*s' != '%s'.", (int) decodedLength, decoded, "www.example.com");
+	}
+
+	// Note: Padding longer than 7 bits or not made up of the most significant bits of EOS is a decoding error.
+	const uint8_t invalidPadding[] = {0xF1, 0xE3, 0xC2, 0xE5, 0xF2, 0x3A, 0x6B, 0xA0, 0xAB, 0x90, 0xF4, 0xFF, 0xFF};
+	if(hpack_decodeHuffman(invalidPadding, sizeof(invalidPadding), decoded, sizeof(decoded), &decodedLength) == ERROR_NO_ERROR){
+		return TEST_FAILURE("%s", "Invalid padding has to be rejected.");
+	}
+
+	if(hpack_decodeHuffman(encoded, sizeof(encoded), decoded, 8, &decodedLength) == ERROR_NO_ERROR){
+		return TEST_FAILURE("%s", "Decoded string does not fit into the buffer.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(hpack_decodeHeaderBlock){
+	ERROR_CODE error;
+
+	HPACK_DynamicTable table;
+	hpack_initDynamicTable(&table, HPACK_DEFAULT_HEADER_TABLE_SIZE);
+
+	// RFC 7541 C.4, three requests on the same connection sharing the dynamic table.
+	const uint8_t firstBlock[] = {0x82, 0x86, 0x84, 0x41, 0x8C, 0xF1, 0xE3, 0xC2, 0xE5, 0xF2, 0x3A, 0x6B, 0xA0, 0xAB, 0x90, 0xF4, 0xFF};
+	const uint8_t secondBlock[] = {0x82, 0x86, 0x84, 0xBE, 0x58, 0x86, 0xA8, 0xEB, 0x10, 0x64, 0x9C, 0xBF};
+	const uint8_t thirdBlock[] = {0x82, 0x87, 0x85, 0xBF, 0x40, 0x88, 0x25, 0xA8, 0x49, 0xE9, 0x5B, 0xA9, 0x7D, 0x7F, 0x89, 0x25, 0xA8, 0x49, 0xE9, 0x5B, 0xB8, 0xE8, 0xB4, 0xBF};
+
+	const uint8_t* blocks[] = {firstBlock, secondBlock, thirdBlock};
+	const uint_fast64_t blockLengths[] = {sizeof(firstBlock), sizeof(secondBlock), sizeof(thirdBlock)};
+	const char* requestURLs[] = {"/", "/", "/index.html"};
+	const uint_fast64_t tableSizes[] = {57, 110, 164};
+
+	char storage[HTTP2_MAX_HEADER_LIST_SIZE];
+
+	uint_fast64_t i;
+	for(i = 0; i < 3; i++){
+		HTTP_Request request;
+		http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+
+		if((error = hpack_decodeHeaderBlock(&table, blocks[i], blockLengths[i], &request, storage, sizeof(storage))) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to decode header block %" PRIuFAST64 ". '%s'.", i, util_toErrorString(error));
+		}
+
+		if(request.httpRequestType != HTTP_REQUEST_TYPE_GET){
+			return TEST_FAILURE("Request type of header block %" PRIuFAST64 " != 'GET'.", i);
+		}
+
+		if(request.requestURL == NULL || strcmp(request.requestURL, requestURLs[i]) != 0){
+			return TEST_FAILURE("Request URL '%s' != '%s'.", request.requestURL, requestURLs[i]);
+		}
+
+		HTTP_HeaderField* host = http_getHeaderField(&request, "Host");
+		if(host == NULL || strcmp(host->value, "www.example.com") != 0){
+			return TEST_FAILURE("%s", "':authority' has to be mapped to 'Host'.");
+		}
+
+		if(table.size != tableSizes[i]){
+			return TEST_FAILURE("Dynamic table size '%" PRIuFAST64 "' != '%" PRIuFAST64 "'.", table.size, tableSizes[i]);
+		}
+
+		http_freeHTTP_Request(&request);
+	}
+
+	if(table.length != 3){
+		return TEST_FAILURE("Dynamic table holds %" PRIuFAST16 " entries instead of 3.", table.length);
+	}
+
+	// Note: Index 62 is the newest entry of the dynamic table, anything past the last entry is a decoding error.
+	const uint8_t invalidIndex[] = {0x82, 0xC2};
+
+	HTTP_Request request;
+	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+
+	if(hpack_decodeHeaderBlock(&table, invalidIndex, sizeof(invalidIndex), &request, storage, sizeof(storage)) == ERROR_NO_ERROR){
+		return TEST_FAILURE("%s", "Index past the end of the dynamic table has to be rejected.");
+	}
+
+	http_freeHTTP_Request(&request);
+
+	// Note: Decoded names and values have to fit into the header storage.
+	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_MAX_MESSAGE_SIZE_EXCEEDED);
+	if(hpack_decodeHeaderBlock(&table, firstBlock, sizeof(firstBlock), &request, storage, 16) != ERROR_MAX_MESSAGE_SIZE_EXCEEDED){
+		return TEST_FAILURE("%s", "Header block exceeding the header storage has to be rejected.");
+	}
+
+	http_freeHTTP_Request(&request);
+
+	hpack_freeDynamicTable(&table);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(hpack_encodeResponseHeader){
+	ERROR_CODE error;
+
+	int8_t responseBuffer[64];
+
+	HTTP_Response response;
+	http_initHttpResponse(&response, responseBuffer, sizeof(responseBuffer), NULL);
+	response.httpStatusCode = _200_OK;
+
+	HTTP_ADD_HEADER_FIELD(&response, Connection, "keep-alive");
+	HTTP_ADD_HEADER_FIELD(&response, X-Test, "abc");
+
+	response.headerBlock = "ETag: \"a\"\r\n";
+	response.headerBlockLength = 11;
+
+	uint8_t buffer[128];
+	uint_fast64_t length;
+	if((error = hpack_encodeResponseHeader(&response, buffer, sizeof(buffer), &length)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to encode response header. '%s'.", util_toErrorString(error));
+	}
+
+	// Note: Indexed ':status: 200', 'x-test: abc' as literal without indexing with a new name and the 'Server' header field every response carries, with the name taken from the static table.
+	const uint8_t expected[] = {0x88, 0x00, 0x06, 'x', '-', 't', 'e', 's', 't', 0x03, 'a', 'b', 'c', 0x0F, 0x27, 0x0D, 'H', 'e', 'r', 'd', 'e', 'r', ' ', 'S', 'e', 'r', 'v', 'e', 'r'};
+	// Note: Followed by the current 'date' and the pre-serialized 'etag', both named from the static table.
+	const uint8_t expectedDate[] = {0x0F, 0x12, HTTP_DATE_LENGTH};
+	const uint8_t expectedEntityTag[] = {0x0F, 0x13, 0x03, '"', 'a', '"'};
+
+	const uint_fast64_t expectedLength = sizeof(expected) + sizeof(expectedDate) + HTTP_DATE_LENGTH + sizeof(expectedEntityTag);
+	if(length != expectedLength || memcmp(buffer, expected, sizeof(expected)) != 0 || memcmp(buffer + sizeof(expected), expectedDate, sizeof(expectedDate)) != 0 || memcmp(buffer + length - sizeof(expectedEntityTag), expectedEntityTag, sizeof(expectedEntityTag)) != 0){
+		return TEST_FAILURE("Encoded header block of %" PRIuFAST64 " bytes does not match the expected %" PRIuFAST64 " bytes.", length, expectedLength);
+	}
+
+	if(hpack_encodeResponseHeader(&response, buffer, 4, &length) == ERROR_NO_ERROR){
+		return TEST_FAILURE("%s", "Encoded header block does not fit into the buffer.");
+	}
+
+	http_freeHTTP_Response(&response);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http2_processInput){
+	ERROR_CODE error;
+
+	Http2Session session;
+	if((error = http2_initSession(&session)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to initialise session. '%s'.", util_toErrorString(error));
+	}
+
+	const uint_fast64_t initialControlFramesLength = session.controlFramesLength;
+
+	// Connection preface, empty SETTINGS and a HEADERS frame for stream 1 with END_STREAM and END_HEADERS set.
+	int8_t input[128];
+	uint_fast64_t length = 0;
+
+	memcpy(input, HTTP2_CONNECTION_PREFACE, HTTP2_CONNECTION_PREFACE_LENGTH);
+	length += HTTP2_CONNECTION_PREFACE_LENGTH;
+
+	length += http2_writeFrameHeader(input + length, 0, HTTP2_FRAME_TYPE_SETTINGS, 0, 0);
+
+	const uint8_t headerBlock[] = {0x82, 0x86, 0x84, 0x41, 0x8C, 0xF1, 0xE3, 0xC2, 0xE5, 0xF2, 0x3A, 0x6B, 0xA0, 0xAB, 0x90, 0xF4, 0xFF};
+	length += http2_writeFrameHeader(input + length, sizeof(headerBlock), HTTP2_FRAME_TYPE_HEADERS, HTTP2_FLAG_END_STREAM | HTTP2_FLAG_END_HEADERS, 1);
+	memcpy(input + length, headerBlock, sizeof(headerBlock));
+	length += sizeof(headerBlock);
+
+	uint_fast64_t consumed;
+	if((error = http2_processInput(&session, input, length, sizeof(input), &consumed)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to process input. '%s'.", util_toErrorString(error));
+	}
+
+	if(consumed != length){
+		return TEST_FAILURE("Consumed %" PRIuFAST64 " of %" PRIuFAST64 " bytes.", consumed, length);
+	}
+
+	Http2Stream* stream = NULL;
+
+	uint_fast64_t i;
+	for(i = 0; i < HTTP2_MAX_CONCURRENT_STREAMS; i++){
+		if(session.streams[i].id == 1){
+			stream = &session.streams[i];
+		}
+	}
+
+	if(stream == NULL || stream->state != HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE){
+		return TEST_FAILURE("%s", "Stream 1 has to be half closed (remote) after END_STREAM.");
+	}
+
+	if(stream->request.requestURL == NULL || strcmp(stream->request.requestURL, "/") != 0){
+		return TEST_FAILURE("Request URL '%s' != '%s'.", stream->request.requestURL, "/");
+	}
+
+	// Note: The SETTINGS acknowledgement gets queued behind the servers own SETTINGS.
+	const uint8_t* ack = (const uint8_t*) session.controlFrames + initialControlFramesLength;
+	if(session.controlFramesLength != initialControlFramesLength + HTTP2_FRAME_HEADER_LENGTH || ack[3] != HTTP2_FRAME_TYPE_SETTINGS || ack[4] != HTTP2_FLAG_ACK){
+		return TEST_FAILURE("%s", "Failed to acknowledge the clients SETTINGS.");
+	}
+
+	http2_freeSession(&session);
+
+	return TEST_SUCCESS;
+}
+
+#endif
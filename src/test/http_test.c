@@ -35,53 +35,41 @@ TEST_TEST_FUNCTION(http_addHeaderField){
 		char value[] = "localhost";
 		const uint_fast64_t headerFieldValueLength = strlen(value);
 
-		char* headerFieldName = malloc(sizeof(*headerFieldName) * (headerFieldNameLength + 1));
-		strncpy(headerFieldName, name, headerFieldNameLength + 1);
-
-		char* headerFieldValue = malloc(sizeof(*headerFieldValue) * (headerFieldValueLength + 1));
-		strncpy(headerFieldValue, value, headerFieldValueLength + 1);
-
-		if(http_addHeaderField(&request, headerFieldName, headerFieldNameLength, headerFieldValue, headerFieldValueLength) != ERROR_NO_ERROR){
+		if(http_addHeaderField(&request, name, headerFieldNameLength, value, headerFieldValueLength) != ERROR_NO_ERROR){
 			return TEST_FAILURE("%s", "Failed to add header field to http request.");
 		}
 
-		if(request.httpHeaderFields.length != 1){
+		if(request.numHeaderFields != 1){
 			return TEST_FAILURE("%s", "Failed to add header field to http request.");
 		}
 
-		HTTP_HeaderField* headerField = http_getHeaderField(&request, name);
+		HTTP_HeaderField* headerField = http_getHeaderField(&request, "host");
 
 		if(headerField == NULL){
 			return TEST_FAILURE("Failed to retrieve Header field '%s'.", name);
 		}
 
-		if(strncmp(name, headerField->name, headerFieldNameLength + 1) != 0){
-			return TEST_FAILURE("HeaderField name '%s' != '%s'.", name, headerField->name);
-		}
-
-		if(strncmp(value, headerField->value, headerFieldValueLength + 1) != 0){
-			return TEST_FAILURE("HeaderField name '%s' != '%s'.", value, headerField->name);
+		// Note: Header fields are views, nothing gets copied.
+		if(headerField->name != name || headerField->value != value){
+			return TEST_FAILURE("HeaderField '%s' does not point into the request.", name);
 		}
 	}
 
 	{
-		HTTP_ADD_HEADER_FIELD(&request, Content-Length, "128");
-
-		#define HEADER_FIELD_NAME "Content-Length"
-		HTTP_HeaderField* headerField = http_getHeaderField(&request, HEADER_FIELD_NAME);
-
-		if(headerField == NULL){
-			return TEST_FAILURE("Failed to retrieve Header field '%s'.", HEADER_FIELD_NAME);
+		char name[] = "X-Test";
+		char value[] = "128";
+
+		uint_fast64_t i;
+		for(i = request.numHeaderFields; i < CONSTANTS_HTTP_MAX_HEADER_FIELDS; i++){
+			if(http_addHeaderField(&request, name, strlen(name), value, strlen(value)) != ERROR_NO_ERROR){
+				return TEST_FAILURE("Failed to add header field %" PRIuFAST64 ".", i);
+			}
 		}
 
-		if(strncmp(HEADER_FIELD_NAME, headerField->name, strlen(HEADER_FIELD_NAME) + 1) != 0){
-			return TEST_FAILURE("HeaderField name '%s' != '%s'.", HEADER_FIELD_NAME, headerField->name);
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_MAX_HEADER_FIELDS_REACHED);
+		if(http_addHeaderField(&request, name, strlen(name), value, strlen(value)) != ERROR_MAX_HEADER_FIELDS_REACHED){
+			return TEST_FAILURE("More than %d header fields got added.", CONSTANTS_HTTP_MAX_HEADER_FIELDS);
 		}
-
-		if(strncmp("128", headerField->value, strlen("128") + 1) != 0){
-			return TEST_FAILURE("HeaderField name '%s' != '%s'.", "128", headerField->name);
-		}
-		#undef HEADER_FIELD_NAME
 	}
 
 	http_freeHTTP_Request(&request);
@@ -92,20 +80,14 @@ TEST_TEST_FUNCTION(http_addHeaderField){
 TEST_TEST_FUNCTION(http_getHeaderField){
 	char name[] = "Host";
 	const uint_fast64_t headerFieldNameLength = strlen(name);
-	
+
 	char value[] = "localhost";
 	const uint_fast64_t headerFieldValueLength = strlen(value);
 
-	char* headerFieldName = malloc(sizeof(*headerFieldName) * (headerFieldNameLength + 1));
-	strncpy(headerFieldName, name, headerFieldNameLength + 1);
-
-	char* headerFieldValue = malloc(sizeof(*headerFieldValue) * (headerFieldValueLength + 1));
-	strncpy(headerFieldValue, value, headerFieldValueLength + 1);
-
 	HTTP_Request request;
 	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_UNKNOWN);
 
-	if(http_addHeaderField(&request, headerFieldName, headerFieldNameLength, headerFieldValue, headerFieldValueLength) != ERROR_NO_ERROR){
+	if(http_addHeaderField(&request, name, headerFieldNameLength, value, headerFieldValueLength) != ERROR_NO_ERROR){
 		return TEST_FAILURE("%s", "Failed to add header field to http request.");
 	}
 
@@ -115,15 +97,70 @@ TEST_TEST_FUNCTION(http_getHeaderField){
 		return TEST_FAILURE("%s", "Failed to retrieve header field from http request.");
 	}
 
-	if(strncmp(headerFieldHost->name, headerFieldName, headerFieldNameLength) !=0){
+	if(strncmp(headerFieldHost->name, name, headerFieldNameLength) !=0){
 		return TEST_FAILURE("%s", "Failed to retrieve header field from http request.");
 	}
 
+	// Note: Names have to match as a whole.
+	if(http_getHeaderField(&request, "Hos") != NULL || http_getHeaderField(&request, "Hosts") != NULL){
+		return TEST_FAILURE("%s", "Header field names must not match by prefix.");
+	}
+
+	if(http_getKnownHeaderField(&request, HTTP_HEADER_FIELD_HOST) != headerFieldHost){
+		return TEST_FAILURE("%s", "Failed to retrieve known header field 'Host' by index.");
+	}
+
+	char unknownName[] = "X-Forwarded-For";
+	char unknownValue[] = "127.0.0.1";
+
+	if(http_addHeaderField(&request, unknownName, strlen(unknownName), unknownValue, strlen(unknownValue)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("%s", "Failed to add header field to http request.");
+	}
+
+	HTTP_HeaderField* headerFieldForwardedFor = http_getHeaderField(&request, "x-forwarded-for");
+	if(headerFieldForwardedFor == NULL || headerFieldForwardedFor->value != unknownValue){
+		return TEST_FAILURE("Failed to retrieve unknown header field '%s'.", unknownName);
+	}
+
+	if(http_getKnownHeaderField(&request, HTTP_HEADER_FIELD_RANGE) != NULL){
+		return TEST_FAILURE("%s", "Request has no header field 'Range'.");
+	}
+
 	http_freeHTTP_Request(&request);
 
 	return TEST_SUCCESS;
 }
 
+TEST_TEST_FUNCTION(http_internHeaderFieldName){
+	HTTP_KnownHeaderField knownHeaderField;
+	for(knownHeaderField = 0; knownHeaderField < HTTP_NUM_KNOWN_HEADER_FIELDS; knownHeaderField++){
+		const char* name = HTTP_KNOWN_HEADER_FIELD_NAME_MAPPING_ARRAY[knownHeaderField];
+
+		if(http_internHeaderFieldName(name, strlen(name)) != knownHeaderField){
+			return TEST_FAILURE("Failed to recognise header field '%s'.", name);
+		}
+	}
+
+	const char* names[] = {"HOST", "if-modified-since", "TRANSFER-ENCODING"};
+	const HTTP_KnownHeaderField knownHeaderFields[] = {HTTP_HEADER_FIELD_HOST, HTTP_HEADER_FIELD_IF_MODIFIED_SINCE, HTTP_HEADER_FIELD_TRANSFER_ENCODING};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(names); i++){
+		if(http_internHeaderFieldName(names[i], strlen(names[i])) != knownHeaderFields[i]){
+			return TEST_FAILURE("Header field names are case insensitive, failed to recognise '%s'.", names[i]);
+		}
+	}
+
+	const char* unknownNames[] = {"Hosts", "Rangx", "If-Modified-Sincx", "Transfer-Encodinx", "Cookie"};
+	for(i = 0; i < UTIL_ARRAY_LENGTH(unknownNames); i++){
+		if(http_internHeaderFieldName(unknownNames[i], strlen(unknownNames[i])) != HTTP_HEADER_FIELD_UNKNOWN){
+			return TEST_FAILURE("'%s' is not a known header field.", unknownNames[i]);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
 TEST_TEST_FUNCTION(HTTP_contentTypeToString){
 	const char* contentType = http_contentTypeToString(HTTP_CONTENT_TYPE_TEXT_HTML);
 
@@ -134,6 +171,138 @@ TEST_TEST_FUNCTION(HTTP_contentTypeToString){
 	return TEST_SUCCESS;
 }
 
+TEST_TEST_FUNCTION(http_getContentType){
+	struct{
+		const char* extension;
+		HTTP_ContentType contentType;
+	}extensions[] = {
+		{"html", HTTP_CONTENT_TYPE_TEXT_HTML},
+		{"HTM", HTTP_CONTENT_TYPE_TEXT_HTML},
+		{"txt", HTTP_CONTENT_TYPE_TEXT_PLAIN},
+		{"css", HTTP_CONTENT_TYPE_TEXT_CSS},
+		{"js", HTTP_CONTENT_TYPE_TEXT_JAVASCRIPT},
+		{"JPEG", HTTP_CONTENT_TYPE_IMAGE_JPEG},
+		{"tif", HTTP_CONTENT_TYPE_IMAGE_TIFF},
+		{"tiff", HTTP_CONTENT_TYPE_IMAGE_TIFF},
+		{"mkv", HTTP_CONTENT_TYPE_VIDEO_X_MATROSKA},
+		{"mp4", HTTP_CONTENT_TYPE_VIDEO_MP4},
+		{"webm", HTTP_CONTENT_TYPE_VIDEO_WEBM},
+		{"flac", HTTP_CONTENT_TYPE_AUDIO_FLAC},
+		{"webp", HTTP_CONTENT_TYPE_IMAGE_WEBP},
+		{"avif", HTTP_CONTENT_TYPE_IMAGE_AVIF}
+	};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(extensions); i++){
+		const HTTP_ContentType contentType = http_getContentType(extensions[i].extension, strlen(extensions[i].extension));
+
+		if(contentType != extensions[i].contentType){
+			return TEST_FAILURE("'%s' mapped to '%s' instead of '%s'.", extensions[i].extension, http_contentTypeToString(contentType), http_contentTypeToString(extensions[i].contentType));
+		}
+	}
+
+	// Note: Unknown extensions, prefixes of known ones and whole paths without an extension fall back to 'text/plain'.
+	const char* unknownExtensions[] = {"", "h", "htmlx", "webmm", "mp", "/var/www/herder/index"};
+	for(i = 0; i < UTIL_ARRAY_LENGTH(unknownExtensions); i++){
+		if(http_getContentType(unknownExtensions[i], strlen(unknownExtensions[i])) != HTTP_CONTENT_TYPE_TEXT_PLAIN){
+			return TEST_FAILURE("'%s' is not a known file extension.", unknownExtensions[i]);
+		}
+	}
+
+	if(!http_isCompressibleContentType(HTTP_CONTENT_TYPE_TEXT_HTML) || http_isCompressibleContentType(HTTP_CONTENT_TYPE_VIDEO_MP4)){
+		return TEST_FAILURE("%s", "Only 'text/html' is compressible.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_initMimeTypeRegistry){
+	ERROR_CODE error;
+
+	#define TEST_FILE_NAME "/tmp/herder_http_test_mimeTypes_XXXXXX"
+
+	char filePath[] = TEST_FILE_NAME;
+
+	#undef TEST_FILE_NAME
+
+	int tempFileDescriptor = mkstemp(filePath);
+	if(tempFileDescriptor < 1){
+		return TEST_FAILURE("Failed to create temporary file '%s' [%s].", filePath, strerror(errno));
+	}
+
+	// Note: Known types keep their value, 'xml' gets replaced, the last definition of 'ogg' wins and types without extensions are skipped.
+	const char mimeTypes[] = "# MIME type\tExtensions\n\napplication/json\t\tjson map\naudio/ogg\togg oga\ntext/html  shtml # Server side includes.\napplication/xml xml xsl\nvideo/ogg ogg ogv\r\napplication/x-empty\nimage/x-icns icns";
+
+	if(write(tempFileDescriptor, mimeTypes, sizeof(mimeTypes) - 1) != sizeof(mimeTypes) - 1){
+		return TEST_FAILURE("Failed to write '%s'.", filePath);
+	}
+
+	close(tempFileDescriptor);
+
+	if((error = http_initMimeTypeRegistry(filePath)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to load '%s'. '%s'.", filePath, util_toErrorString(error));
+	}
+
+	unlink(filePath);
+
+	struct{
+		const char* extension;
+		const char* contentType;
+		bool compressible;
+	}extensions[] = {
+		{"json", "application/json", true},
+		{"MAP", "application/json", true},
+		{"oga", "audio/ogg", false},
+		{"ogg", "video/ogg", false},
+		{"ogv", "video/ogg", false},
+		{"shtml", "text/html", true},
+		{"xml", "application/xml", true},
+		{"xsl", "application/xml", true},
+		{"icns", "image/x-icns", false},
+		{"html", "text/html", true},
+		{"webp", "image/webp", false}
+	};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(extensions); i++){
+		const HTTP_ContentType contentType = http_getContentType(extensions[i].extension, strlen(extensions[i].extension));
+
+		if(strcmp(http_contentTypeToString(contentType), extensions[i].contentType) != 0 || http_isCompressibleContentType(contentType) != extensions[i].compressible){
+			return TEST_FAILURE("'%s' mapped to '%s' instead of '%s'.", extensions[i].extension, http_contentTypeToString(contentType), extensions[i].contentType);
+		}
+	}
+
+	if(http_getContentType("shtml", 5) != HTTP_CONTENT_TYPE_TEXT_HTML){
+		return TEST_FAILURE("%s", "Known content types have to keep their value.");
+	}
+
+	if(http_getContentType("x-empty", 7) != HTTP_CONTENT_TYPE_TEXT_PLAIN){
+		return TEST_FAILURE("%s", "Types without extensions must not register any.");
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_RETRIEV_FILE_INFO);
+	if(http_initMimeTypeRegistry(filePath) == ERROR_NO_ERROR){
+		return TEST_FAILURE("Loaded missing file '%s'.", filePath);
+	}
+
+	// Note: Every entry of a full size mime.types file has to get a slot of its own.
+	if(util_fileExists("/etc/mime.types")){
+		if((error = http_initMimeTypeRegistry("/etc/mime.types")) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to load '%s'. '%s'.", "/etc/mime.types", util_toErrorString(error));
+		}
+
+		if(http_getContentType("html", 4) != HTTP_CONTENT_TYPE_TEXT_HTML || http_getContentType("png", 3) != HTTP_CONTENT_TYPE_IMAGE_PNG){
+			return TEST_FAILURE("%s", "Failed to look up 'html' and 'png' in '/etc/mime.types'.");
+		}
+	}
+
+	if((error = http_initMimeTypeRegistry(NULL)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to restore the built-in content types. '%s'.", util_toErrorString(error));
+	}
+
+	return TEST_SUCCESS;
+}
+
 TEST_TEST_FUNCTION(http_parseRequestType){
 	if(http_parseRequestType("GET", 3) != HTTP_REQUEST_TYPE_GET){
 		return TEST_FAILURE("%s", "Failed to parse 'GET' as 'HTTP_REQUEST_TYPE_GET'.");
@@ -170,6 +339,16 @@ TEST_TEST_FUNCTION(http_parseRequestType){
 	if(http_parseRequestType("UNKNOWN", 7) != HTTP_REQUEST_TYPE_UNKNOWN){
 		return TEST_FAILURE("%s", "Failed to parse 'UNKNOWN' as 'HTTP_REQUEST_TYPE_UNKNOWN'.");
 	}
+
+	// Note: Share a slot or the length with a method, methods are case sensitive.
+	const char* unknownTypes[] = {"", "G", "GEX", "get", "HEAX", "OPTIONZ", "PUTS", "DELETED"};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(unknownTypes); i++){
+		if(http_parseRequestType(unknownTypes[i], strlen(unknownTypes[i])) != HTTP_REQUEST_TYPE_UNKNOWN){
+			return TEST_FAILURE("'%s' is not a request type.", unknownTypes[i]);
+		}
+	}
 	
 	return TEST_SUCCESS;
 }
@@ -197,8 +376,48 @@ TEST_TEST_FUNCTION(http_parseHTTP_Request){
 		return TEST_FAILURE("Failed to parse http version. '%" PRIuFAST8 ".%" PRIuFAST8 "' != '1.1.'", request.httpVersion.release, request.httpVersion.update);
 	}
 
+	if(request.requestURL < requestString || request.requestURL >= requestString + sizeof(requestString)){
+		return TEST_FAILURE("%s", "Request URL has to point into the request buffer.");
+	}
+
+	if(request.numHeaderFields != 13){
+		return TEST_FAILURE("Parsed %" PRIuFAST8 " header fields instead of 13.", request.numHeaderFields);
+	}
+
+	HTTP_HeaderField* host = http_getHeaderField(&request, "Host");
+	if(host == NULL || host->valueLength != strlen("localhost:1869") || strcmp(host->value, "localhost:1869") != 0){
+		return TEST_FAILURE("%s", "Failed to parse header field 'Host'.");
+	}
+
 	http_freeHTTP_Request(&request);
 
+	char http1_0RequestString[] = "GET /index.html HTTP/1.0\r\nHost: localhost:1869\r\n";
+
+	http_initRequest_(&request, NULL, 0, 0);
+
+	if((error = http_parseHTTP_Request(&request, http1_0RequestString, strlen(http1_0RequestString))) != ERROR_NO_ERROR || request.httpVersion.release != 1 || request.httpVersion.update != 0){
+		return TEST_FAILURE("Failed to parse HTTP/1.0 request. '%s'.", util_toErrorString(error));
+	}
+
+	http_freeHTTP_Request(&request);
+
+	const char* unsupportedRequestStrings[] = {"GET /index.html HTTP/2.0\r\nHost: localhost:1869\r\n", "GET /index.html HTTP/1.10\r\nHost: localhost:1869\r\n", "GET /index.html HTTP/\r\nHost: localhost:1869\r\n"};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(unsupportedRequestStrings); i++){
+		char unsupportedRequestString[64];
+		strcpy(unsupportedRequestString, unsupportedRequestStrings[i]);
+
+		http_initRequest_(&request, NULL, 0, 0);
+
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_VERSION_MISSMATCH);
+		if((error = http_parseHTTP_Request(&request, unsupportedRequestString, strlen(unsupportedRequestString))) != ERROR_VERSION_MISSMATCH){
+			return TEST_FAILURE("Expected '%s' for '%s' but got '%s'.", util_toErrorString(ERROR_VERSION_MISSMATCH), unsupportedRequestStrings[i], util_toErrorString(error));
+		}
+
+		http_freeHTTP_Request(&request);
+	}
+
 	return TEST_SUCCESS;
 }
 
@@ -218,6 +437,317 @@ TEST_TEST_FUNCTION(http_parseHTTP_Version){
 		return TEST_FAILURE("%s", "Failed to parese version.");
 	}
 
+	const char* unknownVersions[] = {"HTTP/1.2", "HTTP/3.0", "HTTP/2.1", "HTTPS1.1", "http/1.1", "HTTP/1.1 ", ""};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(unknownVersions); i++){
+		version = http_parseHTTP_Version(unknownVersions[i], strlen(unknownVersions[i]));
+
+		if(version.release != 0 || version.update != 0){
+			return TEST_FAILURE("'%s' is not a supported version.", unknownVersions[i]);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_findEndOfHeader){
+	const char requestString[] = "GET /index.html HTTP/1.1\r\nHost: localhost:1869\r\n\r\nGET /css/site.css HTTP/1.1\r\nHost: localhost:1869\r\n";
+
+	const int_fast64_t firstRequestLength = strlen("GET /index.html HTTP/1.1\r\nHost: localhost:1869\r\n\r\n");
+
+	int_fast64_t headerLength = http_findEndOfHeader(requestString, strlen(requestString));
+	if(headerLength != firstRequestLength){
+		return TEST_FAILURE("Header length '%" PRIdFAST64 "' != '%" PRIdFAST64 "'.", headerLength, firstRequestLength);
+	}
+
+	// The second, pipelined request is still missing its terminating empty line.
+	headerLength = http_findEndOfHeader(requestString + firstRequestLength, strlen(requestString) - firstRequestLength);
+	if(headerLength != -1){
+		return TEST_FAILURE("Found end of header in incomplete request at '%" PRIdFAST64 "'.", headerLength);
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_parseHeaderBlock){
+	const char requestString[] = "GET /index.html HTTP/1.1\r\nHost: localhost:1869\r\n\r\nGET /css/site.css HTTP/1.1\r\n";
+
+	const uint_fast64_t headerLength = strlen("GET /index.html HTTP/1.1\r\nHost: localhost:1869\r\n\r\n");
+
+	HTTP_Parser parser;
+	http_initParser(&parser);
+
+	// Note: The request arrives one byte at a time, the end of the header block is split across reads.
+	uint_fast64_t length;
+	for(length = 0; length < headerLength; length++){
+		uint_fast64_t parsedHeaderLength;
+		if(http_parseHeaderBlock(&parser, requestString, length, &parsedHeaderLength) != ERROR_INCOMPLETE){
+			return TEST_FAILURE("Header block complete after %" PRIuFAST64 " of %" PRIuFAST64 " bytes.", length, headerLength);
+		}
+	}
+
+	uint_fast64_t parsedHeaderLength;
+	if(http_parseHeaderBlock(&parser, requestString, strlen(requestString), &parsedHeaderLength) != ERROR_NO_ERROR || parsedHeaderLength != headerLength){
+		return TEST_FAILURE("Header length '%" PRIuFAST64 "' != '%" PRIuFAST64 "'.", parsedHeaderLength, headerLength);
+	}
+
+	if(parser.scanOffset != 0){
+		return TEST_FAILURE("%s", "Parser has to be reset for the next header block.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_initBody){
+	HTTP_Parser parser;
+	http_initParser(&parser);
+
+	HTTP_Request request;
+
+	char contentLength[] = "Content-Length";
+	char transferEncoding[] = "Transfer-Encoding";
+	char length[] = "128";
+	char invalidLength[] = "12a";
+	char chunked[] = "Chunked";
+	char gzip[] = "gzip, chunked";
+
+	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_GET);
+
+	if(http_initBody(&parser, &request) != ERROR_NO_ERROR || parser.state != HTTP_PARSER_STATE_HEADER){
+		return TEST_FAILURE("%s", "Request without body framing has no body.");
+	}
+
+	http_addHeaderField(&request, contentLength, strlen(contentLength), length, strlen(length));
+
+	if(http_initBody(&parser, &request) != ERROR_NO_ERROR || parser.state != HTTP_PARSER_STATE_BODY || parser.remaining != 128){
+		return TEST_FAILURE("%s", "Failed to frame body by 'Content-Length'.");
+	}
+
+	// Note: 'Transfer-Encoding' and 'Content-Length' together can't be trusted.
+	http_addHeaderField(&request, transferEncoding, strlen(transferEncoding), chunked, strlen(chunked));
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_HEADER_FIELD);
+	if(http_initBody(&parser, &request) != ERROR_INVALID_HEADER_FIELD){
+		return TEST_FAILURE("%s", "Request with 'Transfer-Encoding' and 'Content-Length' has to be rejected.");
+	}
+
+	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_POST);
+	http_addHeaderField(&request, transferEncoding, strlen(transferEncoding), chunked, strlen(chunked));
+
+	if(http_initBody(&parser, &request) != ERROR_NO_ERROR || parser.state != HTTP_PARSER_STATE_CHUNK_SIZE){
+		return TEST_FAILURE("%s", "Failed to frame chunked body.");
+	}
+
+	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_POST);
+	http_addHeaderField(&request, transferEncoding, strlen(transferEncoding), gzip, strlen(gzip));
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_HEADER_FIELD);
+	if(http_initBody(&parser, &request) != ERROR_INVALID_HEADER_FIELD){
+		return TEST_FAILURE("'Transfer-Encoding: %s' is not supported.", gzip);
+	}
+
+	http_initRequest_(&request, NULL, 0, HTTP_REQUEST_TYPE_POST);
+	http_addHeaderField(&request, contentLength, strlen(contentLength), invalidLength, strlen(invalidLength));
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_CONTENT_LENGTH);
+	if(http_initBody(&parser, &request) != ERROR_INVALID_CONTENT_LENGTH){
+		return TEST_FAILURE("'Content-Length: %s' has to be rejected.", invalidLength);
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_parseBody){
+	const char body[] = "4\r\nWiki\r\n6;ext=1\r\npedia \r\nE\r\nin \r\n\r\nchunks.\r\n0\r\nExpires: never\r\n\r\n";
+	const char nextRequest[] = "GET / HTTP/1.1\r\n";
+
+	char buffer[sizeof(body) + sizeof(nextRequest)];
+	memcpy(buffer, body, strlen(body));
+	memcpy(buffer + strlen(body), nextRequest, sizeof(nextRequest));
+
+	const uint_fast64_t bodyLength = strlen(body);
+
+	// Note: The body arrives in two parts, split at every possible offset. Partial lines are passed in again with the rest of the body.
+	uint_fast64_t split;
+	for(split = 0; split <= bodyLength; split++){
+		HTTP_Parser parser;
+		http_initParser(&parser);
+		parser.state = HTTP_PARSER_STATE_CHUNK_SIZE;
+
+		uint_fast64_t consumed;
+		ERROR_CODE error = http_parseBody(&parser, buffer, split, &consumed);
+
+		if(error != ERROR_INCOMPLETE && !(error == ERROR_NO_ERROR && split == bodyLength)){
+			return TEST_FAILURE("Split at %" PRIuFAST64 ": '%s'.", split, util_toErrorString(error));
+		}
+
+		uint_fast64_t totalConsumed = consumed;
+
+		if(error == ERROR_INCOMPLETE){
+			if((error = http_parseBody(&parser, buffer + totalConsumed, sizeof(buffer) - 1 - totalConsumed, &consumed)) != ERROR_NO_ERROR){
+				return TEST_FAILURE("Split at %" PRIuFAST64 ": '%s'.", split, util_toErrorString(error));
+			}
+
+			totalConsumed += consumed;
+		}
+
+		if(totalConsumed != bodyLength || parser.state != HTTP_PARSER_STATE_HEADER){
+			return TEST_FAILURE("Split at %" PRIuFAST64 ": consumed %" PRIuFAST64 " of %" PRIuFAST64 " bytes.", split, totalConsumed, bodyLength);
+		}
+	}
+
+	HTTP_Parser parser;
+	http_initParser(&parser);
+	parser.state = HTTP_PARSER_STATE_CHUNK_SIZE;
+
+	uint_fast64_t consumed;
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_CONTENT_LENGTH);
+	if(http_parseBody(&parser, "x\r\n", 3, &consumed) != ERROR_INVALID_CONTENT_LENGTH){
+		return TEST_FAILURE("%s", "Invalid chunk size has to be rejected.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_parseRange){
+	HTTP_ByteRange ranges[HTTP_MAX_BYTE_RANGES];
+	uint_fast8_t numRanges;
+
+	#define HTTP_TEST_PARSE_RANGE(value) http_parseRange(value, strlen(value), 1000, ranges, &numRanges)
+
+	if(HTTP_TEST_PARSE_RANGE("bytes=0-499") != ERROR_NO_ERROR || numRanges != 1 || ranges[0].first != 0 || ranges[0].last != 499){
+		return TEST_FAILURE("%s", "Failed to parse single range.");
+	}
+
+	// Open ended and past the end ranges get clamped to the last byte.
+	if(HTTP_TEST_PARSE_RANGE("bytes=900-, 950-5000") != ERROR_NO_ERROR || numRanges != 2 || ranges[0].first != 900 || ranges[0].last != 999 || ranges[1].last != 999){
+		return TEST_FAILURE("%s", "Failed to parse open ended ranges.");
+	}
+
+	if(HTTP_TEST_PARSE_RANGE("bytes=-100") != ERROR_NO_ERROR || numRanges != 1 || ranges[0].first != 900 || ranges[0].last != 999){
+		return TEST_FAILURE("%s", "Failed to parse suffix range.");
+	}
+
+	if(HTTP_TEST_PARSE_RANGE("bytes=1000-1100") != ERROR_NO_ERROR || numRanges != 0){
+		return TEST_FAILURE("%s", "Range beyond the end has to be unsatisfiable.");
+	}
+
+	const char* invalidValues[] = {"bytes=", "bytes=500-100", "bytes=a-b", "items=0-1", "bytes=0-1,,2-3", "bytes=99999999999999999999-", "bytes=0-0,1-1,2-2,3-3,4-4,5-5,6-6,7-7,8-8"};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(invalidValues); i++){
+		__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_VALUE);
+		const ERROR_CODE error = HTTP_TEST_PARSE_RANGE(invalidValues[i]);
+		__UTIL_ENABLE_ERROR_LOGGING__();
+
+		if(error != ERROR_INVALID_VALUE){
+			return TEST_FAILURE("Expected '%s' to be ignored.", invalidValues[i]);
+		}
+	}
+
+	#undef HTTP_TEST_PARSE_RANGE
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_parseDate){
+	char date[HTTP_DATE_LENGTH + 1];
+	http_formatDate(date, 1258301756);
+
+	if(strcmp(date, "Sun, 15 Nov 2009 16:15:56 GMT") != 0){
+		return TEST_FAILURE("Failed to format date, got '%s'.", date);
+	}
+
+	time_t time;
+	if(http_parseDate(date, &time) != ERROR_NO_ERROR || time != 1258301756){
+		return TEST_FAILURE("Failed to parse date '%s'.", date);
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_VALUE);
+	const ERROR_CODE error = http_parseDate("Sunday, 15-Nov-09 16:15:56 GMT", &time);
+	__UTIL_ENABLE_ERROR_LOGGING__();
+
+	if(error != ERROR_INVALID_VALUE){
+		return TEST_FAILURE("%s", "Obsolete date formats have to be rejected.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_entityTagListContains){
+	char entityTag[HTTP_ENTITY_TAG_LENGTH + 1];
+	http_formatEntityTag(entityTag, 0xCBF29CE484222325, 1024);
+
+	if(strcmp(entityTag, "\"cbf29ce484222325-400\"") != 0){
+		return TEST_FAILURE("Failed to format entity tag, got '%s'.", entityTag);
+	}
+
+	const char* matching[] = {"\"cbf29ce484222325-400\"", "\"a\", \"cbf29ce484222325-400\"", "W/\"cbf29ce484222325-400\"", "*"};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(matching); i++){
+		if(!http_entityTagListContains(matching[i], strlen(matching[i]), entityTag)){
+			return TEST_FAILURE("Expected '%s' to match.", matching[i]);
+		}
+	}
+
+	const char* notMatching[] = {"", "\"cbf29ce484222325-401\"", "\"a\", \"b\"", "cbf29ce484222325-400"};
+
+	for(i = 0; i < UTIL_ARRAY_LENGTH(notMatching); i++){
+		if(http_entityTagListContains(notMatching[i], strlen(notMatching[i]), entityTag)){
+			return TEST_FAILURE("Expected '%s' not to match.", notMatching[i]);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_tokenListContains){
+	const char* matching[] = {"close", "Close", "keep-alive, close", "keep-alive,close", " \tCLOSE ,upgrade"};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(matching); i++){
+		if(!http_tokenListContains(matching[i], strlen(matching[i]), "close")){
+			return TEST_FAILURE("Expected '%s' to contain 'close'.", matching[i]);
+		}
+	}
+
+	const char* notMatching[] = {"", ",", "keep-alive", "closed", "close-later", "keep-alive, upgrade", "clos"};
+
+	for(i = 0; i < UTIL_ARRAY_LENGTH(notMatching); i++){
+		if(http_tokenListContains(notMatching[i], strlen(notMatching[i]), "close")){
+			return TEST_FAILURE("Expected '%s' not to contain 'close'.", notMatching[i]);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(http_negotiateContentEncoding){
+	struct{
+		const char* acceptEncoding;
+		HTTP_ContentEncoding expected;
+	}cases[] = {
+		{"gzip, deflate, br", HTTP_CONTENT_ENCODING_GZIP},
+		{"br;q=1.0, GZIP;q=0.5, *;q=0.1", HTTP_CONTENT_ENCODING_GZIP},
+		{"deflate", HTTP_CONTENT_ENCODING_IDENTITY},
+		{"gzip;q=0", HTTP_CONTENT_ENCODING_IDENTITY},
+		{"gzip;q=0.5, identity", HTTP_CONTENT_ENCODING_IDENTITY},
+		{"*", HTTP_CONTENT_ENCODING_GZIP},
+		{"", HTTP_CONTENT_ENCODING_IDENTITY}
+	};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(cases); i++){
+		const HTTP_ContentEncoding contentEncoding = http_negotiateContentEncoding(cases[i].acceptEncoding, strlen(cases[i].acceptEncoding));
+
+		if(contentEncoding != cases[i].expected){
+			return TEST_FAILURE("Negotiated '%s' for '%s', expected '%s'.", http_contentEncodingToString(contentEncoding), cases[i].acceptEncoding, http_contentEncodingToString(cases[i].expected));
+		}
+	}
+
 	return TEST_SUCCESS;
 }
 
@@ -0,0 +1,114 @@
+#ifndef IO_URING_TEST_C
+#define IO_URING_TEST_C
+
+#include "../test.c"
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+
+TEST_TEST_FUNCTION(ioUring_timeout){
+	IoUring ring;
+	if(ioUring_init(&ring, 8) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to initialise io_uring. '%s'", strerror(errno));
+	}
+
+	struct __kernel_timespec timeout = {0};
+	timeout.tv_nsec = 1000000;
+
+	ioUring_prepareTimeout(ioUring_getSubmissionQueueEntry(&ring), &timeout, 42);
+
+	const int ret = ioUring_submitAndWait(&ring, 1, NULL);
+
+	struct io_uring_cqe* completionQueueEntry = ioUring_peekCompletionQueueEntry(&ring);
+
+	if(ret < 0 || completionQueueEntry == NULL){
+		ioUring_free(&ring);
+
+		return TEST_FAILURE("Expected a completion, io_uring_enter returned '%d'.", ret);
+	}
+
+	const uint64_t userData = completionQueueEntry->user_data;
+	const int result = completionQueueEntry->res;
+
+	ioUring_advanceCompletionQueue(&ring);
+
+	const bool queueEmpty = ioUring_peekCompletionQueueEntry(&ring) == NULL;
+
+	ioUring_free(&ring);
+
+	if(userData != 42 || result != -ETIME){
+		return TEST_FAILURE("Expected timeout completion '%d' '%d' but got '%" PRIu64 "' '%d'.", 42, -ETIME, userData, result);
+	}
+
+	if(!queueEmpty){
+		return TEST_FAILURE("%s", "Completion queue should be empty.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(ioUring_multishotReceive){
+	int sockets[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0){
+		return TEST_FAILURE("Failed to create socket pair. '%s'", strerror(errno));
+	}
+
+	IoUring ring;
+	if(ioUring_init(&ring, 8) != ERROR_NO_ERROR || ioUring_registerBuffers(&ring, 0, 4, 16) != ERROR_NO_ERROR){
+		close(sockets[0]);
+		close(sockets[1]);
+
+		return TEST_FAILURE("Failed to initialise io_uring. '%s'", strerror(errno));
+	}
+
+	ioUring_prepareMultishotReceive(ioUring_getSubmissionQueueEntry(&ring), sockets[0], 0, 7);
+
+	const char* messages[] = {"Hello", "World"};
+
+	bool success = true;
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(messages) && success; i++){
+		if(write(sockets[1], messages[i], strlen(messages[i])) != (ssize_t) strlen(messages[i])){
+			success = false;
+
+			break;
+		}
+
+		if(ioUring_submitAndWait(&ring, 1, NULL) < 0){
+			success = false;
+
+			break;
+		}
+
+		struct io_uring_cqe* completionQueueEntry = ioUring_peekCompletionQueueEntry(&ring);
+
+		// Note: A multishot receive keeps delivering into provided buffers until it gets cancelled.
+		success = completionQueueEntry != NULL && completionQueueEntry->user_data == 7 && (completionQueueEntry->flags & IORING_CQE_F_MORE) && (completionQueueEntry->flags & IORING_CQE_F_BUFFER) && completionQueueEntry->res == (int) strlen(messages[i]);
+
+		if(success){
+			const uint16_t bufferID = completionQueueEntry->flags >> IORING_CQE_BUFFER_SHIFT;
+
+			success = memcmp(ioUring_getBuffer(&ring, bufferID), messages[i], strlen(messages[i])) == 0;
+
+			ioUring_recycleBuffer(&ring, bufferID);
+		}
+
+		if(completionQueueEntry != NULL){
+			ioUring_advanceCompletionQueue(&ring);
+		}
+	}
+
+	ioUring_free(&ring);
+
+	close(sockets[0]);
+	close(sockets[1]);
+
+	if(!success){
+		return TEST_FAILURE("Failed to receive message '%s'.", messages[MIN(i, UTIL_ARRAY_LENGTH(messages) - 1)]);
+	}
+
+	return TEST_SUCCESS;
+}
+
+#endif
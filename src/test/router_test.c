@@ -0,0 +1,190 @@
+#ifndef ROUTER_TEST_C
+#define ROUTER_TEST_C
+
+#include "../test.c"
+#include <string.h>
+
+#define ROUTER_TEST_LOOKUP(router, request, type, url, value) do{ \
+	(request)->httpRequestType = type; \
+	(request)->requestURL = url; \
+	(request)->requestURLLength = strlen(url); \
+	\
+	error = router_lookup(router, request, (void**) value); \
+}while(0)
+
+TEST_TEST_FUNCTION(router_add){
+	ERROR_CODE error;
+
+	Router router;
+	router_init(&router);
+
+	int a = 0;
+
+	if((error = router_add(&router, HTTP_REQUEST_TYPE_UNKNOWN, "/img", 4, &a)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add route '%s'. '%s'.", "/img", util_toErrorString(error));
+	}
+
+	if((error = router_add(&router, HTTP_REQUEST_TYPE_GET, "/img", 4, &a)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add method specific route '%s'. '%s'.", "/img", util_toErrorString(error));
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_DUPLICATE_ENTRY);
+	if(router_add(&router, HTTP_REQUEST_TYPE_GET, "/img", 4, &a) != ERROR_DUPLICATE_ENTRY){
+		return TEST_FAILURE("Route '%s' registered twice.", "/img");
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_REQUEST_URL);
+	if(router_add(&router, HTTP_REQUEST_TYPE_GET, "img", 3, &a) != ERROR_INVALID_REQUEST_URL){
+		return TEST_FAILURE("Route '%s' has to start with '/'.", "img");
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_REQUEST_URL);
+	if(router_add(&router, HTTP_REQUEST_TYPE_GET, "/user/a:id", 10, &a) != ERROR_INVALID_REQUEST_URL){
+		return TEST_FAILURE("Path parameter of route '%s' has to span a whole segment.", "/user/a:id");
+	}
+
+	if((error = router_add(&router, HTTP_REQUEST_TYPE_GET, "/user/:id", 9, &a)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to add route '%s'. '%s'.", "/user/:id", util_toErrorString(error));
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_NAME_MISSMATCH);
+	if(router_add(&router, HTTP_REQUEST_TYPE_GET, "/user/:name/posts", 17, &a) != ERROR_NAME_MISSMATCH){
+		return TEST_FAILURE("Conflicting path parameter of route '%s' has to be rejected.", "/user/:name/posts");
+	}
+
+	if((error = router_compile(&router)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to compile router. '%s'.", util_toErrorString(error));
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_INVALID_VALUE);
+	if(router_add(&router, HTTP_REQUEST_TYPE_GET, "/css", 4, &a) != ERROR_INVALID_VALUE){
+		return TEST_FAILURE("%s", "Routes can't be added to a compiled router.");
+	}
+
+	router_free(&router);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION(router_lookup){
+	ERROR_CODE error;
+
+	Router router;
+	router_init(&router);
+
+	int root, img, images, userNew, user, userPosts, apiGet, apiPost;
+
+	struct{
+		HTTP_RequestType requestType;
+		const char* path;
+		int* value;
+	}routes[] = {
+		{HTTP_REQUEST_TYPE_UNKNOWN, "/", &root},
+		{HTTP_REQUEST_TYPE_UNKNOWN, "/img", &img},
+		{HTTP_REQUEST_TYPE_UNKNOWN, "/images", &images},
+		{HTTP_REQUEST_TYPE_UNKNOWN, "/user/new", &userNew},
+		{HTTP_REQUEST_TYPE_UNKNOWN, "/user/:id", &user},
+		{HTTP_REQUEST_TYPE_UNKNOWN, "/user/:id/posts/:post", &userPosts},
+		{HTTP_REQUEST_TYPE_GET, "/api", &apiGet},
+		{HTTP_REQUEST_TYPE_POST, "/api", &apiPost}
+	};
+
+	uint_fast64_t i;
+	for(i = 0; i < UTIL_ARRAY_LENGTH(routes); i++){
+		if((error = router_add(&router, routes[i].requestType, routes[i].path, strlen(routes[i].path), routes[i].value)) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to add route '%s'. '%s'.", routes[i].path, util_toErrorString(error));
+		}
+	}
+
+	if((error = router_compile(&router)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to compile router. '%s'.", util_toErrorString(error));
+	}
+
+	struct{
+		HTTP_RequestType requestType;
+		const char* url;
+		int* value;
+	}lookups[] = {
+		{HTTP_REQUEST_TYPE_GET, "/", &root},
+		{HTTP_REQUEST_TYPE_GET, "/index.html", &root},
+		{HTTP_REQUEST_TYPE_GET, "/img", &img},
+		{HTTP_REQUEST_TYPE_GET, "/img/", &img},
+		{HTTP_REQUEST_TYPE_GET, "/img/a/img_001.png", &img},
+		// Note: Only whole segments match, '/imgs' falls back to '/'.
+		{HTTP_REQUEST_TYPE_GET, "/imgs", &root},
+		{HTTP_REQUEST_TYPE_GET, "/images/img_001.png", &images},
+		{HTTP_REQUEST_TYPE_GET, "/user/new", &userNew},
+		{HTTP_REQUEST_TYPE_GET, "/user/newer", &user},
+		{HTTP_REQUEST_TYPE_GET, "/user/42", &user},
+		{HTTP_REQUEST_TYPE_GET, "/user/new/posts/7", &userPosts},
+		{HTTP_REQUEST_TYPE_GET, "/user/42/posts", &user},
+		{HTTP_REQUEST_TYPE_GET, "/api", &apiGet},
+		// Note: Routes for GET answer HEAD as well.
+		{HTTP_REQUEST_TYPE_HEAD, "/api", &apiGet},
+		{HTTP_REQUEST_TYPE_POST, "/api/v1", &apiPost}
+	};
+
+	HTTP_Request request = {0};
+	int* value;
+
+	for(i = 0; i < UTIL_ARRAY_LENGTH(lookups); i++){
+		ROUTER_TEST_LOOKUP(&router, &request, lookups[i].requestType, (char*) lookups[i].url, &value);
+
+		if(error != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to look up '%s'. '%s'.", lookups[i].url, util_toErrorString(error));
+		}
+
+		if(value != lookups[i].value){
+			return TEST_FAILURE("Request URL '%s' routed to the wrong context.", lookups[i].url);
+		}
+	}
+
+	ROUTER_TEST_LOOKUP(&router, &request, HTTP_REQUEST_TYPE_GET, "/user/new/posts/7", &value);
+
+	HTTP_PathParameter* id = http_getPathParameter(&request, "id");
+	HTTP_PathParameter* post = http_getPathParameter(&request, "post");
+
+	if(request.numPathParameters != 2 || id == NULL || post == NULL){
+		return TEST_FAILURE("Expected 2 path parameters but got %" PRIuFAST8 ".", request.numPathParameters);
+	}
+
+	if(id->valueLength != 3 || memcmp(id->value, "new", 3) != 0 || post->valueLength != 1 || memcmp(post->value, "7", 1) != 0){
+		return TEST_FAILURE("Path parameters 'id' = '%.*s', 'post' = '%.*s'.", (int) id->valueLength, id->value, (int) post->valueLength, post->value);
+	}
+
+	// Note: Parameters of a deeper route that did not match must not leak into the result.
+	ROUTER_TEST_LOOKUP(&router, &request, HTTP_REQUEST_TYPE_GET, "/user/42/posts", &value);
+
+	if(request.numPathParameters != 1 || (id = http_getPathParameter(&request, "id")) == NULL || id->valueLength != 2 || memcmp(id->value, "42", 2) != 0){
+		return TEST_FAILURE("%s", "Failed to capture path parameter 'id'.");
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_METHOD_NOT_ALLOWED);
+	ROUTER_TEST_LOOKUP(&router, &request, HTTP_REQUEST_TYPE_DELETE, "/api", &value);
+
+	if(error != ERROR_METHOD_NOT_ALLOWED || value != NULL){
+		return TEST_FAILURE("'%s' has no route for DELETE.", "/api");
+	}
+
+	router_free(&router);
+
+	// Note: Without a route for '/', unrelated paths are not found.
+	router_init(&router);
+
+	if((error = router_add(&router, HTTP_REQUEST_TYPE_UNKNOWN, "/img", 4, &img)) != ERROR_NO_ERROR || (error = router_compile(&router)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to build router. '%s'.", util_toErrorString(error));
+	}
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_ENTRY_NOT_FOUND);
+	ROUTER_TEST_LOOKUP(&router, &request, HTTP_REQUEST_TYPE_GET, "/index.html", &value);
+
+	if(error != ERROR_ENTRY_NOT_FOUND){
+		return TEST_FAILURE("Request URL '%s' must not be routed.", "/index.html");
+	}
+
+	router_free(&router);
+
+	return TEST_SUCCESS;
+}
+
+#endif
@@ -26,6 +26,8 @@ TEST_TEST_SUIT_DESTRUCT_FUNCTION(server, Server, server){
 
 	linkedList_free(&server->contexts);
 
+	router_free(&server->router);
+
 	free(server);
 
 	return ERROR(ERROR_NO_ERROR);
@@ -54,8 +56,12 @@ TEST_TEST_FUNCTION_(server_getContextHandler, Server, server){
 	server_addContext(server, "/img", NULL);
 
 	ERROR_CODE error;
+	if((error = server_compileRouter(server)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to compile router. '%s'.", util_toErrorString(error));
+	}
 
 	HTTP_Request request;
+	request.httpRequestType = HTTP_REQUEST_TYPE_GET;
 	request.requestURL = "/img";
 	request.requestURLLength = 4;
 
@@ -127,4 +133,391 @@ TEST_TEST_FUNCTION_(server_translateSymbolicFileLocationErrorPage, Server, serve
 	return TEST_SUCCESS;
 }
 
+TEST_TEST_FUNCTION_(server_createListeningSocket, Server, server){
+	ERROR_CODE error;
+
+	int socketFileDescriptor_a;
+	if((error = server_createListeningSocket(&socketFileDescriptor_a, 0, true)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to create listening socket. '%s'.", util_toErrorString(error));
+	}
+
+	struct sockaddr_in6 socketAddress;
+	socklen_t socketAddressLength = sizeof(socketAddress);
+	if(getsockname(socketFileDescriptor_a, (struct sockaddr*) &socketAddress, &socketAddressLength) != 0){
+		return TEST_FAILURE("Failed to retrieve socket address. '%s'.", strerror(errno));
+	}
+
+	const uint_fast16_t port = ntohs(socketAddress.sin6_port);
+
+	// A second 'SO_REUSEPORT' listener has to be able to share the port with the first one.
+	int socketFileDescriptor_b;
+	if((error = server_createListeningSocket(&socketFileDescriptor_b, port, true)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to create second listening socket on port %" PRIuFAST16 ". '%s'.", port, util_toErrorString(error));
+	}
+
+	close(socketFileDescriptor_a);
+	close(socketFileDescriptor_b);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(server_connectionPoolBuffer, Server, server){
+	ERROR_CODE error;
+
+	ConnectionPool pool;
+	if((error = server_initConnectionPool(&pool, 1024)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to initialise connection pool. '%s'.", util_toErrorString(error));
+	}
+
+	int8_t* buffer_a;
+	int8_t* buffer_b;
+	if((error = server_acquireBuffer(&pool, &buffer_a)) != ERROR_NO_ERROR || (error = server_acquireBuffer(&pool, &buffer_b)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to acquire buffer. '%s'.", util_toErrorString(error));
+	}
+
+	if(buffer_a == buffer_b){
+		return TEST_FAILURE("%s", "Acquired the same buffer twice.");
+	}
+
+	server_releaseBuffer(&pool, buffer_a);
+	server_releaseBuffer(&pool, buffer_b);
+
+	// Released buffers have to be handed out again, instead of allocating new ones.
+	int8_t* buffer_c;
+	if((error = server_acquireBuffer(&pool, &buffer_c)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to acquire buffer. '%s'.", util_toErrorString(error));
+	}
+
+	if(buffer_c != buffer_b){
+		return TEST_FAILURE("%s", "Failed to reuse released buffer.");
+	}
+
+	server_releaseBuffer(&pool, buffer_c);
+
+	server_freeConnectionPool(&pool);
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(server_openFile, Server, server){
+	#define TEST_FILE_NAME "/tmp/herder_server_test_openFile_XXXXXX"
+
+	char filePath[] = TEST_FILE_NAME;
+
+	#undef TEST_FILE_NAME
+
+	int tempFileDescriptor = mkstemp(filePath);
+	if(tempFileDescriptor < 1){
+		return TEST_FAILURE("Failed to create temporary file '%s' [%s].", filePath, strerror(errno));
+	}
+
+	if(write(tempFileDescriptor, "herder", 6) != 6){
+		return TEST_FAILURE("Failed to write test file. Expected to write %d bytes.", 6);
+	}
+
+	close(tempFileDescriptor);
+
+	// Cached size no longer matches the file on disk.
+	CacheObject cacheObject = {0};
+	cacheObject.fileLocation = filePath;
+	cacheObject.fileLocationLength = strlen(filePath);
+	cacheObject.size = 7;
+
+	int fileDescriptor;
+
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_OPEN_FILE);
+	ERROR_CODE error = server_openFile(&cacheObject, &fileDescriptor);
+	__UTIL_ENABLE_ERROR_LOGGING__();
+
+	if(error != ERROR_FAILED_TO_OPEN_FILE){
+		return TEST_FAILURE("Expected '%s' for a changed file but got '%s'.", util_toErrorString(ERROR_FAILED_TO_OPEN_FILE), util_toErrorString(error));
+	}
+
+	util_deleteFile(filePath);
+
+	// File is gone.
+	__UTIL_SUPPRESS_NEXT_ERROR_OF_TYPE__(ERROR_FAILED_TO_OPEN_FILE);
+	error = server_openFile(&cacheObject, &fileDescriptor);
+	__UTIL_ENABLE_ERROR_LOGGING__();
+
+	if(error != ERROR_FAILED_TO_OPEN_FILE){
+		return TEST_FAILURE("Expected '%s' for a missing file but got '%s'.", util_toErrorString(ERROR_FAILED_TO_OPEN_FILE), util_toErrorString(error));
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(server_prepareResponse, Server, server){
+	ERROR_CODE error;
+
+	int8_t buffer[256];
+
+	uint8_t body[512];
+	memset(body, 'b', sizeof(body));
+
+	CacheObject cacheObject = {0};
+	cacheObject.data = body;
+
+	Connection connection = {0};
+
+	// Note: Every response carries the current 'Date', only its length is known up front.
+	const char expectedHeader[] = "HTTP/1.1 200 OK\r\nServer: " CONSTANTS_HTTP_HEADER_FIELD_SERVER_VALUE "\r\nDate: ";
+	const uint_fast64_t expectedHeaderLength = strlen(expectedHeader) + HTTP_DATE_LENGTH + 4/*"\r\n\r\n"*/;
+
+	// Small static response, header and body share a single write.
+	http_initHttpResponse(&connection.response, buffer, sizeof(buffer), NULL);
+	connection.response.httpStatusCode = _200_OK;
+	connection.response.staticContent = true;
+	connection.response.cacheObject = &cacheObject;
+	cacheObject.size = 16;
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	if(connection.numWriteSegments != 1 || connection.writeSegments[0].length != expectedHeaderLength + 16){
+		return TEST_FAILURE("Expected a single segment of %" PRIuFAST64 " bytes but got %" PRIuFAST8 " segment(s) of %" PRIuFAST64 " bytes.", expectedHeaderLength + 16, connection.numWriteSegments, connection.writeSegments[0].length);
+	}
+
+	if(memcmp(connection.writeSegments[0].data, expectedHeader, strlen(expectedHeader)) != 0 || connection.writeSegments[0].data[expectedHeaderLength] != 'b'){
+		return TEST_FAILURE("%s", "Header block has to be followed by the body.");
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	// Large static response, the response buffer gets filled up with the beginning of the body.
+	http_initHttpResponse(&connection.response, buffer, sizeof(buffer), NULL);
+	connection.response.httpStatusCode = _200_OK;
+	connection.response.staticContent = true;
+	connection.response.cacheObject = &cacheObject;
+	cacheObject.size = sizeof(body);
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	if(connection.numWriteSegments != 2 || connection.writeSegments[0].length != sizeof(buffer) || connection.writeSegments[1].data != (int8_t*) body + sizeof(buffer) - expectedHeaderLength || connection.writeSegments[1].length != sizeof(body) - (sizeof(buffer) - expectedHeaderLength)){
+		return TEST_FAILURE("%s", "Failed to coalesce the beginning of the body with the header block.");
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	// Dynamic response, the header block has to end up in front of the already written body.
+	http_initHttpResponse(&connection.response, buffer, sizeof(buffer), NULL);
+	connection.response.httpStatusCode = _200_OK;
+	memcpy(buffer, "dynamic", 7);
+	connection.response.responseDataSegmentLength = 7;
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	if(connection.numWriteSegments != 1 || connection.writeSegments[0].length != expectedHeaderLength + 7 || memcmp(connection.writeSegments[0].data, expectedHeader, strlen(expectedHeader)) != 0 || memcmp(connection.writeSegments[0].data + expectedHeaderLength, "dynamic", 7) != 0){
+		return TEST_FAILURE("%s", "Failed to move the header block in front of the body.");
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	// Single byte range, served like a smaller body.
+	http_initHttpResponse(&connection.response, buffer, sizeof(buffer), NULL);
+	connection.response.httpStatusCode = _206_PARTIAL_CONTENT;
+	connection.response.staticContent = true;
+	connection.response.cacheObject = &cacheObject;
+	connection.response.byteRanges[0] = (HTTP_ByteRange){100, 199};
+	connection.response.numByteRanges = 1;
+	body[100] = 'r';
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	const uint_fast64_t expectedPartialHeaderLength = strlen("HTTP/1.1 206 Partial Content\r\nServer: " CONSTANTS_HTTP_HEADER_FIELD_SERVER_VALUE "\r\nDate: \r\n\r\n") + HTTP_DATE_LENGTH;
+
+	if(connection.numWriteSegments != 1 || connection.writeSegments[0].length != expectedPartialHeaderLength + 100 || connection.writeSegments[0].data[expectedPartialHeaderLength] != 'r'){
+		return TEST_FAILURE("%s", "Expected the header block followed by the requested range.");
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	// Multiple byte ranges, every range gets its own part header.
+	int8_t multipartBuffer[512];
+	http_initHttpResponse(&connection.response, multipartBuffer, sizeof(multipartBuffer), NULL);
+	connection.response.httpStatusCode = _206_PARTIAL_CONTENT;
+	connection.response.staticContent = true;
+	connection.response.cacheObject = &cacheObject;
+	connection.response.byteRanges[0] = (HTTP_ByteRange){0, 9};
+	connection.response.byteRanges[1] = (HTTP_ByteRange){500, 511};
+	connection.response.numByteRanges = 2;
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	if(connection.numWriteSegments != 5 || connection.writeSegments[1].data != (int8_t*) body || connection.writeSegments[1].length != 10 || connection.writeSegments[3].data != (int8_t*) body + 500 || connection.writeSegments[3].length != 12){
+		return TEST_FAILURE("Expected 5 segments alternating between part headers and ranges but got %" PRIuFAST8 ".", connection.numWriteSegments);
+	}
+
+	const char expectedClosingBoundary[] = "\r\n--" CONSTANTS_HTTP_MULTIPART_BYTERANGES_BOUNDARY "--\r\n";
+	if(connection.writeSegments[4].length != strlen(expectedClosingBoundary) || memcmp(connection.writeSegments[4].data, expectedClosingBoundary, strlen(expectedClosingBoundary)) != 0){
+		return TEST_FAILURE("%s", "Multipart body has to end with the closing boundary.");
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	// Pre-serialized header fields go out after 'Date', right before the body.
+	http_initHttpResponse(&connection.response, buffer, sizeof(buffer), NULL);
+	connection.response.httpStatusCode = _200_OK;
+	connection.response.staticContent = true;
+	connection.response.cacheObject = &cacheObject;
+	connection.response.headerBlock = "Content-Length: 16\r\n";
+	connection.response.headerBlockLength = 20;
+	cacheObject.size = 16;
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	if(connection.numWriteSegments != 1 || connection.writeSegments[0].length != expectedHeaderLength + 20 + 16 || memcmp(connection.writeSegments[0].data + expectedHeaderLength - 2, "Content-Length: 16\r\n\r\nb", 23) != 0){
+		return TEST_FAILURE("%s", "Header block has to end with the pre-serialized header fields.");
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	// HEAD, only the header block goes out, the body is neither copied nor sent.
+	http_initHttpResponse(&connection.response, buffer, sizeof(buffer), NULL);
+	connection.request.httpRequestType = HTTP_REQUEST_TYPE_HEAD;
+	connection.response.httpStatusCode = _200_OK;
+	connection.response.staticContent = true;
+	connection.response.cacheObject = &cacheObject;
+	connection.response.headerBlock = "Content-Length: 512\r\n";
+	connection.response.headerBlockLength = 21;
+	cacheObject.size = sizeof(body);
+
+	if((error = server_prepareResponse(&connection)) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to prepare response. '%s'.", util_toErrorString(error));
+	}
+
+	if(connection.numWriteSegments != 1 || connection.writeSegments[0].length != expectedHeaderLength + 21 || memcmp(connection.writeSegments[0].data + expectedHeaderLength - 2, "Content-Length: 512\r\n\r\n", 23) != 0 || connection.response.fileDescriptor != -1){
+		return TEST_FAILURE("Expected only the header block for HEAD but got %" PRIuFAST8 " segment(s) of %" PRIuFAST64 " bytes.", connection.numWriteSegments, connection.writeSegments[0].length);
+	}
+
+	http_freeHTTP_Response(&connection.response);
+
+	connection.request.httpRequestType = HTTP_REQUEST_TYPE_UNKNOWN;
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(server_expireIdleConnections, Server, server){
+	ConnectionIdleList idleList = {.lock = PTHREAD_MUTEX_INITIALIZER, .timeout = 0};
+	ConnectionIdleList sendingList = {.lock = PTHREAD_MUTEX_INITIALIZER, .timeout = 60 * 1000};
+
+	EpollWorker worker = {0};
+	worker.server = server;
+	worker.idleConnections = &idleList;
+	worker.sendingConnections = &sendingList;
+
+	Connection waiting = {0};
+	waiting.socketFileDescriptor = -1;
+
+	Connection sending = {0};
+	sending.socketFileDescriptor = -1;
+
+	server_markConnectionIdle(&worker, &waiting, false);
+	server_markConnectionIdle(&worker, &sending, true);
+
+	if(idleList.head != &waiting || sendingList.head != &sending){
+		return TEST_FAILURE("%s", "Connections that stalled while sending have to go on their own list.");
+	}
+
+	// A stalled response outlives the keep-alive timeout.
+	server_expireIdleConnections(&worker);
+
+	if(waiting.idle || idleList.head != NULL){
+		return TEST_FAILURE("%s", "Expected the waiting connection to expire.");
+	}
+
+	if(!sending.idle || sendingList.head != &sending){
+		return TEST_FAILURE("%s", "Expected the sending connection to wait for its own timeout.");
+	}
+
+	server_unmarkConnectionIdle(&worker, &sending);
+
+	if(sending.idle || sendingList.head != NULL || sendingList.tail != NULL){
+		return TEST_FAILURE("%s", "Failed to take the sending connection off its list.");
+	}
+
+	return TEST_SUCCESS;
+}
+
+TEST_TEST_FUNCTION_(server_ioUringCloseMidResponse, Server, server){
+	ERROR_CODE error;
+
+	int sockets[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0){
+		return TEST_FAILURE("Failed to create socket pair. '%s'", strerror(errno));
+	}
+
+	IoUring ring;
+	if((error = ioUring_init(&ring, 8)) != ERROR_NO_ERROR){
+		close(sockets[0]);
+		close(sockets[1]);
+
+		return TEST_FAILURE("Failed to initialise io_uring. '%s'", util_toErrorString(error));
+	}
+
+	server->networkBackend = SERVER_NETWORK_BACKEND_IO_URING;
+	server->sslContext = SSL_CTX_new(TLS_server_method());
+
+	ConnectionPool pool;
+	server_initConnectionPool(&pool, 1024);
+
+	ConnectionIdleList idleList = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+	EpollWorker worker = {0};
+	worker.server = server;
+	worker.ring = &ring;
+	worker.idleConnections = &idleList;
+	worker.connectionPool = &pool;
+
+	Connection* connection;
+	if((error = server_acquireConnection(&worker, &connection, sockets[0])) != ERROR_NO_ERROR){
+		return TEST_FAILURE("Failed to acquire connection. '%s'.", util_toErrorString(error));
+	}
+
+	// The response streams a file from disk and is stalled on the socket when the client goes away.
+	const int fileDescriptor = open("/dev/zero", O_RDONLY);
+
+	connection->response.fileDescriptor = fileDescriptor;
+	connection->state = SERVER_CONNECTION_STATE_WRITING;
+
+	close(sockets[1]);
+
+	server_ioUringHandleReceive(&worker, connection, 0, 0);
+
+	const bool fileClosed = fcntl(fileDescriptor, F_GETFD) == -1 && errno == EBADF;
+	const bool released = pool.freeConnections == connection;
+
+	if(!fileClosed){
+		close(fileDescriptor);
+	}
+
+	server_freeConnectionPool(&pool);
+
+	SSL_CTX_free(server->sslContext);
+	server->sslContext = NULL;
+
+	ioUring_free(&ring);
+
+	if(!released){
+		return TEST_FAILURE("%s", "Expected the connection to be released once the client hung up.");
+	}
+
+	if(!fileClosed){
+		return TEST_FAILURE("%s", "Releasing the connection has to close the file its response was streamed from.");
+	}
+
+	return TEST_SUCCESS;
+}
+
 #endif
@@ -26,6 +26,15 @@ TEST_TEST_FUNCTION(util_findFirst_s){
 		}
 	}
 
+	{
+		// Note: The match overlaps with a partial match in front of it.
+		const char a[] = "aaab";
+
+		if(util_findFirst_s(a, strlen(a), "aab", 3) != 1){
+			return TEST_FAILURE("Failed to find fisrt string: 'aab' in string:'%s'.", a);
+		}
+	}
+
 	{
 		const uint_fast64_t stringLength = strlen("aabbccdd--11223344");
 		char* s = alloca(stringLength+ 1);
@@ -52,6 +61,64 @@ TEST_TEST_FUNCTION(util_findFirst_s){
 	return TEST_SUCCESS;
 }
 
+TEST_TEST_FUNCTION(util_scanImplementations){
+	const UtilScanImplementation detectedImplementation = util_getScanImplementation();
+
+	// Note: Buffers are allocated with their exact length, reads past the end show up in sanitized builds.
+	const char needle[] = "\r\n\r\n0123456789abcdef";
+
+	UtilScanImplementation implementation;
+	for(implementation = UTIL_SCAN_IMPLEMENTATION_PORTABLE; implementation <= util_detectScanImplementation(); implementation++){
+		if(util_setScanImplementation(implementation) != ERROR_NO_ERROR){
+			return TEST_FAILURE("Failed to select scan implementation '%s'.", util_scanImplementationToString(implementation));
+		}
+
+		uint_fast64_t length;
+		for(length = 1; length < 80; length++){
+			char* buffer = malloc(length);
+
+			uint_fast64_t position;
+			for(position = 0; position < length; position++){
+				memset(buffer, '\r', length);
+				buffer[position] = ':';
+
+				if(util_findFirst(buffer, length, ':') != (int_fast64_t) position){
+					free(buffer);
+
+					return TEST_FAILURE("'%s' failed to find ':' at %" PRIuFAST64 " of %" PRIuFAST64 ".", util_scanImplementationToString(implementation), position, length);
+				}
+
+				uint_fast64_t stringLength;
+				for(stringLength = 1; stringLength < sizeof(needle) && position + stringLength <= length; stringLength++){
+					// Note: The buffer starts with a partial match, the whole string has to match.
+					memset(buffer, '\r', length);
+					memcpy(buffer + position, needle, stringLength);
+
+					if(util_findFirst_s(buffer, length, needle, stringLength) != (int_fast64_t) (stringLength == 1 && position > 0 ? 0 : position)){
+						free(buffer);
+
+						return TEST_FAILURE("'%s' failed to find string of length %" PRIuFAST64 " at %" PRIuFAST64 " of %" PRIuFAST64 ".", util_scanImplementationToString(implementation), stringLength, position, length);
+					}
+				}
+			}
+
+			memset(buffer, '\r', length);
+
+			if(util_findFirst(buffer, length, ':') != -1 || util_findFirst_s(buffer, length, "\r\n", 2) != -1){
+				free(buffer);
+
+				return TEST_FAILURE("'%s' found a match in a buffer of length %" PRIuFAST64 " without one.", util_scanImplementationToString(implementation), length);
+			}
+
+			free(buffer);
+		}
+	}
+
+	util_setScanImplementation(detectedImplementation);
+
+	return TEST_SUCCESS;
+}
+
 TEST_TEST_FUNCTION(util_findLast){
 	const char a[] = "01234...567";
 	const char b[] = "01234567";
@@ -759,6 +826,15 @@ TEST_TEST_FUNCTION(util_hash){
 	return TEST_SUCCESS;
 }
 
+TEST_TEST_FUNCTION(util_hash64){
+	// Reference values of the FNV-1a specification.
+	if(util_hash64((uint8_t*) "", 0) != 0xCBF29CE484222325 || util_hash64((uint8_t*) "a", 1) != 0xAF63DC4C8601EC8C){
+		return TEST_FAILURE("%s", "Hash does not match the FNV-1a reference values.");
+	}
+
+	return TEST_SUCCESS;
+}
+
 TEST_TEST_FUNCTION(util_renameFile){
 	ERROR_CODE error;
 
@@ -1196,6 +1272,12 @@ TEST_TEST_FUNCTION(util_intToString){
 	 	return TEST_FAILURE("'%s' != '10'", string);
 	}
 
+	UTIL_INT_TO_STRING_HEAP_ALLOCATED(zeroString, 0);
+
+	if(strcmp(zeroString, "0") != 0){
+	 	return TEST_FAILURE("'%s' != '0'", zeroString);
+	}
+
 	return TEST_SUCCESS;
 }
 
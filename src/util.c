@@ -7,6 +7,11 @@
 #include <string.h>
 #include <sys/syslog.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+	#define UTIL_SCAN_X86
+	#include <immintrin.h>
+#endif
+
 /**
  * Converts a given number <b>value</b> into a easy readable formated number string.
  *
@@ -133,37 +138,235 @@ local const char* UTIL_ERROR_CODE_MESSAGE_MAPPING_ARRAY[] = {
 	"ERROR_INVALID_SIGNAL",
 	"ERROR_FILE_NOT_FOUND",
 	"ERROR_NOT_A_NUMBER",
+	"ERROR_FAILED_TO_INITIALISE_IO_URING",
+	"ERROR_FAILED_TO_COMPRESS",
+	"ERROR_HTTP2_PROTOCOL_ERROR",
+	"ERROR_HPACK_DECOMPRESSION_FAILED",
+	"ERROR_METHOD_NOT_ALLOWED",
+	"ERROR_CACHE_ADMISSION_DENIED",
 };
 
 inline const char* util_toErrorString(const ERROR_CODE errorCode){
 	return UTIL_ERROR_CODE_MESSAGE_MAPPING_ARRAY[errorCode];
 }
 
-inline int_fast64_t util_findFirst(const char* s, const uint_fast64_t length, const char c) {
-	int_fast64_t i;
-	for (i = 0; i < (int_fast64_t) length; i++){
-		if(*(s + i) == c){
-			return i;
+local int_fast64_t util_findFirstPortable(const char* s, const uint_fast64_t length, const char c){
+	const char* match = memchr(s, c, length);
+
+	return match == NULL ? -1 : match - s;
+}
+
+local int_fast64_t util_findFirst_sPortable(const char* buffer, const uint_fast64_t bufferLength, const char* s, const uint_fast64_t stringLength){
+	if(stringLength == 0 || stringLength > bufferLength){
+		return -1;
+	}
+
+	// Note: Candidates are found by their first character, only those get compared as a whole.
+	const char* const end = buffer + (bufferLength - stringLength) + 1;
+
+	const char* candidate = buffer;
+	while((candidate = memchr(candidate, s[0], end - candidate)) != NULL){
+		if(memcmp(candidate + 1, s + 1, stringLength - 1) == 0){
+			return candidate - buffer;
 		}
+
+		candidate++;
 	}
 
 	return -1;
 }
 
-inline int_fast64_t util_findFirst_s(const char* buffer, const uint_fast64_t bufferLength, const char* s, const uint_fast64_t stringLength) {
+#ifdef UTIL_SCAN_X86
+// Note: The SIMD implementations never load past 'length', the last block of a buffer that is not a multiple of the vector width gets loaded overlapping with the one in front of it. Buffers shorter than a single vector are left to the portable implementations.
+__attribute__((target("sse4.2"))) local int_fast64_t util_findFirstSSE4_2(const char* s, const uint_fast64_t length, const char c){
+	if(length < 16){
+		return util_findFirstPortable(s, length, c);
+	}
+
+	const __m128i character = _mm_set1_epi8(c);
+
 	uint_fast64_t offset = 0;
-	int_fast64_t i;
-	for (i = 0; i < (int_fast64_t) bufferLength; i++){
-		if(buffer[i] == s[offset++]){
-			if(offset == stringLength){
-				return i - (stringLength - 1);
+	for(;;){
+		const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (s + offset)), character));
+		if(mask != 0){
+			return offset + __builtin_ctz(mask);
+		}
+
+		if(offset + 16 == length){
+			return -1;
+		}
+
+		offset = MIN(offset + 16, length - 16);
+	}
+}
+
+__attribute__((target("avx2"))) local int_fast64_t util_findFirstAVX2(const char* s, const uint_fast64_t length, const char c){
+	if(length < 32){
+		return util_findFirstSSE4_2(s, length, c);
+	}
+
+	const __m256i character = _mm256_set1_epi8(c);
+
+	uint_fast64_t offset = 0;
+	for(;;){
+		const uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (s + offset)), character));
+		if(mask != 0){
+			return offset + __builtin_ctz(mask);
+		}
+
+		if(offset + 32 == length){
+			return -1;
+		}
+
+		offset = MIN(offset + 32, length - 32);
+	}
+}
+
+// Note: PCMPESTRI in 'equal ordered' mode finds the first position in a 16 byte block the string starts at. Matches that run past the end of the block get reported as well and are compared as a whole. Strings longer than a block are left to the portable implementation.
+__attribute__((target("sse4.2"))) local int_fast64_t util_findFirst_sSSE4_2(const char* buffer, const uint_fast64_t bufferLength, const char* s, const uint_fast64_t stringLength){
+	if(stringLength == 0 || stringLength > 16 || stringLength > bufferLength){
+		return util_findFirst_sPortable(buffer, bufferLength, s, stringLength);
+	}
+
+	char string[16] = {0};
+	memcpy(string, s, stringLength);
+
+	const __m128i needle = _mm_loadu_si128((const __m128i*) string);
+
+	uint_fast64_t offset = 0;
+	while(offset + 16 <= bufferLength){
+		const int index = _mm_cmpestri(needle, stringLength, _mm_loadu_si128((const __m128i*) (buffer + offset)), 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ORDERED | _SIDD_LEAST_SIGNIFICANT);
+		if(index == 16){
+			offset += 16;
+
+			continue;
+		}
+
+		if(index + stringLength <= 16 || (offset + index + stringLength <= bufferLength && memcmp(buffer + offset + index, s, stringLength) == 0)){
+			return offset + index;
+		}
+
+		offset += index + 1;
+	}
+
+	const int_fast64_t index = util_findFirst_sPortable(buffer + offset, bufferLength - offset, s, stringLength);
+
+	return index == -1 ? -1 : (int_fast64_t) offset + index;
+}
+
+// Note: Candidates have to match the first and the last character of the string, 32 positions get filtered at once. Only candidates get compared as a whole.
+__attribute__((target("avx2"))) local int_fast64_t util_findFirst_sAVX2(const char* buffer, const uint_fast64_t bufferLength, const char* s, const uint_fast64_t stringLength){
+	if(stringLength < 2 || stringLength > bufferLength){
+		return stringLength == 1 ? util_findFirstAVX2(buffer, bufferLength, s[0]) : util_findFirst_sPortable(buffer, bufferLength, s, stringLength);
+	}
+
+	const __m256i first = _mm256_set1_epi8(s[0]);
+	const __m256i last = _mm256_set1_epi8(s[stringLength - 1]);
+
+	uint_fast64_t offset = 0;
+	for(; offset + (stringLength - 1) + 32 <= bufferLength; offset += 32){
+		const __m256i firstBlock = _mm256_loadu_si256((const __m256i*) (buffer + offset));
+		const __m256i lastBlock = _mm256_loadu_si256((const __m256i*) (buffer + offset + stringLength - 1));
+
+		uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first), _mm256_cmpeq_epi8(lastBlock, last)));
+		while(mask != 0){
+			const uint_fast64_t index = offset + __builtin_ctz(mask);
+
+			if(memcmp(buffer + index + 1, s + 1, stringLength - 2) == 0){
+				return index;
 			}
-		}else{
-			offset = 0;
+
+			mask &= mask - 1;
 		}
 	}
 
-	return -1;
+	const int_fast64_t index = util_findFirst_sSSE4_2(buffer + offset, bufferLength - offset, s, stringLength);
+
+	return index == -1 ? -1 : (int_fast64_t) offset + index;
+}
+#endif
+
+// Note: Picked once at startup by 'util_setScanImplementation', before that the portable implementations are used. Not synchronised, has to happen before other threads get started.
+local UtilScanImplementation util_scanImplementation = UTIL_SCAN_IMPLEMENTATION_PORTABLE;
+local int_fast64_t (*util_findFirstImplementation)(const char*, const uint_fast64_t, const char) = util_findFirstPortable;
+local int_fast64_t (*util_findFirst_sImplementation)(const char*, const uint_fast64_t, const char*, const uint_fast64_t) = util_findFirst_sPortable;
+
+// Note: The best implementation the CPU supports, '__builtin_cpu_supports' queries CPUID and checks that the OS saves the AVX registers.
+inline UtilScanImplementation util_detectScanImplementation(void){
+#ifdef UTIL_SCAN_X86
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx2")){
+		return UTIL_SCAN_IMPLEMENTATION_AVX2;
+	}
+
+	if(__builtin_cpu_supports("sse4.2")){
+		return UTIL_SCAN_IMPLEMENTATION_SSE4_2;
+	}
+#endif
+
+	return UTIL_SCAN_IMPLEMENTATION_PORTABLE;
+}
+
+// Note: Fails with 'ERROR_INVALID_VALUE' for implementations the CPU does not support.
+inline ERROR_CODE util_setScanImplementation(const UtilScanImplementation implementation){
+	if(implementation >= UTIL_NUM_SCAN_IMPLEMENTATIONS || implementation > util_detectScanImplementation()){
+		return ERROR_(ERROR_INVALID_VALUE, "Scan implementation '%d' is not supported.", implementation);
+	}
+
+	switch(implementation){
+#ifdef UTIL_SCAN_X86
+		case UTIL_SCAN_IMPLEMENTATION_AVX2:{
+			util_findFirstImplementation = util_findFirstAVX2;
+			util_findFirst_sImplementation = util_findFirst_sAVX2;
+
+			break;
+		}
+		case UTIL_SCAN_IMPLEMENTATION_SSE4_2:{
+			util_findFirstImplementation = util_findFirstSSE4_2;
+			util_findFirst_sImplementation = util_findFirst_sSSE4_2;
+
+			break;
+		}
+#endif
+		default:{
+			util_findFirstImplementation = util_findFirstPortable;
+			util_findFirst_sImplementation = util_findFirst_sPortable;
+
+			break;
+		}
+	}
+
+	util_scanImplementation = implementation;
+
+	return ERROR(ERROR_NO_ERROR);
+}
+
+inline UtilScanImplementation util_getScanImplementation(void){
+	return util_scanImplementation;
+}
+
+inline const char* util_scanImplementationToString(const UtilScanImplementation implementation){
+	switch(implementation){
+		case UTIL_SCAN_IMPLEMENTATION_AVX2:{
+			return "AVX2";
+		}
+		case UTIL_SCAN_IMPLEMENTATION_SSE4_2:{
+			return "SSE4.2";
+		}
+		default:{
+			return "portable";
+		}
+	}
+}
+
+inline int_fast64_t util_findFirst(const char* s, const uint_fast64_t length, const char c) {
+	return util_findFirstImplementation(s, length, c);
+}
+
+// Note: Strings of length 0 are never found.
+inline int_fast64_t util_findFirst_s(const char* buffer, const uint_fast64_t bufferLength, const char* s, const uint_fast64_t stringLength) {
+	return util_findFirst_sImplementation(buffer, bufferLength, s, stringLength);
 }
 
 inline int_fast64_t util_findLast(const char* s, const uint_fast64_t length, const char c) {
@@ -264,6 +467,18 @@ inline int util_hashString(const char* s, uint_fast64_t length){
 	return util_hash((uint8_t*) s, length);
 }
 
+// FNV-1a - 64 bit hash implementation. see(http://www.isthe.com/chongo/tech/comp/fnv/index.html)
+inline uint64_t util_hash64(const uint8_t* s, uint_fast64_t length){
+	uint64_t hash = 0xCBF29CE484222325;
+
+	while(length-- != 0){
+		hash ^= *s++;
+		hash *= 0x100000001B3;
+	}
+
+	return hash;
+}
+
 // Note: 'directory' has to be slash terminated. (jan - 2019.05.20)
 ERROR_CODE util_deleteDirectory(const char* directory, const bool preserveRoot, const bool emptyDirectoriesOnly){
 	ERROR_CODE error = ERROR_NO_ERROR;
@@ -468,6 +683,13 @@ inline int_fast32_t util_getNumAvailableProcessorCores(void){
 	return sysconf(_SC_NPROCESSORS_ONLN);
 }
 
+inline uint_fast64_t util_getMonotonicTimeMillis(void){
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (uint_fast64_t) time.tv_sec * 1000 + time.tv_nsec / 1000000;
+}
+
 inline ERROR_CODE util_getBaseDirectory(char** baseDirectory, uint_fast64_t* baseDirectoryLength, char* url, uint_fast64_t urlLength){
 	const int_fast64_t firstSeperator = util_findFirst(url, urlLength, '/');
 
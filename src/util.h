@@ -60,7 +60,7 @@
 #define UTIL_INT_TO_STRING_HEAP_ALLOCATED(name, value) char* name; \
 	uint_fast64_t name ## Length; \
 	do{ \
-	name ## Length =(uint_fast64_t) floor(log10(labs((int_fast64_t) value))) + 1 + 1/*'\0'*/; \
+	name ## Length = snprintf(NULL, 0, "%" PRIdFAST64 "", (int_fast64_t) value) + 1/*'\0'*/; \
 	\
 	name = alloca(name ## Length); \
 	snprintf(name, name ## Length, "%" PRIdFAST64 "", (int_fast64_t) value); \
@@ -147,7 +147,13 @@ typedef enum{
 	ERROR_FAILED_TO_INITIALISE_EPOLL,
 	ERROR_INVALID_SIGNAL,
 	ERROR_FILE_NOT_FOUND,
-	ERROR_NOT_A_NUMBER
+	ERROR_NOT_A_NUMBER,
+	ERROR_FAILED_TO_INITIALISE_IO_URING,
+	ERROR_FAILED_TO_COMPRESS,
+	ERROR_HTTP2_PROTOCOL_ERROR,
+	ERROR_HPACK_DECOMPRESSION_FAILED,
+	ERROR_METHOD_NOT_ALLOWED,
+	ERROR_CACHE_ADMISSION_DENIED
 }ERROR_CODE;
 
 ERROR_CODE util_formatNumber(char*, uint_fast64_t*, const int_fast64_t);
@@ -269,6 +275,22 @@ inline ERROR_CODE util_error(const ERROR_CODE error, const char* file, const int
 
 #include "linkedList.h"
 
+// Note: Implementations of the scanning primitives ('util_findFirst', 'util_findFirst_s'), ordered from slowest to fastest.
+typedef enum{
+	UTIL_SCAN_IMPLEMENTATION_PORTABLE = 0,
+	UTIL_SCAN_IMPLEMENTATION_SSE4_2,
+	UTIL_SCAN_IMPLEMENTATION_AVX2,
+	UTIL_NUM_SCAN_IMPLEMENTATIONS
+}UtilScanImplementation;
+
+UtilScanImplementation util_detectScanImplementation(void);
+
+ERROR_CODE util_setScanImplementation(const UtilScanImplementation);
+
+UtilScanImplementation util_getScanImplementation(void);
+
+const char* util_scanImplementationToString(const UtilScanImplementation);
+
 int_fast64_t util_findFirst(const char*, const uint_fast64_t, const char);
 
 int_fast64_t util_findFirst_s(const char*, const uint_fast64_t, const char*, const uint_fast64_t);
@@ -289,6 +311,8 @@ int util_hash(uint8_t*, uint_fast64_t);
 
 int util_hashString(const char*, uint_fast64_t);
 
+uint64_t util_hash64(const uint8_t*, uint_fast64_t);
+
 ERROR_CODE util_deleteFile(const char*);
 
 ERROR_CODE util_deleteDirectory(const char*, const bool, const bool);
@@ -313,6 +337,8 @@ void util_replace(char*, const uint_fast64_t, uint_fast64_t*, const char*, const
 
 int_fast32_t util_getNumAvailableProcessorCores(void);
 
+uint_fast64_t util_getMonotonicTimeMillis(void);
+
 ERROR_CODE util_getBaseDirectory(char**, uint_fast64_t*, char*, uint_fast64_t);
 
 ERROR_CODE util_concatenate(char*, const char*, const uint_fast64_t, const char*, const uint_fast64_t);